@@ -50,6 +50,7 @@ extern char **environ;
 #    define cupsRasterReadHeader cupsRasterReadHeader2
 #    define cupsRasterWriteHeader cupsRasterWriteHeader2
 #    define httpAddrConnect httpAddrConnect2
+#    define httpAddrGetString httpAddrString
 #    define httpConnect httpConnect2
 #    define httpDecode64 httpDecode64_2
 #    define httpEncode64 httpEncode64_2
@@ -85,15 +86,122 @@ typedef cups_raster_iocb_t cups_raster_cb_t;
 #  define _PAPPL_LOC(s) s
 #  define _PAPPL_LOOKUP_STRING(bit,strings) _papplLookupString(bit, sizeof(strings) / sizeof(strings[0]), strings)
 #  define _PAPPL_LOOKUP_VALUE(keyword,strings) _papplLookupValue(keyword, sizeof(strings) / sizeof(strings[0]), strings)
+#  define _PAPPL_REQUESTED(ra,attr) (!(ra) || ((ra)->bits[(attr) / 8] & (1 << ((attr) & 7))))
 
 
 //
 // Types and structures...
 //
 
+typedef enum _pappl_rattr_e		// Attributes checked by the copy functions, sorted by name
+{
+  _PAPPL_RA_COPIES_SUPPORTED,
+  _PAPPL_RA_DATE_TIME_AT_COMPLETED,
+  _PAPPL_RA_DATE_TIME_AT_CREATION,
+  _PAPPL_RA_DATE_TIME_AT_PROCESSING,
+  _PAPPL_RA_IDENTIFY_ACTIONS_DEFAULT,
+  _PAPPL_RA_JOB_IMPRESSIONS,
+  _PAPPL_RA_JOB_IMPRESSIONS_COMPLETED,
+  _PAPPL_RA_JOB_PRINTER_UP_TIME,
+  _PAPPL_RA_JOB_STATE,
+  _PAPPL_RA_JOB_STATE_MESSAGE,
+  _PAPPL_RA_JOB_STATE_REASONS,
+  _PAPPL_RA_LABEL_MODE_CONFIGURED,
+  _PAPPL_RA_LABEL_TEAR_OFFSET_CONFIGURED,
+  _PAPPL_RA_MARKER_COLORS,
+  _PAPPL_RA_MARKER_HIGH_LEVELS,
+  _PAPPL_RA_MARKER_LEVELS,
+  _PAPPL_RA_MARKER_LOW_LEVELS,
+  _PAPPL_RA_MARKER_NAMES,
+  _PAPPL_RA_MARKER_TYPES,
+  _PAPPL_RA_MEDIA_COL_DEFAULT,
+  _PAPPL_RA_MEDIA_COL_READY,
+  _PAPPL_RA_MEDIA_DEFAULT,
+  _PAPPL_RA_MEDIA_READY,
+  _PAPPL_RA_MULTIPLE_DOCUMENT_HANDLING_DEFAULT,
+  _PAPPL_RA_ORIENTATION_REQUESTED_DEFAULT,
+  _PAPPL_RA_OUTPUT_BIN_DEFAULT,
+  _PAPPL_RA_PRINT_COLOR_MODE_DEFAULT,
+  _PAPPL_RA_PRINT_CONTENT_OPTIMIZE_DEFAULT,
+  _PAPPL_RA_PRINT_QUALITY_DEFAULT,
+  _PAPPL_RA_PRINT_SCALING_DEFAULT,
+  _PAPPL_RA_PRINTER_CONFIG_CHANGE_DATE_TIME,
+  _PAPPL_RA_PRINTER_CONFIG_CHANGE_TIME,
+  _PAPPL_RA_PRINTER_CONTACT_COL,
+  _PAPPL_RA_PRINTER_CURRENT_TIME,
+  _PAPPL_RA_PRINTER_DARKNESS_CONFIGURED,
+  _PAPPL_RA_PRINTER_DNS_SD_NAME,
+  _PAPPL_RA_PRINTER_FIRMWARE_NAME,
+  _PAPPL_RA_PRINTER_FIRMWARE_PATCHES,
+  _PAPPL_RA_PRINTER_FIRMWARE_STRING_VERSION,
+  _PAPPL_RA_PRINTER_FIRMWARE_VERSION,
+  _PAPPL_RA_PRINTER_GEO_LOCATION,
+  _PAPPL_RA_PRINTER_ICONS,
+  _PAPPL_RA_PRINTER_IMPRESSIONS_COMPLETED,
+  _PAPPL_RA_PRINTER_INPUT_TRAY,
+  _PAPPL_RA_PRINTER_IS_ACCEPTING_JOBS,
+  _PAPPL_RA_PRINTER_LOCATION,
+  _PAPPL_RA_PRINTER_MORE_INFO,
+  _PAPPL_RA_PRINTER_ORGANIZATION,
+  _PAPPL_RA_PRINTER_ORGANIZATIONAL_UNIT,
+  _PAPPL_RA_PRINTER_RESOLUTION_DEFAULT,
+  _PAPPL_RA_PRINTER_SPEED_DEFAULT,
+  _PAPPL_RA_PRINTER_STATE,
+  _PAPPL_RA_PRINTER_STATE_CHANGE_DATE_TIME,
+  _PAPPL_RA_PRINTER_STATE_CHANGE_TIME,
+  _PAPPL_RA_PRINTER_STATE_MESSAGE,
+  _PAPPL_RA_PRINTER_STATE_REASONS,
+  _PAPPL_RA_PRINTER_STRINGS_LANGUAGES_SUPPORTED,
+  _PAPPL_RA_PRINTER_STRINGS_URI,
+  _PAPPL_RA_PRINTER_SUPPLY,
+  _PAPPL_RA_PRINTER_SUPPLY_DESCRIPTION,
+  _PAPPL_RA_PRINTER_SUPPLY_INFO_URI,
+  _PAPPL_RA_PRINTER_UP_TIME,
+  _PAPPL_RA_PRINTER_URI_SUPPORTED,
+  _PAPPL_RA_PRINTER_WIFI_SSID,
+  _PAPPL_RA_PRINTER_WIFI_STATE,
+  _PAPPL_RA_PRINTER_XRI_SUPPORTED,
+  _PAPPL_RA_QUEUED_JOB_COUNT,
+  _PAPPL_RA_SIDES_DEFAULT,
+  _PAPPL_RA_SYSTEM_CONFIG_CHANGE_DATE_TIME,
+  _PAPPL_RA_SYSTEM_CONFIG_CHANGE_TIME,
+  _PAPPL_RA_SYSTEM_CONFIGURED_PRINTERS,
+  _PAPPL_RA_SYSTEM_CONTACT_COL,
+  _PAPPL_RA_SYSTEM_CURRENT_TIME,
+  _PAPPL_RA_SYSTEM_DEFAULT_PRINTER_ID,
+  _PAPPL_RA_SYSTEM_FIRMWARE_NAME,
+  _PAPPL_RA_SYSTEM_FIRMWARE_PATCHES,
+  _PAPPL_RA_SYSTEM_FIRMWARE_STRING_VERSION,
+  _PAPPL_RA_SYSTEM_FIRMWARE_VERSION,
+  _PAPPL_RA_SYSTEM_GEO_LOCATION,
+  _PAPPL_RA_SYSTEM_LOCATION,
+  _PAPPL_RA_SYSTEM_NAME,
+  _PAPPL_RA_SYSTEM_ORGANIZATION,
+  _PAPPL_RA_SYSTEM_ORGANIZATIONAL_UNIT,
+  _PAPPL_RA_SYSTEM_STATE,
+  _PAPPL_RA_SYSTEM_STATE_CHANGE_DATE_TIME,
+  _PAPPL_RA_SYSTEM_STATE_CHANGE_TIME,
+  _PAPPL_RA_SYSTEM_STATE_REASONS,
+  _PAPPL_RA_SYSTEM_UP_TIME,
+  _PAPPL_RA_SYSTEM_UUID,
+  _PAPPL_RA_SYSTEM_XRI_SUPPORTED,
+  _PAPPL_RA_TIME_AT_COMPLETED,
+  _PAPPL_RA_TIME_AT_CREATION,
+  _PAPPL_RA_TIME_AT_PROCESSING,
+  _PAPPL_RA_URI_AUTHENTICATION_SUPPORTED,
+  _PAPPL_RA_MAX
+} _pappl_rattr_t;
+
+typedef struct _pappl_ra_s		// Compiled requested attributes
+{
+  cups_array_t		*names;			// Requested attribute names
+  unsigned char		bits[(_PAPPL_RA_MAX + 7) / 8];
+						// Requested attribute bits
+} _pappl_ra_t;
+
 typedef struct _pappl_ipp_filter_s	// Attribute filter
 {
-  cups_array_t		*ra;			// Requested attributes
+  _pappl_ra_t		*ra;			// Requested attributes
   ipp_tag_t		group_tag;		// Group to copy
 } _pappl_ipp_filter_t;
 
@@ -111,7 +219,10 @@ typedef struct _pappl_link_s		// Web interface navigation link
 
 extern ipp_t		*_papplContactExport(pappl_contact_t *contact) _PAPPL_PRIVATE;
 extern void		_papplContactImport(ipp_t *col, pappl_contact_t *contact) _PAPPL_PRIVATE;
-extern void		_papplCopyAttributes(ipp_t *to, ipp_t *from, cups_array_t *ra, ipp_tag_t group_tag, int quickcopy) _PAPPL_PRIVATE;
+extern void		_papplCopyAttributes(ipp_t *to, ipp_t *from, _pappl_ra_t *ra, ipp_tag_t group_tag, int quickcopy) _PAPPL_PRIVATE;
+extern _pappl_ra_t	*_papplCreateRequestedAttrs(cups_array_t *names) _PAPPL_PRIVATE;
+extern void		_papplDeleteRequestedAttrs(_pappl_ra_t *ra) _PAPPL_PRIVATE;
+extern int		_papplGetNumCPUs(void) _PAPPL_PRIVATE;
 extern const char	*_papplLookupString(unsigned bit, size_t num_strings, const char * const *strings) _PAPPL_PRIVATE;
 extern unsigned		_papplLookupValue(const char *keyword, size_t num_strings, const char * const *strings) _PAPPL_PRIVATE;
 
@@ -15,6 +15,13 @@
 #  include "log.h"
 
 
+//
+// Constants...
+//
+
+#  define _PAPPL_HTML_BUFFER	65536	// Size of HTML output buffer
+
+
 //
 // Client structure...
 //
@@ -23,8 +30,10 @@ struct _pappl_client_s			// Client data
 {
   pappl_system_t	*system;		// Containing system
   int			number;			// Connection number
-  pthread_t		thread_id;		// Thread ID
   http_t		*http;			// HTTP connection
+  bool			started;		// Has the first request been seen?
+  bool			vary_encoding;		// Does the response depend on Accept-Encoding?
+  time_t		idle_time;		// Time connection became idle
   ipp_t			*request,		// IPP request
 			*response;		// IPP response
   time_t		start;			// Request start time
@@ -44,6 +53,9 @@ struct _pappl_client_s			// Client data
   pappl_loc_t		*loc;			// Localization, if any
   int			num_files;		// Number of temporary files
   char			*files[10];		// Temporary files
+  bool			html_buffer;		// Buffer HTML output?
+  char			*html;			// HTML output buffer, if any
+  size_t		html_used;		// Bytes used in HTML output buffer
 };
 
 
@@ -61,7 +73,8 @@ extern bool		_papplClientHaveDocumentData(pappl_client_t *client) _PAPPL_PRIVATE
 extern http_status_t	_papplClientIsAuthorizedForGroup(pappl_client_t *client, bool allow_remote, const char *group, gid_t groupid) _PAPPL_PUBLIC;
 extern bool		_papplClientProcessHTTP(pappl_client_t *client) _PAPPL_PRIVATE;
 extern bool		_papplClientProcessIPP(pappl_client_t *client) _PAPPL_PRIVATE;
-extern void		*_papplClientRun(pappl_client_t *client) _PAPPL_PRIVATE;
+extern void		_papplClientRespondBusy(pappl_client_t *client) _PAPPL_PRIVATE;
+extern bool		_papplClientRun(pappl_client_t *client) _PAPPL_PRIVATE;
 extern void		_papplClientHTMLInfo(pappl_client_t *client, bool is_form, const char *dns_sd_name, const char *location, const char *geo_location, const char *organization, const char *org_unit, pappl_contact_t *contact);
 extern void		_papplClientHTMLPutLinks(pappl_client_t *client, cups_array_t *links, pappl_loptions_t which);
 
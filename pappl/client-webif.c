@@ -16,6 +16,13 @@
 #include <math.h>
 
 
+//
+// Local functions...
+//
+
+static void	html_write(pappl_client_t *client, const char *s, size_t slen);
+
+
 //
 // 'papplClientGetCookie()' - Get a cookie from the client.
 //
@@ -587,14 +594,14 @@ papplClientHTMLEscape(
     if (*s == '&' || *s == '<' || *s == '\"')
     {
       if (s > start)
-        httpWrite(client->http, start, (size_t)(s - start));
+        html_write(client, start, (size_t)(s - start));
 
       if (*s == '&')
-        httpWrite(client->http, "&amp;", 5);
+        html_write(client, "&amp;", 5);
       else if (*s == '<')
-        httpWrite(client->http, "&lt;", 4);
+        html_write(client, "&lt;", 4);
       else
-        httpWrite(client->http, "&quot;", 6);
+        html_write(client, "&quot;", 6);
 
       start = s + 1;
     }
@@ -603,7 +610,35 @@ papplClientHTMLEscape(
   }
 
   if (s > start)
-    httpWrite(client->http, start, (size_t)(s - start));
+    html_write(client, start, (size_t)(s - start));
+}
+
+
+//
+// 'papplClientHTMLFlush()' - Send any buffered HTML to the client.
+//
+// This function sends any HTML that has been buffered since the last call to
+// @link papplClientHTMLHeader@ when the `PAPPL_SOPTIONS_WEB_BUFFER` system
+// option is set.  Call it before writing to the client's HTTP connection
+// directly (using `httpWrite` or `httpPrintf`) while generating a web page.
+// The @link papplClientHTMLFooter@ and @link papplClientRespond@ functions
+// flush the buffered HTML automatically.
+//
+
+bool					// O - `true` on success, `false` on error
+papplClientHTMLFlush(
+    pappl_client_t *client)		// I - Client
+{
+  size_t	used = client->html_used;
+					// Bytes to send
+
+
+  if (!used)
+    return (true);
+
+  client->html_used = 0;
+
+  return (httpWrite(client->http, client->html, used) >= 0);
 }
 
 
@@ -639,6 +674,10 @@ papplClientHTMLFooter(
   papplClientHTMLPuts(client,
 		      "  </body>\n"
 		      "</html>\n");
+  papplClientHTMLFlush(client);
+
+  client->html_buffer = false;
+
   httpWrite(client->http, "", 0);
 }
 
@@ -650,6 +689,13 @@ papplClientHTMLFooter(
 // "refresh" argument is greater than zero, the page will automatically reload
 // after that many seconds.
 //
+// When the `PAPPL_SOPTIONS_WEB_BUFFER` system option is set, the HTML sent by
+// this function and by the @link papplClientHTMLPuts@,
+// @link papplClientHTMLPrintf@, and @link papplClientHTMLEscape@ functions is
+// buffered until @link papplClientHTMLFooter@ is called.  Call the
+// @link papplClientHTMLFlush@ function before writing to the client's HTTP
+// connection directly.
+//
 // Use the @link papplSystemAddLink@ function to add system-wide navigation
 // links to the header.  Similarly, use @link papplPrinterAddLink@ to add
 // printer-specific links, which will appear in the web interface printer if
@@ -678,6 +724,9 @@ papplClientHTMLHeader(
   else
     name = printer->name;
 
+  // Buffer the page until the footer is sent, if enabled...
+  client->html_buffer = (system->options & PAPPL_SOPTIONS_WEB_BUFFER) != 0;
+
   papplClientHTMLPrintf(client,
 			"<!DOCTYPE html>\n"
 			"<html>\n"
@@ -997,6 +1046,9 @@ papplClientHTMLPrinterHeader(
 // to allow for embedded HTML, however strings inserted using the '%c' or `%s`
 // codes are escaped properly for HTML - "&" is sent as `&amp;`, etc.
 //
+// > Note: HTML output is buffered and sent in large blocks.  Use the
+// > @link papplClientHTMLFooter@ function to finish the page.
+//
 
 void
 papplClientHTMLPrintf(
@@ -1026,14 +1078,14 @@ papplClientHTMLPrintf(
     if (*format == '%')
     {
       if (format > start)
-        httpWrite(client->http, start, (size_t)(format - start));
+        html_write(client, start, (size_t)(format - start));
 
       tptr    = tformat;
       *tptr++ = *format++;
 
       if (*format == '%')
       {
-        httpWrite(client->http, "%", 1);
+        html_write(client, "%", 1);
         format ++;
 	start = format;
 	continue;
@@ -1140,7 +1192,7 @@ papplClientHTMLPrintf(
 
 	    snprintf(temp, sizeof(temp), tformat, va_arg(ap, double));
 
-            httpWrite(client->http, temp, strlen(temp));
+            html_write(client, temp, strlen(temp));
 	    break;
 
         case 'B' : // Integer formats
@@ -1164,7 +1216,7 @@ papplClientHTMLPrintf(
 	    else
 	      snprintf(temp, sizeof(temp), tformat, va_arg(ap, int));
 
-            httpWrite(client->http, temp, strlen(temp));
+            html_write(client, temp, strlen(temp));
 	    break;
 
 	case 'p' : // Pointer value
@@ -1173,7 +1225,7 @@ papplClientHTMLPrintf(
 
 	    snprintf(temp, sizeof(temp), tformat, va_arg(ap, void *));
 
-            httpWrite(client->http, temp, strlen(temp));
+            html_write(client, temp, strlen(temp));
 	    break;
 
         case 'c' : // Character or character array
@@ -1200,7 +1252,7 @@ papplClientHTMLPrintf(
   }
 
   if (format > start)
-    httpWrite(client->http, start, (size_t)(format - start));
+    html_write(client, start, (size_t)(format - start));
 
   va_end(ap);
 }
@@ -1253,6 +1305,9 @@ _papplClientHTMLPutLinks(
 // This function sends a HTML string to the client without performing any
 // escaping of special characters.
 //
+// > Note: HTML output is buffered and sent in large blocks.  Use the
+// > @link papplClientHTMLFooter@ function to finish the page.
+//
 
 void
 papplClientHTMLPuts(
@@ -1260,7 +1315,7 @@ papplClientHTMLPuts(
     const char     *s)			// I - String
 {
   if (client && s && *s)
-    httpWrite(client->http, s, strlen(s));
+    html_write(client, s, strlen(s));
 }
 
 
@@ -1376,3 +1431,44 @@ papplClientSetCookie(
     httpSetCookie(client->http, buffer);
   }
 }
+
+
+//
+// 'html_write()' - Write HTML to the client's output buffer.
+//
+// Web pages are generated in many small pieces.  Collecting them in a
+// per-client buffer lets us send large writes (and large chunks) instead of
+// one write per fragment.  Only pages started with papplClientHTMLHeader on a
+// system with the PAPPL_SOPTIONS_WEB_BUFFER option are buffered, so existing
+// applications that write to the connection directly keep their output in
+// order.  The buffer is allocated on first use and reused for each request on
+// the connection.
+//
+
+static void
+html_write(pappl_client_t *client,	// I - Client
+           const char     *s,		// I - String to write
+           size_t         slen)		// I - Length of string
+{
+  if (!client->html_buffer || (!client->html && (client->html = malloc(_PAPPL_HTML_BUFFER)) == NULL))
+  {
+    // Not buffering or unable to allocate the buffer, write directly...
+    papplClientHTMLFlush(client);
+    httpWrite(client->http, s, slen);
+    return;
+  }
+
+  if ((client->html_used + slen) > _PAPPL_HTML_BUFFER)
+    papplClientHTMLFlush(client);
+
+  if (slen >= _PAPPL_HTML_BUFFER)
+  {
+    // Write large strings directly...
+    httpWrite(client->http, s, slen);
+  }
+  else
+  {
+    memcpy(client->html + client->html_used, s, slen);
+    client->html_used += slen;
+  }
+}
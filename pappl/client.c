@@ -13,13 +13,19 @@
 //
 
 #include "pappl-private.h"
+#if !_WIN32
+#  include <sys/mman.h>
+#endif // !_WIN32
 
 
 //
 // Local functions...
 //
 
+static bool	accepts_encoding(pappl_client_t *client, const char *coding);
 static bool	eval_if_modified(pappl_client_t *client, _pappl_resource_t *r);
+static bool	respond_file(pappl_client_t *client, _pappl_resource_t *r);
+static bool	start_client(pappl_client_t *client);
 
 
 //
@@ -60,6 +66,7 @@ _papplClientCreate(
     int            sock)		// I - Listen socket
 {
   pappl_client_t	*client;	// Client
+  char			name[256];	// Host name for logging
 
 
   if ((client = calloc(1, sizeof(pappl_client_t))) == NULL)
@@ -82,9 +89,11 @@ _papplClientCreate(
     return (NULL);
   }
 
+  // The client hostname is the numeric peer address, host names are looked up
+  // asynchronously and are only used for logging...
   httpGetHostname(client->http, client->hostname, sizeof(client->hostname));
 
-  papplLogClient(client, PAPPL_LOGLEVEL_INFO, "Accepted connection from '%s'.", client->hostname);
+  papplLogClient(client, PAPPL_LOGLEVEL_INFO, "Accepted connection from '%s'.", _papplSystemResolveHost(system, httpGetAddress(client->http), name, sizeof(name)));
 
   return (client);
 }
@@ -153,9 +162,10 @@ _papplClientDelete(
 {
   pappl_system_t *system = client->system;
 					// System
+  char		name[256];		// Host name for logging
 
 
-  papplLogClient(client, PAPPL_LOGLEVEL_INFO, "Closing connection from '%s'.", client->hostname);
+  papplLogClient(client, PAPPL_LOGLEVEL_INFO, "Closing connection from '%s'.", _papplSystemResolveHost(system, httpGetAddress(client->http), name, sizeof(name)));
 
   // Flush pending writes before closing...
   httpFlushWrite(client->http);
@@ -168,6 +178,7 @@ _papplClientDelete(
   ippDelete(client->request);
   ippDelete(client->response);
 
+  free(client->html);
   free(client);
 
   // Update the number of active clients...
@@ -207,6 +218,8 @@ _papplClientProcessHTTP(
   client->request   = NULL;
   client->response  = NULL;
   client->operation = HTTP_STATE_WAITING;
+  client->html_used   = 0;
+  client->html_buffer = false;
 
   // Read a request from the connection...
   while ((http_state = httpReadRequest(client->http, uri, sizeof(uri))) == HTTP_STATE_WAITING)
@@ -371,32 +384,15 @@ _papplClientProcessHTTP(
           else if (resource->cb)
           {
             // Send output of a callback...
-            return ((resource->cb)(client, resource->cbdata));
+            bool ret = (resource->cb)(client, resource->cbdata);
+					// Return value
+
+            return (papplClientHTMLFlush(client) && ret);
 	  }
 	  else if (resource->filename)
 	  {
 	    // Send an external file...
-	    int		fd;		// Resource file descriptor
-	    char	buffer[8192];	// Copy buffer
-	    ssize_t	bytes;		// Bytes read/written
-
-            if ((fd = open(resource->filename, O_RDONLY)) >= 0)
-	    {
-	      if (!papplClientRespond(client, HTTP_STATUS_OK, NULL, resource->format, resource->last_modified, 0))
-	      {
-	        close(fd);
-		return (false);
-	      }
-
-              while ((bytes = read(fd, buffer, sizeof(buffer))) > 0)
-                httpWrite(client->http, buffer, (size_t)bytes);
-
-	      httpWrite(client->http, "", 0);
-
-	      close(fd);
-
-	      return (true);
-	    }
+	    return (respond_file(client, resource));
 	  }
 	  else
 	  {
@@ -438,7 +434,10 @@ _papplClientProcessHTTP(
           if (resource->cb)
           {
             // Handle a post request through the callback...
-            return ((resource->cb)(client, resource->cbdata));
+            bool ret = (resource->cb)(client, resource->cbdata);
+					// Return value
+
+            return (papplClientHTMLFlush(client) && ret);
           }
           else
           {
@@ -479,6 +478,9 @@ _papplClientProcessHTTP(
 // Use the @link papplClientRespondRedirect@ when you need to redirect the
 // client to another page.
 //
+// Variable-length "text/html" responses to remote clients are compressed using
+// the "gzip" or "deflate" content coding when the client supports it.
+//
 
 bool					// O - `true` on success, `false` on failure
 papplClientRespond(
@@ -490,8 +492,14 @@ papplClientRespond(
     size_t         length)		// I - Length of response or `0` for variable-length
 {
   char	message[1024],			// Text message
-	last_str[256];			// Date string
+	last_str[256],			// Date string
+	server[1024];			// Server header value
+
+
+  // Send any HTML that is still buffered from a previous response...
+  papplClientHTMLFlush(client);
 
+  client->html_buffer = false;
 
   if (type)
     papplLogClient(client, PAPPL_LOGLEVEL_INFO, "%s %s %d", httpStatusString(code), type, (int)length);
@@ -515,9 +523,30 @@ papplClientRespond(
   else
     message[0] = '\0';
 
+  // Compress variable-length web pages for remote clients, local clients
+  // don't benefit from the smaller transfer...
+  if (!content_encoding && code == HTTP_STATUS_OK && type && !strcmp(type, "text/html") && !length && !httpAddrLocalhost(httpGetAddress(client->http)))
+  {
+    content_encoding      = httpGetContentEncoding(client->http);
+    client->vary_encoding = true;
+  }
+
   // Send the HTTP response header...
   httpClearFields(client->http);
-  httpSetField(client->http, HTTP_FIELD_SERVER, papplSystemGetServerHeader(client->system));
+
+  if (client->vary_encoding)
+  {
+    // Tell caches that the content coding depends on the Accept-Encoding
+    // header - libcups has no Vary field so append it to the Server header...
+    snprintf(server, sizeof(server), "%s\r\nVary: Accept-Encoding", papplSystemGetServerHeader(client->system));
+    httpSetField(client->http, HTTP_FIELD_SERVER, server);
+
+    client->vary_encoding = false;
+  }
+  else
+  {
+    httpSetField(client->http, HTTP_FIELD_SERVER, papplSystemGetServerHeader(client->system));
+  }
   if (last_modified)
     httpSetField(client->http, HTTP_FIELD_LAST_MODIFIED, httpGetDateString(last_modified, last_str, sizeof(last_str)));
 
@@ -583,6 +612,74 @@ papplClientRespond(
 }
 
 
+//
+// '_papplClientRespondBusy()' - Reject a request because the server is busy.
+//
+// This function is called by the client busy response thread when too many
+// requests are waiting for a worker thread.  IPP requests get a
+// "server-error-busy" response when the start of the IPP message is available,
+// otherwise a 503 (Service Unavailable) response is sent.  Reads time out
+// after a few seconds so that a slow client can't hold up other rejected
+// connections.  The caller closes the connection afterwards.
+//
+
+void
+_papplClientRespondBusy(
+    pappl_client_t *client)		// I - Client
+{
+  char		uri[1024];		// Request URI
+  http_state_t	http_state;		// HTTP state
+  http_status_t	http_status;		// HTTP status
+  unsigned char	header[8];		// IPP message header
+
+
+  httpSetTimeout(client->http, _PAPPL_BUSY_TIMEOUT, NULL, NULL);
+
+  // Negotiate TLS as needed so we can respond...
+  if (!start_client(client))
+    return;
+
+  // Read the request line and header fields...
+  http_state = httpReadRequest(client->http, uri, sizeof(uri));
+
+  if (http_state == HTTP_STATE_WAITING || http_state == HTTP_STATE_ERROR || http_state == HTTP_STATE_UNKNOWN_METHOD || http_state == HTTP_STATE_UNKNOWN_VERSION)
+    return;
+
+  client->operation = httpGetState(client->http);
+
+  while ((http_status = httpUpdate(client->http)) == HTTP_STATUS_CONTINUE)
+    ;					// Read all HTTP headers...
+
+  if (http_status != HTTP_STATUS_OK)
+    return;
+
+  // Send a "server-error-busy" response if the start of the IPP message
+  // arrives within a second, otherwise send a 503 (Service Unavailable)
+  // response...
+  if (client->operation == HTTP_STATE_POST && !strcmp(httpGetField(client->http, HTTP_FIELD_CONTENT_TYPE), "application/ipp") && httpWait(client->http, 1000) && httpRead(client->http, (char *)header, sizeof(header)) == (ssize_t)sizeof(header))
+  {
+    client->operation_id = (ipp_op_t)((header[2] << 8) | header[3]);
+    client->response     = ippNew();
+
+    if (header[0] == 1 || header[0] == 2)
+      ippSetVersion(client->response, header[0], header[1]);
+    else
+      ippSetVersion(client->response, 2, 0);
+
+    ippSetRequestId(client->response, (int)(((unsigned)header[4] << 24) | ((unsigned)header[5] << 16) | ((unsigned)header[6] << 8) | header[7]));
+    ippAddString(client->response, IPP_TAG_OPERATION, IPP_CONST_TAG(IPP_TAG_CHARSET), "attributes-charset", NULL, "utf-8");
+    ippAddString(client->response, IPP_TAG_OPERATION, IPP_CONST_TAG(IPP_TAG_LANGUAGE), "attributes-natural-language", NULL, "en");
+
+    papplClientRespondIPP(client, IPP_STATUS_ERROR_BUSY, "Too many pending requests, try again later.");
+    papplClientRespond(client, HTTP_STATUS_OK, NULL, "application/ipp", 0, ippLength(client->response));
+  }
+  else
+  {
+    papplClientRespond(client, HTTP_STATUS_SERVICE_UNAVAILABLE, NULL, NULL, 0, 0);
+  }
+}
+
+
 //
 // 'papplClientRespondRedirect()' - Respond with a redirect to another page.
 //
@@ -629,50 +726,68 @@ papplClientRespondRedirect(
 
 
 //
-// '_papplClientRun()' - Process client requests on a thread.
+// '_papplClientRun()' - Process pending client requests on a worker thread.
+//
+// This function is called by a client worker thread once a request is
+// available on the connection.  It returns `true` if the connection should be
+// kept open for more requests and `false` if it should be closed.
 //
 
-void *					// O - Exit status
+bool					// O - `true` to keep connection, `false` to close
 _papplClientRun(
     pappl_client_t *client)		// I - Client
 {
-  int first_time = 1;			// First time request?
-
+  if (!start_client(client))
+    return (false);
 
-  // Loop until we are out of requests or timeout (30 seconds)...
-  while (httpWait(client->http, 30000))
+  // Process requests until there is no more buffered data...
+  do
   {
-    if (first_time && !(client->system->options & PAPPL_SOPTIONS_NO_TLS))
-    {
-      // See if we need to negotiate a TLS connection...
-      char buf[1];			// First byte from client
+    if (!_papplClientProcessHTTP(client))
+      return (false);
 
-      if (recv(httpGetFd(client->http), buf, 1, MSG_PEEK) == 1 && (!buf[0] || !strchr("DGHOPT", buf[0])))
-      {
-        papplLogClient(client, PAPPL_LOGLEVEL_INFO, "Starting HTTPS session.");
+    _papplClientCleanTempFiles(client);
+  }
+  while (httpGetReady(client->http) > 0);
 
-	if (httpEncryption(client->http, HTTP_ENCRYPTION_ALWAYS))
-	{
-          papplLogClient(client, PAPPL_LOGLEVEL_ERROR, "Unable to encrypt connection: %s", cupsLastErrorString());
-	  break;
-        }
+  return (true);
+}
 
-        papplLogClient(client, PAPPL_LOGLEVEL_INFO, "Connection now encrypted.");
-      }
 
-      first_time = 0;
-    }
+//
+// 'accepts_encoding()' - Determine whether the client accepts a content coding.
+//
 
-    if (!_papplClientProcessHTTP(client))
-      break;
+static bool				// O - `true` if accepted, `false` otherwise
+accepts_encoding(
+    pappl_client_t *client,		// I - Client
+    const char     *coding)		// I - Content coding such as "br"
+{
+  const char	*ptr,			// Pointer into field
+		*end;			// End of current coding
+  size_t	codinglen = strlen(coding);
+					// Length of content coding
 
-    _papplClientCleanTempFiles(client);
-  }
 
-  // Close the conection to the client and return...
-  _papplClientDelete(client);
+  // Scan the "Accept-Encoding:" header for the coding, honoring "q=0"...
+  for (ptr = httpGetField(client->http, HTTP_FIELD_ACCEPT_ENCODING); *ptr; ptr = end)
+  {
+    while (isspace(*ptr & 255) || *ptr == ',')
+      ptr ++;
+
+    if ((end = strchr(ptr, ',')) == NULL)
+      end = ptr + strlen(ptr);
+
+    if (!strncasecmp(ptr, coding, codinglen) && (ptr[codinglen] == ';' || ptr[codinglen] == ',' || isspace(ptr[codinglen] & 255) || !ptr[codinglen]))
+    {
+      const char *qvalue = strstr(ptr + codinglen, "q=");
+					// Quality value, if any
 
-  return (NULL);
+      return (!qvalue || qvalue >= end || strtod(qvalue + 2, NULL) > 0.0);
+    }
+  }
+
+  return (false);
 }
 
 
@@ -732,3 +847,117 @@ eval_if_modified(
   // Return the evaluation based on the last modified date, time, and size...
   return ((size != 0 && size != (off_t)r->length) || (date != 0 && date < r->last_modified) || (size == 0 && date == 0));
 }
+
+
+//
+// 'respond_file()' - Send an external file resource.
+//
+// A precompressed variant is sent when the client accepts it.  Otherwise the
+// file is memory-mapped and written in a single call so that the data goes
+// straight from the page cache to the connection without a copy buffer.
+//
+
+static bool				// O - `true` on success, `false` on error
+respond_file(pappl_client_t    *client,	// I - Client
+             _pappl_resource_t *r)	// I - Resource
+{
+  const char	*filename = r->filename,// Filename to send
+		*encoding = NULL;	// Content-Encoding of file
+  int		fd;			// Resource file descriptor
+  char		buffer[8192];		// Copy buffer
+  ssize_t	bytes;			// Bytes read/written
+#if !_WIN32
+  struct stat	fileinfo;		// File information
+  void		*data;			// Mapped file data
+  bool		ret;			// Return value
+#endif // !_WIN32
+
+
+  // Use a precompressed variant if the client accepts it...
+  if (r->br_filename)
+  {
+    client->vary_encoding = true;
+
+    if (accepts_encoding(client, "br"))
+    {
+      filename = r->br_filename;
+      encoding = "br";
+    }
+  }
+
+  if ((fd = open(filename, O_RDONLY | O_CLOEXEC | O_BINARY)) < 0)
+  {
+    papplLogClient(client, PAPPL_LOGLEVEL_ERROR, "Unable to open '%s': %s", filename, strerror(errno));
+    return (papplClientRespond(client, HTTP_STATUS_NOT_FOUND, NULL, NULL, 0, 0));
+  }
+
+#if !_WIN32
+  if (!fstat(fd, &fileinfo) && fileinfo.st_size > 0 && (data = mmap(NULL, (size_t)fileinfo.st_size, PROT_READ, MAP_SHARED, fd, 0)) != MAP_FAILED)
+  {
+    // Send the mapped file with a known length...
+    close(fd);
+
+    if ((ret = papplClientRespond(client, HTTP_STATUS_OK, encoding, r->format, r->last_modified, (size_t)fileinfo.st_size)) == true)
+    {
+      ret = httpWrite(client->http, (const char *)data, (size_t)fileinfo.st_size) == (ssize_t)fileinfo.st_size;
+      httpFlushWrite(client->http);
+    }
+
+    munmap(data, (size_t)fileinfo.st_size);
+
+    return (ret);
+  }
+#endif // !_WIN32
+
+  // Copy the file...
+  if (!papplClientRespond(client, HTTP_STATUS_OK, encoding, r->format, r->last_modified, 0))
+  {
+    close(fd);
+    return (false);
+  }
+
+  while ((bytes = read(fd, buffer, sizeof(buffer))) > 0)
+    httpWrite(client->http, buffer, (size_t)bytes);
+
+  httpWrite(client->http, "", 0);
+
+  close(fd);
+
+  return (true);
+}
+
+
+//
+// 'start_client()' - Start a new client connection.
+//
+// This function negotiates a TLS session if the first request on the
+// connection starts with a TLS handshake.
+//
+
+static bool				// O - `true` on success, `false` on error
+start_client(pappl_client_t *client)	// I - Client
+{
+  char	buf[1];				// First byte from client
+
+
+  if (client->started)
+    return (true);
+
+  client->started = true;
+
+  // See if we need to negotiate a TLS connection...
+  if (!(client->system->options & PAPPL_SOPTIONS_NO_TLS) && recv(httpGetFd(client->http), buf, 1, MSG_PEEK) == 1 && (!buf[0] || !strchr("DGHOPT", buf[0])))
+  {
+    papplLogClient(client, PAPPL_LOGLEVEL_INFO, "Starting HTTPS session.");
+
+    if (httpEncryption(client->http, HTTP_ENCRYPTION_ALWAYS))
+    {
+      papplLogClient(client, PAPPL_LOGLEVEL_ERROR, "Unable to encrypt connection: %s", cupsLastErrorString());
+      return (false);
+    }
+
+    papplLogClient(client, PAPPL_LOGLEVEL_INFO, "Connection now encrypted.");
+  }
+
+  return (true);
+}
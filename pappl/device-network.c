@@ -1769,12 +1769,22 @@ pappl_socket_status(
 					// "printer-state-reasons" values
   _pappl_snmp_t		packet;		// SNMP packet
   int			state;		// State bits
+  struct pollfd		data;		// poll() data
+  char			ch;		// Peeked byte
 
 
   // Get the device data...
   if ((sock = papplDeviceGetData(device)) == NULL)
     return (0);
 
+  // See if the printer has closed the connection, for example while the
+  // device was kept open between jobs...
+  data.fd     = sock->fd;
+  data.events = POLLIN;
+
+  if (poll(&data, 1, 0) > 0 && ((data.revents & (POLLERR | POLLHUP | POLLNVAL)) || ((data.revents & POLLIN) && recv(sock->fd, &ch, 1, MSG_PEEK) <= 0)))
+    return (PAPPL_PREASON_OFFLINE);
+
   if (!_papplSNMPWrite(sock->snmp_fd, &(sock->addr->addr), _PAPPL_SNMP_VERSION_1, _PAPPL_SNMP_COMMUNITY, _PAPPL_ASN1_GET_REQUEST, 1, hrPrinterDetectedErrorState))
     return (reasons);
 
@@ -41,6 +41,7 @@ struct _pappl_device_s			// Device connection data
 						// Write buffer
   size_t		bufused;		// Number of bytes in write buffer
   pappl_devmetrics_t	metrics;		// Device metrics
+  size_t		reuses;			// Number of times the open device was reused
 };
 
 typedef void (*_pappl_devscheme_cb_t)(const char *scheme, void *data);
@@ -55,6 +56,7 @@ extern void		_papplDeviceAddNetworkSchemes(void) _PAPPL_PRIVATE;
 extern void		_papplDeviceAddSupportedSchemes(ipp_t *attrs);
 extern void		_papplDeviceAddUSBScheme(void) _PAPPL_PRIVATE;
 extern void		_papplDeviceError(pappl_deverror_cb_t err_cb, void *err_data, const char *message, ...) _PAPPL_FORMAT(3,4) _PAPPL_PRIVATE;
+extern bool		_papplDeviceReuse(pappl_device_t *device) _PAPPL_PRIVATE;
 
 
 #endif // !_PAPPL_DEVICE_H_
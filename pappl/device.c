@@ -859,6 +859,27 @@ papplDeviceRead(
 }
 
 
+//
+// '_papplDeviceReuse()' - Check whether an open device can be reused.
+//
+// This function probes the device status before an open device is used for
+// another job.  If the device reports that it is offline, `false` is returned
+// and the caller should close and reopen the device.
+//
+
+bool					// O - `true` if the device can be reused, `false` otherwise
+_papplDeviceReuse(
+    pappl_device_t *device)		// I - Device
+{
+  if (!device || (papplDeviceGetStatus(device) & PAPPL_PREASON_OFFLINE))
+    return (false);
+
+  device->reuses ++;
+
+  return (true);
+}
+
+
 //
 // 'papplDeviceSetData()' - Set device-specific data.
 //
@@ -13,13 +13,76 @@
 
 #include "pappl.h"
 #include "job-private.h"
+#include "system-private.h"
+#include <math.h>
 #ifdef HAVE_LIBJPEG
 #  include <setjmp.h>
 #  include <jpeglib.h>
+#  include <jerror.h>
 #endif // HAVE_LIBJPEG
 #ifdef HAVE_LIBPNG
 #  include <png.h>
 #endif // HAVE_LIBPNG
+#if !_WIN32
+#  include <sys/mman.h>
+#endif // !_WIN32
+#if defined(__GNUC__) && (defined(__x86_64__) || (defined(__i386__) && defined(__SSE2__)))
+#  include <emmintrin.h>
+#  define _PAPPL_SCALE_SSE2	1	// Use SSE2 scaling kernels
+#elif defined(_M_X64)
+#  include <emmintrin.h>
+#  define _PAPPL_SCALE_SSE2	1	// Use SSE2 scaling kernels
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#  include <arm_neon.h>
+#  define _PAPPL_SCALE_NEON	1	// Use NEON scaling kernels
+#endif // __GNUC__ && (__x86_64__ || (__i386__ && __SSE2__))
+
+
+//
+// Local constants...
+//
+
+#define _PAPPL_IBAND_LINES	32	// Number of lines in a rendered image band
+#define _PAPPL_IBAND_MAX	32	// Maximum number of rendered image bands in flight
+#define _PAPPL_IROWS_LINES	16	// Number of lines in a rotated image band
+#define _PAPPL_IROWS_TILE	16	// Number of columns in a transpose tile
+#define _PAPPL_RCACHE_MAX	16777216// Maximum size of in-memory page cache
+#define _PAPPL_SCALER_BITS	14	// Number of fraction bits in filter weights
+#define _PAPPL_SCALER_ONE	(1 << _PAPPL_SCALER_BITS)
+					// Filter weight of 1.0
+
+
+//
+// Local globals...
+//
+
+#ifdef HAVE_LIBPNG
+static const unsigned short pappl_srgb_thresholds[255] =
+{					// Linear values halfway between sRGB values
+     10,    30,    50,    70,    90,   109,   129,   149,   169,   189,   209,   230,
+    252,   276,   300,   326,   353,   382,   411,   442,   475,   508,   543,   580,
+    618,   657,   697,   739,   783,   828,   874,   922,   971,  1022,  1075,  1129,
+   1184,  1241,  1300,  1360,  1422,  1485,  1550,  1617,  1685,  1755,  1826,  1900,
+   1975,  2051,  2130,  2210,  2292,  2375,  2460,  2547,  2636,  2727,  2819,  2914,
+   3010,  3107,  3207,  3309,  3412,  3517,  3624,  3733,  3844,  3957,  4071,  4188,
+   4306,  4427,  4549,  4673,  4800,  4928,  5058,  5190,  5325,  5461,  5599,  5739,
+   5881,  6026,  6172,  6320,  6471,  6623,  6778,  6935,  7093,  7254,  7417,  7582,
+   7750,  7919,  8090,  8264,  8440,  8618,  8798,  8980,  9165,  9351,  9540,  9731,
+   9925, 10120, 10318, 10518, 10720, 10924, 11131, 11340, 11551, 11765, 11981, 12199,
+  12419, 12642, 12867, 13094, 13324, 13556, 13790, 14027, 14266, 14508, 14751, 14998,
+  15246, 15497, 15750, 16006, 16264, 16525, 16788, 17053, 17321, 17591, 17864, 18139,
+  18416, 18696, 18979, 19264, 19551, 19841, 20134, 20429, 20726, 21026, 21329, 21634,
+  21941, 22251, 22564, 22879, 23197, 23517, 23840, 24165, 24493, 24824, 25157, 25493,
+  25831, 26172, 26516, 26862, 27211, 27562, 27916, 28273, 28632, 28994, 29359, 29726,
+  30096, 30469, 30844, 31222, 31603, 31986, 32372, 32761, 33153, 33547, 33944, 34344,
+  34746, 35151, 35559, 35970, 36383, 36799, 37218, 37640, 38064, 38492, 38922, 39354,
+  39790, 40228, 40670, 41114, 41560, 42010, 42463, 42918, 43376, 43837, 44301, 44768,
+  45237, 45709, 46185, 46663, 47144, 47628, 48114, 48604, 49097, 49592, 50091, 50592,
+  51096, 51603, 52113, 52626, 53142, 53661, 54183, 54707, 55235, 55766, 56299, 56836,
+  57375, 57918, 58463, 59012, 59563, 60118, 60675, 61235, 61799, 62365, 62935, 63507,
+  64083, 64661, 65243
+};
+#endif // HAVE_LIBPNG
 
 
 //
@@ -33,16 +96,230 @@ typedef struct _pappl_jpeg_err_s	// JPEG error manager extension
   jmp_buf	retbuf;				// setjmp() return buffer
   char		message[JMSG_LENGTH_MAX];	// Last error message
 } _pappl_jpeg_err_t;
+
+typedef struct _pappl_jpeg_src_s	// JPEG source manager extension
+{
+  struct jpeg_source_mgr src;			// JPEG source manager information
+  pappl_job_t	*job;				// Job
+  int		fd;				// Document file
+  JOCTET	buffer[8192];			// Read buffer
+} _pappl_jpeg_src_t;
 #endif // HAVE_LIBJPEG
 
+#ifdef HAVE_LIBPNG
+typedef struct _pappl_png_src_s		// PNG source info
+{
+  pappl_job_t	*job;				// Job
+  int		fd;				// Document file
+  png_structp	png;				// PNG decompressor
+  png_infop	info;				// PNG image information
+  int		width,				// Width in columns
+		depth;				// Bytes per output pixel
+  bool		alpha;				// Is the image transparent?
+  unsigned char	*row;				// 16-bit linear line with alpha channel
+} _pappl_png_src_t;
+#endif // HAVE_LIBPNG
+
+typedef struct _pappl_rcache_s		// Page raster cache for copies
+{
+  pappl_job_t	*job;				// Job
+  size_t	linesize;			// Bytes per line
+  unsigned char	*buffer,			// Compressed lines or I/O buffer
+		*packed;			// Compressed line
+  size_t	bufsize,			// Size of buffer
+		bufused,			// Bytes used in buffer
+		bufpos,				// Read position in buffer
+		bytes;				// Total compressed bytes
+  int		fd;				// Spool file or `-1` if in memory
+  char		filename[1024];			// Spool filename
+  bool		error,				// Was there an error?
+		reading;			// Are lines being replayed?
+} _pappl_rcache_t;
+
+struct _pappl_scaler_s			// Image scaler
+{
+  int			in_width,		// Input width in columns
+			in_height,		// Input height in lines
+			depth,			// Bytes per pixel
+			out_width,		// Output width in columns
+			out_height,		// Output height in lines
+			out_left,		// First output column
+			out_right;		// Last output column + 1
+  _pappl_resample_t	filter;			// Resampling filter
+  _pappl_scaler_cb_t	cb;			// Input line callback
+  void			*cb_data;		// Input line callback data
+  size_t		linesize;		// Bytes per horizontally scaled line
+  int			htaps,			// Number of taps per output column
+			*hfirst;		// First input column for each output column
+  short			*hweights;		// Weights for each output column
+  int			vtaps;			// Maximum number of taps per output line
+  double		*weights;		// Floating point weights for a column or line
+  short			*vweights;		// Weights for the current output line
+  const unsigned char	**vlines;		// Horizontally scaled lines for the current output line
+  unsigned char		*ring;			// Ring of horizontally scaled lines
+  int			*ring_rows;		// Input line in each ring slot or `-1`
+};
+
+typedef bool (*_pappl_isrc_cb_t)(void *data, unsigned char *line);
+					// Image line callback
+typedef bool (*_pappl_isrc_rcb_t)(void *data);
+					// Image rewind callback
+
+typedef struct _pappl_isrc_s		// Image source
+{
+  int			width,			// Width in columns
+			height,			// Height in lines
+			depth,			// Bytes per pixel
+			ppi;			// Pixels per inch (`0` for unknown)
+  const unsigned char	*pixels;		// Image pixels or `NULL` if streamed
+  _pappl_isrc_cb_t	read_cb;		// Read line callback for streamed images
+  _pappl_isrc_rcb_t	rewind_cb;		// Rewind callback for streamed images, if any
+  void			*read_data;		// Read line/rewind callback data
+  unsigned char		*buffer;		// Loaded image or line window
+  int			row,			// First line in window
+			count,			// Number of lines in window
+			next;			// Next line from callback
+} _pappl_isrc_t;
+
+typedef struct _pappl_iband_s		// Band of rendered image lines
+{
+  int			y,			// First line
+			count,			// Number of lines
+			row,			// Image line for first line
+			yerr;			// Y error accumulator for first line
+  bool			done;			// Has the band been rendered?
+  unsigned char		*lines;			// Rendered lines
+} _pappl_iband_t;
+
+typedef struct _pappl_ilayout_s		// Image layout on the page
+{
+  int			ileft,			// Imageable left margin
+			itop,			// Imageable top margin
+			iwidth,			// Imageable width
+			iheight,		// Imageable length/height
+			img_width,		// Rotated image width
+			img_height,		// Rotated image height
+			xsize,			// Scaled width
+			ysize;			// Scaled height
+  ipp_orient_t		orientation;		// Orientation of image
+  pappl_scaling_t	scaling;		// Scaling of image
+} _pappl_ilayout_t;
+
+typedef struct _pappl_irows_s		// Rotated image lines for the scaler
+{
+  pappl_job_t		*job;			// Job
+  _pappl_isrc_t		*src;			// Image source
+  const unsigned char	*pixbase;		// Pointer to first pixel
+  int			xdir,			// X direction in bytes
+			ydir,			// Y direction in bytes
+			width,			// Rotated width in columns
+			height,			// Rotated height in lines
+			depth;			// Bytes per pixel
+  unsigned char		*band;			// Band of transposed lines
+  int			band_row,		// First line in band
+			band_count;		// Number of lines in band
+} _pappl_irows_t;
+
+typedef struct _pappl_irender_s		// Image renderer for a page
+{
+  pappl_job_t		*job;			// Job
+  pappl_pr_options_t	*options;		// Print options
+  _pappl_isrc_t		*src;			// Image source
+  const unsigned char	*pixbase;		// Pointer to first pixel
+  size_t		linesize;		// Bytes per line
+  unsigned char		white;			// White color
+  bool			smoothing;		// Resample the image?
+  _pappl_resample_t	filter;			// Resampling filter
+  int			img_width,		// Rotated image width
+			img_height,		// Rotated image height
+			xdir,			// X direction
+			xsize,			// Scaled width
+			xstart,			// X start position
+			xleft,			// First visible X position
+			xend,			// X end position
+			xmod,			// X modulus
+			xstep,			// X step
+			ydir,			// Y direction
+			ysize,			// Scaled height
+			ystart,			// Y start position
+			ybegin,			// First visible Y position
+			yend,			// Y end position
+			ymod,			// Y modulus
+			ystep,			// Y step
+			row,			// Image line for first visible line
+			yerr;			// Y error accumulator for first visible line
+  pthread_mutex_t	mutex;			// Mutex for bands
+  pthread_cond_t	cond;			// Condition for bands
+  int			num_bands,		// Number of bands
+			num_slots,		// Number of band buffers
+			first_band,		// First band that has not been written
+			next_band,		// Next band to render
+			next_row,		// Image line for next band
+			next_yerr,		// Y error accumulator for next band
+			num_tasks;		// Number of unfinished render tasks
+  bool			stop,			// Stop rendering bands?
+			error;			// Did a band fail?
+  _pappl_iband_t	bands[_PAPPL_IBAND_MAX];// Band buffers
+} _pappl_irender_t;
+
+typedef struct _pappl_irctx_s		// Image rendering state for a thread
+{
+  _pappl_scaler_t	*scaler;		// Image scaler for smoothing
+  _pappl_irows_t	irows;			// Rotated image lines for scaler
+  unsigned char		*gray;			// Scaled grayscale line for dithering
+  int			row,			// Current image line
+			yerr;			// Y error accumulator
+} _pappl_irctx_t;
+
 
 //
 // Local functions...
 //
 
+static bool	filter_image(pappl_job_t *job, pappl_device_t *device, pappl_pr_options_t *options, _pappl_isrc_t *src, bool smoothing);
+static bool	image_layout(pappl_job_t *job, pappl_pr_options_t *options, int width, int height, int *ppi, _pappl_ilayout_t *layout);
+static bool	irender_band(_pappl_irender_t *ir, _pappl_irctx_t *ctx, _pappl_iband_t *band);
+static bool	irender_bands(_pappl_irender_t *ir, _pappl_irctx_t *ctx, _pappl_rpipe_t *rpipe, _pappl_rcache_t *cache, int num_workers, int *y);
+static _pappl_iband_t *irender_claim(_pappl_irender_t *ir);
+static void	irender_finish(_pappl_irender_t *ir, _pappl_irctx_t *ctx);
+static bool	irender_line(_pappl_irender_t *ir, _pappl_irctx_t *ctx, int y, unsigned char *line);
+static bool	irender_start(_pappl_irender_t *ir, _pappl_irctx_t *ctx);
+static void	irender_task(_pappl_irender_t *ir);
+static const unsigned char *irows_get_row(_pappl_irows_t *irows, int row);
+static const unsigned char *isrc_get_row(pappl_job_t *job, _pappl_isrc_t *src, int row);
+static bool	isrc_load(pappl_job_t *job, _pappl_isrc_t *src);
+static bool	isrc_reload(pappl_job_t *job, _pappl_isrc_t *src);
 #ifdef HAVE_LIBJPEG
 static void	jpeg_error_handler(j_common_ptr p) _PAPPL_NORETURN;
+static boolean	jpeg_fill_input(j_decompress_ptr dinfo);
+static void	jpeg_init_source(j_decompress_ptr dinfo);
+static bool	jpeg_read_line(j_decompress_ptr dinfo, unsigned char *line);
+static bool	jpeg_rewind(j_decompress_ptr dinfo);
+static void	jpeg_skip_input(j_decompress_ptr dinfo, long num_bytes);
+static void	jpeg_term_source(j_decompress_ptr dinfo);
 #endif // HAVE_LIBJPEG
+#ifdef HAVE_LIBPNG
+static void	png_composite_line(const unsigned char *row, unsigned char *line, int width, int depth);
+static void	png_error_handler(png_structp png, png_const_charp message) _PAPPL_NORETURN;
+static bool	png_open_image(_pappl_png_src_t *psrc);
+static void	png_read_input(png_structp png, png_bytep data, size_t length);
+static bool	png_read_line(_pappl_png_src_t *psrc, unsigned char *line);
+static bool	png_rewind(_pappl_png_src_t *psrc);
+static int	png_set_format(_pappl_png_src_t *psrc, int depth);
+static void	png_warning_handler(png_structp png, png_const_charp message);
+#endif // HAVE_LIBPNG
+static void	rcache_add_line(_pappl_rcache_t *cache, const unsigned char *line);
+static _pappl_rcache_t *rcache_create(pappl_job_t *job, size_t linesize);
+static void	rcache_delete(_pappl_rcache_t *cache);
+static bool	rcache_flush(_pappl_rcache_t *cache);
+static bool	rcache_get_line(_pappl_rcache_t *cache, unsigned char *line);
+static bool	rcache_read(_pappl_rcache_t *cache, size_t bytes);
+static bool	rcache_rewind(_pappl_rcache_t *cache);
+static void	scaler_hline(_pappl_scaler_t *scaler, const unsigned char *in, unsigned char *out);
+static double	scaler_kernel(_pappl_resample_t filter, double x);
+static int	scaler_taps(_pappl_resample_t filter, int in_size, int out_size, int i, double *weights, int *first);
+static void	scaler_vline(const unsigned char **lines, const short *weights, int count, unsigned char *out, size_t bytes);
+static void	scaler_weights(const double *weights, int count, short *fixed);
 
 
 //
@@ -59,6 +336,11 @@ static void	jpeg_error_handler(j_common_ptr p) _PAPPL_NORETURN;
 // some "print-scaling" modes.  Pass `0` if the image has no explicit resolution
 // information.
 //
+// When "smoothing" is `true`, the image is resampled using a Lanczos-2 filter
+// when it is reduced and a bilinear filter when it is enlarged.  Otherwise
+// nearest-neighbor sampling is used, which keeps the edges of line art and
+// barcodes sharp.
+//
 
 bool					// O - `true` on success, `false` otherwise
 papplJobFilterImage(
@@ -72,741 +354,2977 @@ papplJobFilterImage(
     int                 ppi,		// I - Pixels per inch (`0` for unknown)
     bool		smoothing)	// I - `true` to smooth/interpolate the image, `false` for nearest-neighbor sampling
 {
-  bool			started = false;// Have we started the job?
-  int			i;		// Looping var
-  pappl_pr_driver_data_t driver_data;	// Printer driver data
-  const unsigned char	*dither;	// Dither line
-  int			ileft,		// Imageable left margin
-			itop,		// Imageable top margin
-			iwidth,		// Imageable width
-			iheight;	// Imageable length/height
-  unsigned char		white,		// White color
-			*line = NULL,	// Output line
-			*lineptr,	// Pointer in line
-			byte,		// Byte in line
-			bit;		// Current bit
-  const unsigned char	*pixbase,	// Pointer to first pixel
-			*pixline,	// Pointer to start of current line
-			*pixptr,	// Pointer into image
-			*pixend;	// End of image
-  int			pixel0,		// Temporary pixel value
-			pixel1,		// ...
-			img_width,	// Rotated image width
-			img_height,	// Rotated image height
-			x,		// X position
-			xsize,		// Scaled width
-			xstart,		// X start position
-			xend,		// X end position
-			y,		// Y position
-			ysize,		// Scaled height
-			ystart,		// Y start position
-			yend;		// Y end position
-  int			xdir,		// X direction
-			xerr,		// X error accumulator
-			xmod,		// X modulus
-			xstep,		// X step
-			yerr,		// Y error accumulator
-			ymod,		// Y modulus
-			ystep,		// Y step
-			ydir;		// Y direction
+  _pappl_isrc_t	src;			// Image source
 
 
-  // Images contain a single page/impression...
-  papplJobSetImpressions(job, 1);
+  memset(&src, 0, sizeof(src));
 
-  if (options->print_scaling == PAPPL_SCALING_FILL)
+  src.width  = width;
+  src.height = height;
+  src.depth  = depth;
+  src.ppi    = ppi;
+  src.pixels = pixels;
+
+  return (filter_image(job, device, options, &src, smoothing));
+}
+
+
+//
+// '_papplJobFilterJPEG()' - Filter a JPEG image file.
+//
+
+#ifdef HAVE_LIBJPEG
+bool
+_papplJobFilterJPEG(
+    pappl_job_t    *job,		// I - Job
+    pappl_device_t *device,		// I - Device
+    void           *data)		// I - Filter data (unused)
+{
+  const char		*filename;	// JPEG filename
+  _pappl_jpeg_src_t	jsrc;		// Source manager info
+  pappl_pr_options_t	*options = NULL;// Job options
+  struct jpeg_decompress_struct	dinfo;	// Decompressor info
+  int			ppi;		// Pixels per inch
+  _pappl_jpeg_err_t	jerr;		// Error handler info
+  _pappl_ilayout_t	layout;		// Image layout
+  _pappl_isrc_t		src;		// Image source
+  int			scale;		// DCT scaling factor in 1/8ths
+  bool			ret = false;	// Return value
+
+
+  (void)data;
+
+  // Open the JPEG file - the document data is read using papplJobReadFile
+  // since it may still be arriving from the Client...
+  filename = papplJobGetFilename(job);
+  if ((jsrc.fd = open(filename, O_RDONLY | O_BINARY)) < 0)
   {
-    // Scale to fill the entire media area...
-    ileft   = 0;
-    itop    = 0;
-    iwidth  = (int)options->header.cupsWidth;
-    iheight = (int)options->header.cupsHeight;
+    papplLogJob(job, PAPPL_LOGLEVEL_ERROR, "Unable to open JPEG file '%s': %s", filename, strerror(errno));
+    return (false);
   }
-  else
+
+  // Read the image header...
+  jpeg_std_error(&jerr.jerr);
+  jerr.jerr.error_exit = jpeg_error_handler;
+
+  if (setjmp(jerr.retbuf))
   {
-    // Scale/center within the margins...
-    ileft   = options->media.left_margin * options->printer_resolution[0] / 2540;
-    itop    = options->media.top_margin * options->printer_resolution[1] / 2540;
-    iwidth  = (int)options->header.cupsWidth - (options->media.left_margin + options->media.right_margin) * options->printer_resolution[0] / 2540;
-    iheight = (int)options->header.cupsHeight - (options->media.bottom_margin + options->media.top_margin) * options->printer_resolution[1] / 2540;
+    // JPEG library errors are directed to this point...
+    papplJobSetReasons(job, PAPPL_JREASON_DOCUMENT_FORMAT_ERROR, PAPPL_JREASON_NONE);
+    papplLogJob(job, PAPPL_LOGLEVEL_ERROR, "Unable to open JPEG file '%s': %s", filename, jerr.message);
+    ret = false;
+    goto finish_jpeg;
   }
 
-  papplLogJob(job, PAPPL_LOGLEVEL_DEBUG, "ileft=%d, itop=%d, iwidth=%d, iheight=%d", ileft, itop, iwidth, iheight);
+  dinfo.err = (struct jpeg_error_mgr *)&jerr;
+  jpeg_create_decompress(&dinfo);
+
+  jsrc.job                   = job;
+  jsrc.src.init_source       = jpeg_init_source;
+  jsrc.src.fill_input_buffer = jpeg_fill_input;
+  jsrc.src.skip_input_data   = jpeg_skip_input;
+  jsrc.src.resync_to_restart = jpeg_resync_to_restart;
+  jsrc.src.term_source       = jpeg_term_source;
+  jsrc.src.next_input_byte   = NULL;
+  jsrc.src.bytes_in_buffer   = 0;
+  dinfo.src                  = &jsrc.src;
 
-  if (iwidth <= 0 || iheight <= 0)
+  jpeg_read_header(&dinfo, TRUE);
+
+  if (dinfo.X_density != dinfo.Y_density)
   {
-    papplLogJob(job, PAPPL_LOGLEVEL_ERROR, "Invalid media size");
-    return (false);
+    papplLogJob(job, PAPPL_LOGLEVEL_WARN, "Unsupported non-square JPEG resolution %ux%u%s, using default.", dinfo.X_density, dinfo.Y_density, dinfo.density_unit == 1 ? "dpi" : dinfo.density_unit == 2 ? "dpcm" : "???");
+    ppi = 0;
   }
-
-  // Figure out the scaling and rotation of the image...
-  if (options->orientation_requested == IPP_ORIENT_NONE)
+  else
   {
-    if (width > height && options->header.cupsWidth < options->header.cupsHeight)
-    {
-      options->orientation_requested = IPP_ORIENT_LANDSCAPE;
-      papplLogJob(job, PAPPL_LOGLEVEL_INFO, "Auto-orientation: landscape");
-    }
-    else
+    switch (dinfo.density_unit)
     {
-      options->orientation_requested = IPP_ORIENT_PORTRAIT;
-      papplLogJob(job, PAPPL_LOGLEVEL_INFO, "Auto-orientation: portrait");
+      default :
+      case 0 : // Unknown units
+          ppi = 0;
+          break;
+      case 1 : // Dots-per-inch
+          ppi = dinfo.X_density;
+          break;
+      case 2 : // Dots-per-centimeter
+          ppi = dinfo.X_density * 254 / 100;
+          break;
     }
   }
 
-  if (options->print_scaling == PAPPL_SCALING_AUTO || options->print_scaling == PAPPL_SCALING_AUTO_FIT)
-  {
-    if (ppi <= 0)
-    {
-      // No resolution information, so just force scaling the image to fit/fill
-      xsize = iwidth + 1;
-      ysize = iheight + 1;
-    }
-    else if (options->orientation_requested == IPP_ORIENT_PORTRAIT || options->orientation_requested == IPP_ORIENT_REVERSE_PORTRAIT)
-    {
-      xsize = width * options->printer_resolution[0] / ppi;
-      ysize = height * options->printer_resolution[1] / ppi;
-    }
-    else
-    {
-      xsize = height * options->printer_resolution[0] / ppi;
-      ysize = width * options->printer_resolution[1] / ppi;
-    }
+  // Get job options and request the image data in the format we need...
+  options = papplJobCreatePrintOptions(job, 1, dinfo.num_components > 1);
 
-    if (xsize > iwidth || ysize > iheight)
-    {
-      // Scale to fit/fill based on "print-scaling" and margins...
-      if (options->print_scaling == PAPPL_SCALING_AUTO && options->media.bottom_margin == 0 && options->media.left_margin == 0 && options->media.right_margin == 0 && options->media.top_margin == 0)
-        options->print_scaling = PAPPL_SCALING_FILL;
-      else
-        options->print_scaling = PAPPL_SCALING_FIT;
-    }
-    else
-    {
-      // Do no scaling...
-      options->print_scaling = PAPPL_SCALING_NONE;
-    }
+  dinfo.quantize_colors = FALSE;
+
+  if (options->header.cupsNumColors == 1)
+  {
+    dinfo.out_color_space      = JCS_GRAYSCALE;
+    dinfo.out_color_components = 1;
+    dinfo.output_components    = 1;
   }
-  else if (options->print_scaling == PAPPL_SCALING_NONE && ppi <= 0)
+  else
   {
-    // Force a default PPI value of 200, which fits a typical 1080p sized
-    // screenshot on a standard letter/A4 page.
-    ppi = 200;
+    dinfo.out_color_space      = JCS_RGB;
+    dinfo.out_color_components = 3;
+    dinfo.output_components    = 3;
   }
 
-  switch (options->orientation_requested)
+  // Let the decompressor downscale the image in the DCT domain so that we
+  // decode close to the printed size - libjpeg uses the nearest supported
+  // scale that is at least as large as the one we ask for...
+  if (!image_layout(job, options, (int)dinfo.image_width, (int)dinfo.image_height, &ppi, &layout))
   {
-    default :
-    case IPP_ORIENT_PORTRAIT :
-        pixbase    = pixels;
-        img_width  = width;
-        img_height = height;
-        xdir       = (int)depth;
-        ydir       = (int)depth * (int)width;
+    papplJobSetReasons(job, PAPPL_JREASON_ERRORS_DETECTED, PAPPL_JREASON_NONE);
+    goto finish_jpeg;
+  }
 
-        if (options->print_scaling == PAPPL_SCALING_NONE)
-        {
-          // No scaling
-	  xsize = img_width * options->printer_resolution[0] / ppi;
-	  ysize = img_height * options->printer_resolution[1] / ppi;
-        }
-        else
-	{
-	  // Fit/fill
-	  xsize = iwidth;
-	  ysize = xsize * height / width;
-
-	  if ((ysize > iheight && options->print_scaling == PAPPL_SCALING_FIT) || (ysize < iheight && options->print_scaling == PAPPL_SCALING_FILL))
-	  {
-	    ysize = iheight;
-	    xsize = ysize * width / height;
-	  }
-	}
-	break;
+  scale = (8 * layout.xsize + layout.img_width - 1) / layout.img_width;
+  if ((8 * layout.ysize + layout.img_height - 1) / layout.img_height > scale)
+    scale = (8 * layout.ysize + layout.img_height - 1) / layout.img_height;
 
-    case IPP_ORIENT_REVERSE_PORTRAIT :
-        pixbase    = pixels + depth * width * height - depth;
-        img_width  = width;
-        img_height = height;
-        xdir       = -(int)depth;
-        ydir       = -(int)depth * (int)width;
+  if (scale < 1)
+    scale = 1;
+  else if (scale > 8)
+    scale = 8;
 
-        if (options->print_scaling == PAPPL_SCALING_NONE)
-        {
-          // No scaling
-	  xsize = img_width * options->printer_resolution[0] / ppi;
-	  ysize = img_height * options->printer_resolution[1] / ppi;
-        }
-        else
-	{
-	  // Fit/fill
-	  xsize = iwidth;
-	  ysize = xsize * height / width;
-
-	  if ((ysize > iheight && options->print_scaling == PAPPL_SCALING_FIT) || (ysize < iheight && options->print_scaling == PAPPL_SCALING_FILL))
-	  {
-	    ysize = iheight;
-	    xsize = ysize * width / height;
-	  }
-	}
-	break;
+  dinfo.scale_num   = (unsigned)scale;
+  dinfo.scale_denom = 8;
 
-    case IPP_ORIENT_LANDSCAPE : // 90 counter-clockwise
-        pixbase    = pixels + depth * width - depth;
-        img_width  = height;
-        img_height = width;
-        xdir       = (int)depth * (int)width;
-        ydir       = -(int)depth;
+  jpeg_calc_output_dimensions(&dinfo);
 
-        if (options->print_scaling == PAPPL_SCALING_NONE)
-        {
-          // No scaling
-	  xsize = img_width * options->printer_resolution[0] / ppi;
-	  ysize = img_height * options->printer_resolution[1] / ppi;
-        }
-        else
-	{
-	  // Fit/fill
-	  xsize = iwidth;
-	  ysize = xsize * width / height;
-
-	  if ((ysize > iheight && options->print_scaling == PAPPL_SCALING_FIT) || (ysize < iheight && options->print_scaling == PAPPL_SCALING_FILL))
-	  {
-	    ysize = iheight;
-	    xsize = ysize * height / width;
-	  }
-	}
-	break;
+  if (ppi > 0)
+    ppi = (int)((unsigned)ppi * dinfo.output_width / dinfo.image_width);
 
-    case IPP_ORIENT_REVERSE_LANDSCAPE : // 90 clockwise
-        pixbase    = pixels + depth * (height - 1) * width;
-        img_width  = height;
-        img_height = width;
-        xdir       = -(int)depth * (int)width;
-        ydir       = (int)depth;
+  papplLogJob(job, PAPPL_LOGLEVEL_INFO, "Decoding %ux%ux%d JPEG image at %ux%u.", dinfo.image_width, dinfo.image_height, dinfo.output_components, dinfo.output_width, dinfo.output_height);
 
-        if (options->print_scaling == PAPPL_SCALING_NONE)
-        {
-          // No scaling
-	  xsize = img_width * options->printer_resolution[0] / ppi;
-	  ysize = img_height * options->printer_resolution[1] / ppi;
-        }
-        else
-	{
-	  // Fit/fill
-	  xsize = iwidth;
-	  ysize = xsize * width / height;
-
-	  if ((ysize > iheight && options->print_scaling == PAPPL_SCALING_FIT) || (ysize < iheight && options->print_scaling == PAPPL_SCALING_FILL))
-	  {
-	    ysize = iheight;
-	    xsize = ysize * height / width;
-	  }
-	}
-        break;
-  }
+  jpeg_start_decompress(&dinfo);
 
-  // Don't rotate in the driver...
-  options->orientation_requested = IPP_ORIENT_PORTRAIT;
+  // Stream the scanlines to the image filter...
+  memset(&src, 0, sizeof(src));
 
-  xstart = ileft + (iwidth - xsize) / 2;
-  xend   = xstart + xsize;
-  ystart = itop + (iheight - ysize) / 2;
-  yend   = ystart + ysize;
+  src.width     = (int)dinfo.output_width;
+  src.height    = (int)dinfo.output_height;
+  src.depth     = dinfo.output_components;
+  src.ppi       = ppi;
+  src.read_cb   = (_pappl_isrc_cb_t)jpeg_read_line;
+  src.rewind_cb = (_pappl_isrc_rcb_t)jpeg_rewind;
+  src.read_data = &dinfo;
 
-  xmod   = (int)(img_width % xsize);
-  xstep  = (int)(img_width / xsize) * xdir;
+  ret = filter_image(job, device, options, &src, true);
 
-  ymod   = (int)(img_height % ysize);
-  ystep  = (int)(img_height / ysize) * ydir;
+  // Don't finish the decompression since the image filter does not read the
+  // lines below the printed area...
+  finish_jpeg:
 
-  if (xend > (int)options->header.cupsWidth)
-    xend = (int)options->header.cupsWidth;
+  papplJobDeletePrintOptions(options);
+  jpeg_destroy_decompress(&dinfo);
+  close(jsrc.fd);
 
-  if (yend > (int)options->header.cupsHeight)
-    yend = (int)options->header.cupsHeight;
+  return (ret);
+}
+#endif // HAVE_LIBJPEG
 
-  papplLogJob(job, PAPPL_LOGLEVEL_DEBUG, "xsize=%d, xstart=%d, xend=%d, xdir=%d, xmod=%d, xstep=%d", xsize, xstart, xend, xdir, xmod, xstep);
-  papplLogJob(job, PAPPL_LOGLEVEL_DEBUG, "ysize=%d, ystart=%d, yend=%d, ydir=%d, ymod=%d, ystep=%d", ysize, ystart, yend, ydir, ymod, ystep);
 
-  papplPrinterGetDriverData(papplJobGetPrinter(job), &driver_data);
+//
+// '_papplJobFilterPNG()' - Filter a PNG image file.
+//
+
+#ifdef HAVE_LIBPNG
+bool					// O - `true` on success and `false` otherwise
+_papplJobFilterPNG(
+    pappl_job_t    *job,		// I - Job
+    pappl_device_t *device,		// I - Device
+    void           *data)		// I - Filter data (unused)
+{
+  const char		*filename;	// PNG filename
+  _pappl_png_src_t	psrc;		// PNG source info
+  _pappl_isrc_t		src;		// Image source
+  pappl_pr_options_t	*options = NULL;// Job options
+  png_uint_32		width,		// Width in columns
+			height,		// Height in lines
+			y;		// Current line
+  _pappl_ilayout_t	layout;		// Image layout
+  int			ppi = 0;	// Pixels per inch
+  int			bit_depth,	// Bits per sample
+			color_type,	// Color type
+			interlace_type,	// Interlace type
+			passes;		// Number of interlace passes
+  size_t		rowbytes,	// Bytes per decoded line
+			stride;		// Bytes per image line
+  png_bytep		*rows = NULL;	// Lines for interlaced images
+  unsigned char		*pixels = NULL;	// Pixels for interlaced images
+  size_t		pixsize = 0;	// Size of pixels
+#if !_WIN32
+  int			pixfd = -1;	// Temporary file for pixels
+  char			pixname[1024] = "";
+					// Temporary filename
+#endif // !_WIN32
+  bool			ret = false;	// Return value
+
+
+  (void)data;
+
+  // Open the PNG file...
+  memset(&psrc, 0, sizeof(psrc));
+  psrc.job = job;
 
-  if ((line = malloc(options->header.cupsBytesPerLine)) == NULL)
+  filename = papplJobGetFilename(job);
+  if ((psrc.fd = open(filename, O_RDONLY | O_BINARY)) < 0)
   {
-    papplLogJob(job, PAPPL_LOGLEVEL_ERROR, "Unable to allocate memory for raster line.");
-    goto abort_job;
+    papplLogJob(job, PAPPL_LOGLEVEL_ERROR, "Unable to open PNG file '%s': %s", filename, strerror(errno));
+    return (false);
   }
 
-  // Start the job...
-  if (!(driver_data.rstartjob_cb)(job, options, device))
+  // Read the image header...
+  if (!png_open_image(&psrc))
+    goto finish_png;
+
+  png_get_IHDR(psrc.png, psrc.info, &width, &height, &bit_depth, &color_type, &interlace_type, NULL, NULL);
+
+  papplLogJob(job, PAPPL_LOGLEVEL_INFO, "PNG image is %ux%u%s", (unsigned)width, (unsigned)height, interlace_type != PNG_INTERLACE_NONE ? " (interlaced)" : "");
+
+  // Prepare options...
+  options = papplJobCreatePrintOptions(job, 1, (color_type & PNG_COLOR_MASK_COLOR) != 0);
+
+  // Request 8-bit grayscale or sRGB lines...
+  if ((passes = png_set_format(&psrc, options->header.cupsNumColors > 1 ? 3 : 1)) == 0)
+    goto finish_png;
+
+  rowbytes = png_get_rowbytes(psrc.png, psrc.info);
+  stride     = (size_t)width * (size_t)psrc.depth;
+
+  if (rowbytes != (psrc.alpha ? 2 * (stride + width) : stride))
   {
-    papplLogJob(job, PAPPL_LOGLEVEL_ERROR, "Unable to start raster job.");
-    goto abort_job;
+    papplLogJob(job, PAPPL_LOGLEVEL_ERROR, "Unsupported PNG image format.");
+    papplJobSetReasons(job, PAPPL_JREASON_DOCUMENT_FORMAT_ERROR, PAPPL_JREASON_NONE);
+    goto finish_png;
   }
 
-  started = true;
+  memset(&src, 0, sizeof(src));
+
+  src.width  = (int)width;
+  src.height = (int)height;
+  src.depth  = psrc.depth;
+
+  // TODO: Get PNG image resolution information (Issue #65)
+
+  if (!image_layout(job, options, src.width, src.height, &ppi, &layout))
+  {
+    papplJobSetReasons(job, PAPPL_JREASON_ERRORS_DETECTED, PAPPL_JREASON_NONE);
+    goto finish_png;
+  }
+
+  if (passes > 1 || layout.orientation != IPP_ORIENT_PORTRAIT)
+  {
+    // Interlaced images are only complete after the last pass and rotated
+    // images are read by column, so decode them into a temporary file that is
+    // mapped into memory...
+    pixsize = rowbytes * (size_t)height;
+
+#if _WIN32
+    if ((pixels = papplJobGetBuffer(job, pixsize)) == NULL)
+    {
+      papplLogJob(job, PAPPL_LOGLEVEL_ERROR, "Unable to allocate memory for %ux%ux%d PNG image.", (unsigned)width, (unsigned)height, psrc.depth);
+      papplJobSetReasons(job, PAPPL_JREASON_ERRORS_DETECTED, PAPPL_JREASON_NONE);
+      goto finish_png;
+    }
+
+#else
+    if ((pixfd = papplJobOpenFile(job, pixname, sizeof(pixname), NULL, "pixels", "w+")) < 0 || ftruncate(pixfd, (off_t)pixsize) || (pixels = mmap(NULL, pixsize, PROT_READ | PROT_WRITE, MAP_SHARED, pixfd, 0)) == MAP_FAILED)
+    {
+      papplLogJob(job, PAPPL_LOGLEVEL_ERROR, "Unable to create temporary file for %ux%ux%d PNG image: %s", (unsigned)width, (unsigned)height, psrc.depth, strerror(errno));
+      papplJobSetReasons(job, PAPPL_JREASON_ERRORS_DETECTED, PAPPL_JREASON_NONE);
+      pixels = NULL;
+      goto finish_png;
+    }
+#endif // _WIN32
+
+    if ((rows = calloc(height, sizeof(png_bytep))) == NULL)
+    {
+      papplLogJob(job, PAPPL_LOGLEVEL_ERROR, "Unable to allocate memory for PNG image.");
+      papplJobSetReasons(job, PAPPL_JREASON_ERRORS_DETECTED, PAPPL_JREASON_NONE);
+      goto finish_png;
+    }
+
+    for (y = 0; y < height; y ++)
+      rows[y] = pixels + y * rowbytes;
+
+    if (setjmp(png_jmpbuf(psrc.png)))
+      goto finish_png;
+
+    png_read_image(psrc.png, rows);
+
+    // Blend transparent pixels with white - the lines get shorter, so this
+    // can be done in place...
+    if (psrc.alpha)
+    {
+      for (y = 0; y < height; y ++)
+        png_composite_line(rows[y], pixels + y * stride, (int)width, psrc.depth);
+    }
+
+    src.pixels = pixels;
+  }
+  else
+  {
+    // Stream the lines to the image filter...
+    if (psrc.alpha && (psrc.row = papplJobGetBuffer(job, rowbytes)) == NULL)
+    {
+      papplLogJob(job, PAPPL_LOGLEVEL_ERROR, "Unable to allocate memory for PNG image.");
+      papplJobSetReasons(job, PAPPL_JREASON_ERRORS_DETECTED, PAPPL_JREASON_NONE);
+      goto finish_png;
+    }
+
+    src.read_cb   = (_pappl_isrc_cb_t)png_read_line;
+    src.rewind_cb = (_pappl_isrc_rcb_t)png_rewind;
+    src.read_data = &psrc;
+  }
+
+  // Print the image...
+  ret = filter_image(job, device, options, &src, false);
+
+  finish_png:
+
+  papplJobDeletePrintOptions(options);
+
+  // Free the image data when we're done...
+  free(rows);
+
+#if _WIN32
+  papplJobReleaseBuffer(job, pixels);
+#else
+  if (pixels)
+    munmap(pixels, pixsize);
+
+  if (pixfd >= 0)
+    close(pixfd);
+
+  if (pixname[0])
+    unlink(pixname);
+#endif // _WIN32
+
+  papplJobReleaseBuffer(job, psrc.row);
+  png_destroy_read_struct(&psrc.png, &psrc.info, NULL);
+  close(psrc.fd);
+
+  return (ret);
+}
+#endif // HAVE_LIBPNG
+
+
+//
+// '_papplScalerCreate()' - Create an image scaler.
+//
+// The scaler resizes an 8-bit grayscale ("depth" = `1`) or sRGB ("depth" =
+// `3`) image using a separable filter.  The filter taps for each output column
+// are computed once, and each input line is scaled horizontally once and kept
+// in a small ring of lines for the vertical pass, so only a few lines of the
+// image are in memory at any time.
+//
+// Only the output columns from "out_left" to "out_right" - 1 are produced.
+// Input lines are requested from the callback in increasing order.
+//
+
+_pappl_scaler_t *			// O - Image scaler or `NULL` on error
+_papplScalerCreate(
+    int                in_width,	// I - Input width in columns
+    int                in_height,	// I - Input height in lines
+    int                depth,		// I - Bytes per pixel (`1` or `3`)
+    int                out_width,	// I - Output width in columns
+    int                out_height,	// I - Output height in lines
+    int                out_left,	// I - First output column
+    int                out_right,	// I - Last output column + 1
+    _pappl_resample_t  filter,		// I - Resampling filter
+    _pappl_scaler_cb_t cb,		// I - Input line callback
+    void               *cb_data)	// I - Input line callback data
+{
+  _pappl_scaler_t	*scaler;	// Image scaler
+  int			i,		// Looping var
+			count,		// Number of taps
+			first,		// First input column
+			hmax,		// Maximum number of horizontal taps
+			vmax;		// Maximum number of vertical taps
+  double		support;	// Filter support in input pixels
+
+
+  if (in_width < 1 || in_height < 1 || (depth != 1 && depth != 3) || out_width < 1 || out_height < 1 || out_left < 0 || out_right > out_width || out_left >= out_right || !cb)
+    return (NULL);
+
+  if ((scaler = (_pappl_scaler_t *)calloc(1, sizeof(_pappl_scaler_t))) == NULL)
+    return (NULL);
+
+  scaler->in_width   = in_width;
+  scaler->in_height  = in_height;
+  scaler->depth      = depth;
+  scaler->out_width  = out_width;
+  scaler->out_height = out_height;
+  scaler->out_left   = out_left;
+  scaler->out_right  = out_right;
+  scaler->filter     = filter;
+  scaler->cb         = cb;
+  scaler->cb_data    = cb_data;
+  scaler->linesize   = (size_t)((out_right - out_left) * depth);
+
+  // Figure out the maximum number of taps - the filter is stretched when
+  // reducing the image...
+  support = filter == _PAPPL_RESAMPLE_LANCZOS2 ? 2.0 : 1.0;
+
+  hmax = (int)ceil(2.0 * support * (in_width > out_width ? (double)in_width / (double)out_width : 1.0)) + 1;
+  vmax = (int)ceil(2.0 * support * (in_height > out_height ? (double)in_height / (double)out_height : 1.0)) + 1;
+
+  if (vmax > in_height)
+    vmax = in_height;
+
+  // Grayscale columns are filtered 8 taps at a time and color columns 2 taps
+  // at a time, so pad the number of taps and move the taps of the right-most
+  // columns so that they stay inside the line...
+  scaler->htaps = depth == 1 ? (hmax + 7) & ~7 : (hmax + 1) & ~1;
+  if (scaler->htaps > in_width)
+    scaler->htaps = in_width;
+
+  scaler->vtaps = vmax;
+
+  if ((scaler->hfirst = (int *)calloc((size_t)(out_right - out_left), sizeof(int))) == NULL || (scaler->hweights = (short *)calloc((size_t)((out_right - out_left) * scaler->htaps), sizeof(short))) == NULL || (scaler->weights = (double *)calloc((size_t)(hmax > vmax ? hmax : vmax), sizeof(double))) == NULL || (scaler->vweights = (short *)calloc((size_t)vmax, sizeof(short))) == NULL || (scaler->vlines = (const unsigned char **)calloc((size_t)vmax, sizeof(unsigned char *))) == NULL || (scaler->ring = (unsigned char *)malloc((size_t)vmax * scaler->linesize)) == NULL || (scaler->ring_rows = (int *)malloc((size_t)vmax * sizeof(int))) == NULL)
+  {
+    _papplScalerDelete(scaler);
+    return (NULL);
+  }
+
+  for (i = 0; i < vmax; i ++)
+    scaler->ring_rows[i] = -1;
+
+  // Compute the taps for each output column...
+  for (i = out_left; i < out_right; i ++)
+  {
+    short *hweights = scaler->hweights + (i - out_left) * scaler->htaps;
+					// Weights for column
+
+    count = scaler_taps(filter, in_width, out_width, i, scaler->weights, &first);
+
+    scaler->hfirst[i - out_left] = first;
+    if (first > (in_width - scaler->htaps))
+      scaler->hfirst[i - out_left] = in_width - scaler->htaps;
+
+    scaler_weights(scaler->weights, count, hweights + first - scaler->hfirst[i - out_left]);
+  }
+
+  return (scaler);
+}
+
+
+//
+// '_papplScalerDelete()' - Delete an image scaler.
+//
+
+void
+_papplScalerDelete(
+    _pappl_scaler_t *scaler)		// I - Image scaler
+{
+  if (!scaler)
+    return;
+
+  free(scaler->hfirst);
+  free(scaler->hweights);
+  free(scaler->weights);
+  free(scaler->vweights);
+  free(scaler->vlines);
+  free(scaler->ring);
+  free(scaler->ring_rows);
+  free(scaler);
+}
+
+
+//
+// '_papplScalerGetLine()' - Get a scaled line.
+//
+// The "line" buffer receives the pixels for the output columns from
+// "out_left" to "out_right" - 1.  Lines must be requested in increasing order.
+//
+
+bool					// O - `true` on success, `false` on error
+_papplScalerGetLine(
+    _pappl_scaler_t *scaler,		// I - Image scaler
+    int             y,			// I - Output line
+    unsigned char   *line)		// I - Line buffer
+{
+  int			i,		// Looping var
+			count,		// Number of taps
+			first,		// First input line
+			slot;		// Ring slot
+  const unsigned char	*in;		// Input line
+
+
+  if (!scaler || y < 0 || y >= scaler->out_height || !line)
+    return (false);
+
+  count = scaler_taps(scaler->filter, scaler->in_height, scaler->out_height, y, scaler->weights, &first);
+
+  scaler_weights(scaler->weights, count, scaler->vweights);
+
+  // Scale the input lines horizontally as needed - the taps for each output
+  // line start at or after those of the previous line, so input lines that
+  // are still needed are never replaced in the ring...
+  for (i = 0; i < count; i ++)
+  {
+    slot = (first + i) % scaler->vtaps;
+
+    if (scaler->ring_rows[slot] != (first + i))
+    {
+      if ((in = (scaler->cb)(scaler->cb_data, first + i)) == NULL)
+        return (false);
+
+      scaler_hline(scaler, in, scaler->ring + (size_t)slot * scaler->linesize);
+      scaler->ring_rows[slot] = first + i;
+    }
+
+    scaler->vlines[i] = scaler->ring + (size_t)slot * scaler->linesize;
+  }
+
+  // Then filter the lines vertically...
+  scaler_vline(scaler->vlines, scaler->vweights, count, line, scaler->linesize);
+
+  return (true);
+}
+
+
+//
+// 'filter_image()' - Filter an image from memory or a stream.
+//
+// Streamed images are read one line at a time from top to bottom and only
+// the current line, or the lines used by the scaler, are kept in memory.  Rotated images and copies
+// that cannot be replayed from the page raster cache need random access to
+// the pixels, so the whole image is loaded first.
+//
+// Smoothed images are resampled by the image scaler, which keeps only the
+// lines used by its filter in memory.
+//
+// Images in memory are split into bands of lines that are rendered in
+// parallel by the job thread and the system's render workers.
+//
+
+static bool				// O - `true` on success, `false` otherwise
+filter_image(
+    pappl_job_t         *job,		// I - Job
+    pappl_device_t      *device,	// I - Device
+    pappl_pr_options_t  *options,	// I - Print options
+    _pappl_isrc_t       *src,		// I - Image source
+    bool                smoothing)	// I - `true` to smooth/interpolate the image, `false` for nearest-neighbor sampling
+{
+  bool			started = false;// Have we started the job?
+  int			i;		// Looping var
+  pappl_pr_driver_data_t driver_data;	// Printer driver data
+  _pappl_ilayout_t	layout;		// Image layout
+  int			width = src->width,
+					// Width in columns
+			height = src->height,
+					// Height in lines
+			depth = src->depth,
+					// Bytes per pixel
+			ppi = src->ppi;	// Pixels per inch
+  _pappl_rpipe_t	*rpipe = NULL;	// Raster line pipeline
+  _pappl_rcache_t	*cache = NULL;	// Page raster cache for copies
+  _pappl_irender_t	ir;		// Image renderer
+  _pappl_irctx_t	ctx;		// Image rendering state for the job thread
+  struct timeval	starttime,	// Start time of copy
+			endtime;	// End time of copy
+  unsigned char		white,		// White color
+			*line;		// Output line
+  const unsigned char	*pixels,	// Image pixels
+			*pixbase;	// Pointer to first pixel
+  int			img_width,	// Rotated image width
+			img_height,	// Rotated image height
+			xsize,		// Scaled width
+			xstart,		// X start position
+			xleft,		// First visible X position
+			xend,		// X end position
+			y,		// Y position
+			ysize,		// Scaled height
+			ystart,		// Y start position
+			yend,		// Y end position
+			num_workers;	// Number of threads rendering the page
+  int			xdir,		// X direction
+			xmod,		// X modulus
+			xstep,		// X step
+			ymod,		// Y modulus
+			ystep,		// Y step
+			ydir;		// Y direction
+
+
+  // Images contain a single page/impression...
+  papplJobSetImpressions(job, 1);
+
+  memset(&ir, 0, sizeof(ir));
+  memset(&ctx, 0, sizeof(ctx));
+
+  pthread_mutex_init(&ir.mutex, NULL);
+  pthread_cond_init(&ir.cond, NULL);
+
+  // Figure out the scaling and rotation of the image...
+  if (!image_layout(job, options, width, height, &ppi, &layout))
+    goto abort_job;
+
+  if (options->orientation_requested == IPP_ORIENT_NONE)
+    papplLogJob(job, PAPPL_LOGLEVEL_INFO, "Auto-orientation: %s", layout.orientation == IPP_ORIENT_LANDSCAPE ? "landscape" : "portrait");
+
+  options->orientation_requested = layout.orientation;
+  options->print_scaling         = layout.scaling;
+
+  img_width  = layout.img_width;
+  img_height = layout.img_height;
+  xsize      = layout.xsize;
+  ysize      = layout.ysize;
+
+  // The lines of the first copy are cached so that the remaining copies can
+  // be replayed without scaling and dithering the image again...
+  if (options->copies > 1)
+    cache = rcache_create(job, options->header.cupsBytesPerLine);
+
+  // Streamed images are read from top to bottom, so load the whole image if
+  // it needs to be rotated or if the copies cannot be replayed...
+  if (!src->pixels && (options->orientation_requested != IPP_ORIENT_PORTRAIT || (options->copies > 1 && !cache)) && !isrc_load(job, src))
+    goto abort_job;
+
+  pixels = src->pixels;
+
+  switch (options->orientation_requested)
+  {
+    default :
+    case IPP_ORIENT_PORTRAIT :
+        pixbase = pixels;
+        xdir    = depth;
+        ydir    = depth * width;
+	break;
+
+    case IPP_ORIENT_REVERSE_PORTRAIT :
+        pixbase = pixels + depth * width * height - depth;
+        xdir    = -depth;
+        ydir    = -depth * width;
+	break;
+
+    case IPP_ORIENT_LANDSCAPE : // 90 counter-clockwise
+        pixbase = pixels + depth * width - depth;
+        xdir    = depth * width;
+        ydir    = -depth;
+	break;
+
+    case IPP_ORIENT_REVERSE_LANDSCAPE : // 90 clockwise
+        pixbase = pixels + depth * (height - 1) * width;
+        xdir    = -depth * width;
+        ydir    = depth;
+        break;
+  }
+
+  // Don't rotate in the driver...
+  options->orientation_requested = IPP_ORIENT_PORTRAIT;
+
+  xstart = layout.ileft + (layout.iwidth - xsize) / 2;
+  xleft  = xstart < 0 ? 0 : xstart;
+  xend   = xstart + xsize;
+  ystart = layout.itop + (layout.iheight - ysize) / 2;
+  yend   = ystart + ysize;
+
+  xmod   = (int)(img_width % xsize);
+  xstep  = (int)(img_width / xsize) * xdir;
+
+  ymod   = (int)(img_height % ysize);
+  ystep  = (int)(img_height / ysize);
+
+  if (xend > (int)options->header.cupsWidth)
+    xend = (int)options->header.cupsWidth;
+
+  if (yend > (int)options->header.cupsHeight)
+    yend = (int)options->header.cupsHeight;
+
+  papplLogJob(job, PAPPL_LOGLEVEL_DEBUG, "xsize=%d, xstart=%d, xend=%d, xdir=%d, xmod=%d, xstep=%d", xsize, xstart, xend, xdir, xmod, xstep);
+  papplLogJob(job, PAPPL_LOGLEVEL_DEBUG, "ysize=%d, ystart=%d, yend=%d, ydir=%d, ymod=%d, ystep=%d", ysize, ystart, yend, ydir, ymod, ystep);
+
+  if (options->header.cupsColorSpace == CUPS_CSPACE_K || options->header.cupsColorSpace == CUPS_CSPACE_CMYK)
+    white = 0x00;
+  else
+    white = 0xff;
+
+  // Set up the image renderer...
+  ir.job        = job;
+  ir.options    = options;
+  ir.src        = src;
+  ir.pixbase    = pixbase;
+  ir.linesize   = options->header.cupsBytesPerLine;
+  ir.white      = white;
+  ir.img_width  = img_width;
+  ir.img_height = img_height;
+  ir.xdir       = xdir;
+  ir.xsize      = xsize;
+  ir.xstart     = xstart;
+  ir.xleft      = xleft;
+  ir.xend       = xend;
+  ir.xmod       = xmod;
+  ir.xstep      = xstep;
+  ir.ydir       = ydir;
+  ir.ysize      = ysize;
+  ir.ystart     = ystart;
+  ir.ybegin     = ystart < 0 ? 0 : ystart;
+  ir.yend       = yend;
+  ir.ymod       = ymod;
+  ir.ystep      = ystep;
+  ir.smoothing  = smoothing && xleft < xend;
+
+  if (ystart < 0)
+  {
+    ir.row  = -(ystart * ymod / ysize);
+    ir.yerr = -ymod / 2 - (ystart * ymod) % ysize;
+  }
+  else
+  {
+    ir.row  = 0;
+    ir.yerr = -ymod / 2;
+  }
+
+  if (ir.smoothing)
+  {
+    // Resample the visible columns of the image...
+    ir.filter = (xsize < img_width || ysize < img_height) ? _PAPPL_RESAMPLE_LANCZOS2 : _PAPPL_RESAMPLE_BILINEAR;
+
+    papplLogJob(job, PAPPL_LOGLEVEL_DEBUG, "Scaling image using %s filter.", ir.filter == _PAPPL_RESAMPLE_LANCZOS2 ? "Lanczos-2" : "bilinear");
+  }
+
+  if (!irender_start(&ir, &ctx))
+    goto abort_job;
+
+  papplPrinterGetDriverData(papplJobGetPrinter(job), &driver_data);
+
+  // Start the job...
+  if (!(driver_data.rstartjob_cb)(job, options, device))
+  {
+    papplLogJob(job, PAPPL_LOGLEVEL_ERROR, "Unable to start raster job.");
+    goto abort_job;
+  }
+
+  started = true;
+
+  // Print every copy...
+  for (i = 0; i < options->copies; i ++)
+  {
+    gettimeofday(&starttime, NULL);
+
+    if (!(driver_data.rstartpage_cb)(job, options, device, 1))
+    {
+      papplLogJob(job, PAPPL_LOGLEVEL_ERROR, "Unable to start raster page.");
+      goto abort_job;
+    }
+
+    // Lines are written by the pipeline's writer thread while the following
+    // lines are scaled and dithered.  The line buffers start out white and
+    // only the image columns are replaced for each line...
+    if ((rpipe = _papplRasterPipeCreate(job, options, device, options->header.cupsBytesPerLine, white)) == NULL)
+      goto abort_job;
+
+    y = 0;
+
+    if (i > 0 && cache)
+    {
+      // Replay the cached lines - this writes the whole page so the leading
+      // blank space, image, and trailing blank space loops are skipped...
+      if (!rcache_rewind(cache))
+        goto abort_job;
+
+      for (; y < (int)options->header.cupsHeight && !job->is_canceled; y ++)
+      {
+        line = _papplRasterPipeGetLine(rpipe);
+
+        if (!rcache_get_line(cache, line))
+        {
+	  papplLogJob(job, PAPPL_LOGLEVEL_ERROR, "Unable to read cached raster line %u.", y);
+	  goto abort_job;
+        }
+
+	if (!_papplRasterPipeWriteLine(rpipe, (unsigned)y))
+	{
+	  papplLogJob(job, PAPPL_LOGLEVEL_ERROR, "Unable to write raster line %u.", y);
+	  goto abort_job;
+	}
+      }
+    }
+
+    // Leading blank space...
+    for (; y < ystart; y ++)
+    {
+      line = _papplRasterPipeGetLine(rpipe);
+      memset(line, white, options->header.cupsBytesPerLine);
+      rcache_add_line(cache, line);
+
+      if (!_papplRasterPipeWriteLine(rpipe, (unsigned)y))
+      {
+	papplLogJob(job, PAPPL_LOGLEVEL_ERROR, "Unable to write raster line %u.", y);
+	goto abort_job;
+      }
+    }
+
+    // Now RIP the image - streamed images are read from top to bottom, so
+    // only images in memory are rendered in parallel...
+    if ((num_workers = papplSystemGetMaxRenderWorkers(job->system)) > 1 && src->pixels && y < yend)
+    {
+      if (!irender_bands(&ir, &ctx, rpipe, cache, num_workers, &y))
+        goto abort_job;
+    }
+    else
+    {
+      ctx.row  = ir.row;
+      ctx.yerr = ir.yerr;
+
+      for (; y < yend && !job->is_canceled; y ++)
+      {
+	line = _papplRasterPipeGetLine(rpipe);
+
+	if (!irender_line(&ir, &ctx, y, line))
+	  goto abort_job;
+
+	rcache_add_line(cache, line);
+
+	if (!_papplRasterPipeWriteLine(rpipe, (unsigned)y))
+	{
+	  papplLogJob(job, PAPPL_LOGLEVEL_ERROR, "Unable to write raster line %u.", y);
+	  goto abort_job;
+	}
+      }
+    }
+
+    // Trailing blank space...
+    for (; y < (int)options->header.cupsHeight; y ++)
+    {
+      line = _papplRasterPipeGetLine(rpipe);
+      memset(line, white, options->header.cupsBytesPerLine);
+      rcache_add_line(cache, line);
+
+      if (!_papplRasterPipeWriteLine(rpipe, (unsigned)y))
+      {
+	papplLogJob(job, PAPPL_LOGLEVEL_ERROR, "Unable to write raster line %u.", y);
+	goto abort_job;
+      }
+    }
+
+    // Wait for the queued lines to be written...
+    if (!_papplRasterPipeDelete(rpipe))
+    {
+      rpipe = NULL;
+      papplLogJob(job, PAPPL_LOGLEVEL_ERROR, "Unable to write raster lines.");
+      goto abort_job;
+    }
+
+    rpipe = NULL;
+
+    // End the page...
+    if (!(driver_data.rendpage_cb)(job, options, device, 1))
+    {
+      papplLogJob(job, PAPPL_LOGLEVEL_ERROR, "Unable to end raster page.");
+      goto abort_job;
+    }
+
+    papplJobSetImpressionsCompleted(job, 1);
+
+    gettimeofday(&endtime, NULL);
+
+    papplLogJob(job, PAPPL_LOGLEVEL_DEBUG, "Copy %d of %d %s in %.3f seconds.", i + 1, options->copies, i > 0 && cache ? "replayed" : "rendered", endtime.tv_sec - starttime.tv_sec + 0.000001 * (endtime.tv_usec - starttime.tv_usec));
+
+    if (i == 0 && cache && cache->error)
+    {
+      // Unable to cache the first copy, render the remaining copies...
+      rcache_delete(cache);
+      cache = NULL;
+
+      if (!src->pixels)
+      {
+        // Streamed images are only read once, so load the image from the
+        // complete document file and restart the renderer with it - streamed
+        // images are not rotated...
+        papplLogJob(job, PAPPL_LOGLEVEL_WARN, "Unable to cache streamed image for copies, reloading image.");
+
+        irender_finish(&ir, &ctx);
+
+        if (!isrc_reload(job, src))
+        {
+          papplLogJob(job, PAPPL_LOGLEVEL_ERROR, "Unable to reload streamed image for copies.");
+          goto abort_job;
+        }
+
+        ir.pixbase = src->pixels;
+
+        if (!irender_start(&ir, &ctx))
+          goto abort_job;
+      }
+    }
+  }
+
+  // End the job...
+  if (!(driver_data.rendjob_cb)(job, options, device))
+  {
+    papplLogJob(job, PAPPL_LOGLEVEL_ERROR, "Unable to end raster job.");
+    goto abort_job;
+  }
+
+  rcache_delete(cache);
+  irender_finish(&ir, &ctx);
+  pthread_cond_destroy(&ir.cond);
+  pthread_mutex_destroy(&ir.mutex);
+  papplJobReleaseBuffer(job, src->buffer);
+
+  return (true);
+
+  // Abort the job...
+  abort_job:
+
+  if (rpipe)
+    _papplRasterPipeDelete(rpipe);
+
+  rcache_delete(cache);
+  irender_finish(&ir, &ctx);
+  pthread_cond_destroy(&ir.cond);
+  pthread_mutex_destroy(&ir.mutex);
+  papplJobReleaseBuffer(job, src->buffer);
+
+  if (started)
+    (driver_data.rendjob_cb)(job, options, device);
+
+  return (false);
+}
+
+
+//
+// 'image_layout()' - Compute the orientation, scaling, and size of an image.
+//
+// The print options are not changed so that image filters can compute the
+// layout before decoding an image.
+//
+
+static bool				// O - `true` on success, `false` on error
+image_layout(
+    pappl_job_t        *job,		// I - Job
+    pappl_pr_options_t *options,	// I - Print options
+    int                width,		// I - Width in columns
+    int                height,		// I - Height in lines
+    int                *ppi,		// IO - Pixels per inch (`0` for unknown)
+    _pappl_ilayout_t   *layout)		// O - Image layout
+{
+  memset(layout, 0, sizeof(_pappl_ilayout_t));
+
+  if (options->print_scaling == PAPPL_SCALING_FILL)
+  {
+    // Scale to fill the entire media area...
+    layout->ileft   = 0;
+    layout->itop    = 0;
+    layout->iwidth  = (int)options->header.cupsWidth;
+    layout->iheight = (int)options->header.cupsHeight;
+  }
+  else
+  {
+    // Scale/center within the margins...
+    layout->ileft   = options->media.left_margin * options->printer_resolution[0] / 2540;
+    layout->itop    = options->media.top_margin * options->printer_resolution[1] / 2540;
+    layout->iwidth  = (int)options->header.cupsWidth - (options->media.left_margin + options->media.right_margin) * options->printer_resolution[0] / 2540;
+    layout->iheight = (int)options->header.cupsHeight - (options->media.bottom_margin + options->media.top_margin) * options->printer_resolution[1] / 2540;
+  }
+
+  papplLogJob(job, PAPPL_LOGLEVEL_DEBUG, "ileft=%d, itop=%d, iwidth=%d, iheight=%d", layout->ileft, layout->itop, layout->iwidth, layout->iheight);
+
+  if (layout->iwidth <= 0 || layout->iheight <= 0 || width <= 0 || height <= 0)
+  {
+    papplLogJob(job, PAPPL_LOGLEVEL_ERROR, "Invalid media size");
+    return (false);
+  }
+
+  // Figure out the rotation of the image...
+  if ((layout->orientation = options->orientation_requested) == IPP_ORIENT_NONE)
+  {
+    if (width > height && options->header.cupsWidth < options->header.cupsHeight)
+      layout->orientation = IPP_ORIENT_LANDSCAPE;
+    else
+      layout->orientation = IPP_ORIENT_PORTRAIT;
+  }
+
+  if (layout->orientation == IPP_ORIENT_LANDSCAPE || layout->orientation == IPP_ORIENT_REVERSE_LANDSCAPE)
+  {
+    layout->img_width  = height;
+    layout->img_height = width;
+  }
+  else
+  {
+    layout->img_width  = width;
+    layout->img_height = height;
+  }
+
+  // Then the scaling...
+  if ((layout->scaling = options->print_scaling) == PAPPL_SCALING_AUTO || layout->scaling == PAPPL_SCALING_AUTO_FIT)
+  {
+    if (*ppi <= 0)
+    {
+      // No resolution information, so just force scaling the image to fit/fill
+      layout->xsize = layout->iwidth + 1;
+      layout->ysize = layout->iheight + 1;
+    }
+    else
+    {
+      layout->xsize = layout->img_width * options->printer_resolution[0] / *ppi;
+      layout->ysize = layout->img_height * options->printer_resolution[1] / *ppi;
+    }
+
+    if (layout->xsize > layout->iwidth || layout->ysize > layout->iheight)
+    {
+      // Scale to fit/fill based on "print-scaling" and margins...
+      if (layout->scaling == PAPPL_SCALING_AUTO && options->media.bottom_margin == 0 && options->media.left_margin == 0 && options->media.right_margin == 0 && options->media.top_margin == 0)
+        layout->scaling = PAPPL_SCALING_FILL;
+      else
+        layout->scaling = PAPPL_SCALING_FIT;
+    }
+    else
+    {
+      // Do no scaling...
+      layout->scaling = PAPPL_SCALING_NONE;
+    }
+  }
+  else if (layout->scaling == PAPPL_SCALING_NONE && *ppi <= 0)
+  {
+    // Force a default PPI value of 200, which fits a typical 1080p sized
+    // screenshot on a standard letter/A4 page.
+    *ppi = 200;
+  }
+
+  // And finally the size...
+  if (layout->scaling == PAPPL_SCALING_NONE)
+  {
+    // No scaling
+    layout->xsize = layout->img_width * options->printer_resolution[0] / *ppi;
+    layout->ysize = layout->img_height * options->printer_resolution[1] / *ppi;
+  }
+  else
+  {
+    // Fit/fill
+    layout->xsize = layout->iwidth;
+    layout->ysize = layout->xsize * layout->img_height / layout->img_width;
+
+    if ((layout->ysize > layout->iheight && layout->scaling == PAPPL_SCALING_FIT) || (layout->ysize < layout->iheight && layout->scaling == PAPPL_SCALING_FILL))
+    {
+      layout->ysize = layout->iheight;
+      layout->xsize = layout->ysize * layout->img_width / layout->img_height;
+    }
+  }
+
+  if (layout->xsize < 1)
+    layout->xsize = 1;
+  if (layout->ysize < 1)
+    layout->ysize = 1;
+
+  return (true);
+}
+
+
+//
+// 'irender_band()' - Render a band of image lines.
+//
+
+static bool				// O - `true` on success, `false` on error
+irender_band(_pappl_irender_t *ir,	// I - Image renderer
+             _pappl_irctx_t   *ctx,	// I - Image rendering state
+             _pappl_iband_t   *band)	// I - Band
+{
+  int	i;				// Looping var
+
+
+  ctx->row  = band->row;
+  ctx->yerr = band->yerr;
+
+  for (i = 0; i < band->count; i ++)
+  {
+    if (!irender_line(ir, ctx, band->y + i, band->lines + (size_t)i * ir->linesize))
+      return (false);
+  }
+
+  return (true);
+}
+
+
+//
+// 'irender_bands()' - Render the image lines of a page in parallel.
+//
+// The image is split into bands of lines that are rendered by the job thread
+// and by render tasks on the system's render workers.  Each thread has its
+// own scaler and buffers, and the dither thresholds only depend on the line
+// number, so the bands are independent.  The job thread writes the finished
+// bands in order and renders bands itself while it waits.  The number of
+// bands in flight is limited so that the render workers cannot get too far
+// ahead of the device.
+//
+
+static bool				// O - `true` on success, `false` on error
+irender_bands(
+    _pappl_irender_t *ir,		// I - Image renderer
+    _pappl_irctx_t   *ctx,		// I - Image rendering state for the job thread
+    _pappl_rpipe_t   *rpipe,		// I - Raster line pipeline
+    _pappl_rcache_t  *cache,		// I - Page raster cache or `NULL`
+    int              num_workers,	// I - Number of threads rendering the page
+    int              *y)		// IO - Current line
+{
+  bool			ret = false;	// Return value
+  pappl_job_t		*job = ir->job;	// Job
+  int			i,		// Looping var
+			num_tasks;	// Number of render tasks
+  _pappl_iband_t	*band;		// Current band
+  unsigned char		*line;		// Output line
+
+
+  // Allocate the band buffers - the lines start out white and only the image
+  // columns are replaced...
+  ir->num_bands  = (ir->yend - ir->ybegin + _PAPPL_IBAND_LINES - 1) / _PAPPL_IBAND_LINES;
+  ir->num_slots  = 2 * num_workers;
+  ir->first_band = 0;
+  ir->next_band  = 0;
+  ir->next_row   = ir->row;
+  ir->next_yerr  = ir->yerr;
+  ir->num_tasks  = 0;
+  ir->stop       = false;
+  ir->error      = false;
+
+  if (ir->num_slots > _PAPPL_IBAND_MAX)
+    ir->num_slots = _PAPPL_IBAND_MAX;
+  if (ir->num_slots > ir->num_bands)
+    ir->num_slots = ir->num_bands;
+
+  for (i = 0; i < ir->num_slots; i ++)
+  {
+    if ((ir->bands[i].lines = papplJobGetBuffer(job, _PAPPL_IBAND_LINES * ir->linesize)) == NULL)
+      goto done;
+
+    memset(ir->bands[i].lines, ir->white, _PAPPL_IBAND_LINES * ir->linesize);
+  }
+
+  // Queue the render tasks...
+  if ((num_tasks = num_workers - 1) > (ir->num_bands - 1))
+    num_tasks = ir->num_bands - 1;
+
+  pthread_mutex_lock(&ir->mutex);
+
+  for (i = 0; i < num_tasks; i ++)
+  {
+    if (!_papplSystemAddRenderTask(job->system, (_pappl_rtask_cb_t)irender_task, ir))
+      break;
+
+    ir->num_tasks ++;
+  }
+
+  papplLogJob(job, PAPPL_LOGLEVEL_DEBUG, "Rendering %d bands of %d lines with %d render tasks.", ir->num_bands, _PAPPL_IBAND_LINES, ir->num_tasks);
+
+  // Write the bands in order, rendering bands while waiting for them...
+  while (ir->first_band < ir->num_bands && !ir->error)
+  {
+    band = ir->bands + ir->first_band % ir->num_slots;
+
+    if (job->is_canceled)
+    {
+      break;
+    }
+    else if (ir->first_band < ir->next_band && band->done)
+    {
+      // Write the next band...
+      bool ok = true;			// Did the band write?
+
+      pthread_mutex_unlock(&ir->mutex);
+
+      for (i = 0; i < band->count; i ++, (*y) ++)
+      {
+	line = _papplRasterPipeGetLine(rpipe);
+	memcpy(line, band->lines + (size_t)i * ir->linesize, ir->linesize);
+	rcache_add_line(cache, line);
+
+	if (!_papplRasterPipeWriteLine(rpipe, (unsigned)*y))
+	{
+	  papplLogJob(job, PAPPL_LOGLEVEL_ERROR, "Unable to write raster line %u.", *y);
+	  ok = false;
+	  break;
+	}
+      }
+
+      pthread_mutex_lock(&ir->mutex);
+
+      if (!ok)
+        ir->error = true;
+
+      ir->first_band ++;
+      pthread_cond_broadcast(&ir->cond);
+    }
+    else if ((band = irender_claim(ir)) != NULL)
+    {
+      // Render another band...
+      bool ok;				// Did the band render?
+
+      pthread_mutex_unlock(&ir->mutex);
+      ok = irender_band(ir, ctx, band);
+      pthread_mutex_lock(&ir->mutex);
+
+      band->done = true;
+      if (!ok)
+        ir->error = true;
+
+      pthread_cond_broadcast(&ir->cond);
+    }
+    else
+    {
+      // Wait for a render task to finish a band...
+      pthread_cond_wait(&ir->cond, &ir->mutex);
+    }
+  }
+
+  ret = !ir->error;
+
+  // Stop the render tasks, removing any that have not started...
+  ir->stop = true;
+  pthread_cond_broadcast(&ir->cond);
+  pthread_mutex_unlock(&ir->mutex);
+
+  num_tasks = (int)_papplSystemRemoveRenderTasks(job->system, ir);
+
+  pthread_mutex_lock(&ir->mutex);
+  ir->num_tasks -= num_tasks;
+  while (ir->num_tasks > 0)
+    pthread_cond_wait(&ir->cond, &ir->mutex);
+  pthread_mutex_unlock(&ir->mutex);
+
+  done:
+
+  for (i = 0; i < ir->num_slots; i ++)
+  {
+    papplJobReleaseBuffer(job, ir->bands[i].lines);
+    ir->bands[i].lines = NULL;
+  }
+
+  return (ret);
+}
+
+
+//
+// 'irender_claim()' - Claim the next band to render.
+//
+// The renderer's mutex must be held.  `NULL` is returned when all of the
+// bands have been claimed or when all of the band buffers are in use.
+//
+
+static _pappl_iband_t *			// O - Band or `NULL` if none
+irender_claim(_pappl_irender_t *ir)	// I - Image renderer
+{
+  int			i;		// Looping var
+  _pappl_iband_t	*band;		// Band
+
+
+  if (ir->stop || ir->job->is_canceled || ir->next_band >= ir->num_bands || ir->next_band >= (ir->first_band + ir->num_slots))
+    return (NULL);
+
+  band        = ir->bands + ir->next_band % ir->num_slots;
+  band->y     = ir->ybegin + ir->next_band * _PAPPL_IBAND_LINES;
+  band->count = ir->yend - band->y;
+  band->row   = ir->next_row;
+  band->yerr  = ir->next_yerr;
+  band->done  = false;
+
+  if (band->count > _PAPPL_IBAND_LINES)
+    band->count = _PAPPL_IBAND_LINES;
+
+  // Advance to the first image line of the next band...
+  for (i = 0; i < band->count; i ++)
+  {
+    ir->next_row  += ir->ystep;
+    ir->next_yerr += ir->ymod;
+    if (ir->next_yerr >= ir->ysize)
+    {
+      ir->next_row ++;
+      ir->next_yerr -= ir->ysize;
+    }
+  }
+
+  ir->next_band ++;
+
+  return (band);
+}
+
+
+//
+// 'irender_finish()' - Free the image rendering state for a thread.
+//
+
+static void
+irender_finish(_pappl_irender_t *ir,	// I - Image renderer
+               _pappl_irctx_t   *ctx)	// I - Image rendering state
+{
+  _papplScalerDelete(ctx->scaler);
+  papplJobReleaseBuffer(ir->job, ctx->irows.band);
+  papplJobReleaseBuffer(ir->job, ctx->gray);
+
+  memset(ctx, 0, sizeof(_pappl_irctx_t));
+}
+
+
+//
+// 'irender_line()' - Render the image columns of a line.
+//
+// Only the image columns of the output line are replaced.  The current image
+// line in the rendering state is advanced for nearest-neighbor sampling.
+//
+
+static bool				// O - `true` on success, `false` on error
+irender_line(_pappl_irender_t *ir,	// I - Image renderer
+             _pappl_irctx_t   *ctx,	// I - Image rendering state
+             int              y,	// I - Line number
+             unsigned char    *line)	// I - Output line
+{
+  pappl_pr_options_t	*options = ir->options;
+					// Print options
+  int			x,		// X position
+			xend = ir->xend,// X end position
+			xerr,		// X error accumulator
+			xmod = ir->xmod,// X modulus
+			xsize = ir->xsize,
+					// Scaled width
+			xstep = ir->xstep,
+					// X step
+			xdir = ir->xdir;// X direction
+  unsigned char		*lineptr,	// Pointer in line
+			*grayptr;	// Pointer in grayscale line
+  const unsigned char	*pixline,	// Pointer to start of current line
+			*pixptr;	// Pointer into image
+
+
+  if (ctx->scaler)
+  {
+    // Resample the visible columns of the line...
+    if (options->header.cupsBitsPerPixel == 1)
+    {
+      // Need to dither the image to 1-bit black...
+      if (!_papplScalerGetLine(ctx->scaler, y - ir->ystart, ctx->gray))
+        return (false);
+
+      _papplJobDitherLine(options, (unsigned)y, ctx->gray, false, line, (unsigned)ir->xleft, (unsigned)xend);
+    }
+    else if (options->header.cupsColorSpace == CUPS_CSPACE_K)
+    {
+      // Need to invert the image...
+      if (!_papplScalerGetLine(ctx->scaler, y - ir->ystart, ctx->gray))
+        return (false);
+
+      for (x = ir->xleft, lineptr = line + x, grayptr = ctx->gray; x < xend; x ++)
+        *lineptr++ = ~*grayptr++;
+    }
+    else if (!_papplScalerGetLine(ctx->scaler, y - ir->ystart, line + ir->xleft * (int)options->header.cupsBitsPerPixel / 8))
+    {
+      return (false);
+    }
+
+    return (true);
+  }
+
+  if (ir->src->pixels)
+  {
+    pixline = ir->pixbase + ctx->row * ir->ydir;
+  }
+  else
+  {
+    // Read the current line of a streamed image...
+    if ((pixline = isrc_get_row(ir->job, ir->src, ctx->row)) == NULL)
+      return (false);
+  }
+
+  pixptr = pixline;
+
+  if (ir->xstart < 0)
+  {
+    pixptr -= (ir->xstart * xmod / xsize) * xdir;
+    x    = 0;
+    xerr = -xmod / 2 - (ir->xstart * xmod) % xsize;
+  }
+  else
+  {
+    x    = ir->xstart;
+    xerr = -xmod / 2;
+  }
+
+  if (options->header.cupsBitsPerPixel == 1)
+  {
+    // Need to dither the image to 1-bit black - scale the line first and
+    // then dither all of the pixels at once...
+    int dstart = x;			// First dithered column
+
+    for (grayptr = ctx->gray; x < xend; x ++)
+    {
+      // Copy the current pixel...
+      *grayptr++ = *pixptr;
+
+      // Advance to the next pixel...
+      pixptr += xstep;
+      xerr += xmod;
+      if (xerr >= xsize)
+      {
+	// Accumulated error has overflowed, advance another pixel...
+	xerr -= xsize;
+	pixptr += xdir;
+      }
+    }
+
+    if (dstart < xend)
+      _papplJobDitherLine(options, (unsigned)y, ctx->gray, false, line, (unsigned)dstart, (unsigned)xend);
+  }
+  else if (options->header.cupsColorSpace == CUPS_CSPACE_K)
+  {
+    // Need to invert the image...
+    for (lineptr = line + x; x < xend; x ++)
+    {
+      // Copy an inverted grayscale pixel...
+      *lineptr++ = ~*pixptr;
+
+      // Advance to the next pixel...
+      pixptr += xstep;
+      xerr += xmod;
+      if (xerr >= xsize)
+      {
+	// Accumulated error has overflowed, advance another pixel...
+	xerr -= xsize;
+	pixptr += xdir;
+      }
+    }
+  }
+  else
+  {
+    // Need to copy the image...
+    int bpp = (int)options->header.cupsBitsPerPixel / 8;
+
+    for (lineptr = line + x * bpp; x < xend; x ++)
+    {
+      // Copy a grayscale or RGB pixel...
+      memcpy(lineptr, pixptr, (unsigned)bpp);
+      lineptr += bpp;
+
+      // Advance to the next pixel...
+      pixptr += xstep;
+      xerr += xmod;
+      if (xerr >= xsize)
+      {
+	// Accumulated error has overflowed, advance another pixel...
+	xerr -= xsize;
+	pixptr += xdir;
+      }
+    }
+  }
+
+  // Advance to the next image line...
+  ctx->row  += ir->ystep;
+  ctx->yerr += ir->ymod;
+  if (ctx->yerr >= ir->ysize)
+  {
+    ctx->row ++;
+    ctx->yerr -= ir->ysize;
+  }
+
+  return (true);
+}
+
+
+//
+// 'irender_start()' - Create the image rendering state for a thread.
+//
+
+static bool				// O - `true` on success, `false` on error
+irender_start(_pappl_irender_t *ir,	// I - Image renderer
+              _pappl_irctx_t   *ctx)	// I - Image rendering state
+{
+  pappl_pr_options_t	*options = ir->options;
+					// Print options
+
+
+  memset(ctx, 0, sizeof(_pappl_irctx_t));
+
+  if (ir->smoothing)
+  {
+    // Each thread scales its own lines...
+    ctx->irows.job     = ir->job;
+    ctx->irows.src     = ir->src;
+    ctx->irows.pixbase = ir->pixbase;
+    ctx->irows.xdir    = ir->xdir;
+    ctx->irows.ydir    = ir->ydir;
+    ctx->irows.width   = ir->img_width;
+    ctx->irows.height  = ir->img_height;
+    ctx->irows.depth   = ir->src->depth;
+
+    if ((ctx->scaler = _papplScalerCreate(ir->img_width, ir->img_height, ir->src->depth, ir->xsize, ir->ysize, ir->xleft - ir->xstart, ir->xend - ir->xstart, ir->filter, (_pappl_scaler_cb_t)irows_get_row, &ctx->irows)) == NULL)
+    {
+      papplLogJob(ir->job, PAPPL_LOGLEVEL_ERROR, "Unable to allocate memory for image scaler.");
+      return (false);
+    }
+  }
+
+  if ((options->header.cupsBitsPerPixel == 1 || (ctx->scaler && options->header.cupsColorSpace == CUPS_CSPACE_K)) && (ctx->gray = papplJobGetBuffer(ir->job, options->header.cupsWidth)) == NULL)
+    return (false);
+
+  return (true);
+}
+
+
+//
+// 'irender_task()' - Render bands of image lines on a render worker.
+//
+
+static void
+irender_task(_pappl_irender_t *ir)	// I - Image renderer
+{
+  _pappl_irctx_t	ctx;		// Image rendering state
+  _pappl_iband_t	*band;		// Current band
+  bool			ok;		// Did the band render?
+
+
+  ok = irender_start(ir, &ctx);
+
+  pthread_mutex_lock(&ir->mutex);
+
+  while (ok)
+  {
+    if ((band = irender_claim(ir)) == NULL)
+    {
+      if (ir->stop || ir->job->is_canceled || ir->next_band >= ir->num_bands)
+        break;
+
+      // Wait for the job thread to write the oldest band...
+      pthread_cond_wait(&ir->cond, &ir->mutex);
+      continue;
+    }
+
+    pthread_mutex_unlock(&ir->mutex);
+    ok = irender_band(ir, &ctx, band);
+    pthread_mutex_lock(&ir->mutex);
+
+    band->done = true;
+    if (!ok)
+      ir->error = true;
+
+    pthread_cond_broadcast(&ir->cond);
+  }
+
+  pthread_mutex_unlock(&ir->mutex);
+
+  // Free the rendering state before telling the job thread that we are done,
+  // since the renderer goes away once all of its tasks have finished...
+  irender_finish(ir, &ctx);
+
+  pthread_mutex_lock(&ir->mutex);
+  ir->num_tasks --;
+  pthread_cond_broadcast(&ir->cond);
+  pthread_mutex_unlock(&ir->mutex);
+}
+
+
+//
+// 'irows_get_row()' - Get a line of a rotated image.
+//
+// Lines of rotated images are columns of the original image, so they are
+// transposed a band of lines at a time using small tiles that stay in the
+// CPU cache.  Lines must be requested in increasing order.
+//
+
+static const unsigned char *		// O - Line or `NULL` on error
+irows_get_row(_pappl_irows_t *irows,	// I - Rotated image lines
+              int            row)	// I - Line number
+{
+  int			b,		// Current line in band
+			x,		// Current column
+			xtile,		// First column in tile
+			xtend,		// Last column in tile + 1
+			depth = irows->depth;
+					// Bytes per pixel
+  size_t		stride = (size_t)(irows->width * depth);
+					// Bytes per line
+  const unsigned char	*pixptr;	// Pointer into image
+  unsigned char		*bandptr;	// Pointer into band
+
+
+  if (!irows->src->pixels)
+  {
+    // Streamed image, read the line...
+    return (isrc_get_row(irows->job, irows->src, row));
+  }
+  else if (irows->xdir == depth)
+  {
+    // Not rotated, use the image line...
+    return (irows->pixbase + row * irows->ydir);
+  }
+  else if (row >= irows->band_row && row < (irows->band_row + irows->band_count))
+  {
+    // Already have this line...
+    return (irows->band + (size_t)(row - irows->band_row) * stride);
+  }
+
+  if (!irows->band && (irows->band = papplJobGetBuffer(irows->job, _PAPPL_IROWS_LINES * stride)) == NULL)
+  {
+    papplLogJob(irows->job, PAPPL_LOGLEVEL_ERROR, "Unable to allocate memory for rotated image.");
+    return (NULL);
+  }
+
+  // Transpose the next band of lines...
+  irows->band_row   = row;
+  irows->band_count = irows->height - row;
+  if (irows->band_count > _PAPPL_IROWS_LINES)
+    irows->band_count = _PAPPL_IROWS_LINES;
+
+  for (xtile = 0; xtile < irows->width; xtile = xtend)
+  {
+    if ((xtend = xtile + _PAPPL_IROWS_TILE) > irows->width)
+      xtend = irows->width;
+
+    for (b = 0; b < irows->band_count; b ++)
+    {
+      pixptr  = irows->pixbase + xtile * irows->xdir + (row + b) * irows->ydir;
+      bandptr = irows->band + (size_t)b * stride + (size_t)(xtile * depth);
+
+      if (depth == 1)
+      {
+        for (x = xtile; x < xtend; x ++, pixptr += irows->xdir)
+          *bandptr++ = *pixptr;
+      }
+      else
+      {
+        for (x = xtile; x < xtend; x ++, pixptr += irows->xdir, bandptr += 3)
+        {
+          bandptr[0] = pixptr[0];
+          bandptr[1] = pixptr[1];
+          bandptr[2] = pixptr[2];
+        }
+      }
+    }
+  }
+
+  return (irows->band);
+}
+
+
+//
+// 'isrc_get_row()' - Get a line from a streamed image.
+//
+// Lines must be requested in increasing order.
+//
+
+static const unsigned char *		// O - Line or `NULL` on error
+isrc_get_row(pappl_job_t   *job,	// I - Job
+             _pappl_isrc_t *src,	// I - Image source
+             int           row)		// I - Line number
+{
+  if (!src->buffer)
+  {
+    // Allocate a window for one line...
+    if ((src->buffer = papplJobGetBuffer(job, (size_t)(src->width * src->depth))) == NULL)
+      return (NULL);
+
+    src->row   = 0;
+    src->count = 0;
+    src->next  = 0;
+  }
+
+  if (row >= src->height || row < src->row)
+  {
+    papplLogJob(job, PAPPL_LOGLEVEL_ERROR, "Unable to read image line %d.", row);
+    return (NULL);
+  }
+
+  if (src->count > 0 && row == src->row)
+  {
+    // Already have this line...
+    return (src->buffer);
+  }
+
+  // Skip lines as needed and read the requested line...
+  while (src->next <= row)
+  {
+    if (!(src->read_cb)(src->read_data, src->buffer))
+      return (NULL);
+
+    src->next ++;
+  }
+
+  src->row   = row;
+  src->count = 1;
+
+  return (src->buffer);
+}
+
+
+//
+// 'isrc_load()' - Load all of the lines of a streamed image.
+//
+
+static bool				// O - `true` on success, `false` on error
+isrc_load(pappl_job_t   *job,		// I - Job
+          _pappl_isrc_t *src)		// I - Image source
+{
+  int		row;			// Current line
+  size_t	stride = (size_t)(src->width * src->depth);
+					// Bytes per line
+
+
+  papplLogJob(job, PAPPL_LOGLEVEL_DEBUG, "Loading %dx%dx%d image.", src->width, src->height, src->depth);
+
+  if ((src->buffer = papplJobGetBuffer(job, stride * (size_t)src->height)) == NULL)
+  {
+    papplLogJob(job, PAPPL_LOGLEVEL_ERROR, "Unable to allocate memory for %dx%dx%d image.", src->width, src->height, src->depth);
+    papplJobSetReasons(job, PAPPL_JREASON_ERRORS_DETECTED, PAPPL_JREASON_NONE);
+    return (false);
+  }
+
+  for (row = 0; row < src->height; row ++)
+  {
+    if (!(src->read_cb)(src->read_data, src->buffer + (size_t)row * stride))
+      return (false);
+  }
+
+  src->pixels = src->buffer;
+  src->next   = src->height;
+
+  return (true);
+}
+
+
+//
+// 'isrc_reload()' - Read a streamed image again and load all of its lines.
+//
+// The document file is complete once a streamed image has been printed, so
+// the image can be decoded again from the start of the file when the lines
+// need to be in memory, for example to render additional copies.
+//
+
+static bool				// O - `true` on success, `false` on error
+isrc_reload(pappl_job_t   *job,		// I - Job
+            _pappl_isrc_t *src)		// I - Image source
+{
+  if (!src->rewind_cb)
+    return (false);
+
+  // Free the line window and rewind the decoder...
+  papplJobReleaseBuffer(job, src->buffer);
+
+  src->buffer = NULL;
+  src->row    = 0;
+  src->count  = 0;
+  src->next   = 0;
+
+  if (!(src->rewind_cb)(src->read_data))
+    return (false);
+
+  return (isrc_load(job, src));
+}
+
+
+#ifdef HAVE_LIBJPEG
+//
+// 'jpeg_error_handler()' - Handle JPEG errors by not exiting.
+//
+
+static void
+jpeg_error_handler(j_common_ptr p)	// I - JPEG data
+{
+  _pappl_jpeg_err_t	*jerr = (_pappl_jpeg_err_t *)p->err;
+					// JPEG error handler
+
+
+  // Save the error message in the string buffer...
+  (jerr->jerr.format_message)(p, jerr->message);
+
+  // Return to the point we called setjmp()...
+  longjmp(jerr->retbuf, 1);
+}
+
+
+//
+// 'jpeg_fill_input()' - Read more JPEG data from the document file.
+//
+
+static boolean				// O - `TRUE` on success
+jpeg_fill_input(j_decompress_ptr dinfo)	// I - JPEG data
+{
+  _pappl_jpeg_src_t	*jsrc = (_pappl_jpeg_src_t *)dinfo->src;
+					// JPEG source manager
+  ssize_t		bytes;		// Bytes read
+
+
+  if ((bytes = papplJobReadFile(jsrc->job, jsrc->fd, jsrc->buffer, sizeof(jsrc->buffer))) < 0)
+  {
+    // Document data is incomplete...
+    ERREXIT(dinfo, JERR_FILE_READ);
+  }
+  else if (bytes == 0)
+  {
+    // Premature end-of-file, insert a fake EOI marker...
+    WARNMS(dinfo, JWRN_JPEG_EOF);
+
+    jsrc->buffer[0] = (JOCTET)0xff;
+    jsrc->buffer[1] = (JOCTET)JPEG_EOI;
+    bytes           = 2;
+  }
+
+  jsrc->src.next_input_byte = jsrc->buffer;
+  jsrc->src.bytes_in_buffer = (size_t)bytes;
+
+  return (TRUE);
+}
+
+
+//
+// 'jpeg_init_source()' - Start reading JPEG data.
+//
+
+static void
+jpeg_init_source(j_decompress_ptr dinfo)// I - JPEG data
+{
+  (void)dinfo;
+}
+
+
+//
+// 'jpeg_read_line()' - Read a line from a JPEG image.
+//
+
+static bool				// O - `true` on success, `false` on error
+jpeg_read_line(j_decompress_ptr dinfo,	// I - JPEG data
+               unsigned char    *line)	// I - Line buffer
+{
+  _pappl_jpeg_err_t	*jerr = (_pappl_jpeg_err_t *)dinfo->err;
+					// Error handler info
+  pappl_job_t		*job = ((_pappl_jpeg_src_t *)dinfo->src)->job;
+					// Job
+  JSAMPROW		row = (JSAMPROW)line;
+					// Sample row pointer
+
+
+  if (setjmp(jerr->retbuf))
+  {
+    // JPEG library errors are directed to this point...
+    papplJobSetReasons(job, PAPPL_JREASON_DOCUMENT_FORMAT_ERROR, PAPPL_JREASON_NONE);
+    papplLogJob(job, PAPPL_LOGLEVEL_ERROR, "Unable to read JPEG image: %s", jerr->message);
+    return (false);
+  }
+
+  if (jpeg_read_scanlines(dinfo, &row, 1) != 1)
+  {
+    papplJobSetReasons(job, PAPPL_JREASON_DOCUMENT_FORMAT_ERROR, PAPPL_JREASON_NONE);
+    papplLogJob(job, PAPPL_LOGLEVEL_ERROR, "Unable to read JPEG image line %u.", dinfo->output_scanline);
+    return (false);
+  }
+
+  return (true);
+}
+
+
+//
+// 'jpeg_rewind()' - Restart decompression from the start of the JPEG file.
+//
+// The output color space and DCT scaling are preserved so that the image has
+// the same dimensions as before.
+//
+
+static bool				// O - `true` on success, `false` on error
+jpeg_rewind(j_decompress_ptr dinfo)	// I - JPEG data
+{
+  _pappl_jpeg_err_t	*jerr = (_pappl_jpeg_err_t *)dinfo->err;
+					// Error handler info
+  _pappl_jpeg_src_t	*jsrc = (_pappl_jpeg_src_t *)dinfo->src;
+					// JPEG source manager
+  J_COLOR_SPACE		out_color_space = dinfo->out_color_space;
+					// Output color space
+  unsigned		scale_num = dinfo->scale_num,
+					// DCT scaling numerator
+			scale_denom = dinfo->scale_denom;
+					// DCT scaling denominator
+
+
+  if (setjmp(jerr->retbuf))
+  {
+    // JPEG library errors are directed to this point...
+    papplJobSetReasons(jsrc->job, PAPPL_JREASON_DOCUMENT_FORMAT_ERROR, PAPPL_JREASON_NONE);
+    papplLogJob(jsrc->job, PAPPL_LOGLEVEL_ERROR, "Unable to read JPEG image: %s", jerr->message);
+    return (false);
+  }
+
+  jpeg_abort_decompress(dinfo);
+
+  if (lseek(jsrc->fd, 0, SEEK_SET) < 0)
+  {
+    papplLogJob(jsrc->job, PAPPL_LOGLEVEL_ERROR, "Unable to rewind JPEG file: %s", strerror(errno));
+    return (false);
+  }
+
+  jsrc->src.next_input_byte = NULL;
+  jsrc->src.bytes_in_buffer = 0;
+
+  jpeg_read_header(dinfo, TRUE);
+
+  dinfo->quantize_colors = FALSE;
+  dinfo->out_color_space = out_color_space;
+  dinfo->scale_num       = scale_num;
+  dinfo->scale_denom     = scale_denom;
+
+  jpeg_start_decompress(dinfo);
+
+  return (true);
+}
+
+
+//
+// 'jpeg_skip_input()' - Skip JPEG data.
+//
+
+static void
+jpeg_skip_input(j_decompress_ptr dinfo,	// I - JPEG data
+                long             num_bytes)
+					// I - Number of bytes to skip
+{
+  _pappl_jpeg_src_t	*jsrc = (_pappl_jpeg_src_t *)dinfo->src;
+					// JPEG source manager
+
+
+  // Skip data as it arrives since the document file may still be growing...
+  while (num_bytes > 0)
+  {
+    if (jsrc->src.bytes_in_buffer == 0)
+      jpeg_fill_input(dinfo);
+
+    if ((size_t)num_bytes <= jsrc->src.bytes_in_buffer)
+    {
+      jsrc->src.next_input_byte += num_bytes;
+      jsrc->src.bytes_in_buffer -= (size_t)num_bytes;
+      break;
+    }
+
+    num_bytes -= (long)jsrc->src.bytes_in_buffer;
+    jsrc->src.bytes_in_buffer = 0;
+  }
+}
+
+
+//
+// 'jpeg_term_source()' - Finish reading JPEG data.
+//
+
+static void
+jpeg_term_source(j_decompress_ptr dinfo)// I - JPEG data
+{
+  (void)dinfo;
+}
+#endif // HAVE_LIBJPEG
+
+
+#ifdef HAVE_LIBPNG
+//
+// 'png_composite_line()' - Blend a transparent line with white.
+//
+// The input line contains 16-bit linear samples followed by a 16-bit alpha
+// value for each pixel.  The output line contains 8-bit sRGB samples, so it
+// may be blended in place.
+//
+
+static void
+png_composite_line(
+    const unsigned char *row,		// I - 16-bit linear line with alpha channel
+    unsigned char       *line,		// O - 8-bit sRGB line
+    int                 width,		// I - Width in columns
+    int                 depth)		// I - Samples per pixel
+{
+  int		j,			// Looping var
+		lo,			// Low index for search
+		mid,			// Middle index for search
+		hi;			// High index for search
+  unsigned	alpha,			// Alpha value
+		value;			// Linear value
+
+
+  for (; width > 0; width --, row += 2 * (depth + 1), line += depth)
+  {
+    alpha = (unsigned)((row[2 * depth] << 8) | row[2 * depth + 1]);
+
+    for (j = 0; j < depth; j ++)
+    {
+      // Blend with white...
+      value = (unsigned)((row[2 * j] << 8) | row[2 * j + 1]);
+      value = (value * alpha + 65535 * (65535 - alpha) + 32767) / 65535;
+
+      // Then find the nearest sRGB value...
+      for (lo = 0, hi = 255; lo < hi;)
+      {
+        mid = (lo + hi) / 2;
+
+        if (value >= pappl_srgb_thresholds[mid])
+          lo = mid + 1;
+        else
+          hi = mid;
+      }
+
+      line[j] = (unsigned char)lo;
+    }
+  }
+}
+
+
+//
+// 'png_error_handler()' - Handle PNG errors by not exiting.
+//
+
+static void
+png_error_handler(
+    png_structp     png,		// I - PNG decompressor
+    png_const_charp message)		// I - Error message
+{
+  _pappl_png_src_t *psrc = (_pappl_png_src_t *)png_get_error_ptr(png);
+					// PNG source info
+
+
+  papplJobSetReasons(psrc->job, PAPPL_JREASON_DOCUMENT_FORMAT_ERROR, PAPPL_JREASON_NONE);
+  papplLogJob(psrc->job, PAPPL_LOGLEVEL_ERROR, "Unable to read PNG image: %s", message);
+
+  png_longjmp(png, 1);
+}
+
+
+//
+// 'png_open_image()' - Create the PNG decompressor and read the image header.
+//
+
+static bool				// O - `true` on success, `false` on error
+png_open_image(_pappl_png_src_t *psrc)	// I - PNG source info
+{
+  if ((psrc->png = png_create_read_struct(PNG_LIBPNG_VER_STRING, psrc, png_error_handler, png_warning_handler)) == NULL || (psrc->info = png_create_info_struct(psrc->png)) == NULL)
+  {
+    papplLogJob(psrc->job, PAPPL_LOGLEVEL_ERROR, "Unable to allocate memory for PNG image.");
+    papplJobSetReasons(psrc->job, PAPPL_JREASON_ERRORS_DETECTED, PAPPL_JREASON_NONE);
+    return (false);
+  }
+
+  png_set_read_fn(psrc->png, psrc, png_read_input);
+
+  // PNG library errors are logged by png_error_handler and directed to this
+  // point...
+  if (setjmp(png_jmpbuf(psrc->png)))
+    return (false);
+
+  png_read_info(psrc->png, psrc->info);
+
+  return (true);
+}
+
+
+//
+// 'png_read_input()' - Read PNG data from the document file.
+//
+
+static void
+png_read_input(png_structp png,		// I - PNG decompressor
+               png_bytep   data,	// I - Buffer
+               size_t      length)	// I - Number of bytes to read
+{
+  _pappl_png_src_t *psrc = (_pappl_png_src_t *)png_get_io_ptr(png);
+					// PNG source info
+  ssize_t	bytes;			// Bytes read
+
+
+  while (length > 0)
+  {
+    if ((bytes = papplJobReadFile(psrc->job, psrc->fd, data, length)) <= 0)
+      png_error(png, "Unexpected end of PNG data.");
+
+    data   += bytes;
+    length -= (size_t)bytes;
+  }
+}
+
+
+//
+// 'png_read_line()' - Read a line from a non-interlaced PNG image.
+//
+
+static bool				// O - `true` on success, `false` on error
+png_read_line(_pappl_png_src_t *psrc,	// I - PNG source info
+              unsigned char    *line)	// I - Line buffer
+{
+  // PNG library errors are logged by png_error_handler and directed to this
+  // point...
+  if (setjmp(png_jmpbuf(psrc->png)))
+    return (false);
+
+  if (psrc->alpha)
+  {
+    png_read_row(psrc->png, psrc->row, NULL);
+    png_composite_line(psrc->row, line, psrc->width, psrc->depth);
+  }
+  else
+  {
+    png_read_row(psrc->png, line, NULL);
+  }
+
+  return (true);
+}
+
+
+//
+// 'png_rewind()' - Restart decompression from the start of the PNG file.
+//
+// libpng cannot rewind a decompressor, so a new one is created with the same
+// output format.
+//
+
+static bool				// O - `true` on success, `false` on error
+png_rewind(_pappl_png_src_t *psrc)	// I - PNG source info
+{
+  png_destroy_read_struct(&psrc->png, &psrc->info, NULL);
+
+  if (lseek(psrc->fd, 0, SEEK_SET) < 0)
+  {
+    papplLogJob(psrc->job, PAPPL_LOGLEVEL_ERROR, "Unable to rewind PNG file: %s", strerror(errno));
+    return (false);
+  }
+
+  return (png_open_image(psrc) && png_set_format(psrc, psrc->depth) > 0);
+}
+
+
+//
+// 'png_set_format()' - Set the output format of the PNG decompressor.
+//
+// Lines are decoded as 8-bit grayscale ("depth" = `1`) or sRGB ("depth" =
+// `3`).  Transparent images are blended with white in linear space, so they
+// are requested as 16-bit linear lines with an alpha channel.  Images without
+// gamma information use the same defaults as the libpng simplified API -
+// linear for 16-bit images and sRGB otherwise.
+//
+
+static int				// O - Number of interlace passes or `0` on error
+png_set_format(_pappl_png_src_t *psrc,	// I - PNG source info
+               int              depth)	// I - Bytes per output pixel
+{
+  int			bit_depth = png_get_bit_depth(psrc->png, psrc->info),
+					// Bits per sample
+			color_type = png_get_color_type(psrc->png, psrc->info);
+					// Color type
+  png_fixed_point	file_gamma;	// Gamma of image
+  int			passes;		// Number of interlace passes
+
+
+  // PNG library errors are logged by png_error_handler and directed to this
+  // point...
+  if (setjmp(png_jmpbuf(psrc->png)))
+    return (0);
+
+  if (!png_get_gAMA_fixed(psrc->png, psrc->info, &file_gamma))
+    file_gamma = bit_depth == 16 ? PNG_GAMMA_LINEAR : PNG_DEFAULT_sRGB;
+
+  psrc->alpha = (color_type & PNG_COLOR_MASK_ALPHA) || png_get_valid(psrc->png, psrc->info, PNG_INFO_tRNS);
+
+  png_set_expand(psrc->png);
+
+  if (psrc->alpha)
+  {
+    png_set_expand_16(psrc->png);
+    png_set_gamma_fixed(psrc->png, PNG_GAMMA_LINEAR, file_gamma);
+  }
+  else
+  {
+    png_set_gamma_fixed(psrc->png, PNG_DEFAULT_sRGB, file_gamma);
+    png_set_strip_16(psrc->png);
+  }
+
+  if (depth > 1)
+  {
+    psrc->depth = 3;
+
+    if (!(color_type & PNG_COLOR_MASK_COLOR))
+      png_set_gray_to_rgb(psrc->png);
+  }
+  else
+  {
+    psrc->depth = 1;
+
+    if (color_type & PNG_COLOR_MASK_COLOR)
+      png_set_rgb_to_gray_fixed(psrc->png, PNG_ERROR_ACTION_NONE, -1, -1);
+  }
+
+  passes = png_set_interlace_handling(psrc->png);
+
+  png_read_update_info(psrc->png, psrc->info);
+
+  psrc->width = (int)png_get_image_width(psrc->png, psrc->info);
+
+  return (passes);
+}
+
+
+//
+// 'png_warning_handler()' - Log PNG warnings.
+//
+
+static void
+png_warning_handler(
+    png_structp     png,		// I - PNG decompressor
+    png_const_charp message)		// I - Warning message
+{
+  _pappl_png_src_t *psrc = (_pappl_png_src_t *)png_get_error_ptr(png);
+					// PNG source info
+
+
+  papplLogJob(psrc->job, PAPPL_LOGLEVEL_DEBUG, "PNG warning: %s", message);
+}
+#endif // HAVE_LIBPNG
+
+
+//
+// 'rcache_add_line()' - Add a line to a page raster cache.
+//
+// Lines are compressed using PackBits and stored in memory until the cache
+// reaches `_PAPPL_RCACHE_MAX` bytes, after which they are written to a spool
+// file.  Errors are recorded in the cache so the caller can fall back to
+// rendering each copy.
+//
+
+static void
+rcache_add_line(
+    _pappl_rcache_t     *cache,		// I - Page raster cache
+    const unsigned char *line)		// I - Line
+{
+  const unsigned char	*lineptr,	// Pointer into line
+			*lineend,	// End of line
+			*start;		// Start of literal bytes
+  unsigned char		*packptr;	// Pointer into compressed line
+  size_t		count,		// Number of bytes
+			bytes;		// Bytes in compressed line
+
+
+  if (!cache || cache->error || cache->reading)
+    return;
+
+  // Compress the line using PackBits after a 4-byte length...
+  for (lineptr = line, lineend = line + cache->linesize, packptr = cache->packed + 4; lineptr < lineend;)
+  {
+    if ((lineptr + 2) < lineend && lineptr[0] == lineptr[1] && lineptr[0] == lineptr[2])
+    {
+      // 3 or more repeated bytes...
+      for (count = 3; count < 128 && (lineptr + count) < lineend && lineptr[count] == lineptr[0]; count ++);
+
+      *packptr++ = (unsigned char)(257 - count);
+      *packptr++ = *lineptr;
+      lineptr    += count;
+    }
+    else
+    {
+      // Literal bytes up to the next 3 repeated bytes...
+      for (start = lineptr ++, count = 1; count < 128 && lineptr < lineend && ((lineptr + 2) >= lineend || lineptr[0] != lineptr[1] || lineptr[0] != lineptr[2]); count ++, lineptr ++);
+
+      *packptr++ = (unsigned char)(count - 1);
+      memcpy(packptr, start, count);
+      packptr += count;
+    }
+  }
+
+  bytes = (size_t)(packptr - cache->packed);
+
+  cache->packed[0] = (unsigned char)(bytes >> 24);
+  cache->packed[1] = (unsigned char)(bytes >> 16);
+  cache->packed[2] = (unsigned char)(bytes >> 8);
+  cache->packed[3] = (unsigned char)bytes;
+
+  // Write to the spool file when the in-memory cache is full...
+  if ((cache->bufused + bytes) > cache->bufsize && cache->bufsize >= _PAPPL_RCACHE_MAX && !rcache_flush(cache))
+  {
+    cache->error = true;
+    return;
+  }
+
+  // Grow the buffer as needed...
+  if ((cache->bufused + bytes) > cache->bufsize)
+  {
+    size_t		bufsize;	// New buffer size
+    unsigned char	*buffer;	// New buffer
+
+    for (bufsize = cache->bufsize * 2; bufsize < (cache->bufused + bytes); bufsize *= 2);
+
+    if ((buffer = realloc(cache->buffer, bufsize)) == NULL)
+    {
+      papplLogJob(cache->job, PAPPL_LOGLEVEL_WARN, "Unable to allocate memory for page cache: %s", strerror(errno));
+      cache->error = true;
+      return;
+    }
+
+    cache->buffer  = buffer;
+    cache->bufsize = bufsize;
+  }
+
+  memcpy(cache->buffer + cache->bufused, cache->packed, bytes);
+  cache->bufused += bytes;
+  cache->bytes   += bytes;
+}
+
+
+//
+// 'rcache_create()' - Create a page raster cache.
+//
+
+static _pappl_rcache_t *		// O - Page raster cache or `NULL` on error
+rcache_create(pappl_job_t *job,		// I - Job
+              size_t      linesize)	// I - Bytes per line
+{
+  _pappl_rcache_t	*cache;		// Page raster cache
+
+
+  if ((cache = calloc(1, sizeof(_pappl_rcache_t))) == NULL)
+    return (NULL);
+
+  cache->job      = job;
+  cache->linesize = linesize;
+  cache->bufsize  = 65536;
+  cache->fd       = -1;
+
+  // Worst case PackBits output is 1 extra byte for every 128 bytes, plus the
+  // 4-byte length...
+  if ((cache->packed = malloc(linesize + linesize / 128 + 5)) == NULL || (cache->buffer = malloc(cache->bufsize)) == NULL)
+  {
+    papplLogJob(job, PAPPL_LOGLEVEL_WARN, "Unable to allocate memory for page cache: %s", strerror(errno));
+    free(cache->packed);
+    free(cache);
+    return (NULL);
+  }
+
+  return (cache);
+}
+
+
+//
+// 'rcache_delete()' - Delete a page raster cache.
+//
+
+static void
+rcache_delete(_pappl_rcache_t *cache)	// I - Page raster cache
+{
+  if (!cache)
+    return;
+
+  if (cache->fd >= 0)
+    close(cache->fd);
+
+  if (cache->filename[0])
+    unlink(cache->filename);
+
+  papplLogJob(cache->job, PAPPL_LOGLEVEL_DEBUG, "Page cache used %lu bytes %s.", (unsigned long)cache->bytes, cache->filename[0] ? "in a spool file" : "of memory");
+
+  free(cache->buffer);
+  free(cache->packed);
+  free(cache);
+}
+
+
+//
+// 'rcache_flush()' - Write the buffered lines to the spool file.
+//
+
+static bool				// O - `true` on success, `false` on error
+rcache_flush(_pappl_rcache_t *cache)	// I - Page raster cache
+{
+  unsigned char	*bufptr;		// Pointer into buffer
+  ssize_t	bytes;			// Bytes written
+
+
+  if (cache->fd < 0)
+  {
+    if ((cache->fd = papplJobOpenFile(cache->job, cache->filename, sizeof(cache->filename), NULL, "rcache", "w")) < 0)
+    {
+      papplLogJob(cache->job, PAPPL_LOGLEVEL_WARN, "Unable to create page cache file '%s': %s", cache->filename, strerror(errno));
+      cache->filename[0] = '\0';
+      return (false);
+    }
+
+    papplLogJob(cache->job, PAPPL_LOGLEVEL_DEBUG, "Writing page cache to '%s'.", cache->filename);
+  }
+
+  for (bufptr = cache->buffer; cache->bufused > 0; bufptr += bytes, cache->bufused -= (size_t)bytes)
+  {
+    if ((bytes = write(cache->fd, bufptr, cache->bufused)) < 0)
+    {
+      if (errno == EINTR || errno == EAGAIN)
+      {
+        bytes = 0;
+        continue;
+      }
+
+      papplLogJob(cache->job, PAPPL_LOGLEVEL_WARN, "Unable to write page cache file '%s': %s", cache->filename, strerror(errno));
+      return (false);
+    }
+  }
+
+  return (true);
+}
+
+
+//
+// 'rcache_get_line()' - Get the next line from a page raster cache.
+//
+
+static bool				// O - `true` on success, `false` on error
+rcache_get_line(
+    _pappl_rcache_t *cache,		// I - Page raster cache
+    unsigned char   *line)		// I - Line buffer
+{
+  const unsigned char	*packptr,	// Pointer into compressed line
+			*packend;	// End of compressed line
+  unsigned char		*lineptr,	// Pointer into line
+			*lineend;	// End of line
+  size_t		count,		// Number of bytes
+			bytes;		// Bytes in compressed line
+
+
+  // Get the length of the compressed line...
+  if (!rcache_read(cache, 4))
+    return (false);
+
+  packptr = cache->buffer + cache->bufpos;
+  bytes   = ((size_t)packptr[0] << 24) | ((size_t)packptr[1] << 16) | ((size_t)packptr[2] << 8) | packptr[3];
+
+  if (bytes < 4 || !rcache_read(cache, bytes))
+    return (false);
+
+  // Decompress the line...
+  packptr = cache->buffer + cache->bufpos + 4;
+  packend = cache->buffer + cache->bufpos + bytes;
+  lineptr = line;
+  lineend = line + cache->linesize;
+
+  while (packptr < packend && lineptr < lineend)
+  {
+    if (*packptr < 128)
+    {
+      // Literal bytes...
+      count = (size_t)*packptr++ + 1;
+
+      if ((packptr + count) > packend || (lineptr + count) > lineend)
+        return (false);
+
+      memcpy(lineptr, packptr, count);
+      packptr += count;
+    }
+    else
+    {
+      // Repeated bytes...
+      count = 257 - (size_t)*packptr++;
+
+      if (packptr >= packend || (lineptr + count) > lineend)
+        return (false);
+
+      memset(lineptr, *packptr++, count);
+    }
+
+    lineptr += count;
+  }
+
+  cache->bufpos += bytes;
+
+  return (lineptr == lineend);
+}
+
+
+//
+// 'rcache_read()' - Make sure bytes are available in the page raster cache buffer.
+//
+
+static bool				// O - `true` if available, `false` otherwise
+rcache_read(_pappl_rcache_t *cache,	// I - Page raster cache
+            size_t          bytes)	// I - Number of bytes needed
+{
+  ssize_t	rbytes;			// Bytes read
+
+
+  if ((cache->bufpos + bytes) <= cache->bufused)
+    return (true);
+  else if (cache->fd < 0 || bytes > cache->bufsize)
+    return (false);
+
+  // Move any remaining bytes to the start of the buffer and read more...
+  if (cache->bufpos > 0)
+  {
+    memmove(cache->buffer, cache->buffer + cache->bufpos, cache->bufused - cache->bufpos);
+    cache->bufused -= cache->bufpos;
+    cache->bufpos  = 0;
+  }
+
+  while (cache->bufused < bytes)
+  {
+    if ((rbytes = read(cache->fd, cache->buffer + cache->bufused, cache->bufsize - cache->bufused)) < 0)
+    {
+      if (errno == EINTR || errno == EAGAIN)
+        continue;
+
+      papplLogJob(cache->job, PAPPL_LOGLEVEL_ERROR, "Unable to read page cache file '%s': %s", cache->filename, strerror(errno));
+      return (false);
+    }
+    else if (rbytes == 0)
+      return (false);
+
+    cache->bufused += (size_t)rbytes;
+  }
+
+  return (true);
+}
 
-  if (options->header.cupsColorSpace == CUPS_CSPACE_K || options->header.cupsColorSpace == CUPS_CSPACE_CMYK)
-    white = 0x00;
-  else
-    white = 0xff;
 
-  pixend = pixels + width * height * depth;
+//
+// 'rcache_rewind()' - Start replaying the lines in a page raster cache.
+//
 
-  // Print every copy...
-  for (i = 0; i < options->copies; i ++)
+static bool				// O - `true` on success, `false` on error
+rcache_rewind(_pappl_rcache_t *cache)	// I - Page raster cache
+{
+  if (cache->fd >= 0)
   {
-    if (!(driver_data.rstartpage_cb)(job, options, device, 1))
+    if (!cache->reading)
     {
-      papplLogJob(job, PAPPL_LOGLEVEL_ERROR, "Unable to start raster page.");
-      goto abort_job;
-    }
+      // Write the remaining lines and reopen the spool file for reading...
+      if (!rcache_flush(cache))
+        return (false);
 
-    // Leading blank space...
-    memset(line, white, options->header.cupsBytesPerLine);
-    for (y = 0; y < ystart; y ++)
-    {
-      if (!(driver_data.rwriteline_cb)(job, options, device, (unsigned)y, line))
+      close(cache->fd);
+
+      if ((cache->fd = papplJobOpenFile(cache->job, cache->filename, sizeof(cache->filename), NULL, "rcache", "r")) < 0)
       {
-	papplLogJob(job, PAPPL_LOGLEVEL_ERROR, "Unable to write raster line %u.", y);
-	goto abort_job;
+        papplLogJob(cache->job, PAPPL_LOGLEVEL_ERROR, "Unable to open page cache file '%s': %s", cache->filename, strerror(errno));
+        return (false);
       }
     }
-
-    if (ystart < 0)
-    {
-      pixline = pixbase - (ystart * ymod / ysize) * ydir;
-      yerr    = -ymod / 2 - (ystart * ymod) % ysize;
-    }
-    else
+    else if (lseek(cache->fd, 0, SEEK_SET) < 0)
     {
-      pixline = pixbase;
-      yerr    = -ymod / 2;
+      papplLogJob(cache->job, PAPPL_LOGLEVEL_ERROR, "Unable to rewind page cache file '%s': %s", cache->filename, strerror(errno));
+      return (false);
     }
 
-    // Now RIP the image...
-    for (; y < yend && !job->is_canceled; y ++)
-    {
-      pixptr = pixline;
+    cache->bufused = 0;
+  }
 
-      if (xstart < 0)
-      {
-	pixptr -= (xstart * xmod / xsize) * xdir;
-	x    = 0;
-	xerr = -xmod / 2 - (xstart * xmod) % xsize;
-      }
-      else
-      {
-	x    = xstart;
-	xerr = -xmod / 2;
-      }
+  cache->reading = true;
+  cache->bufpos  = 0;
 
-      if (options->header.cupsBitsPerPixel == 1)
-      {
-        // Need to dither the image to 1-bit black...
-	dither = options->dither[y & 15];
+  return (true);
+}
 
-	for (lineptr = line + x / 8, bit = 128 >> (x & 7), byte = 0; x < xend; x ++)
-	{
-	  // Dither the current pixel...
-	  if (*pixptr <= dither[x & 15])
-	    byte |= bit;
-
-	  // Advance to the next pixel...
-	  pixptr += xstep;
-	  xerr += xmod;
-	  if (xerr >= (int)xsize)
-	  {
-	    // Accumulated error has overflowed, advance another pixel...
-	    xerr -= xsize;
-	    pixptr += xdir;
-	  }
-
-	  // and the next bit
-	  if (bit == 1)
-	  {
-	    // Current byte is "full", save it...
-	    *lineptr++ = byte;
-	    byte = 0;
-	    bit  = 128;
-	  }
-	  else
-	    bit /= 2;
-	}
 
-	if (bit < 128)
-	  *lineptr = byte;
-      }
-      else if (options->header.cupsColorSpace == CUPS_CSPACE_K)
-      {
-        // Need to invert the image...
-	for (lineptr = line + x; x < xend; x ++)
-	{
-	  // Copy an inverted grayscale pixel...
-	  if (smoothing && yerr >= 0 && xerr >= 0)
-	  {
-	    const unsigned char	*rt = pixptr + xdir,
-				*dn = pixptr + ydir,
-				*dnrt = pixptr + xdir + ydir;
-					// Pointers to adjacent pixels
-
-	    if (rt < pixels || rt >= pixend)
-	      rt = pixptr;
-	    if (dn < pixels || dn >= pixend)
-	      dn = pixptr;
-	    if (dnrt < pixels || dnrt >= pixend)
-	      dnrt = pixptr;
-
-	    pixel0     = ((xsize - xerr) * *pixptr + xerr * *rt) / xsize;
-            pixel1     = ((xsize - xerr) * *dn + xerr * *dnrt) / xsize;
-	    *lineptr++ = (unsigned char)(255 - ((ysize - yerr) * pixel0 + yerr * pixel1) / ysize);
-	  }
-	  else
-	  {
-	    *lineptr++ = ~*pixptr;
-	  }
-
-	  // Advance to the next pixel...
-	  pixptr += xstep;
-	  xerr += xmod;
-	  if (xerr >= (int)xsize)
-	  {
-	    // Accumulated error has overflowed, advance another pixel...
-	    xerr -= xsize;
-	    pixptr += xdir;
-	  }
-	}
-      }
-      else
-      {
-        // Need to copy the image...
-        int bpp = (int)options->header.cupsBitsPerPixel / 8;
+//
+// 'scaler_hline()' - Scale an input line horizontally.
+//
 
-	for (lineptr = line + x * bpp; x < xend; x ++)
-	{
-	  // Copy a grayscale or RGB pixel...
-	  if (smoothing && yerr >= 0 && xerr >= 0)
-	  {
-	    int			j;	// Looping var
-	    const unsigned char	*rt = pixptr + xdir,
-				*dn = pixptr + ydir,
-				*dnrt = pixptr + xdir + ydir;
-					// Pointers to adjacent pixels
-
-	    if (rt < pixels || rt >= pixend)
-	      rt = pixptr;
-	    if (dn < pixels || dn >= pixend)
-	      dn = pixptr;
-	    if (dnrt < pixels || dnrt >= pixend)
-	      dnrt = pixptr;
-
-            for (j = 0; j < bpp; j ++)
-            {
-	      pixel0     = ((xsize - xerr) * pixptr[j] + xerr * rt[j]) / xsize;
-              pixel1     = ((xsize - xerr) * dn[j] + xerr * dnrt[j]) / xsize;
-	      *lineptr++ = (unsigned char)(((ysize - yerr) * pixel0 + yerr * pixel1) / ysize);
-	    }
-	  }
-	  else
-	  {
-	    memcpy(lineptr, pixptr, (unsigned)bpp);
-	    lineptr += bpp;
-	  }
-
-	  // Advance to the next pixel...
-	  pixptr += xstep;
-	  xerr += xmod;
-	  if (xerr >= (int)xsize)
-	  {
-	    // Accumulated error has overflowed, advance another pixel...
-	    xerr -= xsize;
-	    pixptr += xdir;
-	  }
-	}
-      }
+static void
+scaler_hline(
+    _pappl_scaler_t     *scaler,	// I - Image scaler
+    const unsigned char *in,		// I - Input line
+    unsigned char       *out)		// I - Output line
+{
+  int			i,		// Looping var
+			k,		// Current tap
+			count = scaler->out_right - scaler->out_left,
+					// Number of output columns
+			htaps = scaler->htaps;
+					// Number of taps per column
+  const short		*weights = scaler->hweights;
+					// Weights for current column
+  const unsigned char	*inptr;		// Pointer into input line
+  int			v0, v1, v2;	// Accumulated values
+#if defined(_PAPPL_SCALE_SSE2)
+  int			w01;		// Weights for two color pixels
+#elif defined(_PAPPL_SCALE_NEON)
+  unsigned		p0;		// Color pixel with following byte
+#endif // _PAPPL_SCALE_SSE2
+
+
+  if (scaler->depth == 1)
+  {
+#if defined(_PAPPL_SCALE_SSE2)
+    if ((htaps & 7) == 0)
+    {
+      // Filter 8 taps at a time...
+      __m128i	zero = _mm_setzero_si128(),
+		acc;			// Accumulated values
 
-      if (!(driver_data.rwriteline_cb)(job, options, device, (unsigned)y, line))
+      for (i = 0; i < count; i ++, weights += htaps)
       {
-	papplLogJob(job, PAPPL_LOGLEVEL_ERROR, "Unable to write raster line %u.", y);
-	goto abort_job;
-      }
+        inptr = in + scaler->hfirst[i];
+        acc   = _mm_setzero_si128();
 
-      pixline += ystep;
-      yerr += ymod;
-      if (yerr >= ysize)
-      {
-        pixline += ydir;
-        yerr -= ysize;
+        for (k = 0; k < htaps; k += 8)
+          acc = _mm_add_epi32(acc, _mm_madd_epi16(_mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *)(inptr + k)), zero), _mm_loadu_si128((const __m128i *)(weights + k))));
+
+        acc = _mm_add_epi32(acc, _mm_shuffle_epi32(acc, 0x4e));
+        acc = _mm_add_epi32(acc, _mm_shuffle_epi32(acc, 0xb1));
+        v0  = (_mm_cvtsi128_si32(acc) + _PAPPL_SCALER_ONE / 2) >> _PAPPL_SCALER_BITS;
+
+        *out++ = (unsigned char)(v0 < 0 ? 0 : v0 > 255 ? 255 : v0);
       }
+      return;
     }
 
-    // Trailing blank space...
-    memset(line, white, options->header.cupsBytesPerLine);
-    for (; y < (int)options->header.cupsHeight; y ++)
+#elif defined(_PAPPL_SCALE_NEON)
+    if ((htaps & 7) == 0)
     {
-      if (!(driver_data.rwriteline_cb)(job, options, device, (unsigned)y, line))
+      // Filter 8 taps at a time...
+      int16x8_t	pixels,			// Input pixels
+		w;			// Weights
+      int32x4_t	acc;			// Accumulated values
+      int32x2_t	sum;			// Sum of accumulated values
+
+      for (i = 0; i < count; i ++, weights += htaps)
       {
-	papplLogJob(job, PAPPL_LOGLEVEL_ERROR, "Unable to write raster line %u.", y);
-	goto abort_job;
+        inptr = in + scaler->hfirst[i];
+        acc   = vdupq_n_s32(0);
+
+        for (k = 0; k < htaps; k += 8)
+        {
+          pixels = vreinterpretq_s16_u16(vmovl_u8(vld1_u8(inptr + k)));
+          w      = vld1q_s16(weights + k);
+          acc    = vmlal_s16(acc, vget_low_s16(pixels), vget_low_s16(w));
+          acc    = vmlal_s16(acc, vget_high_s16(pixels), vget_high_s16(w));
+        }
+
+        sum = vadd_s32(vget_low_s32(acc), vget_high_s32(acc));
+        sum = vpadd_s32(sum, sum);
+        v0  = (vget_lane_s32(sum, 0) + _PAPPL_SCALER_ONE / 2) >> _PAPPL_SCALER_BITS;
+
+        *out++ = (unsigned char)(v0 < 0 ? 0 : v0 > 255 ? 255 : v0);
       }
+      return;
     }
+#endif // _PAPPL_SCALE_SSE2
 
-    // End the page...
-    if (!(driver_data.rendpage_cb)(job, options, device, 1))
+    for (i = 0; i < count; i ++, weights += htaps)
     {
-      papplLogJob(job, PAPPL_LOGLEVEL_ERROR, "Unable to end raster page.");
-      goto abort_job;
-    }
+      for (k = 0, inptr = in + scaler->hfirst[i], v0 = _PAPPL_SCALER_ONE / 2; k < htaps; k ++)
+        v0 += inptr[k] * weights[k];
 
-    papplJobSetImpressionsCompleted(job, 1);
-  }
+      v0 >>= _PAPPL_SCALER_BITS;
 
-  // End the job...
-  if (!(driver_data.rendjob_cb)(job, options, device))
-  {
-    papplLogJob(job, PAPPL_LOGLEVEL_ERROR, "Unable to end raster job.");
-    goto abort_job;
+      *out++ = (unsigned char)(v0 < 0 ? 0 : v0 > 255 ? 255 : v0);
+    }
   }
+  else
+  {
+    for (i = 0; i < count; i ++, weights += htaps)
+    {
+      inptr = in + 3 * scaler->hfirst[i];
 
-  // Free memory and return...
-  free(line);
-
-  return (true);
-
-  // Abort the job...
-  abort_job:
+#if defined(_PAPPL_SCALE_SSE2)
+      if ((htaps & 1) == 0 && (scaler->hfirst[i] + htaps) < scaler->in_width)
+      {
+        // Filter 2 pixels at a time - the pixels are loaded with the first 2
+        // bytes of the next pixel, so the right-most column of the line is
+        // filtered by the code below...
+	__m128i	zero = _mm_setzero_si128(),
+		acc = _mm_set1_epi32(_PAPPL_SCALER_ONE / 2),
+					// Accumulated values
+		a;			// Pixels as 16-bit values
+
+        for (k = 0; k < htaps; k += 2, inptr += 6)
+        {
+          memcpy(&w01, weights + k, 4);
 
-  if (started)
-    (driver_data.rendjob_cb)(job, options, device);
+          a   = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *)inptr), zero);
+          acc = _mm_add_epi32(acc, _mm_madd_epi16(_mm_unpacklo_epi16(a, _mm_srli_si128(a, 6)), _mm_set1_epi32(w01)));
+        }
 
-  free(line);
+        acc = _mm_srai_epi32(acc, _PAPPL_SCALER_BITS);
+        acc = _mm_packs_epi32(acc, acc);
+        v0  = _mm_cvtsi128_si32(_mm_packus_epi16(acc, acc));
 
-  return (false);
-}
+        *out++ = (unsigned char)v0;
+        *out++ = (unsigned char)(v0 >> 8);
+        *out++ = (unsigned char)(v0 >> 16);
+        continue;
+      }
 
+#elif defined(_PAPPL_SCALE_NEON)
+      if ((scaler->hfirst[i] + htaps) < scaler->in_width)
+      {
+        // Filter each pixel as 4 values - each pixel is loaded with the first
+        // byte of the next pixel, so the right-most column of the line is
+        // filtered by the code below...
+        int32x4_t	acc = vdupq_n_s32(_PAPPL_SCALER_ONE / 2);
+					// Accumulated values
+        uint8x8_t	rgb;		// Output pixel
+
+        for (k = 0; k < htaps; k ++, inptr += 3)
+        {
+          memcpy(&p0, inptr, 4);
+          acc = vmlal_n_s16(acc, vget_low_s16(vreinterpretq_s16_u16(vmovl_u8(vreinterpret_u8_u32(vdup_n_u32(p0))))), weights[k]);
+        }
 
-//
-// '_papplJobFilterJPEG()' - Filter a JPEG image file.
-//
+        rgb = vqmovn_u16(vcombine_u16(vqshrun_n_s32(acc, _PAPPL_SCALER_BITS), vdup_n_u16(0)));
 
-#ifdef HAVE_LIBJPEG
-bool
-_papplJobFilterJPEG(
-    pappl_job_t    *job,		// I - Job
-    pappl_device_t *device,		// I - Device
-    void           *data)		// I - Filter data (unused)
-{
-  const char		*filename;	// JPEG filename
-  FILE			*fp;		// JPEG file
-  pappl_pr_options_t	*options = NULL;// Job options
-  struct jpeg_decompress_struct	dinfo;	// Decompressor info
-  int			ppi;		// Pixels per inch
-  _pappl_jpeg_err_t	jerr;		// Error handler info
-  unsigned char		*pixels = NULL;	// Image pixels
-  JSAMPROW		row;		// Sample row pointer
-  bool			ret = false;	// Return value
+        *out++ = vget_lane_u8(rgb, 0);
+        *out++ = vget_lane_u8(rgb, 1);
+        *out++ = vget_lane_u8(rgb, 2);
+        continue;
+      }
+#endif // _PAPPL_SCALE_SSE2
 
+      for (k = 0, v0 = v1 = v2 = _PAPPL_SCALER_ONE / 2; k < htaps; k ++, inptr += 3)
+      {
+        v0 += inptr[0] * weights[k];
+        v1 += inptr[1] * weights[k];
+        v2 += inptr[2] * weights[k];
+      }
 
-  (void)data;
+      v0 >>= _PAPPL_SCALER_BITS;
+      v1 >>= _PAPPL_SCALER_BITS;
+      v2 >>= _PAPPL_SCALER_BITS;
 
-  // Open the JPEG file...
-  filename = papplJobGetFilename(job);
-  if ((fp = fopen(filename, "rb")) == NULL)
-  {
-    papplLogJob(job, PAPPL_LOGLEVEL_ERROR, "Unable to open JPEG file '%s': %s", filename, strerror(errno));
-    return (false);
+      *out++ = (unsigned char)(v0 < 0 ? 0 : v0 > 255 ? 255 : v0);
+      *out++ = (unsigned char)(v1 < 0 ? 0 : v1 > 255 ? 255 : v1);
+      *out++ = (unsigned char)(v2 < 0 ? 0 : v2 > 255 ? 255 : v2);
+    }
   }
+}
 
-  // Read the image header...
-  jpeg_std_error(&jerr.jerr);
-  jerr.jerr.error_exit = jpeg_error_handler;
 
-  if (setjmp(jerr.retbuf))
-  {
-    // JPEG library errors are directed to this point...
-    papplJobSetReasons(job, PAPPL_JREASON_DOCUMENT_FORMAT_ERROR, PAPPL_JREASON_NONE);
-    papplLogJob(job, PAPPL_LOGLEVEL_ERROR, "Unable to open JPEG file '%s': %s", filename, jerr.message);
-    ret = false;
-    goto finish_jpeg;
-  }
+//
+// 'scaler_kernel()' - Compute the value of a resampling filter.
+//
 
-  dinfo.err = (struct jpeg_error_mgr *)&jerr;
-  jpeg_create_decompress(&dinfo);
-  jpeg_stdio_src(&dinfo, fp);
-  jpeg_read_header(&dinfo, TRUE);
+static double				// O - Filter value
+scaler_kernel(_pappl_resample_t filter,	// I - Resampling filter
+              double            x)	// I - Distance from center in pixels
+{
+  if (x < 0.0)
+    x = -x;
 
-  // Get job options and request the image data in the format we need...
-  options = papplJobCreatePrintOptions(job, 1, dinfo.num_components > 1);
+  if (filter == _PAPPL_RESAMPLE_LANCZOS2)
+  {
+    // sinc(x) * sinc(x / 2) for |x| < 2
+    if (x < 0.000001)
+      return (1.0);
+    else if (x >= 2.0)
+      return (0.0);
 
-  dinfo.quantize_colors = FALSE;
+    x *= 3.14159265358979323846;
 
-  if (options->header.cupsNumColors == 1)
-  {
-    dinfo.out_color_space      = JCS_GRAYSCALE;
-    dinfo.out_color_components = 1;
-    dinfo.output_components    = 1;
+    return (2.0 * sin(x) * sin(0.5 * x) / (x * x));
   }
   else
   {
-    dinfo.out_color_space      = JCS_RGB;
-    dinfo.out_color_components = 3;
-    dinfo.output_components    = 3;
+    // 1 - |x| for |x| < 1
+    return (x < 1.0 ? 1.0 - x : 0.0);
   }
+}
 
-  jpeg_calc_output_dimensions(&dinfo);
 
-  papplLogJob(job, PAPPL_LOGLEVEL_INFO, "Loading %dx%dx%d JPEG image.", dinfo.output_width, dinfo.output_height, dinfo.output_components);
+//
+// 'scaler_taps()' - Compute the filter taps for an output column or line.
+//
+// The output pixel centers are mapped to the input image and the filter is
+// stretched when reducing the image so that every input pixel contributes to
+// the output.  The weights are normalized so that they add up to 1.0.
+//
 
-  if ((pixels = (unsigned char *)malloc((size_t)(dinfo.output_width * dinfo.output_height * (unsigned)dinfo.output_components))) == NULL)
+static int				// O - Number of taps
+scaler_taps(
+    _pappl_resample_t filter,		// I - Resampling filter
+    int               in_size,		// I - Input size
+    int               out_size,		// I - Output size
+    int               i,		// I - Output column or line
+    double            *weights,		// I - Weights array
+    int               *first)		// O - First input column or line
+{
+  int		j,			// Looping var
+		lo,			// First input pixel
+		hi;			// Last input pixel + 1
+  double	scale = (double)in_size / (double)out_size,
+					// Input pixels per output pixel
+		fscale = scale > 1.0 ? scale : 1.0,
+					// Filter scale
+		support = (filter == _PAPPL_RESAMPLE_LANCZOS2 ? 2.0 : 1.0) * fscale,
+					// Filter support in input pixels
+		center = (i + 0.5) * scale,
+					// Center of output pixel
+		total = 0.0;		// Total of weights
+
+
+  if ((lo = (int)(center - support + 0.5)) < 0)
+    lo = 0;
+  if ((hi = (int)(center + support + 0.5)) > in_size)
+    hi = in_size;
+
+  for (j = lo; j < hi; j ++)
+    total += (weights[j - lo] = scaler_kernel(filter, (j + 0.5 - center) / fscale));
+
+  if (hi <= lo || total <= 0.0)
   {
-    papplLogJob(job, PAPPL_LOGLEVEL_ERROR, "Unable to allocate memory for %dx%dx%d JPEG image.", dinfo.output_width, dinfo.output_height, dinfo.output_components);
-    papplJobSetReasons(job, PAPPL_JREASON_ERRORS_DETECTED, PAPPL_JREASON_NONE);
-    goto finish_jpeg;
-  }
-
-  jpeg_start_decompress(&dinfo);
+    // No taps, use the nearest pixel...
+    if ((lo = (int)center) >= in_size)
+      lo = in_size - 1;
 
-  while (dinfo.output_scanline < dinfo.output_height)
-  {
-    row = (JSAMPROW)(pixels + (size_t)dinfo.output_scanline * (size_t)dinfo.output_width * (size_t)dinfo.output_components);
-    jpeg_read_scanlines(&dinfo, &row, 1);
-  }
+    *first     = lo;
+    weights[0] = 1.0;
 
-  if (dinfo.X_density != dinfo.Y_density)
-  {
-    papplLogJob(job, PAPPL_LOGLEVEL_WARN, "Unsupported non-square JPEG resolution %ux%u%s, using default.", dinfo.X_density, dinfo.Y_density, dinfo.density_unit == 1 ? "dpi" : dinfo.density_unit == 2 ? "dpcm" : "???");
-    ppi = 0;
-  }
-  else
-  {
-    switch (dinfo.density_unit)
-    {
-      default :
-      case 0 : // Unknown units
-          ppi = 0;
-          break;
-      case 1 : // Dots-per-inch
-          ppi = dinfo.X_density;
-          break;
-      case 2 : // Dots-per-centimeter
-          ppi = dinfo.X_density * 254 / 100;
-          break;
-    }
+    return (1);
   }
 
-  ret = papplJobFilterImage(job, device, options, pixels, (int)dinfo.output_width, (int)dinfo.output_height, dinfo.output_components, ppi, true);
-
-  jpeg_finish_decompress(&dinfo);
+  for (j = lo; j < hi; j ++)
+    weights[j - lo] /= total;
 
-  finish_jpeg:
-
-  papplJobDeletePrintOptions(options);
-  free(pixels);
-  jpeg_destroy_decompress(&dinfo);
-  fclose(fp);
+  *first = lo;
 
-  return (ret);
+  return (hi - lo);
 }
-#endif // HAVE_LIBJPEG
 
 
 //
-// 'process_png()' - Process a PNG image file.
+// 'scaler_vline()' - Filter horizontally scaled lines vertically.
 //
 
-#ifdef HAVE_LIBPNG
-bool					// O - `true` on success and `false` otherwise
-_papplJobFilterPNG(
-    pappl_job_t    *job,		// I - Job
-    pappl_device_t *device,		// I - Device
-    void           *data)		// I - Filter data (unused)
+static void
+scaler_vline(
+    const unsigned char **lines,	// I - Horizontally scaled lines
+    const short         *weights,	// I - Weights for each line
+    int                 count,		// I - Number of lines
+    unsigned char       *out,		// I - Output line
+    size_t              bytes)		// I - Bytes per line
 {
-  pappl_pr_options_t	*options = NULL;// Job options
-  png_image		png;		// PNG image data
-  png_color		bg;		// Background color
-  int			png_bpp;	// Bytes per pixel
-  unsigned char		*pixels = NULL;	// Image pixels
-  bool			ret = false;	// Return value
+  size_t	i = 0;			// Looping var
+  int		k,			// Current tap
+		v;			// Accumulated value
+#if defined(_PAPPL_SCALE_SSE2)
+  __m128i	zero = _mm_setzero_si128(),
+		acc[4],			// Accumulated values
+		lo,			// Accumulated values for bytes 0-3
+		hi,			// Accumulated values for bytes 4-7
+		a, b,			// Input bytes
+		a16, b16,		// Input bytes as 16-bit values
+		w;			// Weights for two lines
+#elif defined(_PAPPL_SCALE_NEON)
+  int16x8_t	pixels;			// Input bytes as 16-bit values
+  int32x4_t	lo,			// Accumulated values for bytes 0-3
+		hi;			// Accumulated values for bytes 4-7
+#endif // _PAPPL_SCALE_SSE2
+
+
+#if defined(_PAPPL_SCALE_SSE2)
+  // Filter 16 bytes at a time, two lines at a time...
+  for (; (i + 16) <= bytes; i += 16)
+  {
+    acc[0] = acc[1] = acc[2] = acc[3] = _mm_set1_epi32(_PAPPL_SCALER_ONE / 2);
 
+    for (k = 0; k < count; k += 2)
+    {
+      a = _mm_loadu_si128((const __m128i *)(lines[k] + i));
 
-  // Load the PNG...
-  (void)data;
+      if ((k + 1) < count)
+      {
+        b = _mm_loadu_si128((const __m128i *)(lines[k + 1] + i));
+        w = _mm_set1_epi32((int)((unsigned)(unsigned short)weights[k] | ((unsigned)(unsigned short)weights[k + 1] << 16)));
+      }
+      else
+      {
+        b = zero;
+        w = _mm_set1_epi32((int)(unsigned short)weights[k]);
+      }
 
-  memset(&png, 0, sizeof(png));
-  png.version = PNG_IMAGE_VERSION;
+      a16    = _mm_unpacklo_epi8(a, zero);
+      b16    = _mm_unpacklo_epi8(b, zero);
+      acc[0] = _mm_add_epi32(acc[0], _mm_madd_epi16(_mm_unpacklo_epi16(a16, b16), w));
+      acc[1] = _mm_add_epi32(acc[1], _mm_madd_epi16(_mm_unpackhi_epi16(a16, b16), w));
 
-  bg.red = bg.green = bg.blue = 255;
+      a16    = _mm_unpackhi_epi8(a, zero);
+      b16    = _mm_unpackhi_epi8(b, zero);
+      acc[2] = _mm_add_epi32(acc[2], _mm_madd_epi16(_mm_unpacklo_epi16(a16, b16), w));
+      acc[3] = _mm_add_epi32(acc[3], _mm_madd_epi16(_mm_unpackhi_epi16(a16, b16), w));
+    }
 
-  png_image_begin_read_from_file(&png, job->filename);
+    lo = _mm_packs_epi32(_mm_srai_epi32(acc[0], _PAPPL_SCALER_BITS), _mm_srai_epi32(acc[1], _PAPPL_SCALER_BITS));
+    hi = _mm_packs_epi32(_mm_srai_epi32(acc[2], _PAPPL_SCALER_BITS), _mm_srai_epi32(acc[3], _PAPPL_SCALER_BITS));
 
-  if (png.warning_or_error & PNG_IMAGE_ERROR)
-  {
-    papplJobSetReasons(job, PAPPL_JREASON_DOCUMENT_FORMAT_ERROR, PAPPL_JREASON_NONE);
-    papplLogJob(job, PAPPL_LOGLEVEL_ERROR, "Unable to open PNG file '%s': %s", job->filename, png.message);
-    goto finish_job;
+    _mm_storeu_si128((__m128i *)(out + i), _mm_packus_epi16(lo, hi));
   }
 
-  papplLogJob(job, PAPPL_LOGLEVEL_INFO, "PNG image is %ux%u", png.width, png.height);
+  // Then 8 bytes at a time...
+  for (; (i + 8) <= bytes; i += 8)
+  {
+    lo = hi = _mm_set1_epi32(_PAPPL_SCALER_ONE / 2);
 
-  // Prepare options...
-  options = papplJobCreatePrintOptions(job, 1, (png.format & PNG_FORMAT_FLAG_COLOR) != 0);
+    for (k = 0; k < count; k += 2)
+    {
+      a = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *)(lines[k] + i)), zero);
 
-  if (options->header.cupsNumColors > 1)
-  {
-    png.format = PNG_FORMAT_RGB;
-    png_bpp    = 3;
-  }
-  else
-  {
-    png.format = PNG_FORMAT_GRAY;
-    png_bpp    = 1;
-  }
+      if ((k + 1) < count)
+      {
+        b = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *)(lines[k + 1] + i)), zero);
+        w = _mm_set1_epi32((int)((unsigned)(unsigned short)weights[k] | ((unsigned)(unsigned short)weights[k + 1] << 16)));
+      }
+      else
+      {
+        b = zero;
+        w = _mm_set1_epi32((int)(unsigned short)weights[k]);
+      }
 
-  pixels = malloc(PNG_IMAGE_SIZE(png));
+      lo = _mm_add_epi32(lo, _mm_madd_epi16(_mm_unpacklo_epi16(a, b), w));
+      hi = _mm_add_epi32(hi, _mm_madd_epi16(_mm_unpackhi_epi16(a, b), w));
+    }
 
-  png_image_finish_read(&png, &bg, pixels, 0, NULL);
+    lo = _mm_srai_epi32(lo, _PAPPL_SCALER_BITS);
+    hi = _mm_srai_epi32(hi, _PAPPL_SCALER_BITS);
+    lo = _mm_packs_epi32(lo, hi);
 
-  if (png.warning_or_error & PNG_IMAGE_ERROR)
-  {
-    papplJobSetReasons(job, PAPPL_JREASON_DOCUMENT_FORMAT_ERROR, PAPPL_JREASON_NONE);
-    papplLogJob(job, PAPPL_LOGLEVEL_ERROR, "Unable to open PNG file '%s': %s", job->filename, png.message);
-    goto finish_job;
+    _mm_storel_epi64((__m128i *)(out + i), _mm_packus_epi16(lo, lo));
   }
 
-  // TODO: Get PNG image resolution information (Issue #65)
+#elif defined(_PAPPL_SCALE_NEON)
+  // Filter 8 bytes at a time...
+  for (; (i + 8) <= bytes; i += 8)
+  {
+    lo = hi = vdupq_n_s32(_PAPPL_SCALER_ONE / 2);
 
-  // Print the image...
-  ret = papplJobFilterImage(job, device, options, pixels, (int)png.width, (int)png.height, png_bpp, 0, false);
+    for (k = 0; k < count; k ++)
+    {
+      pixels = vreinterpretq_s16_u16(vmovl_u8(vld1_u8(lines[k] + i)));
+      lo     = vmlal_n_s16(lo, vget_low_s16(pixels), weights[k]);
+      hi     = vmlal_n_s16(hi, vget_high_s16(pixels), weights[k]);
+    }
 
-  finish_job:
+    vst1_u8(out + i, vqmovn_u16(vcombine_u16(vqshrun_n_s32(lo, _PAPPL_SCALER_BITS), vqshrun_n_s32(hi, _PAPPL_SCALER_BITS))));
+  }
+#endif // _PAPPL_SCALE_SSE2
 
-  papplJobDeletePrintOptions(options);
+  // Filter the remaining bytes...
+  for (; i < bytes; i ++)
+  {
+    for (k = 0, v = _PAPPL_SCALER_ONE / 2; k < count; k ++)
+      v += lines[k][i] * weights[k];
 
-  // Free the image data when we're done...
-  png_image_free(&png);
-  free(pixels);
+    v >>= _PAPPL_SCALER_BITS;
 
-  return (ret);
+    out[i] = (unsigned char)(v < 0 ? 0 : v > 255 ? 255 : v);
+  }
 }
-#endif // HAVE_LIBPNG
 
 
-#ifdef HAVE_LIBJPEG
 //
-// 'jpeg_error_handler()' - Handle JPEG errors by not exiting.
+// 'scaler_weights()' - Convert filter weights to fixed point.
+//
+// The largest weight is adjusted so that the fixed point weights add up to
+// exactly 1.0 and solid areas of the image keep their color.
 //
 
 static void
-jpeg_error_handler(j_common_ptr p)	// I - JPEG data
+scaler_weights(const double *weights,	// I - Floating point weights
+               int          count,	// I - Number of weights
+               short        *fixed)	// O - Fixed point weights
 {
-  _pappl_jpeg_err_t	*jerr = (_pappl_jpeg_err_t *)p->err;
-					// JPEG error handler
+  int	k,				// Looping var
+	largest = 0,			// Largest weight
+	total = 0;			// Total of weights
 
 
-  // Save the error message in the string buffer...
-  (jerr->jerr.format_message)(p, jerr->message);
+  for (k = 0; k < count; k ++)
+  {
+    fixed[k] = (short)floor(weights[k] * _PAPPL_SCALER_ONE + 0.5);
+    total    += fixed[k];
 
-  // Return to the point we called setjmp()...
-  longjmp(jerr->retbuf, 1);
+    if (fixed[k] > fixed[largest])
+      largest = k;
+  }
+
+  fixed[largest] += (short)(_PAPPL_SCALER_ONE - total);
 }
-#endif // HAVE_LIBJPEG
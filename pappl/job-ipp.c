@@ -35,6 +35,7 @@ static void		ipp_cancel_job(pappl_client_t *client);
 static void		ipp_close_job(pappl_client_t *client);
 static void		ipp_get_job_attributes(pappl_client_t *client);
 static void		ipp_send_document(pappl_client_t *client);
+static void		stop_spooling(pappl_job_t *job, bool error);
 
 
 //
@@ -45,14 +46,14 @@ void
 _papplJobCopyAttributes(
     pappl_job_t    *job,		// I - Job
     pappl_client_t *client,		// I - Client
-    cups_array_t   *ra)			// I - requested-attributes
+    _pappl_ra_t    *ra)			// I - requested-attributes
 {
   _papplCopyAttributes(client->response, job->attrs, ra, IPP_TAG_JOB, 0);
 
-  if (!ra || cupsArrayFind(ra, "date-time-at-creation"))
+  if (_PAPPL_REQUESTED(ra, _PAPPL_RA_DATE_TIME_AT_CREATION))
     ippAddDate(client->response, IPP_TAG_JOB, "date-time-at-creation", ippTimeToDate(job->created));
 
-  if (!ra || cupsArrayFind(ra, "date-time-at-completed"))
+  if (_PAPPL_REQUESTED(ra, _PAPPL_RA_DATE_TIME_AT_COMPLETED))
   {
     if (job->completed)
       ippAddDate(client->response, IPP_TAG_JOB, "date-time-at-completed", ippTimeToDate(job->completed));
@@ -60,7 +61,7 @@ _papplJobCopyAttributes(
       ippAddOutOfBand(client->response, IPP_TAG_JOB, IPP_TAG_NOVALUE, "date-time-at-completed");
   }
 
-  if (!ra || cupsArrayFind(ra, "date-time-at-processing"))
+  if (_PAPPL_REQUESTED(ra, _PAPPL_RA_DATE_TIME_AT_PROCESSING))
   {
     if (job->processing)
       ippAddDate(client->response, IPP_TAG_JOB, "date-time-at-processing", ippTimeToDate(job->processing));
@@ -68,24 +69,24 @@ _papplJobCopyAttributes(
       ippAddOutOfBand(client->response, IPP_TAG_JOB, IPP_TAG_NOVALUE, "date-time-at-processing");
   }
 
-  if (!ra || cupsArrayFind(ra, "job-impressions"))
+  if (_PAPPL_REQUESTED(ra, _PAPPL_RA_JOB_IMPRESSIONS))
     ippAddInteger(client->response, IPP_TAG_JOB, IPP_TAG_INTEGER, "job-impressions", job->impressions);
 
-  if (!ra || cupsArrayFind(ra, "job-impressions-completed"))
+  if (_PAPPL_REQUESTED(ra, _PAPPL_RA_JOB_IMPRESSIONS_COMPLETED))
     ippAddInteger(client->response, IPP_TAG_JOB, IPP_TAG_INTEGER, "job-impressions-completed", job->impcompleted);
 
-  if (!ra || cupsArrayFind(ra, "job-printer-up-time"))
+  if (_PAPPL_REQUESTED(ra, _PAPPL_RA_JOB_PRINTER_UP_TIME))
     ippAddInteger(client->response, IPP_TAG_JOB, IPP_TAG_INTEGER, "job-printer-up-time", (int)(time(NULL) - client->printer->start_time));
 
   _papplJobCopyState(job, IPP_TAG_JOB, client->response, ra);
 
-  if (!ra || cupsArrayFind(ra, "time-at-creation"))
+  if (_PAPPL_REQUESTED(ra, _PAPPL_RA_TIME_AT_CREATION))
     ippAddInteger(client->response, IPP_TAG_JOB, IPP_TAG_INTEGER, "time-at-creation", (int)(job->created - client->printer->start_time));
 
-  if (!ra || cupsArrayFind(ra, "time-at-completed"))
+  if (_PAPPL_REQUESTED(ra, _PAPPL_RA_TIME_AT_COMPLETED))
     ippAddInteger(client->response, IPP_TAG_JOB, job->completed ? IPP_TAG_INTEGER : IPP_TAG_NOVALUE, "time-at-completed", (int)(job->completed - client->printer->start_time));
 
-  if (!ra || cupsArrayFind(ra, "time-at-processing"))
+  if (_PAPPL_REQUESTED(ra, _PAPPL_RA_TIME_AT_PROCESSING))
     ippAddInteger(client->response, IPP_TAG_JOB, job->processing ? IPP_TAG_INTEGER : IPP_TAG_NOVALUE, "time-at-processing", (int)(job->processing - client->printer->start_time));
 }
 
@@ -104,25 +105,43 @@ _papplJobCopyDocumentData(
 			buffer[4096];	// Copy buffer
   ssize_t		bytes,		// Bytes read
 			total = 0;	// Total bytes copied
-  cups_array_t		*ra;		// Attributes to send in response
+  cups_array_t		*names;		// Attribute names to send in response
+  _pappl_ra_t		*ra;		// Attributes to send in response
+  _pappl_mime_filter_t	*filter;	// Filter for printing
+  bool			streaming = false;
+					// Process the job while receiving it?
 
 
-  // If we have a PWG or Apple raster file, process it directly or return
-  // server-error-busy...
+  // If we have a PWG or Apple raster file and the printer can start another
+  // job, process it directly, otherwise spool it like any other document...
   if (!strcmp(job->format, "image/pwg-raster") || !strcmp(job->format, "image/urf"))
   {
-    if (job->printer->processing_job)
+    bool direct = false;		// Process the raster data directly?
+
+    pthread_rwlock_wrlock(&job->printer->rwlock);
+
+    if (job->printer->num_processing_jobs < job->printer->max_processing_jobs && !job->printer->device_retry && !job->printer->is_stopped && job->printer->state != IPP_PSTATE_STOPPED)
     {
-      papplClientRespondIPP(client, IPP_STATUS_ERROR_BUSY, "Currently printing another job.");
-      _papplClientFlushDocumentData(client);
-      return;
+      // Reserve the printer for this job...
+      pthread_rwlock_wrlock(&job->rwlock);
+      job->state = IPP_JSTATE_PROCESSING;
+      pthread_rwlock_unlock(&job->rwlock);
+
+      job->printer->processing_job = job;
+      job->printer->num_processing_jobs ++;
+      direct = true;
     }
 
-    job->state = IPP_JSTATE_PENDING;
+    pthread_rwlock_unlock(&job->printer->rwlock);
 
-    _papplJobProcessRaster(job, client);
+    if (direct)
+    {
+      _papplJobProcessRaster(job, client);
 
-    goto complete_job;
+      goto complete_job;
+    }
+
+    papplLogJob(job, PAPPL_LOGLEVEL_DEBUG, "Printer is busy, spooling raster data.");
   }
 
   // Create a file for the request data...
@@ -135,6 +154,21 @@ _papplJobCopyDocumentData(
 
   papplLogJob(job, PAPPL_LOGLEVEL_DEBUG, "Created job file \"%s\", format \"%s\".", filename, job->format);
 
+  // See if the job can be processed while the document data is received...
+  if (job->format)
+  {
+    if ((filter = _papplSystemFindMIMEFilter(job->system, job->format, job->printer->driver_data.format)) == NULL)
+      filter = _papplSystemFindMIMEFilter(job->system, job->format, "image/pwg-raster");
+
+    if ((filter && filter->streaming) || (!filter && (!strcmp(job->format, "image/pwg-raster") || !strcmp(job->format, "image/urf"))))
+    {
+      papplLogJob(job, PAPPL_LOGLEVEL_DEBUG, "Streaming document data to filter.");
+
+      streaming     = true;
+      job->spooling = true;
+    }
+  }
+
   while ((bytes = httpRead(client->http, buffer, sizeof(buffer))) > 0)
   {
     papplLogClient(client, PAPPL_LOGLEVEL_DEBUG, "Read %d bytes...", (int)bytes);
@@ -154,6 +188,33 @@ _papplJobCopyDocumentData(
     }
 
     total += (size_t)bytes;
+
+    if (streaming)
+    {
+      // Let the filter know there is more data...
+      pthread_mutex_lock(&job->spool_mutex);
+      job->spool_bytes = (size_t)total;
+      pthread_cond_broadcast(&job->spool_cond);
+      pthread_mutex_unlock(&job->spool_mutex);
+
+      // Submit the job for processing once the first data arrives...
+      if (!job->filename)
+      {
+        _papplJobSubmitFile(job, filename);
+
+        if (!job->filename)
+        {
+          // Unable to submit job, it has been aborted...
+          close(job->fd);
+          job->fd = -1;
+
+          stop_spooling(job, false);
+          _papplClientFlushDocumentData(client);
+          papplClientRespondIPP(client, IPP_STATUS_ERROR_INTERNAL, "Unable to allocate filename.");
+          goto copy_attrs;
+        }
+      }
+    }
   }
 
   if (bytes < 0)
@@ -186,23 +247,29 @@ _papplJobCopyDocumentData(
 
   job->fd = -1;
 
-  // Submit the job for processing...
-  _papplJobSubmitFile(job, filename);
+  // Submit the job for processing, or let the filter know that all of the
+  // document data has been received...
+  if (streaming)
+    stop_spooling(job, false);
+
+  if (!job->filename)
+    _papplJobSubmitFile(job, filename);
 
   complete_job:
 
   // Return the job info...
   papplClientRespondIPP(client, IPP_STATUS_OK, NULL);
 
-  ra = cupsArrayNew((cups_array_cb_t)strcmp, NULL, NULL, 0, NULL, NULL);
-  cupsArrayAdd(ra, "job-id");
-  cupsArrayAdd(ra, "job-state");
-  cupsArrayAdd(ra, "job-state-message");
-  cupsArrayAdd(ra, "job-state-reasons");
-  cupsArrayAdd(ra, "job-uri");
+  names = cupsArrayNew((cups_array_cb_t)strcmp, NULL, NULL, 0, NULL, NULL);
+  cupsArrayAdd(names, "job-id");
+  cupsArrayAdd(names, "job-state");
+  cupsArrayAdd(names, "job-state-message");
+  cupsArrayAdd(names, "job-state-reasons");
+  cupsArrayAdd(names, "job-uri");
 
+  ra = _papplCreateRequestedAttrs(names);
   _papplJobCopyAttributes(job, client, ra);
-  cupsArrayDelete(ra);
+  _papplDeleteRequestedAttrs(ra);
   return;
 
   // If we get here we had to abort the job...
@@ -210,6 +277,18 @@ _papplJobCopyDocumentData(
 
   _papplClientFlushDocumentData(client);
 
+  if (streaming)
+  {
+    // Tell the filter the document data is incomplete...
+    stop_spooling(job, true);
+
+    if (job->filename)
+    {
+      // Job has already been submitted, the filter will abort it...
+      goto copy_attrs;
+    }
+  }
+
   job->state     = IPP_JSTATE_ABORTED;
   job->completed = time(NULL);
 
@@ -223,14 +302,17 @@ _papplJobCopyDocumentData(
 
   pthread_rwlock_unlock(&client->printer->rwlock);
 
-  ra = cupsArrayNew((cups_array_cb_t)strcmp, NULL, NULL, 0, NULL, NULL);
-  cupsArrayAdd(ra, "job-id");
-  cupsArrayAdd(ra, "job-state");
-  cupsArrayAdd(ra, "job-state-reasons");
-  cupsArrayAdd(ra, "job-uri");
+  copy_attrs:
+
+  names = cupsArrayNew((cups_array_cb_t)strcmp, NULL, NULL, 0, NULL, NULL);
+  cupsArrayAdd(names, "job-id");
+  cupsArrayAdd(names, "job-state");
+  cupsArrayAdd(names, "job-state-reasons");
+  cupsArrayAdd(names, "job-uri");
 
+  ra = _papplCreateRequestedAttrs(names);
   _papplJobCopyAttributes(job, client, ra);
-  cupsArrayDelete(ra);
+  _papplDeleteRequestedAttrs(ra);
 }
 
 
@@ -243,12 +325,12 @@ _papplJobCopyState(
     pappl_job_t    *job,	// I - Job
     ipp_tag_t      group_tag,	// I - Group tag
     ipp_t          *ipp,	// I - IPP message
-    cups_array_t   *ra)		// I - Requested attributes
+    _pappl_ra_t    *ra)		// I - Requested attributes
 {
-  if (!ra || cupsArrayFind(ra, "job-state"))
+  if (_PAPPL_REQUESTED(ra, _PAPPL_RA_JOB_STATE))
     ippAddInteger(ipp, group_tag, IPP_TAG_ENUM, "job-state", (int)job->state);
 
-  if (!ra || cupsArrayFind(ra, "job-state-message"))
+  if (_PAPPL_REQUESTED(ra, _PAPPL_RA_JOB_STATE_MESSAGE))
   {
     if (job->message)
     {
@@ -297,7 +379,7 @@ _papplJobCopyState(
     }
   }
 
-  if (!ra || cupsArrayFind(ra, "job-state-reasons"))
+  if (_PAPPL_REQUESTED(ra, _PAPPL_RA_JOB_STATE_REASONS))
   {
     if (job->state_reasons)
     {
@@ -630,7 +712,7 @@ ipp_get_job_attributes(
     pappl_client_t *client)		// I - Client
 {
   pappl_job_t	*job = client->job;	// Job information
-  cups_array_t	*ra;			// requested-attributes
+  _pappl_ra_t	*ra;			// requested-attributes
 
 
   // Authorize access...
@@ -645,9 +727,9 @@ ipp_get_job_attributes(
 
   papplClientRespondIPP(client, IPP_STATUS_OK, NULL);
 
-  ra = ippCreateRequestedArray(client->request);
+  ra = _papplCreateRequestedAttrs(ippCreateRequestedArray(client->request));
   _papplJobCopyAttributes(job, client, ra);
-  cupsArrayDelete(ra);
+  _papplDeleteRequestedAttrs(ra);
 }
 
 
@@ -744,3 +826,19 @@ ipp_send_document(
   if (have_data)
     _papplJobCopyDocumentData(client, job);
 }
+
+
+//
+// 'stop_spooling()' - Stop spooling document data for a streaming filter.
+//
+
+static void
+stop_spooling(pappl_job_t *job,		// I - Job
+              bool        error)	// I - `true` if the document data is incomplete
+{
+  pthread_mutex_lock(&job->spool_mutex);
+  job->spooling    = false;
+  job->spool_error = error;
+  pthread_cond_broadcast(&job->spool_cond);
+  pthread_mutex_unlock(&job->spool_mutex);
+}
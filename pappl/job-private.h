@@ -19,6 +19,22 @@
 // Types and structures...
 //
 
+typedef struct _pappl_bufpool_s _pappl_bufpool_t;
+					// Raster buffer pool
+typedef struct _pappl_rpipe_s _pappl_rpipe_t;
+					// Raster line pipeline
+typedef struct _pappl_scaler_s _pappl_scaler_t;
+					// Image scaler
+
+typedef enum _pappl_resample_e		// Image resampling filters
+{
+  _PAPPL_RESAMPLE_BILINEAR,		// Bilinear (triangle) filter
+  _PAPPL_RESAMPLE_LANCZOS2		// Lanczos-2 filter
+} _pappl_resample_t;
+
+typedef const unsigned char *(*_pappl_scaler_cb_t)(void *data, int row);
+					// Image line callback
+
 struct _pappl_job_s			// Job data
 {
   pthread_rwlock_t	rwlock;			// Reader/writer lock
@@ -41,7 +57,17 @@ struct _pappl_job_s			// Job data
   ipp_t			*attrs;			// Static attributes
   char			*filename;		// Print file name
   int			fd;			// Print file descriptor
+  pappl_device_t	*device;		// Output device, if processing
+  _pappl_bufpool_t	*bufpool;		// Raster buffer pool, if processing
+  int			priority;		// "job-priority" value
+  size_t		fair_share;		// Fair share credit, `0` if not yet queued
+  int			pending_index;		// Index in printer's pending jobs or `-1`
   bool			streaming;		// Streaming job?
+  pthread_mutex_t	spool_mutex;		// Mutex for spooled document data
+  pthread_cond_t	spool_cond;		// Condition for spooled document data
+  bool			spooling;		// Is document data still being spooled?
+  bool			spool_error;		// Did spooling fail?
+  size_t		spool_bytes;		// Number of bytes spooled so far
   void			*data;			// Per-job driver data
 };
 
@@ -50,14 +76,18 @@ struct _pappl_job_s			// Job data
 // Functions...
 //
 
+extern _pappl_bufpool_t	*_papplBufPoolCreate(void) _PAPPL_PRIVATE;
+extern void		_papplBufPoolDelete(_pappl_bufpool_t *pool) _PAPPL_PRIVATE;
+
 extern int		_papplJobCompareActive(pappl_job_t *a, pappl_job_t *b) _PAPPL_PRIVATE;
 extern int		_papplJobCompareAll(pappl_job_t *a, pappl_job_t *b) _PAPPL_PRIVATE;
 extern int		_papplJobCompareCompleted(pappl_job_t *a, pappl_job_t *b) _PAPPL_PRIVATE;
-extern void		_papplJobCopyAttributes(pappl_job_t *job, pappl_client_t *client, cups_array_t *ra) _PAPPL_PRIVATE;
+extern void		_papplJobCopyAttributes(pappl_job_t *job, pappl_client_t *client, _pappl_ra_t *ra) _PAPPL_PRIVATE;
 extern void		_papplJobCopyDocumentData(pappl_client_t *client, pappl_job_t *job) _PAPPL_PRIVATE;
-extern void		_papplJobCopyState(pappl_job_t *job, ipp_tag_t group_tag, ipp_t *ipp, cups_array_t *ra) _PAPPL_PRIVATE;
+extern void		_papplJobCopyState(pappl_job_t *job, ipp_tag_t group_tag, ipp_t *ipp, _pappl_ra_t *ra) _PAPPL_PRIVATE;
 extern pappl_job_t	*_papplJobCreate(pappl_printer_t *printer, int job_id, const char *username, const char *format, const char *job_name, ipp_t *attrs) _PAPPL_PRIVATE;
 extern void		_papplJobDelete(pappl_job_t *job) _PAPPL_PRIVATE;
+extern void		_papplJobDitherLine(pappl_pr_options_t *options, unsigned y, const unsigned char *pixels, bool black, unsigned char *line, unsigned xstart, unsigned xend) _PAPPL_PRIVATE;
 #  ifdef HAVE_LIBJPEG
 extern bool		_papplJobFilterJPEG(pappl_job_t *job, pappl_device_t *device, void *data);
 #  endif // HAVE_LIBJPEG
@@ -73,5 +103,14 @@ extern void		_papplJobSetState(pappl_job_t *job, ipp_jstate_t state) _PAPPL_PRIV
 extern void		_papplJobSubmitFile(pappl_job_t *job, const char *filename) _PAPPL_PRIVATE;
 extern bool		_papplJobValidateDocumentAttributes(pappl_client_t *client) _PAPPL_PRIVATE;
 
+extern _pappl_rpipe_t	*_papplRasterPipeCreate(pappl_job_t *job, pappl_pr_options_t *options, pappl_device_t *device, size_t linesize, unsigned char fill) _PAPPL_PRIVATE;
+extern bool		_papplRasterPipeDelete(_pappl_rpipe_t *rpipe) _PAPPL_PRIVATE;
+extern unsigned char	*_papplRasterPipeGetLine(_pappl_rpipe_t *rpipe) _PAPPL_PRIVATE;
+extern bool		_papplRasterPipeWriteLine(_pappl_rpipe_t *rpipe, unsigned y) _PAPPL_PRIVATE;
+
+extern _pappl_scaler_t	*_papplScalerCreate(int in_width, int in_height, int depth, int out_width, int out_height, int out_left, int out_right, _pappl_resample_t filter, _pappl_scaler_cb_t cb, void *cb_data) _PAPPL_PRIVATE;
+extern void		_papplScalerDelete(_pappl_scaler_t *scaler) _PAPPL_PRIVATE;
+extern bool		_papplScalerGetLine(_pappl_scaler_t *scaler, int y, unsigned char *line) _PAPPL_PRIVATE;
+
 
 #endif // !_PAPPL_JOB_PRIVATE_H_
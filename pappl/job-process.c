@@ -12,6 +12,88 @@
 //
 
 #include "pappl-private.h"
+#include "device-private.h"
+#if defined(__GNUC__) && (defined(__x86_64__) || (defined(__i386__) && defined(__SSE2__)))
+#  include <immintrin.h>
+#  define _PAPPL_DITHER_SSE2	1	// Use SSE2 dither kernel
+#  define _PAPPL_DITHER_AVX2	1	// Use AVX2 dither kernel if supported
+#elif defined(_M_X64)
+#  include <emmintrin.h>
+#  define _PAPPL_DITHER_SSE2	1	// Use SSE2 dither kernel
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#  include <arm_neon.h>
+#  define _PAPPL_DITHER_NEON	1	// Use NEON dither kernel
+#endif // __GNUC__ && (__x86_64__ || (__i386__ && __SSE2__))
+
+
+//
+// Local constants...
+//
+
+#define _PAPPL_RPIPE_LINES	64	// Maximum number of lines in a raster pipeline
+#define _PAPPL_RPIPE_SIZE	4194304	// Maximum size of a raster pipeline in bytes
+
+
+//
+// Local types...
+//
+
+struct _pappl_rpipe_s			// Raster line pipeline
+{
+  pappl_job_t		*job;			// Job
+  pappl_pr_options_t	*options;		// Print options
+  pappl_device_t	*device;		// Output device
+  pappl_pr_rwriteline_cb_t writeline_cb;	// Write raster line callback
+  pthread_mutex_t	mutex;			// Mutex for queued lines
+  pthread_cond_t	cond;			// Condition for queued lines
+  pthread_t		tid;			// Writer thread
+  bool			threaded,		// Is there a writer thread?
+			done,			// Have all lines been queued?
+			error;			// Did a line fail to write?
+  size_t		linesize,		// Bytes per line
+			num_lines,		// Number of line buffers
+			first,			// First queued line
+			count;			// Number of queued lines
+  unsigned		ys[_PAPPL_RPIPE_LINES];	// Line numbers for queued lines
+  unsigned char		*buffer;		// Line buffers
+  struct timeval	start;			// Creation time
+  size_t		lines,			// Number of lines written
+			wait_usecs,		// Time spent waiting for a line buffer
+			write_usecs;		// Time spent writing lines
+};
+
+typedef struct _pappl_raster_src_s	// Raster document file
+{
+  pappl_job_t	*job;			// Job
+  int		fd;			// File descriptor
+} _pappl_raster_src_t;
+
+
+//
+// Local globals...
+//
+
+#ifdef _PAPPL_DITHER_SSE2
+static const unsigned char pappl_bitrev[256] =
+{					// Bit-reversed bytes for SSE2/AVX2 masks
+  0x00, 0x80, 0x40, 0xc0, 0x20, 0xa0, 0x60, 0xe0, 0x10, 0x90, 0x50, 0xd0, 0x30, 0xb0, 0x70, 0xf0,
+  0x08, 0x88, 0x48, 0xc8, 0x28, 0xa8, 0x68, 0xe8, 0x18, 0x98, 0x58, 0xd8, 0x38, 0xb8, 0x78, 0xf8,
+  0x04, 0x84, 0x44, 0xc4, 0x24, 0xa4, 0x64, 0xe4, 0x14, 0x94, 0x54, 0xd4, 0x34, 0xb4, 0x74, 0xf4,
+  0x0c, 0x8c, 0x4c, 0xcc, 0x2c, 0xac, 0x6c, 0xec, 0x1c, 0x9c, 0x5c, 0xdc, 0x3c, 0xbc, 0x7c, 0xfc,
+  0x02, 0x82, 0x42, 0xc2, 0x22, 0xa2, 0x62, 0xe2, 0x12, 0x92, 0x52, 0xd2, 0x32, 0xb2, 0x72, 0xf2,
+  0x0a, 0x8a, 0x4a, 0xca, 0x2a, 0xaa, 0x6a, 0xea, 0x1a, 0x9a, 0x5a, 0xda, 0x3a, 0xba, 0x7a, 0xfa,
+  0x06, 0x86, 0x46, 0xc6, 0x26, 0xa6, 0x66, 0xe6, 0x16, 0x96, 0x56, 0xd6, 0x36, 0xb6, 0x76, 0xf6,
+  0x0e, 0x8e, 0x4e, 0xce, 0x2e, 0xae, 0x6e, 0xee, 0x1e, 0x9e, 0x5e, 0xde, 0x3e, 0xbe, 0x7e, 0xfe,
+  0x01, 0x81, 0x41, 0xc1, 0x21, 0xa1, 0x61, 0xe1, 0x11, 0x91, 0x51, 0xd1, 0x31, 0xb1, 0x71, 0xf1,
+  0x09, 0x89, 0x49, 0xc9, 0x29, 0xa9, 0x69, 0xe9, 0x19, 0x99, 0x59, 0xd9, 0x39, 0xb9, 0x79, 0xf9,
+  0x05, 0x85, 0x45, 0xc5, 0x25, 0xa5, 0x65, 0xe5, 0x15, 0x95, 0x55, 0xd5, 0x35, 0xb5, 0x75, 0xf5,
+  0x0d, 0x8d, 0x4d, 0xcd, 0x2d, 0xad, 0x6d, 0xed, 0x1d, 0x9d, 0x5d, 0xdd, 0x3d, 0xbd, 0x7d, 0xfd,
+  0x03, 0x83, 0x43, 0xc3, 0x23, 0xa3, 0x63, 0xe3, 0x13, 0x93, 0x53, 0xd3, 0x33, 0xb3, 0x73, 0xf3,
+  0x0b, 0x8b, 0x4b, 0xcb, 0x2b, 0xab, 0x6b, 0xeb, 0x1b, 0x9b, 0x5b, 0xdb, 0x3b, 0xbb, 0x7b, 0xfb,
+  0x07, 0x87, 0x47, 0xc7, 0x27, 0xa7, 0x67, 0xe7, 0x17, 0x97, 0x57, 0xd7, 0x37, 0xb7, 0x77, 0xf7,
+  0x0f, 0x8f, 0x4f, 0xcf, 0x2f, 0xaf, 0x6f, 0xef, 0x1f, 0x9f, 0x5f, 0xdf, 0x3f, 0xbf, 0x7f, 0xff
+};
+#endif // _PAPPL_DITHER_SSE2
 
 
 //
@@ -19,9 +101,23 @@
 //
 
 static const char *cups_cspace_string(cups_cspace_t cspace);
+#ifdef _PAPPL_DITHER_AVX2
+static unsigned	dither_avx2(const unsigned char *pixels, const unsigned char *dither, bool black, unsigned char *line, unsigned count);
+#endif // _PAPPL_DITHER_AVX2
+#ifdef _PAPPL_DITHER_NEON
+static unsigned	dither_neon(const unsigned char *pixels, const unsigned char *dither, bool black, unsigned char *line, unsigned count);
+#endif // _PAPPL_DITHER_NEON
+#ifdef _PAPPL_DITHER_SSE2
+static unsigned	dither_sse2(const unsigned char *pixels, const unsigned char *dither, bool black, unsigned char *line, unsigned count);
+#endif // _PAPPL_DITHER_SSE2
+static bool	filter_raster(pappl_job_t *job, pappl_device_t *device);
 static bool	filter_raw(pappl_job_t *job, pappl_device_t *device);
 static void	finish_job(pappl_job_t *job);
+static void	process_raster(pappl_job_t *job, cups_raster_t *ras);
+static ssize_t	read_raster(_pappl_raster_src_t *src, unsigned char *buffer, size_t bytes);
+static void	release_job(pappl_job_t *job);
 static bool	start_job(pappl_job_t *job);
+static void	*write_lines(_pappl_rpipe_t *rpipe);
 
 
 //
@@ -501,6 +597,101 @@ papplJobDeletePrintOptions(
 }
 
 
+//
+// '_papplJobDitherLine()' - Dither a line of 8-bit pixels to 1-bit black.
+//
+// The 8-bit pixels for columns "xstart" through "xend - 1" are compared
+// against the print options' dither thresholds for line "y", and the
+// corresponding bits of the 1-bit line are set for black pixels.  Black (K)
+// pixels are black when greater than the threshold, and luminance pixels are
+// black when less than or equal to the threshold.  Bits in the partial
+// bytes before "xstart" and after "xend - 1" are cleared.
+//
+// Groups of 16 or 32 pixels are dithered using SIMD instructions when they
+// are available, with identical output to the scalar code.
+//
+
+void
+_papplJobDitherLine(
+    pappl_pr_options_t  *options,	// I - Print options
+    unsigned            y,		// I - Line number
+    const unsigned char *pixels,	// I - 8-bit pixels, starting at column "xstart"
+    bool                black,		// I - `true` for black (K) pixels, `false` for luminance
+    unsigned char       *line,		// I - 1-bit line
+    unsigned            xstart,		// I - First column
+    unsigned            xend)		// I - Last column + 1
+{
+  const unsigned char	*dither = options->dither[y & 15];
+					// Dither thresholds for this line
+  unsigned		x,		// Current column
+			count;		// Number of pixels dithered with SIMD
+  unsigned char		*lineptr,	// Pointer into line
+			byte,		// Current byte
+			bit;		// Current bit
+
+
+  lineptr = line + xstart / 8;
+  bit     = (unsigned char)(128 >> (xstart & 7));
+  byte    = 0;
+
+  // Dither leading pixels up to the start of the dither tile...
+  for (x = xstart; x < xend && (x & 15); x ++, pixels ++)
+  {
+    if ((*pixels > dither[x & 15]) == black)
+      byte |= bit;
+
+    if (bit == 1)
+    {
+      *lineptr++ = byte;
+      byte       = 0;
+      bit        = 128;
+    }
+    else
+      bit /= 2;
+  }
+
+  // Then whole tiles using SIMD instructions, if available...
+  if ((count = (xend - x) & ~15U) > 0)
+  {
+#if defined(_PAPPL_DITHER_AVX2)
+    if (__builtin_cpu_supports("avx2"))
+      count = dither_avx2(pixels, dither, black, lineptr, count);
+    else
+      count = dither_sse2(pixels, dither, black, lineptr, count);
+#elif defined(_PAPPL_DITHER_SSE2)
+    count = dither_sse2(pixels, dither, black, lineptr, count);
+#elif defined(_PAPPL_DITHER_NEON)
+    count = dither_neon(pixels, dither, black, lineptr, count);
+#else
+    count = 0;
+#endif // _PAPPL_DITHER_AVX2
+
+    x       += count;
+    pixels  += count;
+    lineptr += count / 8;
+  }
+
+  // Finally dither any remaining pixels...
+  for (; x < xend; x ++, pixels ++)
+  {
+    if ((*pixels > dither[x & 15]) == black)
+      byte |= bit;
+
+    if (bit == 1)
+    {
+      *lineptr++ = byte;
+      byte       = 0;
+      bit        = 128;
+    }
+    else
+      bit /= 2;
+  }
+
+  if (bit < 128)
+    *lineptr = byte;
+}
+
+
 //
 // '_papplJobProcess()' - Process a print job.
 //
@@ -520,12 +711,17 @@ _papplJobProcess(pappl_job_t *job)	// I - Job
 
     if (filter)
     {
-      if (!(filter->cb)(job, job->printer->device, filter->cbdata))
+      if (!(filter->cb)(job, job->device, filter->cbdata))
 	job->state = IPP_JSTATE_ABORTED;
     }
     else if (!strcmp(job->format, job->printer->driver_data.format))
     {
-      if (!filter_raw(job, job->printer->device))
+      if (!filter_raw(job, job->device))
+	job->state = IPP_JSTATE_ABORTED;
+    }
+    else if (!strcmp(job->format, "image/pwg-raster") || !strcmp(job->format, "image/urf"))
+    {
+      if (!filter_raster(job, job->device))
 	job->state = IPP_JSTATE_ABORTED;
     }
     else
@@ -535,6 +731,11 @@ _papplJobProcess(pappl_job_t *job)	// I - Job
       job->state = IPP_JSTATE_ABORTED;
     }
   }
+  else if (job->state == IPP_JSTATE_PENDING)
+  {
+    // Device isn't available, the job stays queued until it is...
+    return (NULL);
+  }
 
   // Move the job to a completed state...
   finish_job(job);
@@ -552,29 +753,26 @@ _papplJobProcessRaster(
     pappl_job_t    *job,		// I - Job
     pappl_client_t *client)		// I - Client
 {
-  pappl_printer_t	*printer = job->printer;
-					// Printer for job
-  pappl_pr_options_t	*options = NULL;// Job options
   cups_raster_t		*ras = NULL;	// Raster stream
-  cups_page_header_t	header;		// Page header
-  unsigned		header_pages;	// Number of pages from page header
-  const unsigned char	*dither;	// Dither line
-  unsigned char		*pixels,	// Incoming pixel line
-			*pixptr,	// Pixel pointer in line
-			*line,		// Output (bitmap) line
-			*lineptr,	// Pointer in line
-			byte,		// Byte in line
-			bit;		// Current bit
-  unsigned		page = 0,	// Current page
-			x,		// Current column
-			y;		// Current line
+  _pappl_bufpool_t	*pool;		// Raster buffer pool
 
 
-  // Start processing the job...
+  // Start processing the job - streamed jobs are processed by the client
+  // thread, so use a buffer pool just for this job...
   job->streaming = true;
+  job->bufpool   = pool = _papplBufPoolCreate();
 
   if (!start_job(job))
+  {
+    if (job->state == IPP_JSTATE_PENDING)
+    {
+      // Streamed data can't wait for the device to come back...
+      papplLogJob(job, PAPPL_LOGLEVEL_ERROR, "Unable to print streamed job while the device is unavailable.");
+      job->state = IPP_JSTATE_ABORTED;
+    }
+
     goto complete_job;
+  }
 
   // Open the raster stream...
   if ((ras = cupsRasterOpenIO((cups_raster_cb_t)httpRead, client->http, CUPS_RASTER_READ)) == NULL)
@@ -584,246 +782,249 @@ _papplJobProcessRaster(
     goto complete_job;
   }
 
-  // Prepare options...
-  if (!cupsRasterReadHeader(ras, &header))
+  process_raster(job, ras);
+
+  complete_job:
+
+  if (httpGetState(client->http) == HTTP_STATE_POST_RECV)
   {
-    papplLogJob(job, PAPPL_LOGLEVEL_ERROR, "Unable to read raster stream from client - %s", cupsLastErrorString());
-    job->state = IPP_JSTATE_ABORTED;
-    goto complete_job;
+    // Flush excess data...
+    char	buffer[8192];		// Read buffer
+
+    while (httpRead(client->http, buffer, sizeof(buffer)) > 0)
+      ;				// Read all document data
   }
 
-  if ((header_pages = header.cupsInteger[CUPS_RASTER_PWG_TotalPageCount]) > 0)
-    papplJobSetImpressions(job, (int)header.cupsInteger[CUPS_RASTER_PWG_TotalPageCount]);
+  cupsRasterClose(ras);
+
+  finish_job(job);
+
+  _papplBufPoolDelete(pool);
+}
+
+
+//
+// '_papplRasterPipeCreate()' - Create a raster line pipeline for a page.
+//
+// A raster line pipeline decouples producing raster lines (decoding, scaling,
+// and dithering) from writing them with the driver's "rwriteline" callback.
+// Lines are queued in a bounded ring of buffers that is drained by a writer
+// thread, so device I/O overlaps the processing of the following lines and
+// the producer is throttled to the speed of the device when the ring is full.
+//
+// The pipeline is created after calling the "rstartpage" callback and must be
+// deleted before calling the "rendpage" callback.  The line buffers are
+// initialized with the "fill" value.  If the writer thread cannot be created
+// the lines are written synchronously.
+//
 
-  options = papplJobCreatePrintOptions(job, (unsigned)job->impressions, header.cupsBitsPerPixel > 8);
+_pappl_rpipe_t *			// O - Raster pipeline or `NULL` on error
+_papplRasterPipeCreate(
+    pappl_job_t        *job,		// I - Job
+    pappl_pr_options_t *options,	// I - Print options
+    pappl_device_t     *device,		// I - Output device
+    size_t             linesize,	// I - Bytes per line
+    unsigned char      fill)		// I - Initial value for line buffers
+{
+  _pappl_rpipe_t	*rpipe;		// Raster pipeline
+  size_t		num_lines;	// Number of line buffers
+
+
+  // Size the ring of line buffers...
+  if (linesize == 0)
+    return (NULL);
+  else if ((num_lines = _PAPPL_RPIPE_SIZE / linesize) > _PAPPL_RPIPE_LINES)
+    num_lines = _PAPPL_RPIPE_LINES;
+  else if (num_lines < 2)
+    num_lines = 2;
 
-  if (!(printer->driver_data.rstartjob_cb)(job, options, job->printer->device))
+  // Allocate memory...
+  if ((rpipe = calloc(1, sizeof(_pappl_rpipe_t))) == NULL)
   {
-    job->state = IPP_JSTATE_ABORTED;
-    goto complete_job;
+    papplLogJob(job, PAPPL_LOGLEVEL_ERROR, "Unable to allocate memory for raster lines: %s", strerror(errno));
+    return (NULL);
   }
 
-  // Print pages...
-  do
+  if ((rpipe->buffer = papplJobGetBuffer(job, num_lines * linesize)) == NULL)
   {
-    if (job->is_canceled)
-      break;
+    free(rpipe);
+    return (NULL);
+  }
 
-    page ++;
-    papplJobSetImpressionsCompleted(job, 1);
+  memset(rpipe->buffer, fill, num_lines * linesize);
 
-    papplLogJob(job, PAPPL_LOGLEVEL_INFO, "Page %u raster data is %ux%ux%u (%s)", page, header.cupsWidth, header.cupsHeight, header.cupsBitsPerPixel, cups_cspace_string(header.cupsColorSpace));
+  rpipe->job          = job;
+  rpipe->options      = options;
+  rpipe->device       = device;
+  rpipe->writeline_cb = job->printer->driver_data.rwriteline_cb;
+  rpipe->linesize     = linesize;
+  rpipe->num_lines    = num_lines;
 
-    papplSystemAddEvent(printer->system, printer, job, PAPPL_EVENT_JOB_PROGRESS, NULL);
+  pthread_mutex_init(&rpipe->mutex, NULL);
+  pthread_cond_init(&rpipe->cond, NULL);
 
-    // Set options for this page...
-    papplJobDeletePrintOptions(options);
-    options = papplJobCreatePrintOptions(job, (unsigned)job->impressions, header.cupsBitsPerPixel > 8);
+  gettimeofday(&rpipe->start, NULL);
 
-    if (header.cupsWidth == 0 || header.cupsHeight == 0 || (header.cupsBitsPerColor != 1 && header.cupsBitsPerColor != 8) || header.cupsColorOrder != CUPS_ORDER_CHUNKED || (header.cupsBytesPerLine != ((header.cupsWidth * header.cupsBitsPerPixel + 7) / 8)))
-    {
-      papplLogJob(job, PAPPL_LOGLEVEL_ERROR, "Bad raster data seen.");
-      papplJobSetReasons(job, PAPPL_JREASON_DOCUMENT_FORMAT_ERROR, PAPPL_JREASON_NONE);
-      job->state = IPP_JSTATE_ABORTED;
-      break;
-    }
+  // Start the writer thread...
+  if (pthread_create(&rpipe->tid, NULL, (void *(*)(void *))write_lines, rpipe))
+    papplLogJob(job, PAPPL_LOGLEVEL_WARN, "Unable to create raster writer thread: %s", strerror(errno));
+  else
+    rpipe->threaded = true;
 
-    if (header.cupsBitsPerPixel > 8 && !(printer->driver_data.color_supported & PAPPL_COLOR_MODE_COLOR))
-    {
-      papplLogJob(job, PAPPL_LOGLEVEL_ERROR, "Unsupported raster data seen.");
-      papplJobSetReasons(job, PAPPL_JREASON_DOCUMENT_UNPRINTABLE_ERROR, PAPPL_JREASON_NONE);
-      job->state = IPP_JSTATE_ABORTED;
-      break;
-    }
+  return (rpipe);
+}
 
-    if (options->header.cupsBitsPerPixel >= 8 && header.cupsBitsPerPixel >= 8)
-      options->header = header;		// Use page header from client
 
-    if (!(printer->driver_data.rstartpage_cb)(job, options, job->printer->device, page))
-    {
-      job->state = IPP_JSTATE_ABORTED;
-      break;
-    }
+//
+// '_papplRasterPipeDelete()' - Write any queued lines and delete a raster line pipeline.
+//
 
-    if (options->header.cupsBytesPerLine > header.cupsBytesPerLine)
-    {
-      // Allocate enough space for the entire output line and clear to white
-      if ((pixels = malloc(options->header.cupsBytesPerLine)) == NULL)
-      {
-        papplLogJob(job, PAPPL_LOGLEVEL_ERROR, "Unable to allocate raster line.");
-	job->state = IPP_JSTATE_ABORTED;
-	break;
-      }
+bool					// O - `true` if all lines were written, `false` otherwise
+_papplRasterPipeDelete(
+    _pappl_rpipe_t *rpipe)		// I - Raster pipeline
+{
+  bool			ret;		// Return value
+  pappl_system_t	*system;	// System
+  struct timeval	curtime;	// Current time
+  size_t		msecs,		// Elapsed time
+			wait_msecs,	// Time spent waiting for the writer
+			write_msecs;	// Time spent writing lines
 
-      if (options->header.cupsColorSpace == CUPS_CSPACE_K)
-        memset(pixels, 0, options->header.cupsBytesPerLine);
-      else
-        memset(pixels, 255, options->header.cupsBytesPerLine);
-    }
-    else
-    {
-      // The input raster is at least as wide as the output raster...
-      if ((pixels = malloc(header.cupsBytesPerLine)) == NULL)
-      {
-        papplLogJob(job, PAPPL_LOGLEVEL_ERROR, "Unable to allocate raster line.");
-	job->state = IPP_JSTATE_ABORTED;
-	break;
-      }
-    }
 
-    if ((line = malloc(options->header.cupsBytesPerLine)) == NULL)
-    {
-      free(pixels);
+  if (!rpipe)
+    return (false);
 
-      papplLogJob(job, PAPPL_LOGLEVEL_ERROR, "Unable to allocate raster line.");
-      job->state = IPP_JSTATE_ABORTED;
-      break;
-    }
+  if (rpipe->threaded)
+  {
+    // Tell the writer thread that we are done and wait for it to exit...
+    pthread_mutex_lock(&rpipe->mutex);
+    rpipe->done = true;
+    pthread_cond_broadcast(&rpipe->cond);
+    pthread_mutex_unlock(&rpipe->mutex);
 
-    for (y = 0; !job->is_canceled && y < header.cupsHeight && y < options->header.cupsHeight; y ++)
-    {
-      if (cupsRasterReadPixels(ras, pixels, header.cupsBytesPerLine))
-      {
-        if (header.cupsBitsPerPixel == 8 && options->header.cupsBitsPerPixel == 1)
-        {
-          // Dither the line...
-	  dither = options->dither[y & 15];
-	  memset(line, 0, options->header.cupsBytesPerLine);
+    pthread_join(rpipe->tid, NULL);
+  }
 
-          if (header.cupsColorSpace == CUPS_CSPACE_K)
-          {
-            // Black...
-	    for (x = 0, lineptr = line, pixptr = pixels, bit = 128, byte = 0; x < header.cupsWidth; x ++, pixptr ++)
-	    {
-	      if (*pixptr > dither[x & 15])
-	        byte |= bit;
-
-	      if (bit == 1)
-	      {
-	        *lineptr++ = byte;
-	        byte       = 0;
-	        bit        = 128;
-	      }
-	      else
-	        bit /= 2;
-	    }
-
-	    if (bit < 128)
-	      *lineptr = byte;
-	  }
-	  else
-	  {
-	    // Grayscale to black...
-	    for (x = 0, lineptr = line, pixptr = pixels, bit = 128, byte = 0; x < header.cupsWidth; x ++, pixptr ++)
-	    {
-	      if (*pixptr <= dither[x & 15])
-	        byte |= bit;
-
-	      if (bit == 1)
-	      {
-	        *lineptr++ = byte;
-	        byte       = 0;
-	        bit        = 128;
-	      }
-	      else
-	        bit /= 2;
-	    }
-
-	    if (bit < 128)
-	      *lineptr = byte;
-	  }
-
-          (printer->driver_data.rwriteline_cb)(job, options, job->printer->device, y, line);
-        }
-        else
-          (printer->driver_data.rwriteline_cb)(job, options, job->printer->device, y, pixels);
-      }
-      else
-        break;
-    }
+  gettimeofday(&curtime, NULL);
+  msecs       = (size_t)(1000 * (curtime.tv_sec - rpipe->start.tv_sec) + (curtime.tv_usec - rpipe->start.tv_usec) / 1000);
+  wait_msecs  = rpipe->wait_usecs / 1000;
+  write_msecs = rpipe->write_usecs / 1000;
 
-    if (!job->is_canceled && y < header.cupsHeight)
-    {
-      // Discard excess lines from client...
-      while (y < header.cupsHeight)
-      {
-        cupsRasterReadPixels(ras, pixels, header.cupsBytesPerLine);
-        y ++;
-      }
-    }
-    else
-    {
-      // Pad missing lines with whitespace...
-      if (header.cupsBitsPerPixel == 8 && options->header.cupsBitsPerPixel == 1)
-      {
-        memset(line, 0, options->header.cupsBytesPerLine);
+  papplLogJob(rpipe->job, PAPPL_LOGLEVEL_DEBUG, "Raster pipeline: %lu lines in %lu msecs, %lu msecs writing, %lu msecs waiting for the writer.", (unsigned long)rpipe->lines, (unsigned long)msecs, (unsigned long)write_msecs, (unsigned long)wait_msecs);
 
-        while (y < options->header.cupsHeight)
-        {
-	  (printer->driver_data.rwriteline_cb)(job, options, job->printer->device, y, line);
-          y ++;
-        }
-      }
-      else
-      {
-        if (header.cupsColorSpace == CUPS_CSPACE_K || header.cupsColorSpace == CUPS_CSPACE_CMYK)
-          memset(pixels, 0x00, header.cupsBytesPerLine);
-	else
-          memset(pixels, 0xff, header.cupsBytesPerLine);
+  // Update the job metrics...
+  system = rpipe->job->system;
 
-        while (y < options->header.cupsHeight)
-        {
-	  (printer->driver_data.rwriteline_cb)(job, options, job->printer->device, y, pixels);
-          y ++;
-        }
-      }
-    }
+  pthread_mutex_lock(&system->job_mutex);
+  system->job_metrics.raster_lines += rpipe->lines;
+  system->job_metrics.raster_msecs += msecs;
+  system->job_metrics.render_msecs += msecs > wait_msecs ? msecs - wait_msecs : 0;
+  system->job_metrics.write_msecs  += write_msecs;
+  pthread_mutex_unlock(&system->job_mutex);
 
-    free(pixels);
-    free(line);
+  ret = !rpipe->error;
 
-    if (!(printer->driver_data.rendpage_cb)(job, options, job->printer->device, page))
-    {
-      job->state = IPP_JSTATE_ABORTED;
-      break;
-    }
+  pthread_mutex_destroy(&rpipe->mutex);
+  pthread_cond_destroy(&rpipe->cond);
 
-    if (job->is_canceled)
-      break;
-    else if (y < header.cupsHeight)
-    {
-      papplLogJob(job, PAPPL_LOGLEVEL_ERROR, "Unable to read page from raster stream from client - %s", cupsLastErrorString());
-      job->state = IPP_JSTATE_ABORTED;
-      break;
-    }
-  }
-  while (cupsRasterReadHeader(ras, &header));
+  papplJobReleaseBuffer(rpipe->job, rpipe->buffer);
+  free(rpipe);
 
-  if (!(printer->driver_data.rendjob_cb)(job, options, job->printer->device))
-    job->state = IPP_JSTATE_ABORTED;
-  else if (header_pages == 0)
-    papplJobSetImpressions(job, (int)page);
+  return (ret);
+}
 
-  complete_job:
 
-  papplJobDeletePrintOptions(options);
+//
+// '_papplRasterPipeGetLine()' - Get the next line buffer in a raster line pipeline.
+//
+// This function waits for the writer when all of the line buffers are queued.
+// The returned buffer holds the contents of an earlier line or the initial
+// fill value.
+//
 
-  if (httpGetState(client->http) == HTTP_STATE_POST_RECV)
+unsigned char *				// O - Line buffer
+_papplRasterPipeGetLine(
+    _pappl_rpipe_t *rpipe)		// I - Raster pipeline
+{
+  unsigned char		*line;		// Line buffer
+  struct timeval	starttime,	// Start of wait
+			endtime;	// End of wait
+
+
+  pthread_mutex_lock(&rpipe->mutex);
+
+  if (rpipe->count >= rpipe->num_lines)
   {
-    // Flush excess data...
-    char	buffer[8192];		// Read buffer
+    // Wait for the writer to catch up...
+    gettimeofday(&starttime, NULL);
 
-    while (httpRead(client->http, buffer, sizeof(buffer)) > 0)
-      ;				// Read all document data
+    while (rpipe->count >= rpipe->num_lines)
+      pthread_cond_wait(&rpipe->cond, &rpipe->mutex);
+
+    gettimeofday(&endtime, NULL);
+
+    rpipe->wait_usecs += (size_t)(1000000 * (endtime.tv_sec - starttime.tv_sec) + (endtime.tv_usec - starttime.tv_usec));
   }
 
-  cupsRasterClose(ras);
+  line = rpipe->buffer + ((rpipe->first + rpipe->count) % rpipe->num_lines) * rpipe->linesize;
 
-  finish_job(job);
-  return;
+  pthread_mutex_unlock(&rpipe->mutex);
+
+  return (line);
 }
 
 
+//
+// '_papplRasterPipeWriteLine()' - Queue the current line buffer for writing.
+//
+// The line buffer from the last call to @link _papplRasterPipeGetLine@ is
+// queued for the writer thread.  Since lines are written asynchronously, a
+// `false` return value reports a failure to write an earlier line.
+//
+
+bool					// O - `true` on success, `false` if a line failed to write
+_papplRasterPipeWriteLine(
+    _pappl_rpipe_t *rpipe,		// I - Raster pipeline
+    unsigned       y)			// I - Line number
+{
+  bool		ret;			// Return value
+
+
+  if (!rpipe->threaded)
+  {
+    // Write the line now...
+    struct timeval	starttime,	// Start of write
+			endtime;	// End of write
+    size_t		usecs;		// Write time
+
+    gettimeofday(&starttime, NULL);
+
+    if (!(rpipe->writeline_cb)(rpipe->job, rpipe->options, rpipe->device, y, rpipe->buffer + rpipe->first * rpipe->linesize))
+      rpipe->error = true;
+
+    gettimeofday(&endtime, NULL);
+
+    usecs = (size_t)(1000000 * (endtime.tv_sec - starttime.tv_sec) + (endtime.tv_usec - starttime.tv_usec));
+
+    rpipe->lines ++;
+    rpipe->write_usecs += usecs;
+    rpipe->wait_usecs  += usecs;
+
+    return (!rpipe->error);
+  }
+
+  pthread_mutex_lock(&rpipe->mutex);
+
+  rpipe->ys[(rpipe->first + rpipe->count) % rpipe->num_lines] = y;
+  rpipe->count ++;
+  ret = !rpipe->error;
+
+  pthread_cond_broadcast(&rpipe->cond);
+  pthread_mutex_unlock(&rpipe->mutex);
+
+  return (ret);
+}
+
 //
 // 'cups_cspace_string()' - Get a string corresponding to a cupsColorSpace enum value.
 //
@@ -907,15 +1108,184 @@ cups_cspace_string(
 }
 
 
+#ifdef _PAPPL_DITHER_AVX2
 //
-// 'filter_raw()' - "Filter" a raw print file.
+// 'dither_avx2()' - Dither whole dither tiles using AVX2 instructions.
 //
 
-static bool				// O - `true` on success, `false` otherwise
-filter_raw(pappl_job_t    *job,		// I - Job
-           pappl_device_t *device)	// I - Device
+__attribute__((target("avx2")))
+static unsigned				// O - Number of pixels dithered
+dither_avx2(
+    const unsigned char *pixels,	// I - 8-bit pixels
+    const unsigned char *dither,	// I - Dither thresholds
+    bool                black,		// I - `true` for black (K) pixels, `false` for luminance
+    unsigned char       *line,		// I - 1-bit line
+    unsigned            count)		// I - Number of pixels (multiple of 16)
 {
-  pappl_pr_options_t	*options;	// Job options
+  unsigned	i;			// Looping var
+  __m256i	thresholds,		// Dither thresholds
+		values;			// Pixel values
+  unsigned	bits,			// Bits for black pixels
+		invert = black ? 0xffffffff : 0;
+					// Bits to invert
+
+
+  // Use two copies of the dither tile for 32 pixels at a time...
+  thresholds = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i *)dither));
+
+  for (i = 0; (i + 32) <= count; i += 32, pixels += 32, line += 4)
+  {
+    // "values <= thresholds" is the same as "max(values, thresholds) == thresholds"...
+    values = _mm256_loadu_si256((const __m256i *)pixels);
+    bits   = (unsigned)_mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_max_epu8(values, thresholds), thresholds)) ^ invert;
+
+    line[0] = pappl_bitrev[bits & 255];
+    line[1] = pappl_bitrev[(bits >> 8) & 255];
+    line[2] = pappl_bitrev[(bits >> 16) & 255];
+    line[3] = pappl_bitrev[bits >> 24];
+  }
+
+  // Dither any remaining tile using SSE2...
+  if (i < count)
+    i += dither_sse2(pixels, dither, black, line, count - i);
+
+  return (i);
+}
+#endif // _PAPPL_DITHER_AVX2
+
+
+#ifdef _PAPPL_DITHER_NEON
+//
+// 'dither_neon()' - Dither whole dither tiles using NEON instructions.
+//
+
+static unsigned				// O - Number of pixels dithered
+dither_neon(
+    const unsigned char *pixels,	// I - 8-bit pixels
+    const unsigned char *dither,	// I - Dither thresholds
+    bool                black,		// I - `true` for black (K) pixels, `false` for luminance
+    unsigned char       *line,		// I - 1-bit line
+    unsigned            count)		// I - Number of pixels (multiple of 16)
+{
+  unsigned	i;			// Looping var
+  static const unsigned char weights[16] =
+  {					// Bit for each pixel
+    128, 64, 32, 16, 8, 4, 2, 1, 128, 64, 32, 16, 8, 4, 2, 1
+  };
+  uint8x16_t	thresholds,		// Dither thresholds
+		bitvals,		// Bit for each pixel
+		values;			// Pixel values
+  uint8x8_t	bits;			// Bits for black pixels
+
+
+  thresholds = vld1q_u8(dither);
+  bitvals    = vld1q_u8(weights);
+
+  for (i = 0; i < count; i += 16, pixels += 16, line += 2)
+  {
+    // Compare and then add up the bits for each group of 8 pixels...
+    values = vld1q_u8(pixels);
+    values = vandq_u8(black ? vcgtq_u8(values, thresholds) : vcleq_u8(values, thresholds), bitvals);
+    bits   = vpadd_u8(vget_low_u8(values), vget_high_u8(values));
+    bits   = vpadd_u8(bits, bits);
+    bits   = vpadd_u8(bits, bits);
+
+    line[0] = vget_lane_u8(bits, 0);
+    line[1] = vget_lane_u8(bits, 1);
+  }
+
+  return (i);
+}
+#endif // _PAPPL_DITHER_NEON
+
+
+#ifdef _PAPPL_DITHER_SSE2
+//
+// 'dither_sse2()' - Dither whole dither tiles using SSE2 instructions.
+//
+
+static unsigned				// O - Number of pixels dithered
+dither_sse2(
+    const unsigned char *pixels,	// I - 8-bit pixels
+    const unsigned char *dither,	// I - Dither thresholds
+    bool                black,		// I - `true` for black (K) pixels, `false` for luminance
+    unsigned char       *line,		// I - 1-bit line
+    unsigned            count)		// I - Number of pixels (multiple of 16)
+{
+  unsigned	i;			// Looping var
+  __m128i	thresholds,		// Dither thresholds
+		values;			// Pixel values
+  unsigned	bits,			// Bits for black pixels
+		invert = black ? 0xffff : 0;
+					// Bits to invert
+
+
+  thresholds = _mm_loadu_si128((const __m128i *)dither);
+
+  for (i = 0; i < count; i += 16, pixels += 16, line += 2)
+  {
+    // "values <= thresholds" is the same as "max(values, thresholds) == thresholds"...
+    values = _mm_loadu_si128((const __m128i *)pixels);
+    bits   = (unsigned)_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_max_epu8(values, thresholds), thresholds)) ^ invert;
+
+    line[0] = pappl_bitrev[bits & 255];
+    line[1] = pappl_bitrev[bits >> 8];
+  }
+
+  return (i);
+}
+#endif // _PAPPL_DITHER_SSE2
+
+
+//
+// 'filter_raster()' - Print a spooled Apple/PWG Raster file.
+//
+
+static bool				// O - `true` on success, `false` on failure
+filter_raster(pappl_job_t    *job,	// I - Job
+              pappl_device_t *device)	// I - Device
+{
+  _pappl_raster_src_t	src;		// Raster document file
+  cups_raster_t		*ras;		// Raster stream
+
+
+  (void)device;
+
+  // Open the raster file - the document data is read using papplJobReadFile
+  // since it may still be arriving from the Client...
+  src.job = job;
+
+  if ((src.fd = open(job->filename, O_RDONLY | O_BINARY)) < 0)
+  {
+    papplLogJob(job, PAPPL_LOGLEVEL_ERROR, "Unable to open raster file '%s': %s", job->filename, strerror(errno));
+    return (false);
+  }
+
+  if ((ras = cupsRasterOpenIO((cups_raster_cb_t)read_raster, &src, CUPS_RASTER_READ)) == NULL)
+  {
+    papplLogJob(job, PAPPL_LOGLEVEL_ERROR, "Unable to open raster file '%s' - %s", job->filename, cupsLastErrorString());
+    close(src.fd);
+    return (false);
+  }
+
+  process_raster(job, ras);
+
+  cupsRasterClose(ras);
+  close(src.fd);
+
+  return (job->state != IPP_JSTATE_ABORTED);
+}
+
+
+//
+// 'filter_raw()' - "Filter" a raw print file.
+//
+
+static bool				// O - `true` on success, `false` otherwise
+filter_raw(pappl_job_t    *job,		// I - Job
+           pappl_device_t *device)	// I - Device
+{
+  pappl_pr_options_t	*options;	// Job options
 
 
   papplJobSetImpressions(job, 1);
@@ -958,7 +1328,22 @@ finish_job(pappl_job_t  *job)		// I - Job
   if (job->state >= IPP_JSTATE_CANCELED)
     job->completed = time(NULL);
 
-  printer->processing_job = NULL;
+  // Jobs that were put back in the queue by start_job() have already been
+  // released...
+  if (job->processing)
+    release_job(job);
+
+  if (job->device)
+  {
+    if (job->device == printer->device)
+      printer->device_job = NULL;	// Keep the printer's device open
+    else
+      papplDeviceClose(job->device);	// Close the additional connection
+
+    job->device = NULL;
+  }
+
+  job->bufpool = NULL;			// Pool belongs to the processing thread
 
   if (!printer->max_preserved_jobs)
     _papplJobRemoveFile(job);
@@ -967,7 +1352,11 @@ finish_job(pappl_job_t  *job)		// I - Job
 
   pthread_rwlock_unlock(&job->rwlock);
 
-  if (printer->is_stopped)
+  if (printer->num_processing_jobs > 0)
+  {
+    // Printer is still processing other jobs...
+  }
+  else if (printer->is_stopped)
   {
     // New printer-state is 'stopped'...
     printer->state      = IPP_PSTATE_STOPPED;
@@ -980,6 +1369,7 @@ finish_job(pappl_job_t  *job)		// I - Job
   }
 
   printer->state_time = time(NULL);
+  printer->generation ++;
 
   cupsArrayRemove(printer->active_jobs, job);
   cupsArrayAdd(printer->completed_jobs, job);
@@ -1000,26 +1390,316 @@ finish_job(pappl_job_t  *job)		// I - Job
 
   if (printer->is_deleted)
   {
-    papplPrinterDelete(printer);
+    if (printer->num_processing_jobs == 0)
+      papplPrinterDelete(printer);
   }
   else if (cupsArrayGetCount(printer->active_jobs) > 0)
   {
     _papplPrinterCheckJobs(printer);
   }
+  else if (printer->device_linger > 0 && papplSystemIsRunning(printer->system))
+  {
+    // Keep the device open for the next job...
+    pthread_rwlock_wrlock(&printer->rwlock);
+    printer->device_time = time(NULL);
+    pthread_rwlock_unlock(&printer->rwlock);
+  }
   else
   {
-    pappl_devmetrics_t	metrics;	// Metrics for device IO
+    _papplPrinterCloseIdleDevice(printer, true);
+  }
+}
 
-    pthread_rwlock_wrlock(&printer->rwlock);
 
-    papplDeviceGetMetrics(printer->device, &metrics);
-    papplLogJob(job, PAPPL_LOGLEVEL_DEBUG, "Device read metrics: %lu requests, %lu bytes, %lu msecs", (unsigned long)metrics.read_requests, (unsigned long)metrics.read_bytes, (unsigned long)metrics.read_msecs);
-    papplLogJob(job, PAPPL_LOGLEVEL_DEBUG, "Device write metrics: %lu requests, %lu bytes, %lu msecs", (unsigned long)metrics.write_requests, (unsigned long)metrics.write_bytes, (unsigned long)metrics.write_msecs);
+//
+// 'process_raster()' - Print pages from an Apple/PWG Raster stream.
+//
 
-    papplDeviceClose(printer->device);
-    printer->device = NULL;
+static void
+process_raster(pappl_job_t   *job,	// I - Job
+               cups_raster_t *ras)	// I - Raster stream
+{
+  pappl_printer_t	*printer = job->printer;
+					// Printer for job
+  pappl_pr_options_t	*options = NULL;// Job options
+  cups_page_header_t	header,		// Page header
+			options_header;	// Page header from job options
+  bool			color;		// Color page?
+  unsigned		header_pages;	// Number of pages from page header
+  _pappl_rpipe_t	*rpipe;		// Raster line pipeline
+  bool			dithering,	// Dither 8-bit grayscale to 1-bit black?
+			written;	// Were all lines written?
+  unsigned char		*pixels,	// Incoming pixel line
+			*line;		// Output (bitmap) line
+  unsigned		page = 0,	// Current page
+			y;		// Current line
 
-    pthread_rwlock_unlock(&printer->rwlock);
+
+  // Prepare options...
+  if (!cupsRasterReadHeader(ras, &header))
+  {
+    papplLogJob(job, PAPPL_LOGLEVEL_ERROR, "Unable to read raster stream - %s", cupsLastErrorString());
+    job->state = IPP_JSTATE_ABORTED;
+    return;
+  }
+
+  if ((header_pages = header.cupsInteger[CUPS_RASTER_PWG_TotalPageCount]) > 0)
+    papplJobSetImpressions(job, (int)header.cupsInteger[CUPS_RASTER_PWG_TotalPageCount]);
+
+  // The print options only depend on the job attributes and whether the pages
+  // are in color, so they are created once and reused for every page...
+  color = header.cupsBitsPerPixel > 8;
+
+  if ((options = papplJobCreatePrintOptions(job, (unsigned)job->impressions, color)) == NULL)
+  {
+    papplLogJob(job, PAPPL_LOGLEVEL_ERROR, "Unable to allocate memory for print options.");
+    job->state = IPP_JSTATE_ABORTED;
+    return;
+  }
+
+  options_header = options->header;
+
+  if (!(printer->driver_data.rstartjob_cb)(job, options, job->device))
+  {
+    job->state = IPP_JSTATE_ABORTED;
+    papplJobDeletePrintOptions(options);
+    return;
+  }
+
+  // Print pages...
+  do
+  {
+    if (job->is_canceled)
+      break;
+
+    page ++;
+    papplJobSetImpressionsCompleted(job, 1);
+
+    papplLogJob(job, PAPPL_LOGLEVEL_INFO, "Page %u raster data is %ux%ux%u (%s)", page, header.cupsWidth, header.cupsHeight, header.cupsBitsPerPixel, cups_cspace_string(header.cupsColorSpace));
+
+    papplSystemAddEvent(printer->system, printer, job, PAPPL_EVENT_JOB_PROGRESS, NULL);
+
+    // Set options for this page...
+    if ((header.cupsBitsPerPixel > 8) != color)
+    {
+      // Switching between color and grayscale pages, recreate the options...
+      pappl_pr_options_t *page_options;	// New options for page
+
+      color = header.cupsBitsPerPixel > 8;
+
+      if ((page_options = papplJobCreatePrintOptions(job, (unsigned)job->impressions, color)) == NULL)
+      {
+	papplLogJob(job, PAPPL_LOGLEVEL_ERROR, "Unable to allocate memory for print options.");
+	job->state = IPP_JSTATE_ABORTED;
+	break;
+      }
+
+      papplJobDeletePrintOptions(options);
+
+      options        = page_options;
+      options_header = options->header;
+    }
+    else
+    {
+      // Reset any per-page header changes from the previous page...
+      options->header = options_header;
+    }
+
+    if (header.cupsWidth == 0 || header.cupsHeight == 0 || (header.cupsBitsPerColor != 1 && header.cupsBitsPerColor != 8) || header.cupsColorOrder != CUPS_ORDER_CHUNKED || (header.cupsBytesPerLine != ((header.cupsWidth * header.cupsBitsPerPixel + 7) / 8)))
+    {
+      papplLogJob(job, PAPPL_LOGLEVEL_ERROR, "Bad raster data seen.");
+      papplJobSetReasons(job, PAPPL_JREASON_DOCUMENT_FORMAT_ERROR, PAPPL_JREASON_NONE);
+      job->state = IPP_JSTATE_ABORTED;
+      break;
+    }
+
+    if (header.cupsBitsPerPixel > 8 && !(printer->driver_data.color_supported & PAPPL_COLOR_MODE_COLOR))
+    {
+      papplLogJob(job, PAPPL_LOGLEVEL_ERROR, "Unsupported raster data seen.");
+      papplJobSetReasons(job, PAPPL_JREASON_DOCUMENT_UNPRINTABLE_ERROR, PAPPL_JREASON_NONE);
+      job->state = IPP_JSTATE_ABORTED;
+      break;
+    }
+
+    if (options->header.cupsBitsPerPixel >= 8 && header.cupsBitsPerPixel >= 8)
+      options->header = header;		// Use page header from client
+
+    if (!(printer->driver_data.rstartpage_cb)(job, options, job->device, page))
+    {
+      job->state = IPP_JSTATE_ABORTED;
+      break;
+    }
+
+    // Queue lines for the driver using a pipeline so that writing to the
+    // device overlaps reading and dithering the following lines...
+    dithering = header.cupsBitsPerPixel == 8 && options->header.cupsBitsPerPixel == 1;
+
+    if ((pixels = papplJobGetBuffer(job, header.cupsBytesPerLine)) == NULL)
+    {
+      job->state = IPP_JSTATE_ABORTED;
+      break;
+    }
+
+    if ((rpipe = _papplRasterPipeCreate(job, options, job->device, options->header.cupsBytesPerLine > header.cupsBytesPerLine ? options->header.cupsBytesPerLine : header.cupsBytesPerLine, options->header.cupsColorSpace == CUPS_CSPACE_K ? 0 : 255)) == NULL)
+    {
+      papplJobReleaseBuffer(job, pixels);
+
+      job->state = IPP_JSTATE_ABORTED;
+      break;
+    }
+
+    written = true;
+
+    for (y = 0; !job->is_canceled && y < header.cupsHeight && y < options->header.cupsHeight; y ++)
+    {
+      line = _papplRasterPipeGetLine(rpipe);
+
+      if (cupsRasterReadPixels(ras, dithering ? pixels : line, header.cupsBytesPerLine))
+      {
+        if (dithering)
+        {
+          // Dither the line...
+	  memset(line, 0, options->header.cupsBytesPerLine);
+	  _papplJobDitherLine(options, y, pixels, header.cupsColorSpace == CUPS_CSPACE_K, line, 0, header.cupsWidth);
+        }
+
+        if (!_papplRasterPipeWriteLine(rpipe, y))
+        {
+	  papplLogJob(job, PAPPL_LOGLEVEL_ERROR, "Unable to write raster line %u.", y);
+	  written = false;
+	  break;
+        }
+      }
+      else
+        break;
+    }
+
+    if (!written)
+    {
+      // Don't read or pad the rest of the page after a write error...
+    }
+    else if (!job->is_canceled && y < header.cupsHeight)
+    {
+      // Discard excess lines from client...
+      while (y < header.cupsHeight)
+      {
+        cupsRasterReadPixels(ras, pixels, header.cupsBytesPerLine);
+        y ++;
+      }
+    }
+    else
+    {
+      // Pad missing lines with whitespace...
+      while (y < options->header.cupsHeight)
+      {
+        line = _papplRasterPipeGetLine(rpipe);
+
+        if (dithering)
+          memset(line, 0, options->header.cupsBytesPerLine);
+        else if (header.cupsColorSpace == CUPS_CSPACE_K || header.cupsColorSpace == CUPS_CSPACE_CMYK)
+          memset(line, 0x00, header.cupsBytesPerLine);
+	else
+          memset(line, 0xff, header.cupsBytesPerLine);
+
+        if (!_papplRasterPipeWriteLine(rpipe, y))
+        {
+	  papplLogJob(job, PAPPL_LOGLEVEL_ERROR, "Unable to write raster line %u.", y);
+	  written = false;
+	  break;
+        }
+
+        y ++;
+      }
+    }
+
+    if (!_papplRasterPipeDelete(rpipe) && written)
+    {
+      papplLogJob(job, PAPPL_LOGLEVEL_ERROR, "Unable to write raster lines.");
+      written = false;
+    }
+
+    papplJobReleaseBuffer(job, pixels);
+
+    if (!written)
+    {
+      // Stop reading the raster stream after a device write error...
+      job->state = IPP_JSTATE_ABORTED;
+      break;
+    }
+
+    if (!(printer->driver_data.rendpage_cb)(job, options, job->device, page))
+    {
+      job->state = IPP_JSTATE_ABORTED;
+      break;
+    }
+
+    if (job->is_canceled)
+      break;
+    else if (y < header.cupsHeight)
+    {
+      papplLogJob(job, PAPPL_LOGLEVEL_ERROR, "Unable to read page from raster stream - %s", cupsLastErrorString());
+      job->state = IPP_JSTATE_ABORTED;
+      break;
+    }
+  }
+  while (cupsRasterReadHeader(ras, &header));
+
+  if (!(printer->driver_data.rendjob_cb)(job, options, job->device))
+    job->state = IPP_JSTATE_ABORTED;
+  else if (header_pages == 0)
+    papplJobSetImpressions(job, (int)page);
+
+  papplJobDeletePrintOptions(options);
+
+}
+
+
+//
+// 'read_raster()' - Read data from a spooled raster file.
+//
+
+static ssize_t				// O - Bytes read or `-1` on error
+read_raster(_pappl_raster_src_t *src,	// I - Raster document file
+            unsigned char       *buffer,// I - Buffer
+            size_t              bytes)	// I - Size of buffer
+{
+  return (papplJobReadFile(src->job, src->fd, buffer, bytes));
+}
+
+
+//
+// 'release_job()' - Release a job's processing slot on the printer.
+//
+// The printer must be write-locked by the caller.
+//
+
+static void
+release_job(pappl_job_t *job)		// I - Job
+{
+  pappl_printer_t	*printer = job->printer;
+					// Printer
+  pappl_job_t		*current;	// Current job
+
+
+  if (printer->num_processing_jobs > 0)
+    printer->num_processing_jobs --;
+
+  if (printer->processing_job == job)
+  {
+    // Make another processing job (if any) the current job...
+    printer->processing_job = NULL;
+
+    if (printer->num_processing_jobs > 0)
+    {
+      for (current = (pappl_job_t *)cupsArrayGetFirst(printer->active_jobs); current; current = (pappl_job_t *)cupsArrayGetNext(printer->active_jobs))
+      {
+        if (current != job && current->state >= IPP_JSTATE_PROCESSING)
+        {
+          printer->processing_job = current;
+          break;
+        }
+      }
+    }
   }
 }
 
@@ -1033,7 +1713,7 @@ start_job(pappl_job_t *job)		// I - Job
 {
   pappl_printer_t *printer = job->printer;
 					// Printer
-  bool	first_open = true;		// Is this the first time we try to open the device?
+  int		delay;			// Delay before next open attempt
 
 
   // Move the job to the 'processing' state...
@@ -1050,48 +1730,168 @@ start_job(pappl_job_t *job)		// I - Job
 
   pthread_rwlock_unlock(&job->rwlock);
 
-  // Open the output device...
-  while (!printer->device && !printer->is_deleted && !job->is_canceled && papplSystemIsRunning(printer->system))
+  if (printer->device_job)
   {
-    printer->device = papplDeviceOpen(printer->device_uri, job->name, papplLogDevice, job->system);
-
-    if (!printer->device && !printer->is_deleted && !job->is_canceled)
+    // Another job is using the printer's device, open a separate connection
+    // for this job...
+    if (!printer->is_deleted && !job->is_canceled && papplSystemIsRunning(printer->system))
+    {
+      if ((job->device = papplDeviceOpen(printer->device_uri, job->name, papplLogDevice, job->system)) != NULL)
+        papplLogJob(job, PAPPL_LOGLEVEL_DEBUG, "Opened additional device connection.");
+      else
+        papplLogJob(job, PAPPL_LOGLEVEL_DEBUG, "Unable to open additional device connection, waiting for another job to finish.");
+    }
+  }
+  else
+  {
+    // Reuse the device from a previous job if it is still online...
+    if (printer->device && !printer->device_in_use)
     {
-      // Log that the printer is unavailable then sleep for 5 seconds to retry.
-      if (first_open)
+      if (_papplDeviceReuse(printer->device))
       {
-        papplLogPrinter(printer, PAPPL_LOGLEVEL_ERROR, "Unable to open device '%s', pausing queue until printer becomes available.", printer->device_uri);
-        first_open = false;
+	papplLogJob(job, PAPPL_LOGLEVEL_DEBUG, "Reusing open device.");
+      }
+      else
+      {
+	papplLogPrinter(printer, PAPPL_LOGLEVEL_INFO, "Device is offline, reopening.");
+	papplDeviceClose(printer->device);
+	printer->device = NULL;
+      }
+    }
 
-	printer->state      = IPP_PSTATE_STOPPED;
-	printer->state_time = time(NULL);
+    // Open the output device...
+    if (!printer->device && !printer->is_deleted && !job->is_canceled && papplSystemIsRunning(printer->system))
+    {
+      if ((printer->device = papplDeviceOpen(printer->device_uri, job->name, papplLogDevice, job->system)) != NULL)
+      {
+	if (printer->device_retry)
+	{
+	  papplLogPrinter(printer, PAPPL_LOGLEVEL_INFO, "Device '%s' is available again.", printer->device_uri);
+
+	  printer->device_retry   = 0;
+	  printer->device_backoff = 0;
+	  printer->state_reasons  &= (pappl_preason_t)~PAPPL_PREASON_OFFLINE;
+	}
+      }
+      else if (!printer->is_deleted && !job->is_canceled)
+      {
+	// Schedule another attempt using a jittered exponential backoff - the
+	// system main loop requeues the printer once the delay has passed...
+	if (!printer->device_retry)
+	  papplLogPrinter(printer, PAPPL_LOGLEVEL_ERROR, "Unable to open device '%s', pausing queue until printer becomes available.", printer->device_uri);
+
+	if (printer->device_backoff < _PAPPL_DEVICE_RETRY_MIN)
+	  printer->device_backoff = _PAPPL_DEVICE_RETRY_MIN;
+	else if ((printer->device_backoff *= 2) > _PAPPL_DEVICE_RETRY_MAX)
+	  printer->device_backoff = _PAPPL_DEVICE_RETRY_MAX;
+
+	delay                  = printer->device_backoff + (int)(papplGetRand() % (unsigned)(printer->device_backoff / 2 + 1));
+	printer->device_retry  = time(NULL) + delay;
+	printer->state_reasons |= PAPPL_PREASON_OFFLINE;
+	printer->state_time    = time(NULL);
+	printer->generation ++;
+
+	papplLogPrinter(printer, PAPPL_LOGLEVEL_DEBUG, "Retrying device in %d seconds.", delay);
       }
+    }
 
-      pthread_rwlock_unlock(&printer->rwlock);
-      sleep(5);
-      pthread_rwlock_wrlock(&printer->rwlock);
+    if (printer->device)
+    {
+      job->device         = printer->device;
+      printer->device_job = job;
     }
   }
 
-  if (!papplSystemIsRunning(printer->system))
+  if (!job->device && !printer->is_deleted && !job->is_canceled)
   {
-    job->state = IPP_JSTATE_PENDING;
+    // Put the job back in the queue...
+    pthread_rwlock_wrlock(&job->rwlock);
+
+    job->state      = IPP_JSTATE_PENDING;
+    job->processing = 0;
+    job->bufpool    = NULL;
+
+    // Streamed jobs are aborted by the caller since the data can't wait for
+    // the device to come back.  Jobs that can't be queued are aborted by
+    // finish_job()...
+    if (!job->streaming && !_papplPrinterAddPendingJobNoLock(printer, job))
+      job->state = IPP_JSTATE_ABORTED;
+    else
+      _papplSystemAddEventNoLock(job->system, job->printer, job, PAPPL_EVENT_JOB_STATE_CHANGED, NULL);
 
-    pthread_rwlock_rdlock(&job->rwlock);
-    _papplSystemAddEventNoLock(job->system, job->printer, job, PAPPL_EVENT_JOB_STATE_CHANGED, NULL);
     pthread_rwlock_unlock(&job->rwlock);
+
+    release_job(job);
   }
 
-  if (printer->device)
+  if (job->device)
   {
     // Move the printer to the 'processing' state...
     printer->state      = IPP_PSTATE_PROCESSING;
     printer->state_time = time(NULL);
+    printer->generation ++;
   }
 
   _papplSystemAddEventNoLock(printer->system, printer, NULL, PAPPL_EVENT_PRINTER_STATE_CHANGED, NULL);
 
   pthread_rwlock_unlock(&printer->rwlock);
 
-  return (printer->device != NULL);
+  return (job->device != NULL);
+}
+
+
+//
+// 'write_lines()' - Write queued lines from a raster line pipeline.
+//
+
+static void *				// O - Thread exit status
+write_lines(_pappl_rpipe_t *rpipe)	// I - Raster pipeline
+{
+  const unsigned char	*line;		// Current line
+  unsigned		y;		// Current line number
+  bool			ok;		// Did the line write?
+  struct timeval	starttime,	// Start of write
+			endtime;	// End of write
+
+
+  pthread_mutex_lock(&rpipe->mutex);
+
+  for (;;)
+  {
+    // Wait for the next line...
+    while (rpipe->count == 0 && !rpipe->done)
+      pthread_cond_wait(&rpipe->cond, &rpipe->mutex);
+
+    if (rpipe->count == 0)
+      break;
+
+    line = rpipe->buffer + rpipe->first * rpipe->linesize;
+    y    = rpipe->ys[rpipe->first];
+
+    // Write the line without holding the lock so that the next lines can be
+    // queued...
+    pthread_mutex_unlock(&rpipe->mutex);
+
+    gettimeofday(&starttime, NULL);
+    ok = (rpipe->writeline_cb)(rpipe->job, rpipe->options, rpipe->device, y, line);
+    gettimeofday(&endtime, NULL);
+
+    pthread_mutex_lock(&rpipe->mutex);
+
+    if (!ok)
+      rpipe->error = true;
+
+    rpipe->lines ++;
+    rpipe->write_usecs += (size_t)(1000000 * (endtime.tv_sec - starttime.tv_sec) + (endtime.tv_usec - starttime.tv_usec));
+
+    // Release the line buffer...
+    rpipe->first = (rpipe->first + 1) % rpipe->num_lines;
+    rpipe->count --;
+
+    pthread_cond_broadcast(&rpipe->cond);
+  }
+
+  pthread_mutex_unlock(&rpipe->mutex);
+
+  return (NULL);
 }
@@ -13,6 +13,116 @@
 //
 
 #include "pappl-private.h"
+#include "device-private.h"
+
+
+//
+// Local constants...
+//
+
+#define _PAPPL_BUFFER_ALIGN	64	// Alignment of raster buffers
+#define _PAPPL_BUFFER_CLASSES	11	// Number of size classes (4k to 4M)
+#define _PAPPL_BUFFER_FREE	4	// Maximum free buffers per size class
+#define _PAPPL_BUFFER_MIN	4096	// Size of the smallest size class
+
+
+//
+// Local types...
+//
+
+typedef struct _pappl_buffer_s		// Raster buffer header
+{
+  struct _pappl_buffer_s *prev,		// Previous buffer in list
+			*next;		// Next buffer in list
+  _pappl_bufpool_t	*pool;		// Pool or `NULL` if not pooled
+  int			sizeclass;	// Size class or `-1` if not pooled
+  void			*data;		// Allocated memory
+} _pappl_buffer_t;
+
+struct _pappl_bufpool_s			// Raster buffer pool
+{
+  pthread_mutex_t	mutex;		// Mutex for buffers
+  _pappl_buffer_t	*free[_PAPPL_BUFFER_CLASSES],
+					// Free buffers by size class
+			*used;		// Buffers in use
+  size_t		num_free[_PAPPL_BUFFER_CLASSES];
+					// Number of free buffers by size class
+};
+
+typedef struct _pappl_fair_share_s	// Fair share credit for a user
+{
+  char		username[256];		// User name (key)
+  size_t	credit;			// Credit of the user's last queued job
+} _pappl_fair_share_t;
+
+
+//
+// Local functions...
+//
+
+static int	compare_fair_shares(_pappl_fair_share_t *a, _pappl_fair_share_t *b);
+static int	compare_pending_jobs(pappl_job_t *a, pappl_job_t *b);
+static void	sift_pending_down(pappl_printer_t *printer, size_t idx);
+static void	sift_pending_up(pappl_printer_t *printer, size_t idx);
+
+
+//
+// '_papplBufPoolCreate()' - Create a raster buffer pool.
+//
+// Each job worker thread has a pool of raster buffers that is used for all of
+// the jobs it processes, so that line and band buffers are reused from page to
+// page and job to job instead of being allocated every time.
+//
+
+_pappl_bufpool_t *			// O - Buffer pool or `NULL` on error
+_papplBufPoolCreate(void)
+{
+  _pappl_bufpool_t	*pool;		// Buffer pool
+
+
+  if ((pool = calloc(1, sizeof(_pappl_bufpool_t))) != NULL)
+    pthread_mutex_init(&pool->mutex, NULL);
+
+  return (pool);
+}
+
+
+//
+// '_papplBufPoolDelete()' - Free a raster buffer pool and its buffers.
+//
+
+void
+_papplBufPoolDelete(
+    _pappl_bufpool_t *pool)		// I - Buffer pool
+{
+  int			i;		// Looping var
+  _pappl_buffer_t	*buffer,	// Current buffer
+			*next;		// Next buffer
+
+
+  if (!pool)
+    return;
+
+  for (i = 0; i < _PAPPL_BUFFER_CLASSES; i ++)
+  {
+    for (buffer = pool->free[i]; buffer; buffer = next)
+    {
+      next = buffer->next;
+      free(buffer->data);
+    }
+  }
+
+  // Free any buffers that were not released...
+  for (buffer = pool->used; buffer; buffer = next)
+  {
+    next = buffer->next;
+    free(buffer->data);
+  }
+
+  pthread_mutex_destroy(&pool->mutex);
+
+  free(pool);
+}
 
 
 //
@@ -32,12 +142,15 @@ papplJobCancel(pappl_job_t *job)	// I - Job
   pthread_rwlock_wrlock(&job->printer->rwlock);
   pthread_rwlock_wrlock(&job->rwlock);
 
-  if (job->state == IPP_JSTATE_PROCESSING || (job->state == IPP_JSTATE_HELD && job->fd >= 0))
+  if (job->state == IPP_JSTATE_PROCESSING || job->printer->processing_job == job || (job->state == IPP_JSTATE_HELD && job->fd >= 0))
   {
+    // Let the job worker finish the job...
     job->is_canceled = true;
   }
   else
   {
+    _papplPrinterRemovePendingJobNoLock(job->printer, job);
+
     job->state     = IPP_JSTATE_CANCELED;
     job->completed = time(NULL);
 
@@ -96,15 +209,18 @@ _papplJobCreate(
   }
 
   pthread_rwlock_init(&job->rwlock, NULL);
-
-  job->attrs   = ippNew();
-  job->fd      = -1;
-  job->format  = format;
-  job->name    = job_name;
-  job->printer = printer;
-  job->state   = IPP_JSTATE_HELD;
-  job->system  = printer->system;
-  job->created = time(NULL);
+  pthread_mutex_init(&job->spool_mutex, NULL);
+  pthread_cond_init(&job->spool_cond, NULL);
+
+  job->attrs         = ippNew();
+  job->fd            = -1;
+  job->format        = format;
+  job->name          = job_name;
+  job->printer       = printer;
+  job->state         = IPP_JSTATE_HELD;
+  job->system        = printer->system;
+  job->created       = time(NULL);
+  job->pending_index = -1;
 
   if (attrs)
   {
@@ -227,7 +343,13 @@ _papplJobDelete(pappl_job_t *job)	// I - Job
 {
   papplLogJob(job, PAPPL_LOGLEVEL_INFO, "Removing job from history.");
 
+  // Make sure the scheduler doesn't hold on to the job (the caller holds the
+  // printer's writer lock)...
+  _papplPrinterRemovePendingJobNoLock(job->printer, job);
+
   pthread_rwlock_destroy(&job->rwlock);
+  pthread_mutex_destroy(&job->spool_mutex);
+  pthread_cond_destroy(&job->spool_cond);
 
   ippDelete(job->attrs);
 
@@ -241,6 +363,97 @@ _papplJobDelete(pappl_job_t *job)	// I - Job
 }
 
 
+//
+// 'papplJobGetBuffer()' - Get a raster buffer for a job.
+//
+// This function returns a buffer of at least "size" bytes that is aligned to
+// 64 bytes, suitable for raster lines and bands that are processed using SIMD
+// instructions.  The contents of the buffer are undefined.
+//
+// While a job is being processed, buffers come from the pool of the thread
+// that processes the job and are reused by later pages and jobs, so drivers
+// can get and release scratch buffers in their raster callbacks without the
+// cost of allocating memory each time.
+//
+// Release the buffer using the @link papplJobReleaseBuffer@ function.
+//
+
+void *					// O - Buffer or `NULL` on error
+papplJobGetBuffer(pappl_job_t *job,	// I - Job
+                  size_t      size)	// I - Minimum size in bytes
+{
+  _pappl_bufpool_t	*pool;		// Buffer pool
+  _pappl_buffer_t	*buffer = NULL;	// Buffer
+  int			sizeclass;	// Size class
+  size_t		classsize;	// Size of size class
+  void			*data;		// Allocated memory
+  unsigned char		*ptr;		// Aligned pointer
+
+
+  if (!job || size == 0)
+    return (NULL);
+
+  // Figure out the size class...
+  for (sizeclass = 0, classsize = _PAPPL_BUFFER_MIN; sizeclass < _PAPPL_BUFFER_CLASSES && classsize < size; sizeclass ++, classsize *= 2);
+
+  if (sizeclass >= _PAPPL_BUFFER_CLASSES || (pool = job->bufpool) == NULL)
+  {
+    // Not pooled...
+    pool      = NULL;
+    sizeclass = -1;
+    classsize = size;
+  }
+  else
+  {
+    // Reuse a free buffer as needed...
+    pthread_mutex_lock(&pool->mutex);
+
+    if ((buffer = pool->free[sizeclass]) != NULL)
+    {
+      pool->free[sizeclass] = buffer->next;
+      pool->num_free[sizeclass] --;
+    }
+
+    pthread_mutex_unlock(&pool->mutex);
+  }
+
+  if (!buffer)
+  {
+    // Allocate a new buffer with room for the header and alignment...
+    if ((data = malloc(classsize + sizeof(_pappl_buffer_t) + _PAPPL_BUFFER_ALIGN)) == NULL)
+    {
+      papplLogJob(job, PAPPL_LOGLEVEL_ERROR, "Unable to allocate %lu bytes for raster buffer: %s", (unsigned long)classsize, strerror(errno));
+      return (NULL);
+    }
+
+    ptr    = (unsigned char *)data + sizeof(_pappl_buffer_t);
+    ptr    += (_PAPPL_BUFFER_ALIGN - ((size_t)ptr & (_PAPPL_BUFFER_ALIGN - 1))) & (_PAPPL_BUFFER_ALIGN - 1);
+    buffer = (_pappl_buffer_t *)ptr - 1;
+
+    buffer->pool      = pool;
+    buffer->sizeclass = sizeclass;
+    buffer->data      = data;
+  }
+
+  // Track the buffer while it is in use...
+  buffer->prev = NULL;
+  buffer->next = NULL;
+
+  if (pool)
+  {
+    pthread_mutex_lock(&pool->mutex);
+
+    if ((buffer->next = pool->used) != NULL)
+      buffer->next->prev = buffer;
+    pool->used = buffer;
+
+    pthread_mutex_unlock(&pool->mutex);
+  }
+
+  return (buffer + 1);
+}
+
+
 //
 // 'papplJobOpenFile()' - Create or open a file for the document in a job.
 //
@@ -250,9 +463,9 @@ _papplJobDelete(pappl_job_t *job)	// I - Job
 // (title), and "ext" values.  The job name is "sanitized" to only contain
 // alphanumeric characters.
 //
-// The "mode" argument is "r" to read an existing job file or "w" to write a
-// new job file.  New files are created with restricted permissions for
-// security purposes.
+// The "mode" argument is "r" to read an existing job file, "w" to write a
+// new job file, or "w+" to read and write a new job file.  New files are
+// created with restricted permissions for security purposes.
 //
 
 int					// O - File descriptor or -1 on error
@@ -262,7 +475,7 @@ papplJobOpenFile(
     size_t      fnamesize,		// I - Size of filename buffer
     const char  *directory,		// I - Directory to store in (`NULL` for default)
     const char  *ext,			// I - Extension (`NULL` for default)
-    const char  *mode)			// I - Open mode - "r" for reading or "w" for writing
+    const char  *mode)			// I - Open mode - "r" for reading, "w" for writing, or "w+" for reading and writing
 {
   char			name[64],	// "Safe" filename
 			*nameptr;	// Pointer into filename
@@ -350,6 +563,8 @@ papplJobOpenFile(
     return (open(fname, O_RDONLY | O_NOFOLLOW | O_CLOEXEC | O_BINARY));
   else if (!strcmp(mode, "w"))
     return (open(fname, O_WRONLY | O_CREAT | O_TRUNC | O_NOFOLLOW | O_CLOEXEC | O_BINARY, 0600));
+  else if (!strcmp(mode, "w+"))
+    return (open(fname, O_RDWR | O_CREAT | O_TRUNC | O_NOFOLLOW | O_CLOEXEC | O_BINARY, 0600));
   else if (!strcmp(mode, "x"))
     return (unlink(fname));
   else
@@ -357,6 +572,152 @@ papplJobOpenFile(
 }
 
 
+//
+// 'papplJobReadFile()' - Read document data from a job file.
+//
+// This function reads document data from a file descriptor that was opened for
+// the job's document file, returning the number of bytes read, `0` at the end
+// of the document, or `-1` on error.
+//
+// Document data may still be arriving from the Client when a filter registered
+// with the @link papplSystemAddStreamingMIMEFilter@ function starts
+// processing the job.  In that case this function waits for more data rather
+// than returning a premature end-of-file.  If the Client fails to send the
+// whole document, `-1` is returned.  A canceled job is reported as the end of
+// the document.
+//
+
+ssize_t					// O - Number of bytes read, `0` at end of document, or `-1` on error
+papplJobReadFile(pappl_job_t *job,	// I - Job
+                 int         fd,	// I - File descriptor
+                 void        *buffer,	// I - Buffer
+                 size_t      bytes)	// I - Size of buffer
+{
+  ssize_t	rbytes;			// Bytes read
+  off_t		offset;			// Current file offset
+
+
+  // Range check input...
+  if (!job || fd < 0 || !buffer || bytes == 0)
+  {
+    errno = EINVAL;
+    return (-1);
+  }
+
+  while ((rbytes = read(fd, buffer, bytes)) <= 0)
+  {
+    if (rbytes < 0 && errno != EINTR && errno != EAGAIN)
+      break;
+
+    if (papplJobIsCanceled(job))
+    {
+      rbytes = 0;
+      break;
+    }
+
+    pthread_mutex_lock(&job->spool_mutex);
+
+    if (job->spool_error)
+    {
+      // Client did not send the whole document...
+      pthread_mutex_unlock(&job->spool_mutex);
+      errno  = EIO;
+      rbytes = -1;
+      break;
+    }
+
+    offset = lseek(fd, 0, SEEK_CUR);
+
+    if (offset < 0 || (size_t)offset >= job->spool_bytes)
+    {
+      if (!job->spooling)
+      {
+        // All of the document data has been read...
+        pthread_mutex_unlock(&job->spool_mutex);
+        break;
+      }
+      else
+      {
+        // Wait up to 1 second for more data...
+	struct timeval	curtime;	// Current time
+	struct timespec	timeout;	// Timeout
+
+	gettimeofday(&curtime, NULL);
+	timeout.tv_sec  = curtime.tv_sec + 1;
+	timeout.tv_nsec = curtime.tv_usec * 1000;
+
+        pthread_cond_timedwait(&job->spool_cond, &job->spool_mutex, &timeout);
+      }
+    }
+
+    pthread_mutex_unlock(&job->spool_mutex);
+  }
+
+  return (rbytes);
+}
+
+
+//
+// 'papplJobReleaseBuffer()' - Release a raster buffer for a job.
+//
+// This function releases a buffer that was returned by the
+// @link papplJobGetBuffer@ function.  Pooled buffers are kept so that later
+// calls to @link papplJobGetBuffer@ can reuse them, while other buffers are
+// freed.  The buffer must not be used after calling this function.
+//
+
+void
+papplJobReleaseBuffer(
+    pappl_job_t *job,			// I - Job
+    void        *buffer)		// I - Buffer
+{
+  _pappl_bufpool_t	*pool;		// Buffer pool
+  _pappl_buffer_t	*bufhdr;	// Buffer header
+
+
+  (void)job;
+
+  if (!buffer)
+    return;
+
+  bufhdr = (_pappl_buffer_t *)buffer - 1;
+
+  if ((pool = bufhdr->pool) == NULL)
+  {
+    // Not pooled...
+    free(bufhdr->data);
+    return;
+  }
+
+  pthread_mutex_lock(&pool->mutex);
+
+  // Remove from the list of buffers in use...
+  if (bufhdr->prev)
+    bufhdr->prev->next = bufhdr->next;
+  else
+    pool->used = bufhdr->next;
+
+  if (bufhdr->next)
+    bufhdr->next->prev = bufhdr->prev;
+
+  // Then add to the free list or free it if there are enough free buffers...
+  if (pool->num_free[bufhdr->sizeclass] < _PAPPL_BUFFER_FREE)
+  {
+    bufhdr->prev                  = NULL;
+    bufhdr->next                  = pool->free[bufhdr->sizeclass];
+    pool->free[bufhdr->sizeclass] = bufhdr;
+    pool->num_free[bufhdr->sizeclass] ++;
+
+    bufhdr = NULL;
+  }
+
+  pthread_mutex_unlock(&pool->mutex);
+
+  if (bufhdr)
+    free(bufhdr->data);
+}
+
+
 //
 // '_papplJobRemoveFile()' - Remove a file in spool directory
 //
@@ -392,6 +753,10 @@ _papplJobSubmitFile(
     pappl_job_t *job,			// I - Job
     const char  *filename)		// I - Filename
 {
+  bool		queued;			// Was the job queued?
+  size_t	dirlen;			// Length of spool directory
+
+
   if (!job->format)
   {
     // Open the file
@@ -452,52 +817,147 @@ _papplJobSubmitFile(
   // Save the print file information...
   if ((job->filename = strdup(filename)) != NULL)
   {
-    // Process the job...
+    // Queue the job for processing...
+    pthread_rwlock_wrlock(&job->printer->rwlock);
     job->state = IPP_JSTATE_PENDING;
+    queued     = _papplPrinterAddPendingJobNoLock(job->printer, job);
+    pthread_rwlock_unlock(&job->printer->rwlock);
 
-    _papplPrinterCheckJobs(job->printer);
+    if (queued)
+    {
+      _papplPrinterCheckJobs(job->printer);
+      return;
+    }
   }
   else
   {
-    // Abort the job...
-    size_t dirlen = strlen(job->system->directory);
-					// Length of spool directory
+    papplLogJob(job, PAPPL_LOGLEVEL_ERROR, "Unable to allocate filename.");
+  }
 
-    job->state     = IPP_JSTATE_ABORTED;
-    job->completed = time(NULL);
+  // Abort the job...
+  dirlen = strlen(job->system->directory);
 
-    papplLogJob(job, PAPPL_LOGLEVEL_ERROR, "Unable to allocate filename.");
+  job->state     = IPP_JSTATE_ABORTED;
+  job->completed = time(NULL);
 
-    if (!strncmp(filename, job->system->directory, dirlen) && filename[dirlen] == '/')
-      unlink(filename);
+  if (!strncmp(filename, job->system->directory, dirlen) && filename[dirlen] == '/')
+    unlink(filename);
 
-    pthread_rwlock_wrlock(&job->printer->rwlock);
-    cupsArrayRemove(job->printer->active_jobs, job);
-    cupsArrayAdd(job->printer->completed_jobs, job);
-    pthread_rwlock_unlock(&job->printer->rwlock);
+  pthread_rwlock_wrlock(&job->printer->rwlock);
+  cupsArrayRemove(job->printer->active_jobs, job);
+  cupsArrayAdd(job->printer->completed_jobs, job);
+  pthread_rwlock_unlock(&job->printer->rwlock);
 
-    if (!job->system->clean_time)
-      job->system->clean_time = time(NULL) + 60;
+  if (!job->system->clean_time)
+    job->system->clean_time = time(NULL) + 60;
+}
+
+
+//
+// '_papplPrinterAddPendingJobNoLock()' - Add a pending job to the scheduler.
+//
+// Pending jobs are kept in a binary heap ordered by "job-priority" (highest
+// first), then fair share credit (lowest first), then job ID.  The fair share
+// credit implements start-time fair queuing: each new job is stamped with one
+// more than the larger of the user's previous credit and the credit of the
+// last job that was started, so a large batch of jobs from one user is
+// interleaved with the jobs from other users instead of delaying them.
+//
+// Jobs that are put back in the queue keep their original credit.
+//
+// `false` is returned if the heap cannot be grown, in which case the caller
+// must abort the job since it will never be scheduled.
+//
+
+bool					// O - `true` on success, `false` on error
+_papplPrinterAddPendingJobNoLock(
+    pappl_printer_t *printer,		// I - Printer
+    pappl_job_t     *job)		// I - Job
+{
+  ipp_attribute_t	*attr;		// "job-priority" attribute
+  _pappl_fair_share_t	key,		// Search key
+			*share;		// Fair share for user
+  pappl_job_t		**temp;		// New pending jobs array
+  size_t		alloc;		// New allocation size
+
+
+  if (job->pending_index >= 0)
+    return (true);
+
+  // Make room in the heap as needed...
+  if (printer->num_pending_jobs >= printer->alloc_pending_jobs)
+  {
+    alloc = printer->alloc_pending_jobs + 16;
+
+    if ((temp = realloc(printer->pending_jobs, alloc * sizeof(pappl_job_t *))) == NULL)
+    {
+      papplLogJob(job, PAPPL_LOGLEVEL_ERROR, "Unable to allocate memory for pending jobs: %s", strerror(errno));
+      return (false);
+    }
+
+    printer->pending_jobs       = temp;
+    printer->alloc_pending_jobs = alloc;
   }
+
+  if ((attr = ippFindAttribute(job->attrs, "job-priority", IPP_TAG_INTEGER)) != NULL)
+    job->priority = ippGetInteger(attr, 0);
+  else
+    job->priority = 50;
+
+  if (!job->fair_share)
+  {
+    // Assign a fair share credit for the job...
+    if (!printer->fair_shares)
+      printer->fair_shares = cupsArrayNew((cups_array_cb_t)compare_fair_shares, NULL, NULL, 0, NULL, (cups_afree_cb_t)free);
+
+    papplCopyString(key.username, job->username ? job->username : "", sizeof(key.username));
+
+    if ((share = (_pappl_fair_share_t *)cupsArrayFind(printer->fair_shares, &key)) == NULL && (share = (_pappl_fair_share_t *)calloc(1, sizeof(_pappl_fair_share_t))) != NULL)
+    {
+      papplCopyString(share->username, key.username, sizeof(share->username));
+      cupsArrayAdd(printer->fair_shares, share);
+    }
+
+    if (share && share->credit > printer->fair_share_time)
+      job->fair_share = share->credit + 1;
+    else
+      job->fair_share = printer->fair_share_time + 1;
+
+    if (share)
+      share->credit = job->fair_share;
+  }
+
+  papplLogJob(job, PAPPL_LOGLEVEL_DEBUG, "Queued with priority %d and fair share %lu.", job->priority, (unsigned long)job->fair_share);
+
+  // Add the job to the end of the heap and move it up to its place...
+  job->pending_index = (int)printer->num_pending_jobs;
+  printer->pending_jobs[printer->num_pending_jobs ++] = job;
+
+  sift_pending_up(printer, (size_t)job->pending_index);
+
+  return (true);
 }
 
 
 //
 // '_papplPrinterCheckJobs()' - Check for new jobs to process.
 //
+// Jobs are processed by the system's job worker threads.  This function queues
+// the printer for a worker if it has a pending job and isn't already printing.
+//
 
 void
 _papplPrinterCheckJobs(
     pappl_printer_t *printer)		// I - Printer
 {
-  pappl_job_t	*job;			// Current job
+  bool	pending;			// Are there pending jobs?
 
 
   papplLogPrinter(printer, PAPPL_LOGLEVEL_DEBUG, "Checking for new jobs to process.");
 
-  if (printer->processing_job)
+  if (printer->num_processing_jobs >= printer->max_processing_jobs)
   {
-    papplLogPrinter(printer, PAPPL_LOGLEVEL_DEBUG, "Printer is already processing job %d.", printer->processing_job->job_id);
+    papplLogPrinter(printer, PAPPL_LOGLEVEL_DEBUG, "Printer is already processing %d job(s).", printer->num_processing_jobs);
     return;
   }
   else if (printer->is_deleted)
@@ -510,41 +970,20 @@ _papplPrinterCheckJobs(
     papplLogPrinter(printer, PAPPL_LOGLEVEL_DEBUG, "Printer is stopped.");
     return;
   }
-
-  pthread_rwlock_wrlock(&printer->rwlock);
-
-  // Enumerate the jobs.  Since we have a writer (exclusive) lock, we are the
-  // only thread enumerating and can use cupsArrayGetFirst/Last...
-
-  for (job = (pappl_job_t *)cupsArrayGetFirst(printer->active_jobs); job; job = (pappl_job_t *)cupsArrayGetNext(printer->active_jobs))
+  else if (printer->device_retry > time(NULL))
   {
-    if (job->state == IPP_JSTATE_PENDING)
-    {
-      pthread_t	t;			// Thread
-
-      papplLogPrinter(printer, PAPPL_LOGLEVEL_DEBUG, "Starting job %d.", job->job_id);
-
-      if (pthread_create(&t, NULL, (void *(*)(void *))_papplJobProcess, job))
-      {
-	job->state     = IPP_JSTATE_ABORTED;
-	job->completed = time(NULL);
-
-	cupsArrayRemove(printer->active_jobs, job);
-	cupsArrayAdd(printer->completed_jobs, job);
-
-	if (!printer->system->clean_time)
-	  printer->system->clean_time = time(NULL) + 60;
-      }
-      else
-	pthread_detach(t);
-      break;
-    }
+    papplLogPrinter(printer, PAPPL_LOGLEVEL_DEBUG, "Waiting for device to become available.");
+    return;
   }
 
-  if (!job)
-    papplLogPrinter(printer, PAPPL_LOGLEVEL_DEBUG, "No jobs to process at this time.");
-
+  pthread_rwlock_rdlock(&printer->rwlock);
+  pending = printer->num_pending_jobs > 0;
   pthread_rwlock_unlock(&printer->rwlock);
+
+  if (pending)
+    _papplSystemQueuePrinter(printer->system, printer);
+  else
+    papplLogPrinter(printer, PAPPL_LOGLEVEL_DEBUG, "No jobs to process at this time.");
 }
 
 
@@ -588,6 +1027,103 @@ _papplPrinterCleanJobsNoLock(
 }
 
 
+//
+// '_papplPrinterCloseIdleDevice()' - Close a printer's idle device.
+//
+// The device is closed once it has been idle for longer than the printer's
+// linger time, or immediately when "force" is `true`.  Devices that are in
+// use by a job or @link papplPrinterOpenDevice@ are left open.
+//
+
+void
+_papplPrinterCloseIdleDevice(
+    pappl_printer_t *printer,		// I - Printer
+    bool            force)		// I - Close regardless of the linger time?
+{
+  pappl_devmetrics_t	metrics;	// Metrics for device IO
+
+
+  if (!printer->device || printer->device_in_use || printer->processing_job)
+    return;
+
+  pthread_rwlock_wrlock(&printer->rwlock);
+
+  if (printer->device && !printer->device_in_use && !printer->processing_job && (force || (time(NULL) - printer->device_time) >= printer->device_linger))
+  {
+    papplDeviceGetMetrics(printer->device, &metrics);
+    papplLogPrinter(printer, PAPPL_LOGLEVEL_DEBUG, "Device read metrics: %lu requests, %lu bytes, %lu msecs", (unsigned long)metrics.read_requests, (unsigned long)metrics.read_bytes, (unsigned long)metrics.read_msecs);
+    papplLogPrinter(printer, PAPPL_LOGLEVEL_DEBUG, "Device write metrics: %lu requests, %lu bytes, %lu msecs", (unsigned long)metrics.write_requests, (unsigned long)metrics.write_bytes, (unsigned long)metrics.write_msecs);
+    papplLogPrinter(printer, PAPPL_LOGLEVEL_DEBUG, "Device reuse metrics: %lu reuses", (unsigned long)printer->device->reuses);
+
+    papplDeviceClose(printer->device);
+    printer->device = NULL;
+  }
+
+  pthread_rwlock_unlock(&printer->rwlock);
+}
+
+
+//
+// '_papplPrinterNextJob()' - Get the next job to process.
+//
+// This function is called by a job worker thread.  The returned job is
+// counted against the printer's maximum number of processing jobs until it is
+// finished.
+//
+
+pappl_job_t *				// O - Next job or `NULL` for none
+_papplPrinterNextJob(
+    pappl_printer_t *printer)		// I - Printer
+{
+  pappl_job_t	*job = NULL;		// Current job
+
+
+  pthread_rwlock_wrlock(&printer->rwlock);
+
+  if (printer->num_processing_jobs < printer->max_processing_jobs && !printer->is_deleted && printer->state != IPP_PSTATE_STOPPED && !printer->is_stopped && printer->device_retry <= time(NULL))
+  {
+    // Take the first pending job from the scheduler, skipping any that are no
+    // longer pending...
+    while (printer->num_pending_jobs > 0)
+    {
+      job = printer->pending_jobs[0];
+
+      _papplPrinterRemovePendingJobNoLock(printer, job);
+
+      if (job->state == IPP_JSTATE_PENDING)
+      {
+	papplLogPrinter(printer, PAPPL_LOGLEVEL_DEBUG, "Starting job %d.", job->job_id);
+
+	// Claim the job so that no other worker starts it...
+	pthread_rwlock_wrlock(&job->rwlock);
+	job->state = IPP_JSTATE_PROCESSING;
+	pthread_rwlock_unlock(&job->rwlock);
+
+	printer->processing_job = job;
+	printer->num_processing_jobs ++;
+
+	if (job->fair_share > printer->fair_share_time)
+	  printer->fair_share_time = job->fair_share;
+	break;
+      }
+
+      job = NULL;
+    }
+
+    if (printer->num_pending_jobs == 0)
+    {
+      // Nothing else is queued, start over with fresh credits...
+      cupsArrayClear(printer->fair_shares);
+      printer->fair_share_time = 0;
+    }
+  }
+
+  pthread_rwlock_unlock(&printer->rwlock);
+
+  return (job);
+}
+
+
 //
 // 'papplPrinterFindJob()' - Find a job.
 //
@@ -613,6 +1149,38 @@ papplPrinterFindJob(
 }
 
 
+//
+// '_papplPrinterRemovePendingJobNoLock()' - Remove a job from the scheduler.
+//
+
+void
+_papplPrinterRemovePendingJobNoLock(
+    pappl_printer_t *printer,		// I - Printer
+    pappl_job_t     *job)		// I - Job
+{
+  size_t	idx;			// Index of job in heap
+  pappl_job_t	*last;			// Last job in heap
+
+
+  if (job->pending_index < 0)
+    return;
+
+  idx                = (size_t)job->pending_index;
+  job->pending_index = -1;
+  last               = printer->pending_jobs[-- printer->num_pending_jobs];
+
+  if (last != job)
+  {
+    // Move the last job into the hole and restore the heap order...
+    printer->pending_jobs[idx] = last;
+    last->pending_index        = (int)idx;
+
+    sift_pending_up(printer, idx);
+    sift_pending_down(printer, (size_t)last->pending_index);
+  }
+}
+
+
 //
 // 'papplSystemCleanJobs()' - Clean out old (completed) jobs.
 //
@@ -651,3 +1219,103 @@ papplSystemCleanJobs(
 
   pthread_rwlock_unlock(&system->rwlock);
 }
+
+
+//
+// 'compare_fair_shares()' - Compare two fair share credits.
+//
+
+static int				// O - Result of comparison
+compare_fair_shares(
+    _pappl_fair_share_t *a,		// I - First fair share
+    _pappl_fair_share_t *b)		// I - Second fair share
+{
+  return (strcmp(a->username, b->username));
+}
+
+
+//
+// 'compare_pending_jobs()' - Compare the scheduling order of two jobs.
+//
+// Returns a negative value if job "a" should be processed before job "b".
+//
+
+static int				// O - Result of comparison
+compare_pending_jobs(pappl_job_t *a,	// I - First job
+                     pappl_job_t *b)	// I - Second job
+{
+  if (a->priority != b->priority)
+    return (b->priority - a->priority);
+  else if (a->fair_share < b->fair_share)
+    return (-1);
+  else if (a->fair_share > b->fair_share)
+    return (1);
+  else
+    return (a->job_id - b->job_id);
+}
+
+
+//
+// 'sift_pending_down()' - Move a pending job down the heap.
+//
+
+static void
+sift_pending_down(
+    pappl_printer_t *printer,		// I - Printer
+    size_t          idx)		// I - Index of job
+{
+  size_t	child;			// Index of child
+  pappl_job_t	**jobs = printer->pending_jobs,
+					// Pending jobs
+		*job = jobs[idx];	// Job to move
+
+
+  while ((child = 2 * idx + 1) < printer->num_pending_jobs)
+  {
+    // Use the child that should be processed first...
+    if ((child + 1) < printer->num_pending_jobs && compare_pending_jobs(jobs[child + 1], jobs[child]) < 0)
+      child ++;
+
+    if (compare_pending_jobs(job, jobs[child]) <= 0)
+      break;
+
+    jobs[idx]                = jobs[child];
+    jobs[idx]->pending_index = (int)idx;
+    idx                      = child;
+  }
+
+  jobs[idx]          = job;
+  job->pending_index = (int)idx;
+}
+
+
+//
+// 'sift_pending_up()' - Move a pending job up the heap.
+//
+
+static void
+sift_pending_up(
+    pappl_printer_t *printer,		// I - Printer
+    size_t          idx)		// I - Index of job
+{
+  size_t	parent;			// Index of parent
+  pappl_job_t	**jobs = printer->pending_jobs,
+					// Pending jobs
+		*job = jobs[idx];	// Job to move
+
+
+  while (idx > 0)
+  {
+    parent = (idx - 1) / 2;
+
+    if (compare_pending_jobs(jobs[parent], job) <= 0)
+      break;
+
+    jobs[idx]                = jobs[parent];
+    jobs[idx]->pending_index = (int)idx;
+    idx                      = parent;
+  }
+
+  jobs[idx]          = job;
+  job->pending_index = (int)idx;
+}
@@ -61,6 +61,7 @@ extern void		papplJobDeletePrintOptions(pappl_pr_options_t *options);
 extern bool		papplJobFilterImage(pappl_job_t *job, pappl_device_t *device, pappl_pr_options_t *options, const unsigned char *pixels, int width, int height, int depth, int ppi, bool smoothing) _PAPPL_PUBLIC;
 
 extern ipp_attribute_t	*papplJobGetAttribute(pappl_job_t *job, const char *name) _PAPPL_PUBLIC;
+extern void		*papplJobGetBuffer(pappl_job_t *job, size_t size) _PAPPL_PUBLIC;
 extern void		*papplJobGetData(pappl_job_t *job) _PAPPL_PUBLIC;
 extern const char	*papplJobGetFilename(pappl_job_t *job) _PAPPL_PUBLIC;
 extern const char	*papplJobGetFormat(pappl_job_t *job) _PAPPL_PUBLIC;
@@ -79,6 +80,8 @@ extern const char	*papplJobGetUsername(pappl_job_t *job) _PAPPL_PUBLIC;
 extern bool		papplJobIsCanceled(pappl_job_t *job) _PAPPL_PUBLIC;
 
 extern int		papplJobOpenFile(pappl_job_t *job, char *fname, size_t fnamesize, const char *directory, const char *ext, const char *mode) _PAPPL_PUBLIC;
+extern ssize_t		papplJobReadFile(pappl_job_t *job, int fd, void *buffer, size_t bytes) _PAPPL_PUBLIC;
+extern void		papplJobReleaseBuffer(pappl_job_t *job, void *buffer) _PAPPL_PUBLIC;
 
 extern void		papplJobSetData(pappl_job_t *job, void *data) _PAPPL_PUBLIC;
 extern void		papplJobSetImpressions(pappl_job_t *job, int impressions) _PAPPL_PUBLIC;
@@ -1703,6 +1703,8 @@ default_system_cb(
         soptions |= PAPPL_SOPTIONS_WEB_REMOTE;
       else if (!strcmp(valptr, "web-security") || !strncmp(valptr, "web-security,", 13))
         soptions |= PAPPL_SOPTIONS_WEB_SECURITY;
+      else if (!strcmp(valptr, "web-buffer") || !strncmp(valptr, "web-buffer,", 11))
+        soptions |= PAPPL_SOPTIONS_WEB_BUFFER;
       else if (!strcmp(valptr, "no-tls") || !strncmp(valptr, "no-tls,", 7))
         soptions |= PAPPL_SOPTIONS_NO_TLS;
 
@@ -1802,6 +1804,9 @@ default_system_cb(
   if (!cupsGetOption("private-server", (cups_len_t)num_options, options))
   {
     // Listen for TCP/IP connections...
+    if ((value = cupsGetOption("listen-threads", (cups_len_t)num_options, options)) != NULL)
+      papplSystemSetListenerThreads(system, atoi(value));
+
     papplSystemAddListeners(system, cupsGetOption("listen-hostname", (cups_len_t)num_options, options));
   }
 
@@ -11,6 +11,7 @@
 // Include necessary headers...
 //
 
+#include "device-private.h"
 #include "printer-private.h"
 #include "system-private.h"
 
@@ -21,6 +22,9 @@
 // This function closes the device for a printer.  The device must have been
 // previously opened using the @link papplPrinterOpenDevice@ function.
 //
+// If the printer has a device linger time, the device is kept open for reuse
+// until it has been idle for that long.
+//
 
 void
 papplPrinterCloseDevice(
@@ -31,12 +35,22 @@ papplPrinterCloseDevice(
 
   pthread_rwlock_wrlock(&printer->rwlock);
 
-  papplDeviceClose(printer->device);
+  if (printer->device_linger > 0 && !printer->is_deleted)
+  {
+    // Keep the device open for a while...
+    printer->device_time = time(NULL);
+  }
+  else
+  {
+    papplDeviceClose(printer->device);
+    printer->device = NULL;
+  }
 
-  printer->device        = NULL;
   printer->device_in_use = false;
 
   pthread_rwlock_unlock(&printer->rwlock);
+
+  _papplPrinterCheckJobs(printer);
 }
 
 
@@ -120,6 +134,22 @@ papplPrinterGetDeviceID(
 }
 
 
+//
+// 'papplPrinterGetDeviceLinger()' - Get the device linger time.
+//
+// This function returns the number of seconds an idle device is kept open
+// for the next job, as set by the @link papplPrinterSetDeviceLinger@
+// function.
+//
+
+int					// O - Linger time in seconds or `0` to close immediately
+papplPrinterGetDeviceLinger(
+    pappl_printer_t *printer)		// I - Printer
+{
+  return (printer ? printer->device_linger : 0);
+}
+
+
 //
 // 'papplPrinterGetDeviceURI()' - Get the URI of the device associated with the
 //                                printer.
@@ -303,6 +333,23 @@ papplPrinterGetMaxPreservedJobs(
 }
 
 
+//
+// 'papplPrinterGetMaxProcessingJobs()' - Get the maximum number of jobs
+//                                        processed by the printer at once.
+//
+// This function returns the maximum number of jobs that the printer processes
+// at the same time, as configured by the
+// @link papplPrinterSetMaxProcessingJobs@ function.
+//
+
+int					// O - Maximum number of processing jobs
+papplPrinterGetMaxProcessingJobs(
+    pappl_printer_t *printer)		// I - Printer
+{
+  return (printer ? printer->max_processing_jobs : 0);
+}
+
+
 //
 // 'papplPrinterGetName()' - Get the printer name.
 //
@@ -781,8 +828,30 @@ papplPrinterOpenDevice(
 
   if (!printer->device_in_use && !printer->processing_job)
   {
-    printer->device        = device = papplDeviceOpen(printer->device_uri, "printer", papplLogDevice, printer->system);
+    if (printer->device && !_papplDeviceReuse(printer->device))
+    {
+      // Device went offline while idle, open it again...
+      papplDeviceClose(printer->device);
+      printer->device = NULL;
+    }
+
+    if (!printer->device)
+      printer->device = papplDeviceOpen(printer->device_uri, "printer", papplLogDevice, printer->system);
+
+    device                 = printer->device;
     printer->device_in_use = device != NULL;
+
+    if (device && printer->device_retry)
+    {
+      // Device is back, resume any pending jobs once it is closed...
+      papplLogPrinter(printer, PAPPL_LOGLEVEL_INFO, "Device '%s' is available again.", printer->device_uri);
+
+      printer->device_retry   = 0;
+      printer->device_backoff = 0;
+      printer->state_reasons  &= (pappl_preason_t)~PAPPL_PREASON_OFFLINE;
+      printer->state_time     = time(NULL);
+      printer->generation ++;
+    }
   }
 
   pthread_rwlock_unlock(&printer->rwlock);
@@ -862,6 +931,7 @@ papplPrinterSetContact(
 
   printer->contact     = *contact;
   printer->config_time = time(NULL);
+  printer->generation ++;
 
   pthread_rwlock_unlock(&printer->rwlock);
 
@@ -869,6 +939,35 @@ papplPrinterSetContact(
 }
 
 
+//
+// 'papplPrinterSetDeviceLinger()' - Set the device linger time.
+//
+// This function sets the number of seconds an idle device is kept open after
+// a job or @link papplPrinterCloseDevice@ so that the next job can reuse the
+// connection instead of opening the device again.  An open device is checked
+// for an "offline" status before it is reused.  The default linger time of
+// `0` closes the device as soon as it is idle.
+//
+// > Note: Do not set a linger time for "file" devices, since each job opens a
+// > new output file.
+//
+
+void
+papplPrinterSetDeviceLinger(
+    pappl_printer_t *printer,		// I - Printer
+    int             linger)		// I - Linger time in seconds or `0` to close immediately
+{
+  if (!printer || linger < 0)
+    return;
+
+  pthread_rwlock_wrlock(&printer->rwlock);
+
+  printer->device_linger = linger;
+
+  pthread_rwlock_unlock(&printer->rwlock);
+}
+
+
 //
 // 'papplPrinterSetDNSSDName()' - Set the DNS-SD service name.
 //
@@ -891,6 +990,7 @@ papplPrinterSetDNSSDName(
   printer->dns_sd_collision = false;
   printer->dns_sd_serial    = 0;
   printer->config_time      = time(NULL);
+  printer->generation ++;
 
   if (!value)
     _papplPrinterUnregisterDNSSDNoLock(printer);
@@ -930,6 +1030,7 @@ papplPrinterSetGeoLocation(
   free(printer->geo_location);
   printer->geo_location = value ? strdup(value) : NULL;
   printer->config_time  = time(NULL);
+  printer->generation ++;
 
   _papplPrinterRegisterDNSSDNoLock(printer);
 
@@ -959,6 +1060,7 @@ papplPrinterSetImpressionsCompleted(
 
   printer->impcompleted += add;
   printer->state_time   = time(NULL);
+  printer->generation ++;
 
   pthread_rwlock_unlock(&printer->rwlock);
 
@@ -986,6 +1088,7 @@ papplPrinterSetLocation(
   free(printer->location);
   printer->location    = value ? strdup(value) : NULL;
   printer->config_time = time(NULL);
+  printer->generation ++;
 
   _papplPrinterRegisterDNSSDNoLock(printer);
 
@@ -1018,6 +1121,7 @@ papplPrinterSetMaxActiveJobs(
 
   printer->max_active_jobs = max_active_jobs;
   printer->config_time     = time(NULL);
+  printer->generation ++;
 
   pthread_rwlock_unlock(&printer->rwlock);
 
@@ -1045,6 +1149,7 @@ papplPrinterSetMaxCompletedJobs(
 
   printer->max_completed_jobs = max_completed_jobs;
   printer->config_time        = time(NULL);
+  printer->generation ++;
 
   pthread_rwlock_unlock(&printer->rwlock);
 
@@ -1072,6 +1177,7 @@ papplPrinterSetMaxPreservedJobs(
 
   printer->max_preserved_jobs = max_preserved_jobs;
   printer->config_time        = time(NULL);
+  printer->generation ++;
 
   pthread_rwlock_unlock(&printer->rwlock);
 
@@ -1079,6 +1185,43 @@ papplPrinterSetMaxPreservedJobs(
 }
 
 
+//
+// 'papplPrinterSetMaxProcessingJobs()' - Set the maximum number of jobs
+//                                        processed by the printer at once.
+//
+// This function sets the maximum number of jobs that the printer processes at
+// the same time.  The default is `1`, which prints one job at a time.
+//
+// Drivers for devices that accept several concurrent connections, or that have
+// several print engines behind one queue, can use a larger value.  Each
+// additional job uses its own connection to the device.  The maximum number of
+// active jobs (@link papplPrinterSetMaxActiveJobs@) must also allow more than
+// one job to be queued.
+//
+
+void
+papplPrinterSetMaxProcessingJobs(
+    pappl_printer_t *printer,		// I - Printer
+    int             max_processing_jobs)// I - Maximum number of processing jobs
+{
+  if (!printer || max_processing_jobs < 1)
+    return;
+
+  pthread_rwlock_wrlock(&printer->rwlock);
+
+  printer->max_processing_jobs = max_processing_jobs;
+  printer->config_time         = time(NULL);
+  printer->generation ++;
+
+  pthread_rwlock_unlock(&printer->rwlock);
+
+  _papplSystemConfigChanged(printer->system);
+
+  // Start more jobs as needed...
+  _papplPrinterCheckJobs(printer);
+}
+
+
 //
 // 'papplPrinterSetNextJobID()' - Set the next "job-id" value.
 //
@@ -1101,6 +1244,7 @@ papplPrinterSetNextJobID(
 
   printer->next_job_id = next_job_id;
   printer->config_time = time(NULL);
+  printer->generation ++;
 
   pthread_rwlock_unlock(&printer->rwlock);
 
@@ -1128,6 +1272,7 @@ papplPrinterSetOrganization(
   free(printer->organization);
   printer->organization = value ? strdup(value) : NULL;
   printer->config_time  = time(NULL);
+  printer->generation ++;
 
   pthread_rwlock_unlock(&printer->rwlock);
 
@@ -1155,6 +1300,7 @@ papplPrinterSetOrganizationalUnit(
   free(printer->org_unit);
   printer->org_unit    = value ? strdup(value) : NULL;
   printer->config_time = time(NULL);
+  printer->generation ++;
 
   pthread_rwlock_unlock(&printer->rwlock);
 
@@ -1185,6 +1331,7 @@ papplPrinterSetPrintGroup(
   free(printer->print_group);
   printer->print_group = value ? strdup(value) : NULL;
   printer->config_time = time(NULL);
+  printer->generation ++;
 
 #if !_WIN32
   if (printer->print_group && strcmp(printer->print_group, "none"))
@@ -1228,6 +1375,9 @@ papplPrinterSetReasons(
 
   pthread_rwlock_wrlock(&printer->rwlock);
 
+  if (((printer->state_reasons & ~remove) | add) != printer->state_reasons)
+    printer->generation ++;
+
   printer->state_reasons &= ~remove;
   printer->state_reasons |= add;
   printer->state_time    = printer->status_time = time(NULL);
@@ -1253,6 +1403,11 @@ papplPrinterSetSupplies(
 
   pthread_rwlock_wrlock(&printer->rwlock);
 
+  // Only invalidate cached attributes when the supplies actually change, since
+  // status callbacks typically report the same values over and over...
+  if (num_supplies != printer->num_supply || (num_supplies > 0 && memcmp(printer->supply, supplies, (size_t)num_supplies * sizeof(pappl_supply_t))))
+    printer->generation ++;
+
   printer->num_supply = num_supplies;
   memset(printer->supply, 0, sizeof(printer->supply));
   if (supplies)
@@ -196,6 +196,8 @@ papplPrinterSetDriverData(
   if (attrs)
     ippCopyAttributes(printer->driver_attrs, attrs, 0, NULL, NULL);
 
+  printer->generation ++;
+
   pthread_rwlock_unlock(&printer->rwlock);
 
   return (true);
@@ -296,6 +298,7 @@ papplPrinterSetDriverDefaults(
   }
 
   printer->config_time = time(NULL);
+  printer->generation ++;
 
   pthread_rwlock_unlock(&printer->rwlock);
 
@@ -347,6 +350,7 @@ papplPrinterSetReadyMedia(
   }
 
   printer->state_time = time(NULL);
+  printer->generation ++;
 
   pthread_rwlock_unlock(&printer->rwlock);
 
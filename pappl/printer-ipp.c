@@ -16,7 +16,14 @@
 
 
 //
-// Local type...
+// Local constants...
+//
+
+#define _PAPPL_MAX_PCACHE	16	// Maximum number of cached attribute sets
+
+
+//
+// Local types...
 //
 
 typedef struct _pappl_attr_s		// Input attribute structure
@@ -26,12 +33,23 @@ typedef struct _pappl_attr_s		// Input attribute structure
   cups_len_t	max_count;		// Max number of values
 } _pappl_attr_t;
 
+typedef struct _pappl_pcache_s		// Cached printer attributes
+{
+  char		*key;			// Request key
+  size_t	generation;		// Printer generation number
+  size_t	last_used;		// Value of use counter at last use
+  ipp_t		*attrs;			// Printer attributes
+} _pappl_pcache_t;
+
 
 //
 // Local functions...
 //
 
+static int		compare_pcache(_pappl_pcache_t *a, _pappl_pcache_t *b);
+static void		copy_printer_attributes(pappl_printer_t *printer, pappl_client_t *client, ipp_t *ipp, _pappl_ra_t *ra, const char *format);
 static pappl_job_t	*create_job(pappl_client_t *client);
+static void		free_pcache(_pappl_pcache_t *pc);
 
 static void		ipp_cancel_current_job(pappl_client_t *client);
 static void		ipp_cancel_jobs(pappl_client_t *client);
@@ -47,365 +65,133 @@ static void		ipp_resume_printer(pappl_client_t *client);
 static void		ipp_set_printer_attributes(pappl_client_t *client);
 static void		ipp_validate_job(pappl_client_t *client);
 
+static char		*make_cache_key(pappl_client_t *client, _pappl_ra_t *ra, const char *format);
 static bool		valid_job_attributes(pappl_client_t *client);
 
 
 //
 // '_papplPrinterCopyAttributes()' - Copy printer attributes to a response...
 //
+// Attributes that only change with the printer configuration are cached for
+// each combination of requested attributes, document format, and client
+// host name/address, and reused until the printer's generation number
+// changes.  Attributes that change over time are added directly.
+//
+// The caller must hold a lock on the printer.
+//
 
 void
 _papplPrinterCopyAttributes(
     pappl_printer_t *printer,		// I - Printer
     pappl_client_t  *client,		// I - Client
-    cups_array_t    *ra,		// I - Requested attributes
+    _pappl_ra_t     *ra,		// I - Requested attributes
     const char      *format)		// I - "document-format" value, if any
 {
   size_t	i,			// Looping var
 		num_values;		// Number of values
-  unsigned	bit;			// Current bit value
   const char	*svalues[100];		// String values
-  int		ivalues[100];		// Integer values
-  pappl_pr_driver_data_t *data = &printer->driver_data;
-					// Driver data
   const char	*webscheme = (httpAddrLocalhost(httpGetAddress(client->http)) || !papplSystemGetTLSOnly(client->system)) ? "http" : "https";
 					// URL scheme for resources
+  _pappl_pcache_t	key,		// Search key
+			*pc,		// Cached attributes
+			*oldest;	// Least recently used attributes
 
 
-  _papplCopyAttributes(client->response, printer->attrs, ra, IPP_TAG_ZERO, IPP_TAG_CUPS_CONST);
-  _papplCopyAttributes(client->response, printer->driver_attrs, ra, IPP_TAG_ZERO, IPP_TAG_CUPS_CONST);
-  _papplPrinterCopyState(printer, IPP_TAG_PRINTER, client->response, client, ra);
-
-  if (!ra || cupsArrayFind(ra, "copies-supported"))
-  {
-    // Filter copies-supported value based on the document format...
-    // (no copy support for streaming raster formats)
-    if (format && (!strcmp(format, "image/pwg-raster") || !strcmp(format, "image/urf")))
-      ippAddRange(client->response, IPP_TAG_PRINTER, "copies-supported", 1, 1);
-    else
-      ippAddRange(client->response, IPP_TAG_PRINTER, "copies-supported", 1, 999);
-  }
-
-  if (!ra || cupsArrayFind(ra, "identify-actions-default"))
-  {
-    for (num_values = 0, bit = PAPPL_IDENTIFY_ACTIONS_DISPLAY; bit <= PAPPL_IDENTIFY_ACTIONS_SPEAK; bit *= 2)
-    {
-      if (data->identify_default & bit)
-	svalues[num_values ++] = _papplIdentifyActionsString(bit);
-    }
-
-    if (num_values > 0)
-      ippAddStrings(client->response, IPP_TAG_PRINTER, IPP_CONST_TAG(IPP_TAG_KEYWORD), "identify-actions-default", IPP_NUM_CAST num_values, NULL, svalues);
-    else
-      ippAddString(client->response, IPP_TAG_PRINTER, IPP_CONST_TAG(IPP_TAG_KEYWORD), "identify-actions-default", NULL, "none");
-  }
-
-  if ((!ra || cupsArrayFind(ra, "label-mode-configured")) && data->mode_configured)
-    ippAddString(client->response, IPP_TAG_PRINTER, IPP_CONST_TAG(IPP_TAG_KEYWORD), "label-mode-configured", NULL, _papplLabelModeString(data->mode_configured));
-
-  if ((!ra || cupsArrayFind(ra, "label-tear-offset-configured")) && data->tear_offset_supported[1] > 0)
-    ippAddInteger(client->response, IPP_TAG_PRINTER, IPP_TAG_INTEGER, "label-tear-offset-configured", data->tear_offset_configured);
-
-  if (printer->num_supply > 0)
-  {
-    pappl_supply_t *supply = printer->supply;
-					// Supply values...
-
-    if (!ra || cupsArrayFind(ra, "marker-colors"))
-    {
-      for (i = 0; i < (size_t)printer->num_supply; i ++)
-        svalues[i] = _papplMarkerColorString(supply[i].color);
-
-      ippAddStrings(client->response, IPP_TAG_PRINTER, IPP_CONST_TAG(IPP_TAG_NAME), "marker-colors", IPP_NUM_CAST printer->num_supply, NULL, svalues);
-    }
-
-    if (!ra || cupsArrayFind(ra, "marker-high-levels"))
-    {
-      for (i = 0; i < (size_t)printer->num_supply; i ++)
-        ivalues[i] = supply[i].is_consumed ? 100 : 90;
-
-      ippAddIntegers(client->response, IPP_TAG_PRINTER, IPP_TAG_INTEGER, "marker-high-levels", IPP_NUM_CAST printer->num_supply, ivalues);
-    }
-
-    if (!ra || cupsArrayFind(ra, "marker-levels"))
-    {
-      for (i = 0; i < (size_t)printer->num_supply; i ++)
-        ivalues[i] = supply[i].level;
-
-      ippAddIntegers(client->response, IPP_TAG_PRINTER, IPP_TAG_INTEGER, "marker-levels", IPP_NUM_CAST printer->num_supply, ivalues);
-    }
-
-    if (!ra || cupsArrayFind(ra, "marker-low-levels"))
-    {
-      for (i = 0; i < (size_t)printer->num_supply; i ++)
-        ivalues[i] = supply[i].is_consumed ? 10 : 0;
-
-      ippAddIntegers(client->response, IPP_TAG_PRINTER, IPP_TAG_INTEGER, "marker-low-levels", IPP_NUM_CAST printer->num_supply, ivalues);
-    }
-
-    if (!ra || cupsArrayFind(ra, "marker-names"))
-    {
-      for (i = 0; i < (size_t)printer->num_supply; i ++)
-        svalues[i] = supply[i].description;
-
-      ippAddStrings(client->response, IPP_TAG_PRINTER, IPP_TAG_NAME, "marker-names", IPP_NUM_CAST printer->num_supply, NULL, svalues);
-    }
-
-    if (!ra || cupsArrayFind(ra, "marker-types"))
-    {
-      for (i = 0; i < (size_t)printer->num_supply; i ++)
-        svalues[i] = _papplMarkerTypeString(supply[i].type);
-
-      ippAddStrings(client->response, IPP_TAG_PRINTER, IPP_CONST_TAG(IPP_TAG_KEYWORD), "marker-types", IPP_NUM_CAST printer->num_supply, NULL, svalues);
-    }
-  }
-
-  if ((!ra || cupsArrayFind(ra, "media-col-default")) && data->media_default.size_name[0])
+  // Copy the cached attributes, updating the cache as needed...
+  if ((key.key = make_cache_key(client, ra, format)) != NULL)
   {
-    ipp_t *col = _papplMediaColExport(&printer->driver_data, &data->media_default, 0);
-					// Collection value
-
-    ippAddCollection(client->response, IPP_TAG_PRINTER, "media-col-default", col);
-    ippDelete(col);
-  }
+    pthread_mutex_lock(&printer->cache_mutex);
 
-  if (!ra || cupsArrayFind(ra, "media-col-ready"))
-  {
-    size_t		j,		// Looping var
-			count;		// Number of values
-    ipp_t		*col;		// Collection value
-    ipp_attribute_t	*attr;		// media-col-ready attribute
-    pappl_media_col_t	media;		// Current media...
+    if (!printer->cache)
+      printer->cache = cupsArrayNew((cups_array_cb_t)compare_pcache, NULL, NULL, 0, NULL, (cups_afree_cb_t)free_pcache);
 
-    for (i = 0, count = 0; i < (size_t)printer->num_ready; i ++)
+    if ((pc = (_pappl_pcache_t *)cupsArrayFind(printer->cache, &key)) != NULL && pc->generation != printer->generation)
     {
-      if (data->media_ready[i].size_name[0])
-        count ++;
+      // Discard stale attributes...
+      cupsArrayRemove(printer->cache, pc);
+      pc = NULL;
     }
 
-    if (data->borderless && (data->bottom_top != 0 || data->left_right != 0))
-      count *= 2;			// Need to report ready media for borderless, too...
-
-    if (count > 0)
+    if (!pc)
     {
-      attr = ippAddCollections(client->response, IPP_TAG_PRINTER, "media-col-ready", IPP_NUM_CAST count, NULL);
-
-      for (i = 0, j = 0; i < (size_t)printer->num_ready && j < count; i ++)
+      // Make room in the cache as needed by removing the least recently used
+      // attributes...
+      if (cupsArrayGetCount(printer->cache) >= _PAPPL_MAX_PCACHE)
       {
-	if (data->media_ready[i].size_name[0])
-	{
-          if (data->borderless && (data->bottom_top != 0 || data->left_right != 0))
-	  {
-	    // Report both bordered and borderless media-col values...
-	    media = data->media_ready[i];
-
-	    media.bottom_margin = media.top_margin   = data->bottom_top;
-	    media.left_margin   = media.right_margin = data->left_right;
-	    col = _papplMediaColExport(&printer->driver_data, &media, 0);
-	    ippSetCollection(client->response, &attr, IPP_NUM_CAST j ++, col);
-	    ippDelete(col);
+        for (oldest = pc = (_pappl_pcache_t *)cupsArrayGetFirst(printer->cache); pc; pc = (_pappl_pcache_t *)cupsArrayGetNext(printer->cache))
+        {
+          if (pc->last_used < oldest->last_used)
+            oldest = pc;
+        }
 
-	    media.bottom_margin = media.top_margin   = 0;
-	    media.left_margin   = media.right_margin = 0;
-	    col = _papplMediaColExport(&printer->driver_data, &media, 0);
-	    ippSetCollection(client->response, &attr, IPP_NUM_CAST j ++, col);
-	    ippDelete(col);
-	  }
-	  else
-	  {
-	    // Just report the single media-col value...
-	    col = _papplMediaColExport(&printer->driver_data, data->media_ready + i, 0);
-	    ippSetCollection(client->response, &attr, IPP_NUM_CAST j ++, col);
-	    ippDelete(col);
-	  }
-	}
+        cupsArrayRemove(printer->cache, oldest);
+        pc = NULL;
       }
-    }
-  }
-
-  if ((!ra || cupsArrayFind(ra, "media-default")) && data->media_default.size_name[0])
-    ippAddString(client->response, IPP_TAG_PRINTER, IPP_TAG_KEYWORD, "media-default", NULL, data->media_default.size_name);
-
-  if (!ra || cupsArrayFind(ra, "media-ready"))
-  {
-    size_t		j,		// Looping vars
-			count;		// Number of values
-    ipp_attribute_t	*attr;		// media-col-ready attribute
 
-    for (i = 0, count = 0; i < (size_t)printer->num_ready; i ++)
-    {
-      if (data->media_ready[i].size_name[0])
-        count ++;
-    }
+      if ((pc = (_pappl_pcache_t *)calloc(1, sizeof(_pappl_pcache_t))) != NULL)
+      {
+        pc->key        = key.key;
+        pc->generation = printer->generation;
+        pc->attrs      = ippNew();
+        key.key        = NULL;
 
-    if (count > 0)
-    {
-      attr = ippAddStrings(client->response, IPP_TAG_PRINTER, IPP_TAG_KEYWORD, "media-ready", IPP_NUM_CAST count, NULL, NULL);
+        copy_printer_attributes(printer, client, pc->attrs, ra, format);
 
-      for (i = 0, j = 0; i < (size_t)printer->num_ready && j < count; i ++)
+        if (!cupsArrayAdd(printer->cache, pc))
+        {
+          ippCopyAttributes(client->response, pc->attrs, 0, NULL, NULL);
+          free_pcache(pc);
+          pc = NULL;
+        }
+      }
+      else
       {
-	if (data->media_ready[i].size_name[0])
-	  ippSetString(client->response, &attr, IPP_NUM_CAST j ++, data->media_ready[i].size_name);
+        copy_printer_attributes(printer, client, client->response, ra, format);
       }
     }
-  }
-
-  if (!ra || cupsArrayFind(ra, "multiple-document-handling-default"))
-    ippAddString(client->response, IPP_TAG_PRINTER, IPP_CONST_TAG(IPP_TAG_KEYWORD), "multiple-document-handling-default", NULL, "separate-documents-collated-copies");
 
-  if (!ra || cupsArrayFind(ra, "orientation-requested-default"))
-    ippAddInteger(client->response, IPP_TAG_PRINTER, IPP_TAG_ENUM, "orientation-requested-default", (int)data->orient_default);
+    if (pc)
+    {
+      pc->last_used = ++ printer->cache_uses;
 
-  if (!ra || cupsArrayFind(ra, "output-bin-default"))
-  {
-    if (data->num_bin > 0)
-      ippAddString(client->response, IPP_TAG_PRINTER, IPP_CONST_TAG(IPP_TAG_KEYWORD), "output-bin-default", NULL, data->bin[data->bin_default]);
-    else if (data->output_face_up)
-      ippAddString(client->response, IPP_TAG_PRINTER, IPP_CONST_TAG(IPP_TAG_KEYWORD), "output-bin-default", NULL, "face-up");
-    else
-      ippAddString(client->response, IPP_TAG_PRINTER, IPP_CONST_TAG(IPP_TAG_KEYWORD), "output-bin-default", NULL, "face-down");
-  }
+      ippCopyAttributes(client->response, pc->attrs, 0, NULL, NULL);
+    }
 
-  if ((!ra || cupsArrayFind(ra, "print-color-mode-default")) && data->color_default)
-    ippAddString(client->response, IPP_TAG_PRINTER, IPP_CONST_TAG(IPP_TAG_KEYWORD), "print-color-mode-default", NULL, _papplColorModeString(data->color_default));
+    pthread_mutex_unlock(&printer->cache_mutex);
 
-  if (!ra || cupsArrayFind(ra, "print-content-optimize-default"))
-  {
-    if (data->content_default)
-      ippAddString(client->response, IPP_TAG_PRINTER, IPP_CONST_TAG(IPP_TAG_KEYWORD), "print-content-optimize-default", NULL, _papplContentString(data->content_default));
-    else
-      ippAddString(client->response, IPP_TAG_PRINTER, IPP_CONST_TAG(IPP_TAG_KEYWORD), "print-content-optimize-default", NULL, "auto");
+    free(key.key);
   }
-
-  if (!ra || cupsArrayFind(ra, "print-quality-default"))
+  else
   {
-    if (data->quality_default)
-      ippAddInteger(client->response, IPP_TAG_PRINTER, IPP_TAG_ENUM, "print-quality-default", (int)data->quality_default);
-    else
-      ippAddInteger(client->response, IPP_TAG_PRINTER, IPP_TAG_ENUM, "print-quality-default", IPP_QUALITY_NORMAL);
+    copy_printer_attributes(printer, client, client->response, ra, format);
   }
 
-  if (!ra || cupsArrayFind(ra, "print-scaling-default"))
-  {
-    if (data->scaling_default)
-      ippAddString(client->response, IPP_TAG_PRINTER, IPP_CONST_TAG(IPP_TAG_KEYWORD), "print-scaling-default", NULL, _papplScalingString(data->scaling_default));
-    else
-      ippAddString(client->response, IPP_TAG_PRINTER, IPP_CONST_TAG(IPP_TAG_KEYWORD), "print-scaling-default", NULL, "auto");
-  }
+  // Copy the attributes that change over time...
+  _papplPrinterCopyState(printer, IPP_TAG_PRINTER, client->response, client, ra);
 
-  if (!ra || cupsArrayFind(ra, "printer-config-change-date-time"))
+  if (_PAPPL_REQUESTED(ra, _PAPPL_RA_PRINTER_CONFIG_CHANGE_DATE_TIME))
     ippAddDate(client->response, IPP_TAG_PRINTER, "printer-config-change-date-time", ippTimeToDate(printer->config_time));
 
-  if (!ra || cupsArrayFind(ra, "printer-config-change-time"))
+  if (_PAPPL_REQUESTED(ra, _PAPPL_RA_PRINTER_CONFIG_CHANGE_TIME))
     ippAddInteger(client->response, IPP_TAG_PRINTER, IPP_TAG_INTEGER, "printer-config-change-time", (int)(printer->config_time - printer->start_time));
 
-  if (!ra || cupsArrayFind(ra, "printer-contact-col"))
-  {
-    ipp_t *col = _papplContactExport(&printer->contact);
-    ippAddCollection(client->response, IPP_TAG_PRINTER, "printer-contact-col", col);
-    ippDelete(col);
-  }
-
-  if (!ra || cupsArrayFind(ra, "printer-current-time"))
+  if (_PAPPL_REQUESTED(ra, _PAPPL_RA_PRINTER_CURRENT_TIME))
     ippAddDate(client->response, IPP_TAG_PRINTER, "printer-current-time", ippTimeToDate(time(NULL)));
 
-  if ((!ra || cupsArrayFind(ra, "printer-darkness-configured")) && data->darkness_supported > 0)
-    ippAddInteger(client->response, IPP_TAG_PRINTER, IPP_TAG_INTEGER, "printer-darkness-configured", data->darkness_configured);
-
-  if (!ra || cupsArrayFind(ra, "printer-dns-sd-name"))
-    ippAddString(client->response, IPP_TAG_PRINTER, IPP_TAG_NAME, "printer-dns-sd-name", NULL, printer->dns_sd_name ? printer->dns_sd_name : "");
-
   pthread_rwlock_rdlock(&client->system->rwlock);
   _papplSystemExportVersions(client->system, client->response, IPP_TAG_PRINTER, ra);
   pthread_rwlock_unlock(&client->system->rwlock);
 
-  if (!ra || cupsArrayFind(ra, "printer-geo-location"))
-  {
-    if (printer->geo_location)
-      ippAddString(client->response, IPP_TAG_PRINTER, IPP_TAG_URI, "printer-geo-location", NULL, printer->geo_location);
-    else
-      ippAddOutOfBand(client->response, IPP_TAG_PRINTER, IPP_TAG_UNKNOWN, "printer-geo-location");
-  }
-
-  if (!ra || cupsArrayFind(ra, "printer-icons"))
-  {
-    char	uris[3][1024];		// Buffers for URIs
-    const char	*values[3];		// Values for attribute
-
-    httpAssembleURIf(HTTP_URI_CODING_ALL, uris[0], sizeof(uris[0]), webscheme, NULL, client->host_field, client->host_port, "%s/icon-sm.png", printer->uriname);
-    httpAssembleURIf(HTTP_URI_CODING_ALL, uris[1], sizeof(uris[1]), webscheme, NULL, client->host_field, client->host_port, "%s/icon-md.png", printer->uriname);
-    httpAssembleURIf(HTTP_URI_CODING_ALL, uris[2], sizeof(uris[2]), webscheme, NULL, client->host_field, client->host_port, "%s/icon-lg.png", printer->uriname);
-
-    values[0] = uris[0];
-    values[1] = uris[1];
-    values[2] = uris[2];
-
-    ippAddStrings(client->response, IPP_TAG_PRINTER, IPP_TAG_URI, "printer-icons", 3, NULL, values);
-  }
-
-  if (!ra || cupsArrayFind(ra, "printer-impressions-completed"))
+  if (_PAPPL_REQUESTED(ra, _PAPPL_RA_PRINTER_IMPRESSIONS_COMPLETED))
     ippAddInteger(client->response, IPP_TAG_PRINTER, IPP_TAG_INTEGER, "printer-impressions-completed", printer->impcompleted);
 
-  if (!ra || cupsArrayFind(ra, "printer-input-tray"))
-  {
-    ipp_attribute_t	*attr = NULL;	// "printer-input-tray" attribute
-    char		value[256];	// Value for current tray
-    pappl_media_col_t	*media;		// Media in the tray
-
-    for (i = 0, media = data->media_ready; i < (size_t)data->num_source; i ++, media ++)
-    {
-      const char	*type;		// Tray type
-
-      if (!strcmp(data->source[i], "manual"))
-        type = "sheetFeedManual";
-      else if (!strcmp(data->source[i], "by-pass-tray"))
-        type = "sheetFeedAutoNonRemovableTray";
-      else
-        type = "sheetFeedAutoRemovableTray";
-
-      snprintf(value, sizeof(value), "type=%s;mediafeed=%d;mediaxfeed=%d;maxcapacity=%d;level=-2;status=0;name=%s;", type, media->size_length, media->size_width, !strcmp(media->source, "manual") ? 1 : -2, media->source);
-
-      if (attr)
-        ippSetOctetString(client->response, &attr, ippGetCount(attr), value, IPP_NUM_CAST strlen(value));
-      else
-        attr = ippAddOctetString(client->response, IPP_TAG_PRINTER, "printer-input-tray", value, IPP_NUM_CAST strlen(value));
-    }
-
-    // The "auto" tray is a dummy entry...
-    papplCopyString(value, "type=other;mediafeed=0;mediaxfeed=0;maxcapacity=-2;level=-2;status=0;name=auto;", sizeof(value));
-    ippSetOctetString(client->response, &attr, ippGetCount(attr), value, IPP_NUM_CAST strlen(value));
-  }
-
-  if (!ra || cupsArrayFind(ra, "printer-location"))
-    ippAddString(client->response, IPP_TAG_PRINTER, IPP_TAG_TEXT, "printer-location", NULL, printer->location ? printer->location : "");
-
-  if (!ra || cupsArrayFind(ra, "printer-more-info"))
-  {
-    char	uri[1024];		// URI value
-
-    httpAssembleURIf(HTTP_URI_CODING_ALL, uri, sizeof(uri), webscheme, NULL, client->host_field, client->host_port, "%s/", printer->uriname);
-    ippAddString(client->response, IPP_TAG_PRINTER, IPP_TAG_URI, "printer-more-info", NULL, uri);
-  }
-
-  if (!ra || cupsArrayFind(ra, "printer-organization"))
-    ippAddString(client->response, IPP_TAG_PRINTER, IPP_TAG_TEXT, "printer-organization", NULL, printer->organization ? printer->organization : "");
-
-  if (!ra || cupsArrayFind(ra, "printer-organizational-unit"))
-    ippAddString(client->response, IPP_TAG_PRINTER, IPP_TAG_TEXT, "printer-organizational-unit", NULL, printer->org_unit ? printer->org_unit : "");
-
-  if (!ra || cupsArrayFind(ra, "printer-resolution-default"))
-    ippAddResolution(client->response, IPP_TAG_PRINTER, "printer-resolution-default", IPP_RES_PER_INCH, data->x_default, data->y_default);
-
-  if (!ra || cupsArrayFind(ra, "printer-speed-default"))
-    ippAddInteger(client->response, IPP_TAG_PRINTER, IPP_TAG_INTEGER, "printer-speed-default", data->speed_default);
-
-  if (!ra || cupsArrayFind(ra, "printer-state-change-date-time"))
+  if (_PAPPL_REQUESTED(ra, _PAPPL_RA_PRINTER_STATE_CHANGE_DATE_TIME))
     ippAddDate(client->response, IPP_TAG_PRINTER, "printer-state-change-date-time", ippTimeToDate(printer->state_time));
 
-  if (!ra || cupsArrayFind(ra, "printer-state-change-time"))
+  if (_PAPPL_REQUESTED(ra, _PAPPL_RA_PRINTER_STATE_CHANGE_TIME))
     ippAddInteger(client->response, IPP_TAG_PRINTER, IPP_TAG_INTEGER, "printer-state-change-time", (int)(printer->state_time - printer->start_time));
 
-  if (!ra || cupsArrayFind(ra, "printer-strings-languages-supported"))
+  if (_PAPPL_REQUESTED(ra, _PAPPL_RA_PRINTER_STRINGS_LANGUAGES_SUPPORTED))
   {
     _pappl_resource_t	*r;		// Current resource
     size_t		rcount;		// Number of resources
@@ -424,10 +210,10 @@ _papplPrinterCopyAttributes(
     pthread_rwlock_unlock(&printer->system->rwlock);
 
     if (num_values > 0)
-      ippAddStrings(printer->attrs, IPP_TAG_PRINTER, IPP_TAG_LANGUAGE, "printer-strings-languages-supported", IPP_NUM_CAST num_values, NULL, svalues);
+      ippAddStrings(client->response, IPP_TAG_PRINTER, IPP_TAG_LANGUAGE, "printer-strings-languages-supported", IPP_NUM_CAST num_values, NULL, svalues);
   }
 
-  if (!ra || cupsArrayFind(ra, "printer-strings-uri"))
+  if (_PAPPL_REQUESTED(ra, _PAPPL_RA_PRINTER_STRINGS_URI))
   {
     const char	*lang = ippGetString(ippFindAttribute(client->request, "attributes-natural-language", IPP_TAG_LANGUAGE), 0, NULL);
 					// Language
@@ -457,140 +243,27 @@ _papplPrinterCopyAttributes(
     pthread_rwlock_unlock(&printer->system->rwlock);
   }
 
-  if (printer->num_supply > 0)
-  {
-    pappl_supply_t	 *supply = printer->supply;
-					// Supply values...
-
-    if (!ra || cupsArrayFind(ra, "printer-supply"))
-    {
-      char		value[256];	// "printer-supply" value
-      ipp_attribute_t	*attr = NULL;	// "printer-supply" attribute
-
-      for (i = 0; i < (size_t)printer->num_supply; i ++)
-      {
-	snprintf(value, sizeof(value), "index=%u;type=%s;maxcapacity=100;level=%d;colorantname=%s;", (unsigned)i, _papplSupplyTypeString(supply[i].type), supply[i].level, _papplSupplyColorString(supply[i].color));
+  if (_PAPPL_REQUESTED(ra, _PAPPL_RA_PRINTER_UP_TIME))
+    ippAddInteger(client->response, IPP_TAG_PRINTER, IPP_TAG_INTEGER, "printer-up-time", (int)(time(NULL) - printer->start_time));
 
-	if (attr)
-	  ippSetOctetString(client->response, &attr, ippGetCount(attr), value, IPP_NUM_CAST strlen(value));
-	else
-	  attr = ippAddOctetString(client->response, IPP_TAG_PRINTER, "printer-supply", value, IPP_NUM_CAST strlen(value));
-      }
-    }
+  if (client->system->wifi_status_cb && httpAddrLocalhost(httpGetAddress(client->http)) && (_PAPPL_REQUESTED(ra, _PAPPL_RA_PRINTER_WIFI_SSID) || _PAPPL_REQUESTED(ra, _PAPPL_RA_PRINTER_WIFI_STATE)))
+  {
+    // Get Wi-Fi status...
+    pappl_wifi_t	wifi;		// Wi-Fi status
 
-    if (!ra || cupsArrayFind(ra, "printer-supply-description"))
+    if ((client->system->wifi_status_cb)(client->system, client->system->wifi_cbdata, &wifi))
     {
-      for (i = 0; i < (size_t)printer->num_supply; i ++)
-        svalues[i] = supply[i].description;
+      if (_PAPPL_REQUESTED(ra, _PAPPL_RA_PRINTER_WIFI_SSID))
+        ippAddString(client->response, IPP_TAG_PRINTER, IPP_TAG_NAME, "printer-wifi-ssid", NULL, wifi.ssid);
 
-      ippAddStrings(client->response, IPP_TAG_PRINTER, IPP_TAG_TEXT, "printer-supply-description", IPP_NUM_CAST printer->num_supply, NULL, svalues);
+      if (_PAPPL_REQUESTED(ra, _PAPPL_RA_PRINTER_WIFI_STATE))
+        ippAddInteger(client->response, IPP_TAG_PRINTER, IPP_TAG_ENUM, "printer-wifi-state", (int)wifi.state);
     }
   }
 
-  if (!ra || cupsArrayFind(ra, "printer-supply-info-uri"))
-  {
-    char	uri[1024];		// URI value
-
-    httpAssembleURIf(HTTP_URI_CODING_ALL, uri, sizeof(uri), webscheme, NULL, client->host_field, client->host_port, "%s/supplies", printer->uriname);
-    ippAddString(client->response, IPP_TAG_PRINTER, IPP_TAG_URI, "printer-supply-info-uri", NULL, uri);
-  }
-
-  if (!ra || cupsArrayFind(ra, "printer-up-time"))
-    ippAddInteger(client->response, IPP_TAG_PRINTER, IPP_TAG_INTEGER, "printer-up-time", (int)(time(NULL) - printer->start_time));
-
-  if (!ra || cupsArrayFind(ra, "printer-uri-supported"))
-  {
-    char	uris[2][1024];		// Buffers for URIs
-    const char	*values[2];		// Values for attribute
-
-    num_values = 0;
-
-    if (httpAddrLocalhost(httpGetAddress(client->http)) || !papplSystemGetTLSOnly(client->system))
-    {
-      httpAssembleURI(HTTP_URI_CODING_ALL, uris[num_values], sizeof(uris[0]), "ipp", NULL, client->host_field, client->host_port, printer->resource);
-      values[num_values] = uris[num_values];
-      num_values ++;
-    }
-
-    if (!httpAddrLocalhost(httpGetAddress(client->http)) && !(client->system->options & PAPPL_SOPTIONS_NO_TLS))
-    {
-      httpAssembleURI(HTTP_URI_CODING_ALL, uris[num_values], sizeof(uris[0]), "ipps", NULL, client->host_field, client->host_port, printer->resource);
-      values[num_values] = uris[num_values];
-      num_values ++;
-    }
-
-    if (num_values > 0)
-      ippAddStrings(client->response, IPP_TAG_PRINTER, IPP_TAG_URI, "printer-uri-supported", IPP_NUM_CAST num_values, NULL, values);
-  }
-
-  if (client->system->wifi_status_cb && httpAddrLocalhost(httpGetAddress(client->http)) && (!ra || cupsArrayFind(ra, "printer-wifi-ssid") || cupsArrayFind(ra, "printer-wifi-state")))
-  {
-    // Get Wi-Fi status...
-    pappl_wifi_t	wifi;		// Wi-Fi status
-
-    if ((client->system->wifi_status_cb)(client->system, client->system->wifi_cbdata, &wifi))
-    {
-      if (!ra || cupsArrayFind(ra, "printer-wifi-ssid"))
-        ippAddString(client->response, IPP_TAG_PRINTER, IPP_TAG_NAME, "printer-wifi-ssid", NULL, wifi.ssid);
-
-      if (!ra || cupsArrayFind(ra, "printer-wifi-state"))
-        ippAddInteger(client->response, IPP_TAG_PRINTER, IPP_TAG_ENUM, "printer-wifi-state", (int)wifi.state);
-    }
-  }
-
-  if (!ra || cupsArrayFind(ra, "printer-xri-supported"))
-    _papplPrinterCopyXRI(printer, client->response, client);
-
-  if (!ra || cupsArrayFind(ra, "queued-job-count"))
-    ippAddInteger(client->response, IPP_TAG_PRINTER, IPP_TAG_INTEGER, "queued-job-count", (int)cupsArrayGetCount(printer->active_jobs));
-
-  if (!ra || cupsArrayFind(ra, "sides-default"))
-  {
-    if (data->sides_default)
-      ippAddString(client->response, IPP_TAG_PRINTER, IPP_CONST_TAG(IPP_TAG_KEYWORD), "sides-default", NULL, _papplSidesString(data->sides_default));
-    else
-      ippAddString(client->response, IPP_TAG_PRINTER, IPP_CONST_TAG(IPP_TAG_KEYWORD), "sides-default", NULL, "one-sided");
-  }
-
-  if (!ra || cupsArrayFind(ra, "uri-authentication-supported"))
-  {
-    // For each supported printer-uri value, report whether authentication is
-    // supported.  Since we only support authentication over a secure (TLS)
-    // channel, the value is always 'none' for the "ipp" URI and either 'none'
-    // or 'basic' for the "ipps" URI...
-    if (httpAddrLocalhost(httpGetAddress(client->http)) || (client->system->options & PAPPL_SOPTIONS_NO_TLS))
-    {
-      ippAddString(client->response, IPP_TAG_PRINTER, IPP_CONST_TAG(IPP_TAG_KEYWORD), "uri-authentication-supported", NULL, "none");
-    }
-    else if (papplSystemGetTLSOnly(client->system))
-    {
-      if (papplSystemGetAuthService(client->system))
-        ippAddString(client->response, IPP_TAG_PRINTER, IPP_CONST_TAG(IPP_TAG_KEYWORD), "uri-authentication-supported", NULL, "basic");
-      else
-        ippAddString(client->response, IPP_TAG_PRINTER, IPP_CONST_TAG(IPP_TAG_KEYWORD), "uri-authentication-supported", NULL, "none");
-    }
-    else if (papplSystemGetAuthService(client->system))
-    {
-      static const char * const uri_authentication_basic[] =
-      {					// uri-authentication-supported values
-	"none",
-	"basic"
-      };
-
-      ippAddStrings(client->response, IPP_TAG_PRINTER, IPP_CONST_TAG(IPP_TAG_KEYWORD), "uri-authentication-supported", 2, NULL, uri_authentication_basic);
-    }
-    else
-    {
-      static const char * const uri_authentication_none[] =
-      {					// uri-authentication-supported values
-	"none",
-	"none"
-      };
-
-      ippAddStrings(client->response, IPP_TAG_PRINTER, IPP_CONST_TAG(IPP_TAG_KEYWORD), "uri-authentication-supported", 2, NULL, uri_authentication_none);
-    }
-  }
-}
+  if (_PAPPL_REQUESTED(ra, _PAPPL_RA_QUEUED_JOB_COUNT))
+    ippAddInteger(client->response, IPP_TAG_PRINTER, IPP_TAG_INTEGER, "queued-job-count", (int)cupsArrayGetCount(printer->active_jobs));
+}
 
 
 //
@@ -603,22 +276,22 @@ _papplPrinterCopyState(
     ipp_tag_t       group_tag,		// I - Group tag
     ipp_t           *ipp,		// I - IPP message
     pappl_client_t  *client,		// I - Client connection
-    cups_array_t    *ra)		// I - Requested attributes
+    _pappl_ra_t     *ra)		// I - Requested attributes
 {
-  if (!ra || cupsArrayFind(ra, "printer-is-accepting-jobs"))
+  if (_PAPPL_REQUESTED(ra, _PAPPL_RA_PRINTER_IS_ACCEPTING_JOBS))
     ippAddBoolean(ipp, group_tag, "printer-is-accepting-jobs", printer->is_accepting);
 
-  if (!ra || cupsArrayFind(ra, "printer-state"))
+  if (_PAPPL_REQUESTED(ra, _PAPPL_RA_PRINTER_STATE))
     ippAddInteger(ipp, group_tag, IPP_TAG_ENUM, "printer-state", (int)printer->state);
 
-  if (!ra || cupsArrayFind(ra, "printer-state-message"))
+  if (_PAPPL_REQUESTED(ra, _PAPPL_RA_PRINTER_STATE_MESSAGE))
   {
     static const char * const messages[] = { "Idle.", "Printing.", "Stopped." };
 
     ippAddString(ipp, group_tag, IPP_CONST_TAG(IPP_TAG_TEXT), "printer-state-message", NULL, messages[printer->state - IPP_PSTATE_IDLE]);
   }
 
-  if (!ra || cupsArrayFind(ra, "printer-state-reasons"))
+  if (_PAPPL_REQUESTED(ra, _PAPPL_RA_PRINTER_STATE_REASONS))
   {
     ipp_attribute_t	*attr = NULL;	// printer-state-reasons
     bool		wifi_not_configured = false;
@@ -1012,194 +685,659 @@ _papplPrinterSetAttributes(
     {
       count = ippGetCount(rattr);
 
-      for (i = 0; i < count; i ++)
-        _papplMediaColImport(ippGetCollection(rattr, i), driver_data.media_ready + i);
+      for (i = 0; i < count; i ++)
+        _papplMediaColImport(ippGetCollection(rattr, i), driver_data.media_ready + i);
+
+      for (; i < PAPPL_MAX_SOURCE; i ++)
+        memset(driver_data.media_ready + i, 0, sizeof(pappl_media_col_t));
+
+      do_ready = true;
+    }
+    else if (!strcmp(name, "media-default"))
+    {
+      if ((pwg = pwgMediaForPWG(ippGetString(rattr, 0, NULL))) != NULL)
+      {
+        papplCopyString(driver_data.media_default.size_name, pwg->pwg, sizeof(driver_data.media_default.size_name));
+        driver_data.media_default.size_width  = pwg->width;
+        driver_data.media_default.size_length = pwg->length;
+      }
+
+      do_defaults = true;
+    }
+    else if (!strcmp(name, "media-ready"))
+    {
+      count = ippGetCount(rattr);
+
+      for (i = 0; i < count; i ++)
+      {
+        if ((pwg = pwgMediaForPWG(ippGetString(rattr, i, NULL))) != NULL)
+        {
+          papplCopyString(driver_data.media_ready[i].size_name, pwg->pwg, sizeof(driver_data.media_ready[i].size_name));
+	  driver_data.media_ready[i].size_width  = pwg->width;
+	  driver_data.media_ready[i].size_length = pwg->length;
+	}
+      }
+
+      for (; i < PAPPL_MAX_SOURCE; i ++)
+      {
+        driver_data.media_ready[i].size_name[0] = '\0';
+        driver_data.media_ready[i].size_width   = 0;
+        driver_data.media_ready[i].size_length  = 0;
+      }
+
+      do_ready = true;
+    }
+    else if (!strcmp(name, "orientation-requested-default"))
+    {
+      driver_data.orient_default = (ipp_orient_t)ippGetInteger(rattr, 0);
+      do_defaults = true;
+    }
+    else if (!strcmp(name, "print-color-mode-default"))
+    {
+      driver_data.color_default = _papplColorModeValue(ippGetString(rattr, 0, NULL));
+      do_defaults = true;
+    }
+    else if (!strcmp(name, "print-content-optimize-default"))
+    {
+      driver_data.content_default = _papplContentValue(ippGetString(rattr, 0, NULL));
+      do_defaults = true;
+    }
+    else if (!strcmp(name, "print-darkness-default"))
+    {
+      driver_data.darkness_default = ippGetInteger(rattr, 0);
+      do_defaults = true;
+    }
+    else if (!strcmp(name, "print-quality-default"))
+    {
+      driver_data.quality_default = (ipp_quality_t)ippGetInteger(rattr, 0);
+      do_defaults = true;
+    }
+    else if (!strcmp(name, "print-scaling-default"))
+    {
+      driver_data.scaling_default = _papplScalingValue(ippGetString(rattr, 0, NULL));
+      do_defaults = true;
+    }
+    else if (!strcmp(name, "print-speed-default"))
+    {
+      driver_data.speed_default = ippGetInteger(rattr, 0);
+      do_defaults = true;
+    }
+    else if (!strcmp(name, "printer-contact-col"))
+    {
+      _papplContactImport(ippGetCollection(rattr, 0), &contact);
+      do_contact = true;
+    }
+    else if (!strcmp(name, "printer-darkness-configured"))
+    {
+      driver_data.darkness_configured = ippGetInteger(rattr, 0);
+      do_defaults = true;
+    }
+    else if (!strcmp(name, "printer-geo-location"))
+    {
+      float geo_lat, geo_lon;		// Latitude and longitude
+
+      geo_location = ippGetString(rattr, 0, NULL);
+      if (sscanf(geo_location, "geo:%f,%f", &geo_lat, &geo_lon) != 2 || geo_lat < -90.0 || geo_lat > 90.0 || geo_lon < -180.0 || geo_lon > 180.0)
+        papplClientRespondIPPUnsupported(client, rattr);
+    }
+    else if (!strcmp(name, "printer-location"))
+    {
+      location = ippGetString(rattr, 0, NULL);
+    }
+    else if (!strcmp(name, "printer-organization"))
+    {
+      organization = ippGetString(rattr, 0, NULL);
+    }
+    else if (!strcmp(name, "printer-organization-unit"))
+    {
+      org_unit = ippGetString(rattr, 0, NULL);
+    }
+    else if (!strcmp(name, "printer-resolution-default"))
+    {
+      ipp_res_t units;			// Resolution units
+
+      driver_data.x_default = ippGetResolution(rattr, 0, &driver_data.y_default, &units);
+      do_defaults = true;
+    }
+    else if (!strcmp(name, "printer-wifi-password"))
+    {
+      void		*data;		// Password
+      cups_len_t	datalen;	// Length of password
+
+      data = ippGetOctetString(rattr, 0, &datalen);
+      if (datalen > ((int)sizeof(wifi_password) - 1))
+      {
+	papplClientRespondIPPUnsupported(client, rattr);
+	continue;
+      }
+
+      memcpy(wifi_password, data, datalen);
+      wifi_password[datalen] = '\0';
+
+      do_wifi = true;
+    }
+    else if (!strcmp(name, "printer-wifi-ssid"))
+    {
+      papplCopyString(wifi_ssid, ippGetString(rattr, 0, NULL), sizeof(wifi_ssid));
+      do_wifi = true;
+    }
+  }
+
+  if (ippGetStatusCode(client->response) != IPP_STATUS_OK)
+  {
+    cupsFreeOptions(num_vendor, vendor);
+    return (false);
+  }
+
+  // Now apply changes...
+  if (do_defaults && !papplPrinterSetDriverDefaults(printer, &driver_data, (int)num_vendor, vendor))
+  {
+    papplClientRespondIPP(client, IPP_STATUS_ERROR_ATTRIBUTES_OR_VALUES, "One or more attribute values were not supported.");
+    cupsFreeOptions(num_vendor, vendor);
+    return (false);
+  }
+
+  cupsFreeOptions(num_vendor, vendor);
+
+  if (do_ready && !papplPrinterSetReadyMedia(printer, driver_data.num_source, driver_data.media_ready))
+  {
+    papplClientRespondIPP(client, IPP_STATUS_ERROR_ATTRIBUTES_OR_VALUES, "One or more attribute values were not supported.");
+    return (false);
+  }
+
+  if (do_wifi)
+  {
+    if (!(printer->system->wifi_join_cb)(printer->system, printer->system->wifi_cbdata, wifi_ssid, wifi_password))
+    {
+      papplClientRespondIPP(client, IPP_STATUS_ERROR_ATTRIBUTES_OR_VALUES, "Unable to join Wi-Fi network '%s'.", wifi_ssid);
+      return (false);
+    }
+  }
+
+  if (do_contact)
+    papplPrinterSetContact(printer, &contact);
+
+  if (geo_location)
+    papplPrinterSetGeoLocation(printer, geo_location);
+
+  if (location)
+    papplPrinterSetGeoLocation(printer, location);
+
+  if (organization)
+    papplPrinterSetGeoLocation(printer, organization);
+
+  if (org_unit)
+    papplPrinterSetGeoLocation(printer, org_unit);
+
+  papplSystemAddEvent(printer->system, printer, NULL, PAPPL_EVENT_PRINTER_CONFIG_CHANGED, NULL);
+
+  return (true);
+}
+
+
+//
+// 'compare_pcache()' - Compare two cached attribute sets.
+//
+
+static int				// O - Result of comparison
+compare_pcache(_pappl_pcache_t *a,	// I - First attribute set
+               _pappl_pcache_t *b)	// I - Second attribute set
+{
+  return (strcmp(a->key, b->key));
+}
+
+
+//
+// 'copy_printer_attributes()' - Copy the cacheable printer attributes.
+//
+// This function adds the printer attributes that only change when the
+// printer's generation number changes.
+//
+
+static void
+copy_printer_attributes(
+    pappl_printer_t *printer,		// I - Printer
+    pappl_client_t  *client,		// I - Client
+    ipp_t           *ipp,		// I - IPP message
+    _pappl_ra_t     *ra,		// I - Requested attributes
+    const char      *format)		// I - "document-format" value, if any
+{
+  size_t	i,			// Looping var
+		num_values;		// Number of values
+  unsigned	bit;			// Current bit value
+  const char	*svalues[100];		// String values
+  int		ivalues[100];		// Integer values
+  pappl_pr_driver_data_t *data = &printer->driver_data;
+					// Driver data
+  const char	*webscheme = (httpAddrLocalhost(httpGetAddress(client->http)) || !papplSystemGetTLSOnly(client->system)) ? "http" : "https";
+					// URL scheme for resources
+
+
+  _papplCopyAttributes(ipp, printer->attrs, ra, IPP_TAG_ZERO, 0);
+  _papplCopyAttributes(ipp, printer->driver_attrs, ra, IPP_TAG_ZERO, 0);
+
+  if (_PAPPL_REQUESTED(ra, _PAPPL_RA_COPIES_SUPPORTED))
+  {
+    // Filter copies-supported value based on the document format...
+    // (no copy support for streaming raster formats)
+    if (format && (!strcmp(format, "image/pwg-raster") || !strcmp(format, "image/urf")))
+      ippAddRange(ipp, IPP_TAG_PRINTER, "copies-supported", 1, 1);
+    else
+      ippAddRange(ipp, IPP_TAG_PRINTER, "copies-supported", 1, 999);
+  }
+
+  if (_PAPPL_REQUESTED(ra, _PAPPL_RA_IDENTIFY_ACTIONS_DEFAULT))
+  {
+    for (num_values = 0, bit = PAPPL_IDENTIFY_ACTIONS_DISPLAY; bit <= PAPPL_IDENTIFY_ACTIONS_SPEAK; bit *= 2)
+    {
+      if (data->identify_default & bit)
+	svalues[num_values ++] = _papplIdentifyActionsString(bit);
+    }
+
+    if (num_values > 0)
+      ippAddStrings(ipp, IPP_TAG_PRINTER, IPP_CONST_TAG(IPP_TAG_KEYWORD), "identify-actions-default", IPP_NUM_CAST num_values, NULL, svalues);
+    else
+      ippAddString(ipp, IPP_TAG_PRINTER, IPP_CONST_TAG(IPP_TAG_KEYWORD), "identify-actions-default", NULL, "none");
+  }
+
+  if ((_PAPPL_REQUESTED(ra, _PAPPL_RA_LABEL_MODE_CONFIGURED)) && data->mode_configured)
+    ippAddString(ipp, IPP_TAG_PRINTER, IPP_CONST_TAG(IPP_TAG_KEYWORD), "label-mode-configured", NULL, _papplLabelModeString(data->mode_configured));
+
+  if ((_PAPPL_REQUESTED(ra, _PAPPL_RA_LABEL_TEAR_OFFSET_CONFIGURED)) && data->tear_offset_supported[1] > 0)
+    ippAddInteger(ipp, IPP_TAG_PRINTER, IPP_TAG_INTEGER, "label-tear-offset-configured", data->tear_offset_configured);
+
+  if (printer->num_supply > 0)
+  {
+    pappl_supply_t *supply = printer->supply;
+					// Supply values...
+
+    if (_PAPPL_REQUESTED(ra, _PAPPL_RA_MARKER_COLORS))
+    {
+      for (i = 0; i < (size_t)printer->num_supply; i ++)
+        svalues[i] = _papplMarkerColorString(supply[i].color);
+
+      ippAddStrings(ipp, IPP_TAG_PRINTER, IPP_CONST_TAG(IPP_TAG_NAME), "marker-colors", IPP_NUM_CAST printer->num_supply, NULL, svalues);
+    }
+
+    if (_PAPPL_REQUESTED(ra, _PAPPL_RA_MARKER_HIGH_LEVELS))
+    {
+      for (i = 0; i < (size_t)printer->num_supply; i ++)
+        ivalues[i] = supply[i].is_consumed ? 100 : 90;
+
+      ippAddIntegers(ipp, IPP_TAG_PRINTER, IPP_TAG_INTEGER, "marker-high-levels", IPP_NUM_CAST printer->num_supply, ivalues);
+    }
+
+    if (_PAPPL_REQUESTED(ra, _PAPPL_RA_MARKER_LEVELS))
+    {
+      for (i = 0; i < (size_t)printer->num_supply; i ++)
+        ivalues[i] = supply[i].level;
+
+      ippAddIntegers(ipp, IPP_TAG_PRINTER, IPP_TAG_INTEGER, "marker-levels", IPP_NUM_CAST printer->num_supply, ivalues);
+    }
+
+    if (_PAPPL_REQUESTED(ra, _PAPPL_RA_MARKER_LOW_LEVELS))
+    {
+      for (i = 0; i < (size_t)printer->num_supply; i ++)
+        ivalues[i] = supply[i].is_consumed ? 10 : 0;
+
+      ippAddIntegers(ipp, IPP_TAG_PRINTER, IPP_TAG_INTEGER, "marker-low-levels", IPP_NUM_CAST printer->num_supply, ivalues);
+    }
+
+    if (_PAPPL_REQUESTED(ra, _PAPPL_RA_MARKER_NAMES))
+    {
+      for (i = 0; i < (size_t)printer->num_supply; i ++)
+        svalues[i] = supply[i].description;
+
+      ippAddStrings(ipp, IPP_TAG_PRINTER, IPP_TAG_NAME, "marker-names", IPP_NUM_CAST printer->num_supply, NULL, svalues);
+    }
+
+    if (_PAPPL_REQUESTED(ra, _PAPPL_RA_MARKER_TYPES))
+    {
+      for (i = 0; i < (size_t)printer->num_supply; i ++)
+        svalues[i] = _papplMarkerTypeString(supply[i].type);
+
+      ippAddStrings(ipp, IPP_TAG_PRINTER, IPP_CONST_TAG(IPP_TAG_KEYWORD), "marker-types", IPP_NUM_CAST printer->num_supply, NULL, svalues);
+    }
+  }
+
+  if ((_PAPPL_REQUESTED(ra, _PAPPL_RA_MEDIA_COL_DEFAULT)) && data->media_default.size_name[0])
+  {
+    ipp_t *col = _papplMediaColExport(&printer->driver_data, &data->media_default, 0);
+					// Collection value
+
+    ippAddCollection(ipp, IPP_TAG_PRINTER, "media-col-default", col);
+    ippDelete(col);
+  }
+
+  if (_PAPPL_REQUESTED(ra, _PAPPL_RA_MEDIA_COL_READY))
+  {
+    size_t		j,		// Looping var
+			count;		// Number of values
+    ipp_t		*col;		// Collection value
+    ipp_attribute_t	*attr;		// media-col-ready attribute
+    pappl_media_col_t	media;		// Current media...
+
+    for (i = 0, count = 0; i < (size_t)printer->num_ready; i ++)
+    {
+      if (data->media_ready[i].size_name[0])
+        count ++;
+    }
+
+    if (data->borderless && (data->bottom_top != 0 || data->left_right != 0))
+      count *= 2;			// Need to report ready media for borderless, too...
+
+    if (count > 0)
+    {
+      attr = ippAddCollections(ipp, IPP_TAG_PRINTER, "media-col-ready", IPP_NUM_CAST count, NULL);
+
+      for (i = 0, j = 0; i < (size_t)printer->num_ready && j < count; i ++)
+      {
+	if (data->media_ready[i].size_name[0])
+	{
+          if (data->borderless && (data->bottom_top != 0 || data->left_right != 0))
+	  {
+	    // Report both bordered and borderless media-col values...
+	    media = data->media_ready[i];
+
+	    media.bottom_margin = media.top_margin   = data->bottom_top;
+	    media.left_margin   = media.right_margin = data->left_right;
+	    col = _papplMediaColExport(&printer->driver_data, &media, 0);
+	    ippSetCollection(ipp, &attr, IPP_NUM_CAST j ++, col);
+	    ippDelete(col);
+
+	    media.bottom_margin = media.top_margin   = 0;
+	    media.left_margin   = media.right_margin = 0;
+	    col = _papplMediaColExport(&printer->driver_data, &media, 0);
+	    ippSetCollection(ipp, &attr, IPP_NUM_CAST j ++, col);
+	    ippDelete(col);
+	  }
+	  else
+	  {
+	    // Just report the single media-col value...
+	    col = _papplMediaColExport(&printer->driver_data, data->media_ready + i, 0);
+	    ippSetCollection(ipp, &attr, IPP_NUM_CAST j ++, col);
+	    ippDelete(col);
+	  }
+	}
+      }
+    }
+  }
+
+  if ((_PAPPL_REQUESTED(ra, _PAPPL_RA_MEDIA_DEFAULT)) && data->media_default.size_name[0])
+    ippAddString(ipp, IPP_TAG_PRINTER, IPP_TAG_KEYWORD, "media-default", NULL, data->media_default.size_name);
+
+  if (_PAPPL_REQUESTED(ra, _PAPPL_RA_MEDIA_READY))
+  {
+    size_t		j,		// Looping vars
+			count;		// Number of values
+    ipp_attribute_t	*attr;		// media-col-ready attribute
+
+    for (i = 0, count = 0; i < (size_t)printer->num_ready; i ++)
+    {
+      if (data->media_ready[i].size_name[0])
+        count ++;
+    }
+
+    if (count > 0)
+    {
+      attr = ippAddStrings(ipp, IPP_TAG_PRINTER, IPP_TAG_KEYWORD, "media-ready", IPP_NUM_CAST count, NULL, NULL);
+
+      for (i = 0, j = 0; i < (size_t)printer->num_ready && j < count; i ++)
+      {
+	if (data->media_ready[i].size_name[0])
+	  ippSetString(ipp, &attr, IPP_NUM_CAST j ++, data->media_ready[i].size_name);
+      }
+    }
+  }
+
+  if (_PAPPL_REQUESTED(ra, _PAPPL_RA_MULTIPLE_DOCUMENT_HANDLING_DEFAULT))
+    ippAddString(ipp, IPP_TAG_PRINTER, IPP_CONST_TAG(IPP_TAG_KEYWORD), "multiple-document-handling-default", NULL, "separate-documents-collated-copies");
+
+  if (_PAPPL_REQUESTED(ra, _PAPPL_RA_ORIENTATION_REQUESTED_DEFAULT))
+    ippAddInteger(ipp, IPP_TAG_PRINTER, IPP_TAG_ENUM, "orientation-requested-default", (int)data->orient_default);
+
+  if (_PAPPL_REQUESTED(ra, _PAPPL_RA_OUTPUT_BIN_DEFAULT))
+  {
+    if (data->num_bin > 0)
+      ippAddString(ipp, IPP_TAG_PRINTER, IPP_CONST_TAG(IPP_TAG_KEYWORD), "output-bin-default", NULL, data->bin[data->bin_default]);
+    else if (data->output_face_up)
+      ippAddString(ipp, IPP_TAG_PRINTER, IPP_CONST_TAG(IPP_TAG_KEYWORD), "output-bin-default", NULL, "face-up");
+    else
+      ippAddString(ipp, IPP_TAG_PRINTER, IPP_CONST_TAG(IPP_TAG_KEYWORD), "output-bin-default", NULL, "face-down");
+  }
+
+  if ((_PAPPL_REQUESTED(ra, _PAPPL_RA_PRINT_COLOR_MODE_DEFAULT)) && data->color_default)
+    ippAddString(ipp, IPP_TAG_PRINTER, IPP_CONST_TAG(IPP_TAG_KEYWORD), "print-color-mode-default", NULL, _papplColorModeString(data->color_default));
+
+  if (_PAPPL_REQUESTED(ra, _PAPPL_RA_PRINT_CONTENT_OPTIMIZE_DEFAULT))
+  {
+    if (data->content_default)
+      ippAddString(ipp, IPP_TAG_PRINTER, IPP_CONST_TAG(IPP_TAG_KEYWORD), "print-content-optimize-default", NULL, _papplContentString(data->content_default));
+    else
+      ippAddString(ipp, IPP_TAG_PRINTER, IPP_CONST_TAG(IPP_TAG_KEYWORD), "print-content-optimize-default", NULL, "auto");
+  }
+
+  if (_PAPPL_REQUESTED(ra, _PAPPL_RA_PRINT_QUALITY_DEFAULT))
+  {
+    if (data->quality_default)
+      ippAddInteger(ipp, IPP_TAG_PRINTER, IPP_TAG_ENUM, "print-quality-default", (int)data->quality_default);
+    else
+      ippAddInteger(ipp, IPP_TAG_PRINTER, IPP_TAG_ENUM, "print-quality-default", IPP_QUALITY_NORMAL);
+  }
+
+  if (_PAPPL_REQUESTED(ra, _PAPPL_RA_PRINT_SCALING_DEFAULT))
+  {
+    if (data->scaling_default)
+      ippAddString(ipp, IPP_TAG_PRINTER, IPP_CONST_TAG(IPP_TAG_KEYWORD), "print-scaling-default", NULL, _papplScalingString(data->scaling_default));
+    else
+      ippAddString(ipp, IPP_TAG_PRINTER, IPP_CONST_TAG(IPP_TAG_KEYWORD), "print-scaling-default", NULL, "auto");
+  }
+
+  if (_PAPPL_REQUESTED(ra, _PAPPL_RA_PRINTER_CONTACT_COL))
+  {
+    ipp_t *col = _papplContactExport(&printer->contact);
+    ippAddCollection(ipp, IPP_TAG_PRINTER, "printer-contact-col", col);
+    ippDelete(col);
+  }
+
+  if ((_PAPPL_REQUESTED(ra, _PAPPL_RA_PRINTER_DARKNESS_CONFIGURED)) && data->darkness_supported > 0)
+    ippAddInteger(ipp, IPP_TAG_PRINTER, IPP_TAG_INTEGER, "printer-darkness-configured", data->darkness_configured);
+
+  if (_PAPPL_REQUESTED(ra, _PAPPL_RA_PRINTER_DNS_SD_NAME))
+    ippAddString(ipp, IPP_TAG_PRINTER, IPP_TAG_NAME, "printer-dns-sd-name", NULL, printer->dns_sd_name ? printer->dns_sd_name : "");
+
+  if (_PAPPL_REQUESTED(ra, _PAPPL_RA_PRINTER_GEO_LOCATION))
+  {
+    if (printer->geo_location)
+      ippAddString(ipp, IPP_TAG_PRINTER, IPP_TAG_URI, "printer-geo-location", NULL, printer->geo_location);
+    else
+      ippAddOutOfBand(ipp, IPP_TAG_PRINTER, IPP_TAG_UNKNOWN, "printer-geo-location");
+  }
+
+  if (_PAPPL_REQUESTED(ra, _PAPPL_RA_PRINTER_ICONS))
+  {
+    char	uris[3][1024];		// Buffers for URIs
+    const char	*values[3];		// Values for attribute
+
+    httpAssembleURIf(HTTP_URI_CODING_ALL, uris[0], sizeof(uris[0]), webscheme, NULL, client->host_field, client->host_port, "%s/icon-sm.png", printer->uriname);
+    httpAssembleURIf(HTTP_URI_CODING_ALL, uris[1], sizeof(uris[1]), webscheme, NULL, client->host_field, client->host_port, "%s/icon-md.png", printer->uriname);
+    httpAssembleURIf(HTTP_URI_CODING_ALL, uris[2], sizeof(uris[2]), webscheme, NULL, client->host_field, client->host_port, "%s/icon-lg.png", printer->uriname);
+
+    values[0] = uris[0];
+    values[1] = uris[1];
+    values[2] = uris[2];
+
+    ippAddStrings(ipp, IPP_TAG_PRINTER, IPP_TAG_URI, "printer-icons", 3, NULL, values);
+  }
+
+  if (_PAPPL_REQUESTED(ra, _PAPPL_RA_PRINTER_INPUT_TRAY))
+  {
+    ipp_attribute_t	*attr = NULL;	// "printer-input-tray" attribute
+    char		value[256];	// Value for current tray
+    pappl_media_col_t	*media;		// Media in the tray
+
+    for (i = 0, media = data->media_ready; i < (size_t)data->num_source; i ++, media ++)
+    {
+      const char	*type;		// Tray type
+
+      if (!strcmp(data->source[i], "manual"))
+        type = "sheetFeedManual";
+      else if (!strcmp(data->source[i], "by-pass-tray"))
+        type = "sheetFeedAutoNonRemovableTray";
+      else
+        type = "sheetFeedAutoRemovableTray";
+
+      snprintf(value, sizeof(value), "type=%s;mediafeed=%d;mediaxfeed=%d;maxcapacity=%d;level=-2;status=0;name=%s;", type, media->size_length, media->size_width, !strcmp(media->source, "manual") ? 1 : -2, media->source);
+
+      if (attr)
+        ippSetOctetString(ipp, &attr, ippGetCount(attr), value, IPP_NUM_CAST strlen(value));
+      else
+        attr = ippAddOctetString(ipp, IPP_TAG_PRINTER, "printer-input-tray", value, IPP_NUM_CAST strlen(value));
+    }
+
+    // The "auto" tray is a dummy entry...
+    papplCopyString(value, "type=other;mediafeed=0;mediaxfeed=0;maxcapacity=-2;level=-2;status=0;name=auto;", sizeof(value));
+    ippSetOctetString(ipp, &attr, ippGetCount(attr), value, IPP_NUM_CAST strlen(value));
+  }
+
+  if (_PAPPL_REQUESTED(ra, _PAPPL_RA_PRINTER_LOCATION))
+    ippAddString(ipp, IPP_TAG_PRINTER, IPP_TAG_TEXT, "printer-location", NULL, printer->location ? printer->location : "");
+
+  if (_PAPPL_REQUESTED(ra, _PAPPL_RA_PRINTER_MORE_INFO))
+  {
+    char	uri[1024];		// URI value
+
+    httpAssembleURIf(HTTP_URI_CODING_ALL, uri, sizeof(uri), webscheme, NULL, client->host_field, client->host_port, "%s/", printer->uriname);
+    ippAddString(ipp, IPP_TAG_PRINTER, IPP_TAG_URI, "printer-more-info", NULL, uri);
+  }
+
+  if (_PAPPL_REQUESTED(ra, _PAPPL_RA_PRINTER_ORGANIZATION))
+    ippAddString(ipp, IPP_TAG_PRINTER, IPP_TAG_TEXT, "printer-organization", NULL, printer->organization ? printer->organization : "");
 
-      for (; i < PAPPL_MAX_SOURCE; i ++)
-        memset(driver_data.media_ready + i, 0, sizeof(pappl_media_col_t));
+  if (_PAPPL_REQUESTED(ra, _PAPPL_RA_PRINTER_ORGANIZATIONAL_UNIT))
+    ippAddString(ipp, IPP_TAG_PRINTER, IPP_TAG_TEXT, "printer-organizational-unit", NULL, printer->org_unit ? printer->org_unit : "");
 
-      do_ready = true;
-    }
-    else if (!strcmp(name, "media-default"))
-    {
-      if ((pwg = pwgMediaForPWG(ippGetString(rattr, 0, NULL))) != NULL)
-      {
-        papplCopyString(driver_data.media_default.size_name, pwg->pwg, sizeof(driver_data.media_default.size_name));
-        driver_data.media_default.size_width  = pwg->width;
-        driver_data.media_default.size_length = pwg->length;
-      }
+  if (_PAPPL_REQUESTED(ra, _PAPPL_RA_PRINTER_RESOLUTION_DEFAULT))
+    ippAddResolution(ipp, IPP_TAG_PRINTER, "printer-resolution-default", IPP_RES_PER_INCH, data->x_default, data->y_default);
 
-      do_defaults = true;
-    }
-    else if (!strcmp(name, "media-ready"))
+  if (_PAPPL_REQUESTED(ra, _PAPPL_RA_PRINTER_SPEED_DEFAULT))
+    ippAddInteger(ipp, IPP_TAG_PRINTER, IPP_TAG_INTEGER, "printer-speed-default", data->speed_default);
+
+  if (printer->num_supply > 0)
+  {
+    pappl_supply_t	 *supply = printer->supply;
+					// Supply values...
+
+    if (_PAPPL_REQUESTED(ra, _PAPPL_RA_PRINTER_SUPPLY))
     {
-      count = ippGetCount(rattr);
+      char		value[256];	// "printer-supply" value
+      ipp_attribute_t	*attr = NULL;	// "printer-supply" attribute
 
-      for (i = 0; i < count; i ++)
+      for (i = 0; i < (size_t)printer->num_supply; i ++)
       {
-        if ((pwg = pwgMediaForPWG(ippGetString(rattr, i, NULL))) != NULL)
-        {
-          papplCopyString(driver_data.media_ready[i].size_name, pwg->pwg, sizeof(driver_data.media_ready[i].size_name));
-	  driver_data.media_ready[i].size_width  = pwg->width;
-	  driver_data.media_ready[i].size_length = pwg->length;
-	}
-      }
+	snprintf(value, sizeof(value), "index=%u;type=%s;maxcapacity=100;level=%d;colorantname=%s;", (unsigned)i, _papplSupplyTypeString(supply[i].type), supply[i].level, _papplSupplyColorString(supply[i].color));
 
-      for (; i < PAPPL_MAX_SOURCE; i ++)
-      {
-        driver_data.media_ready[i].size_name[0] = '\0';
-        driver_data.media_ready[i].size_width   = 0;
-        driver_data.media_ready[i].size_length  = 0;
+	if (attr)
+	  ippSetOctetString(ipp, &attr, ippGetCount(attr), value, IPP_NUM_CAST strlen(value));
+	else
+	  attr = ippAddOctetString(ipp, IPP_TAG_PRINTER, "printer-supply", value, IPP_NUM_CAST strlen(value));
       }
-
-      do_ready = true;
-    }
-    else if (!strcmp(name, "orientation-requested-default"))
-    {
-      driver_data.orient_default = (ipp_orient_t)ippGetInteger(rattr, 0);
-      do_defaults = true;
-    }
-    else if (!strcmp(name, "print-color-mode-default"))
-    {
-      driver_data.color_default = _papplColorModeValue(ippGetString(rattr, 0, NULL));
-      do_defaults = true;
-    }
-    else if (!strcmp(name, "print-content-optimize-default"))
-    {
-      driver_data.content_default = _papplContentValue(ippGetString(rattr, 0, NULL));
-      do_defaults = true;
-    }
-    else if (!strcmp(name, "print-darkness-default"))
-    {
-      driver_data.darkness_default = ippGetInteger(rattr, 0);
-      do_defaults = true;
-    }
-    else if (!strcmp(name, "print-quality-default"))
-    {
-      driver_data.quality_default = (ipp_quality_t)ippGetInteger(rattr, 0);
-      do_defaults = true;
-    }
-    else if (!strcmp(name, "print-scaling-default"))
-    {
-      driver_data.scaling_default = _papplScalingValue(ippGetString(rattr, 0, NULL));
-      do_defaults = true;
-    }
-    else if (!strcmp(name, "print-speed-default"))
-    {
-      driver_data.speed_default = ippGetInteger(rattr, 0);
-      do_defaults = true;
-    }
-    else if (!strcmp(name, "printer-contact-col"))
-    {
-      _papplContactImport(ippGetCollection(rattr, 0), &contact);
-      do_contact = true;
-    }
-    else if (!strcmp(name, "printer-darkness-configured"))
-    {
-      driver_data.darkness_configured = ippGetInteger(rattr, 0);
-      do_defaults = true;
     }
-    else if (!strcmp(name, "printer-geo-location"))
-    {
-      float geo_lat, geo_lon;		// Latitude and longitude
 
-      geo_location = ippGetString(rattr, 0, NULL);
-      if (sscanf(geo_location, "geo:%f,%f", &geo_lat, &geo_lon) != 2 || geo_lat < -90.0 || geo_lat > 90.0 || geo_lon < -180.0 || geo_lon > 180.0)
-        papplClientRespondIPPUnsupported(client, rattr);
-    }
-    else if (!strcmp(name, "printer-location"))
-    {
-      location = ippGetString(rattr, 0, NULL);
-    }
-    else if (!strcmp(name, "printer-organization"))
-    {
-      organization = ippGetString(rattr, 0, NULL);
-    }
-    else if (!strcmp(name, "printer-organization-unit"))
-    {
-      org_unit = ippGetString(rattr, 0, NULL);
-    }
-    else if (!strcmp(name, "printer-resolution-default"))
+    if (_PAPPL_REQUESTED(ra, _PAPPL_RA_PRINTER_SUPPLY_DESCRIPTION))
     {
-      ipp_res_t units;			// Resolution units
+      for (i = 0; i < (size_t)printer->num_supply; i ++)
+        svalues[i] = supply[i].description;
 
-      driver_data.x_default = ippGetResolution(rattr, 0, &driver_data.y_default, &units);
-      do_defaults = true;
+      ippAddStrings(ipp, IPP_TAG_PRINTER, IPP_TAG_TEXT, "printer-supply-description", IPP_NUM_CAST printer->num_supply, NULL, svalues);
     }
-    else if (!strcmp(name, "printer-wifi-password"))
-    {
-      void		*data;		// Password
-      cups_len_t	datalen;	// Length of password
+  }
 
-      data = ippGetOctetString(rattr, 0, &datalen);
-      if (datalen > ((int)sizeof(wifi_password) - 1))
-      {
-	papplClientRespondIPPUnsupported(client, rattr);
-	continue;
-      }
+  if (_PAPPL_REQUESTED(ra, _PAPPL_RA_PRINTER_SUPPLY_INFO_URI))
+  {
+    char	uri[1024];		// URI value
 
-      memcpy(wifi_password, data, datalen);
-      wifi_password[datalen] = '\0';
+    httpAssembleURIf(HTTP_URI_CODING_ALL, uri, sizeof(uri), webscheme, NULL, client->host_field, client->host_port, "%s/supplies", printer->uriname);
+    ippAddString(ipp, IPP_TAG_PRINTER, IPP_TAG_URI, "printer-supply-info-uri", NULL, uri);
+  }
 
-      do_wifi = true;
-    }
-    else if (!strcmp(name, "printer-wifi-ssid"))
+  if (_PAPPL_REQUESTED(ra, _PAPPL_RA_PRINTER_URI_SUPPORTED))
+  {
+    char	uris[2][1024];		// Buffers for URIs
+    const char	*values[2];		// Values for attribute
+
+    num_values = 0;
+
+    if (httpAddrLocalhost(httpGetAddress(client->http)) || !papplSystemGetTLSOnly(client->system))
     {
-      papplCopyString(wifi_ssid, ippGetString(rattr, 0, NULL), sizeof(wifi_ssid));
-      do_wifi = true;
+      httpAssembleURI(HTTP_URI_CODING_ALL, uris[num_values], sizeof(uris[0]), "ipp", NULL, client->host_field, client->host_port, printer->resource);
+      values[num_values] = uris[num_values];
+      num_values ++;
     }
-  }
 
-  if (ippGetStatusCode(client->response) != IPP_STATUS_OK)
-  {
-    cupsFreeOptions(num_vendor, vendor);
-    return (false);
-  }
+    if (!httpAddrLocalhost(httpGetAddress(client->http)) && !(client->system->options & PAPPL_SOPTIONS_NO_TLS))
+    {
+      httpAssembleURI(HTTP_URI_CODING_ALL, uris[num_values], sizeof(uris[0]), "ipps", NULL, client->host_field, client->host_port, printer->resource);
+      values[num_values] = uris[num_values];
+      num_values ++;
+    }
 
-  // Now apply changes...
-  if (do_defaults && !papplPrinterSetDriverDefaults(printer, &driver_data, (int)num_vendor, vendor))
-  {
-    papplClientRespondIPP(client, IPP_STATUS_ERROR_ATTRIBUTES_OR_VALUES, "One or more attribute values were not supported.");
-    cupsFreeOptions(num_vendor, vendor);
-    return (false);
+    if (num_values > 0)
+      ippAddStrings(ipp, IPP_TAG_PRINTER, IPP_TAG_URI, "printer-uri-supported", IPP_NUM_CAST num_values, NULL, values);
   }
 
-  cupsFreeOptions(num_vendor, vendor);
+  if (_PAPPL_REQUESTED(ra, _PAPPL_RA_PRINTER_XRI_SUPPORTED))
+    _papplPrinterCopyXRI(printer, ipp, client);
 
-  if (do_ready && !papplPrinterSetReadyMedia(printer, driver_data.num_source, driver_data.media_ready))
+  if (_PAPPL_REQUESTED(ra, _PAPPL_RA_SIDES_DEFAULT))
   {
-    papplClientRespondIPP(client, IPP_STATUS_ERROR_ATTRIBUTES_OR_VALUES, "One or more attribute values were not supported.");
-    return (false);
+    if (data->sides_default)
+      ippAddString(ipp, IPP_TAG_PRINTER, IPP_CONST_TAG(IPP_TAG_KEYWORD), "sides-default", NULL, _papplSidesString(data->sides_default));
+    else
+      ippAddString(ipp, IPP_TAG_PRINTER, IPP_CONST_TAG(IPP_TAG_KEYWORD), "sides-default", NULL, "one-sided");
   }
 
-  if (do_wifi)
+  if (_PAPPL_REQUESTED(ra, _PAPPL_RA_URI_AUTHENTICATION_SUPPORTED))
   {
-    if (!(printer->system->wifi_join_cb)(printer->system, printer->system->wifi_cbdata, wifi_ssid, wifi_password))
+    // For each supported printer-uri value, report whether authentication is
+    // supported.  Since we only support authentication over a secure (TLS)
+    // channel, the value is always 'none' for the "ipp" URI and either 'none'
+    // or 'basic' for the "ipps" URI...
+    if (httpAddrLocalhost(httpGetAddress(client->http)) || (client->system->options & PAPPL_SOPTIONS_NO_TLS))
     {
-      papplClientRespondIPP(client, IPP_STATUS_ERROR_ATTRIBUTES_OR_VALUES, "Unable to join Wi-Fi network '%s'.", wifi_ssid);
-      return (false);
+      ippAddString(ipp, IPP_TAG_PRINTER, IPP_CONST_TAG(IPP_TAG_KEYWORD), "uri-authentication-supported", NULL, "none");
     }
-  }
-
-  if (do_contact)
-    papplPrinterSetContact(printer, &contact);
-
-  if (geo_location)
-    papplPrinterSetGeoLocation(printer, geo_location);
-
-  if (location)
-    papplPrinterSetGeoLocation(printer, location);
+    else if (papplSystemGetTLSOnly(client->system))
+    {
+      if (papplSystemGetAuthService(client->system))
+        ippAddString(ipp, IPP_TAG_PRINTER, IPP_CONST_TAG(IPP_TAG_KEYWORD), "uri-authentication-supported", NULL, "basic");
+      else
+        ippAddString(ipp, IPP_TAG_PRINTER, IPP_CONST_TAG(IPP_TAG_KEYWORD), "uri-authentication-supported", NULL, "none");
+    }
+    else if (papplSystemGetAuthService(client->system))
+    {
+      static const char * const uri_authentication_basic[] =
+      {					// uri-authentication-supported values
+	"none",
+	"basic"
+      };
 
-  if (organization)
-    papplPrinterSetGeoLocation(printer, organization);
+      ippAddStrings(ipp, IPP_TAG_PRINTER, IPP_CONST_TAG(IPP_TAG_KEYWORD), "uri-authentication-supported", 2, NULL, uri_authentication_basic);
+    }
+    else
+    {
+      static const char * const uri_authentication_none[] =
+      {					// uri-authentication-supported values
+	"none",
+	"none"
+      };
 
-  if (org_unit)
-    papplPrinterSetGeoLocation(printer, org_unit);
+      ippAddStrings(ipp, IPP_TAG_PRINTER, IPP_CONST_TAG(IPP_TAG_KEYWORD), "uri-authentication-supported", 2, NULL, uri_authentication_none);
+    }
+  }
+}
 
-  papplSystemAddEvent(printer->system, printer, NULL, PAPPL_EVENT_PRINTER_CONFIG_CHANGED, NULL);
 
-  return (true);
-}
 
 
 //
@@ -1233,6 +1371,19 @@ create_job(
 }
 
 
+//
+// 'free_pcache()' - Free a cached attribute set.
+//
+
+static void
+free_pcache(_pappl_pcache_t *pc)	// I - Cached attribute set
+{
+  free(pc->key);
+  ippDelete(pc->attrs);
+  free(pc);
+}
+
+
 //
 // 'ipp_cancel_current_job()' - Cancel the current job.
 //
@@ -1313,7 +1464,8 @@ static void
 ipp_create_job(pappl_client_t *client)	// I - Client
 {
   pappl_job_t		*job;		// New job
-  cups_array_t		*ra;		// Attributes to send in response
+  cups_array_t		*names;		// Attribute names to send in response
+  _pappl_ra_t		*ra;		// Attributes to send in response
 
 
   // Authorize access...
@@ -1349,15 +1501,16 @@ ipp_create_job(pappl_client_t *client)	// I - Client
   // Return the job info...
   papplClientRespondIPP(client, IPP_STATUS_OK, NULL);
 
-  ra = cupsArrayNew((cups_array_cb_t)strcmp, NULL, NULL, 0, NULL, NULL);
-  cupsArrayAdd(ra, "job-id");
-  cupsArrayAdd(ra, "job-state");
-  cupsArrayAdd(ra, "job-state-message");
-  cupsArrayAdd(ra, "job-state-reasons");
-  cupsArrayAdd(ra, "job-uri");
+  names = cupsArrayNew((cups_array_cb_t)strcmp, NULL, NULL, 0, NULL, NULL);
+  cupsArrayAdd(names, "job-id");
+  cupsArrayAdd(names, "job-state");
+  cupsArrayAdd(names, "job-state-message");
+  cupsArrayAdd(names, "job-state-reasons");
+  cupsArrayAdd(names, "job-uri");
 
+  ra = _papplCreateRequestedAttrs(names);
   _papplJobCopyAttributes(job, client, ra);
-  cupsArrayDelete(ra);
+  _papplDeleteRequestedAttrs(ra);
 }
 
 
@@ -1413,7 +1566,7 @@ ipp_get_jobs(pappl_client_t *client)	// I - Client
   const char		*username;	// Username
   cups_array_t		*list;		// Jobs list
   pappl_job_t		*job;		// Current job pointer
-  cups_array_t		*ra;		// Requested attributes array
+  _pappl_ra_t		*ra;		// Requested attributes
 
 
   // Authorize access...
@@ -1490,7 +1643,7 @@ ipp_get_jobs(pappl_client_t *client)	// I - Client
   }
 
   // OK, build a list of jobs for this printer...
-  ra = ippCreateRequestedArray(client->request);
+  ra = _papplCreateRequestedAttrs(ippCreateRequestedArray(client->request));
 
   papplClientRespondIPP(client, IPP_STATUS_OK, NULL);
 
@@ -1515,7 +1668,7 @@ ipp_get_jobs(pappl_client_t *client)	// I - Client
     _papplJobCopyAttributes(job, client, ra);
   }
 
-  cupsArrayDelete(ra);
+  _papplDeleteRequestedAttrs(ra);
 
   pthread_rwlock_unlock(&(client->printer->rwlock));
 }
@@ -1529,7 +1682,7 @@ static void
 ipp_get_printer_attributes(
     pappl_client_t *client)		// I - Client
 {
-  cups_array_t		*ra;		// Requested attributes array
+  _pappl_ra_t		*ra;		// Requested attributes
   pappl_printer_t	*printer = client->printer;
 					// Printer
 
@@ -1542,7 +1695,7 @@ ipp_get_printer_attributes(
   }
 
   // Send the attributes...
-  ra = ippCreateRequestedArray(client->request);
+  ra = _papplCreateRequestedAttrs(ippCreateRequestedArray(client->request));
 
   papplClientRespondIPP(client, IPP_STATUS_OK, NULL);
 
@@ -1552,7 +1705,7 @@ ipp_get_printer_attributes(
 
   pthread_rwlock_unlock(&(printer->rwlock));
 
-  cupsArrayDelete(ra);
+  _papplDeleteRequestedAttrs(ra);
 }
 
 
@@ -1729,6 +1882,60 @@ ipp_validate_job(
 }
 
 
+//
+// 'make_cache_key()' - Make the cache key for a Get-Printer-Attributes request.
+//
+// The key combines the document format, the client's Host: value, whether the
+// client is local, and the (sorted) list of requested attributes.
+//
+
+static char *				// O - Cache key or `NULL` on error
+make_cache_key(pappl_client_t *client,	// I - Client
+               _pappl_ra_t    *ra,	// I - Requested attributes
+               const char     *format)	// I - "document-format" value, if any
+{
+  char		*key,			// Cache key
+		*keyptr;		// Pointer into cache key
+  size_t	keysize;		// Size of cache key
+  const char	*name;			// Current attribute name
+
+
+  // Figure out how much memory is needed...
+  keysize = strlen(format ? format : "") + strlen(client->host_field) + 32;
+
+  if (ra)
+  {
+    for (name = (const char *)cupsArrayGetFirst(ra->names); name; name = (const char *)cupsArrayGetNext(ra->names))
+      keysize += strlen(name) + 1;
+  }
+
+  if ((key = (char *)malloc(keysize)) == NULL)
+    return (NULL);
+
+  // Build the key...
+  snprintf(key, keysize, "%s|%s:%d|%d|", format ? format : "", client->host_field, client->host_port, httpAddrLocalhost(httpGetAddress(client->http)));
+  keyptr = key + strlen(key);
+
+  if (ra)
+  {
+    for (name = (const char *)cupsArrayGetFirst(ra->names); name; name = (const char *)cupsArrayGetNext(ra->names))
+    {
+      if (keyptr > key && keyptr[-1] != '|')
+        *keyptr++ = ',';
+
+      papplCopyString(keyptr, name, keysize - (size_t)(keyptr - key));
+      keyptr += strlen(keyptr);
+    }
+  }
+  else
+  {
+    papplCopyString(keyptr, "*", keysize - (size_t)(keyptr - key));
+  }
+
+  return (key);
+}
+
+
 //
 // 'valid_job_attributes()' - Determine whether the job attributes are valid.
 //
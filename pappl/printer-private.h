@@ -30,6 +30,14 @@
 #  include "device.h"
 
 
+//
+// Constants...
+//
+
+#  define _PAPPL_DEVICE_RETRY_MIN 2	// Initial device reconnect delay in seconds
+#  define _PAPPL_DEVICE_RETRY_MAX 60	// Maximum device reconnect delay in seconds
+
+
 //
 // Types and structures...
 //
@@ -59,11 +67,20 @@ struct _pappl_printer_s			// Printer data
 			*device_uri;		// Device URI
   pappl_device_t	*device;		// Current connection to device (if any)
   bool			device_in_use;		// Is the device in use?
+  pappl_job_t		*device_job;		// Job using the device, if any
+  int			device_linger;		// Number of seconds to keep an idle device open
+  time_t		device_time;		// Time when the device became idle
+  time_t		device_retry;		// Time of next device open attempt, if offline
+  int			device_backoff;		// Current device reconnect delay in seconds
   char			*driver_name;		// Driver name
   pappl_pr_driver_data_t driver_data;		// Driver data
   ipp_t			*driver_attrs;		// Driver attributes
   int			num_ready;		// Number of ready media
   ipp_t			*attrs;			// Other (static) printer attributes
+  size_t		generation;		// Generation number for attribute changes
+  pthread_mutex_t	cache_mutex;		// Mutex for attribute cache
+  cups_array_t		*cache;			// Cached printer attributes
+  size_t		cache_uses;		// Cache use counter for LRU eviction
   time_t		start_time;		// Startup time
   time_t		config_time;		// "printer-config-change-time" value
   time_t		status_time;		// Last time status was updated
@@ -73,6 +90,14 @@ struct _pappl_printer_s			// Printer data
   pappl_supply_t	supply[PAPPL_MAX_SUPPLY];
 						// "printer-supply" values
   pappl_job_t		*processing_job;	// Currently printing job, if any
+  int			num_processing_jobs,	// Number of jobs being processed
+			max_processing_jobs;	// Maximum number of jobs to process at once
+  pappl_job_t		**pending_jobs;		// Pending jobs in scheduling order (heap)
+  size_t		num_pending_jobs,	// Number of pending jobs
+			alloc_pending_jobs;	// Allocated pending job slots
+  cups_array_t		*fair_shares;		// Fair share credits by user
+  size_t		fair_share_time;	// Fair share credit of last started job
+  bool			is_queued;		// Is the printer waiting for a job worker?
   int			max_active_jobs,	// Maximum number of active jobs to accept
 			max_completed_jobs,	// Maximum number of completed jobs to retain in history
 			max_preserved_jobs;	// Maximum number of completed jobs to preserve in history
@@ -118,16 +143,20 @@ extern void		*_papplPrinterRunRaw(pappl_printer_t *printer) _PAPPL_PRIVATE;
 
 extern void		*_papplPrinterRunUSB(pappl_printer_t *printer) _PAPPL_PRIVATE;
 
+extern bool		_papplPrinterAddPendingJobNoLock(pappl_printer_t *printer, pappl_job_t *job) _PAPPL_PRIVATE;
 extern void		_papplPrinterCheckJobs(pappl_printer_t *printer) _PAPPL_PRIVATE;
 extern void		_papplPrinterCleanJobsNoLock(pappl_printer_t *printer) _PAPPL_PRIVATE;
-extern void		_papplPrinterCopyAttributes(pappl_printer_t *printer, pappl_client_t *client, cups_array_t *ra, const char *format) _PAPPL_PRIVATE;
-extern void		_papplPrinterCopyState(pappl_printer_t *printer, ipp_tag_t group_tag, ipp_t *ipp, pappl_client_t *client, cups_array_t *ra) _PAPPL_PRIVATE;
+extern void		_papplPrinterCloseIdleDevice(pappl_printer_t *printer, bool force) _PAPPL_PRIVATE;
+extern void		_papplPrinterCopyAttributes(pappl_printer_t *printer, pappl_client_t *client, _pappl_ra_t *ra, const char *format) _PAPPL_PRIVATE;
+extern void		_papplPrinterCopyState(pappl_printer_t *printer, ipp_tag_t group_tag, ipp_t *ipp, pappl_client_t *client, _pappl_ra_t *ra) _PAPPL_PRIVATE;
 extern void		_papplPrinterCopyXRI(pappl_printer_t *printer, ipp_t *ipp, pappl_client_t *client) _PAPPL_PRIVATE;
 extern void		_papplPrinterDelete(pappl_printer_t *printer) _PAPPL_PRIVATE;
 extern void		_papplPrinterInitDriverData(pappl_pr_driver_data_t *d) _PAPPL_PRIVATE;
 extern bool		_papplPrinterIsAuthorized(pappl_client_t *client) _PAPPL_PRIVATE;
+extern pappl_job_t	*_papplPrinterNextJob(pappl_printer_t *printer) _PAPPL_PRIVATE;
 extern void		_papplPrinterProcessIPP(pappl_client_t *client) _PAPPL_PRIVATE;
 extern bool		_papplPrinterRegisterDNSSDNoLock(pappl_printer_t *printer) _PAPPL_PRIVATE;
+extern void		_papplPrinterRemovePendingJobNoLock(pappl_printer_t *printer, pappl_job_t *job) _PAPPL_PRIVATE;
 extern bool		_papplPrinterSetAttributes(pappl_client_t *client, pappl_printer_t *printer) _PAPPL_PRIVATE;
 extern void		_papplPrinterUnregisterDNSSDNoLock(pappl_printer_t *printer) _PAPPL_PRIVATE;
 
@@ -113,6 +113,7 @@ _papplPrinterRunRaw(
           socklen_t	sockaddrlen;	// Length of client address
           struct pollfd	sockp;		// poll() data for client socket
           pappl_job_t	*job;		// New print job
+          bool		queued;		// Was the job queued?
           ssize_t	bytes;		// Bytes read from socket
           char		buffer[8192];	// Copy buffer
           char		filename[1024];	// Job filename
@@ -196,7 +197,13 @@ _papplPrinterRunRaw(
 	  }
 
 	  // Finish the job...
+	  pthread_rwlock_wrlock(&printer->rwlock);
 	  job->state = IPP_JSTATE_PENDING;
+	  queued     = _papplPrinterAddPendingJobNoLock(printer, job);
+	  pthread_rwlock_unlock(&printer->rwlock);
+
+	  if (!queued)
+	    goto abort_job;
 
 	  _papplPrinterCheckJobs(printer);
 	  continue;
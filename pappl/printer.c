@@ -53,6 +53,8 @@ papplPrinterCancelAllJobs(
     }
     else
     {
+      _papplPrinterRemovePendingJobNoLock(printer, job);
+
       job->state     = IPP_JSTATE_CANCELED;
       job->completed = time(NULL);
 
@@ -319,6 +321,7 @@ papplPrinterCreate(
 
   // Initialize printer structure and attributes...
   pthread_rwlock_init(&printer->rwlock, NULL);
+  pthread_mutex_init(&printer->cache_mutex, NULL);
 
   printer->system             = system;
   printer->name               = strdup(printer_name);
@@ -339,11 +342,12 @@ papplPrinterCreate(
   printer->all_jobs           = cupsArrayNew((cups_array_cb_t)compare_all_jobs, NULL, NULL, 0, NULL, (cups_afree_cb_t)_papplJobDelete);
   printer->active_jobs        = cupsArrayNew((cups_array_cb_t)compare_active_jobs, NULL, NULL, 0, NULL, NULL);
   printer->completed_jobs     = cupsArrayNew((cups_array_cb_t)compare_completed_jobs, NULL, NULL, 0, NULL, NULL);
-  printer->next_job_id        = 1;
-  printer->max_active_jobs    = (system->options & PAPPL_SOPTIONS_MULTI_QUEUE) ? 0 : 1;
-  printer->max_completed_jobs = 100;
-  printer->usb_vendor_id      = 0x1209;	// See <pid.codes>
-  printer->usb_product_id     = 0x8011;
+  printer->next_job_id         = 1;
+  printer->max_active_jobs     = (system->options & PAPPL_SOPTIONS_MULTI_QUEUE) ? 0 : 1;
+  printer->max_completed_jobs  = 100;
+  printer->max_processing_jobs = 1;
+  printer->usb_vendor_id       = 0x1209;	// See <pid.codes>
+  printer->usb_product_id      = 0x8011;
 
   if (!printer->name || !printer->dns_sd_name || !printer->resource || (device_id && !printer->device_id) || !printer->device_uri || !printer->driver_name || !printer->attrs)
   {
@@ -492,7 +496,7 @@ papplPrinterCreate(
   ippAddInteger(printer->attrs, IPP_TAG_PRINTER, IPP_TAG_INTEGER, "job-priority-default", 50);
 
   // job-priority-supported
-  ippAddInteger(printer->attrs, IPP_TAG_PRINTER, IPP_TAG_INTEGER, "job-priority-supported", 1);
+  ippAddInteger(printer->attrs, IPP_TAG_PRINTER, IPP_TAG_INTEGER, "job-priority-supported", 100);
 
   // job-sheets-default
   ippAddString(printer->attrs, IPP_TAG_PRINTER, IPP_CONST_TAG(IPP_TAG_NAME), "job-sheets-default", NULL, "none");
@@ -725,6 +729,13 @@ _papplPrinterDelete(
 
   printer->num_raw_listeners = 0;
 
+  // Close the device if it is still open...
+  if (printer->device)
+  {
+    papplDeviceClose(printer->device);
+    printer->device = NULL;
+  }
+
   // Remove DNS-SD registrations...
   _papplPrinterUnregisterDNSSDNoLock(printer);
 
@@ -749,6 +760,8 @@ _papplPrinterDelete(
   cupsArrayDelete(printer->active_jobs);
   cupsArrayDelete(printer->completed_jobs);
   cupsArrayDelete(printer->all_jobs);
+  cupsArrayDelete(printer->fair_shares);
+  free(printer->pending_jobs);
 
   // Free memory...
   free(printer->name);
@@ -766,6 +779,9 @@ _papplPrinterDelete(
   ippDelete(printer->driver_attrs);
   ippDelete(printer->attrs);
 
+  cupsArrayDelete(printer->cache);
+  pthread_mutex_destroy(&printer->cache_mutex);
+
   cupsArrayDelete(printer->links);
 
   free(printer);
@@ -790,8 +806,17 @@ papplPrinterDelete(
   // Deliver delete event...
   papplSystemAddEvent(system, printer, NULL, PAPPL_EVENT_PRINTER_DELETED | PAPPL_EVENT_SYSTEM_CONFIG_CHANGED, NULL);
 
+  // Remove the printer from the job queue...
+  pthread_mutex_lock(&system->job_mutex);
+  cupsArrayRemove(system->ready_printers, printer);
+  printer->is_queued = false;
+  pthread_mutex_unlock(&system->job_mutex);
+
   // Remove the printer from the system object...
   pthread_rwlock_wrlock(&system->rwlock);
+  cupsArrayRemove(system->printers_by_id, printer);
+  cupsArrayRemove(system->printers_by_resource, printer);
+  cupsArrayRemove(system->printers_by_uri, printer);
   cupsArrayRemove(system->printers, printer);
   pthread_rwlock_unlock(&system->rwlock);
 
@@ -23,6 +23,7 @@
 static void		add_resource(pappl_system_t *system, _pappl_resource_t *r);
 static int		compare_resources(_pappl_resource_t *a, _pappl_resource_t *b);
 static _pappl_resource_t *copy_resource(_pappl_resource_t *r);
+static void		find_variants(_pappl_resource_t *r, char *br_filename, size_t br_size);
 static void		free_resource(_pappl_resource_t *r);
 
 
@@ -112,6 +113,10 @@ papplSystemAddResourceData(
 // time of the call are available, and those files must remain stable for as
 // long as the resources are added to the system..
 //
+// A file with an added ".br" extension, for example "style.css.br", is
+// served as a Brotli-compressed variant of the original file to clients that
+// accept it.
+//
 // > Note: Any resource that is added prior to calling the @link papplSystemRun@
 // > function will replace the corresponding standard resource at the same path.
 //
@@ -125,6 +130,8 @@ papplSystemAddResourceDirectory(
   cups_dir_t		*dir;		// Directory pointer
   cups_dentry_t		*dent;		// Current directory entry
   char			filename[1024],	// External filename
+			br_filename[1024],
+					// Brotli-compressed filename
 			path[1024],	// Resource path
 			*ext;		// Extension on filename
   const char		*format;	// MIME media type
@@ -176,6 +183,8 @@ papplSystemAddResourceDirectory(
     r.last_modified = dent->fileinfo.st_mtime;
     r.length        = (size_t)dent->fileinfo.st_size;
 
+    find_variants(&r, br_filename, sizeof(br_filename));
+
     add_resource(system, &r);
   }
 
@@ -190,6 +199,9 @@ papplSystemAddResourceDirectory(
 // file is not copied to the resource and must remain stable for as long as the
 // resource is added to the system.
 //
+// If a file with an added ".br" extension exists alongside the file, it is
+// served as a Brotli-compressed variant to clients that accept it.
+//
 // > Note: Any resource that is added prior to calling the @link papplSystemRun@
 // > function will replace the corresponding standard resource at the same path.
 //
@@ -203,6 +215,8 @@ papplSystemAddResourceFile(
 {
   _pappl_resource_t	r;		// New resource
   struct stat		fileinfo;	// File information
+  char			br_filename[1024];
+					// Brotli-compressed filename
 
 
   if (!system || !path || path[0] != '/' || !format || !filename || stat(filename, &fileinfo))
@@ -216,6 +230,8 @@ papplSystemAddResourceFile(
   r.last_modified = fileinfo.st_mtime;
   r.length        = (size_t)fileinfo.st_size;
 
+  find_variants(&r, br_filename, sizeof(br_filename));
+
   add_resource(system, &r);
 }
 
@@ -489,15 +505,18 @@ copy_resource(_pappl_resource_t *r)	// I - Resource to copy
     newr->last_modified = r->last_modified;
     newr->data          = r->data;
     newr->length        = r->length;
+    newr->br_length     = r->br_length;
     newr->cb            = r->cb;
     newr->cbdata        = r->cbdata;
 
     if (r->filename)
       newr->filename = strdup(r->filename);
+    if (r->br_filename)
+      newr->br_filename = strdup(r->br_filename);
     if (r->language)
       newr->language = strdup(r->language);
 
-    if (!newr->path || !newr->format || (r->filename && !newr->filename) || (r->language && !newr->language))
+    if (!newr->path || !newr->format || (r->filename && !newr->filename) || (r->br_filename && !newr->br_filename) || (r->language && !newr->language))
     {
       free_resource(newr);
       return (NULL);
@@ -508,6 +527,33 @@ copy_resource(_pappl_resource_t *r)	// I - Resource to copy
 }
 
 
+//
+// 'find_variants()' - Find precompressed variants of a resource file.
+//
+// A variant is a sibling file with an added ".br" extension that is at least
+// as new as the original file.  Variants are served as-is to clients that
+// accept the corresponding content coding, so they cost no CPU to send.
+//
+
+static void
+find_variants(
+    _pappl_resource_t *r,		// I - Resource
+    char              *br_filename,	// I - Brotli filename buffer
+    size_t            br_size)		// I - Size of Brotli filename buffer
+{
+  struct stat	fileinfo;		// File information
+
+
+  snprintf(br_filename, br_size, "%s.br", r->filename);
+
+  if (!stat(br_filename, &fileinfo) && S_ISREG(fileinfo.st_mode) && fileinfo.st_mtime >= r->last_modified && fileinfo.st_size > 0)
+  {
+    r->br_filename = br_filename;
+    r->br_length   = (size_t)fileinfo.st_size;
+  }
+}
+
+
 //
 // 'free_resource()' - Free the memory used for a resource.
 //
@@ -518,6 +564,7 @@ free_resource(_pappl_resource_t *r)	// I - Resource
   free(r->path);
   free(r->format);
   free(r->filename);
+  free(r->br_filename);
   free(r->language);
 
   free(r);
@@ -276,7 +276,7 @@ _papplSubscriptionIPPGetAttributes(
     pappl_client_t *client)		// I - Client
 {
   pappl_subscription_t	*sub;		// Subscription
-  cups_array_t		*ra;		// Requested attributes
+  _pappl_ra_t		*ra;		// Requested attributes
 
 
   // Authorize access...
@@ -302,7 +302,7 @@ _papplSubscriptionIPPGetAttributes(
     return;
 
   // Return attributes...
-  ra = ippCreateRequestedArray(client->request);
+  ra = _papplCreateRequestedAttrs(ippCreateRequestedArray(client->request));
 
   papplClientRespondIPP(client, IPP_STATUS_OK, NULL);
 
@@ -310,7 +310,7 @@ _papplSubscriptionIPPGetAttributes(
   _papplCopyAttributes(client->response, sub->attrs, ra, IPP_TAG_SUBSCRIPTION, 0);
   pthread_rwlock_unlock(&sub->rwlock);
 
-  cupsArrayDelete(ra);
+  _papplDeleteRequestedAttrs(ra);
 }
 
 
@@ -458,7 +458,7 @@ _papplSubscriptionIPPList(
     pappl_client_t *client)		// I - Client
 {
   pappl_subscription_t	*sub;		// Subscription
-  cups_array_t		*ra;		// Requested attributes
+  _pappl_ra_t		*ra;		// Requested attributes
   bool			my_subs;	// my-subscriptions value
   int			job_id,		// notify-job-id value
 			limit,		// limit value, if any
@@ -488,7 +488,7 @@ _papplSubscriptionIPPList(
   job_id  = ippGetInteger(ippFindAttribute(client->request, "notify-job-id", IPP_TAG_INTEGER), 0);
   limit   = ippGetInteger(ippFindAttribute(client->request, "limit", IPP_TAG_INTEGER), 0);
   my_subs = ippGetBoolean(ippFindAttribute(client->request, "my-subscriptions", IPP_TAG_BOOLEAN), 0);
-  ra      = ippCreateRequestedArray(client->request);
+  ra      = _papplCreateRequestedAttrs(ippCreateRequestedArray(client->request));
 
   if (client->username[0])
     username = client->username;
@@ -519,7 +519,7 @@ _papplSubscriptionIPPList(
   }
   pthread_rwlock_unlock(&client->system->rwlock);
 
-  cupsArrayDelete(ra);
+  _papplDeleteRequestedAttrs(ra);
 }
 
 
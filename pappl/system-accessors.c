@@ -32,8 +32,12 @@
 //
 
 static bool		add_listeners(pappl_system_t *system, const char *name, int port, int family);
+static void		add_mime_filter(pappl_system_t *system, const char *srctype, const char *dsttype, pappl_mime_filter_cb_t cb, void *data, bool streaming);
 static int		compare_filters(_pappl_mime_filter_t *a, _pappl_mime_filter_t *b);
 static _pappl_mime_filter_t *copy_filter(_pappl_mime_filter_t *f);
+#ifdef _PAPPL_SO_REUSEPORT
+static int		listen_shared(http_addr_t *addr);
+#endif // _PAPPL_SO_REUSEPORT
 
 
 //
@@ -45,6 +49,11 @@ static _pappl_mime_filter_t *copy_filter(_pappl_mime_filter_t *f);
 // or numeric IPv4 or IPv6 address.  If name is `NULL`, the "any" addresses are
 // used ("0.0.0.0" and "[::]").
 //
+// When more than one listener thread has been requested using the
+// @link papplSystemSetListenerThreads@ function, one socket is opened per
+// listener thread for each network address and the operating system spreads
+// new connections between them.
+//
 // Listeners cannot be added after @link papplSystemRun@ is called.
 //
 
@@ -101,7 +110,10 @@ papplSystemAddListeners(
       while (!ret && port < 10000);
 
       if (ret)
-        system->port = port;
+      {
+        system->port      = port;
+        system->auto_port = true;
+      }
     }
   }
   else if (name && *name == '[')
@@ -129,7 +141,10 @@ papplSystemAddListeners(
       while (!ret && port < 10000);
 
       if (ret)
-        system->port = port;
+      {
+        system->port      = port;
+        system->auto_port = true;
+      }
     }
   }
   else
@@ -159,7 +174,8 @@ papplSystemAddListeners(
 
       if (ret)
       {
-        system->port = port;
+        system->port      = port;
+        system->auto_port = true;
         add_listeners(system, name, port, AF_INET6);
       }
     }
@@ -191,25 +207,31 @@ papplSystemAddMIMEFilter(
     pappl_mime_filter_cb_t cb,		// I - Filter callback function
     void                   *data)	// I - Filter callback data
 {
-  _pappl_mime_filter_t	key;		// Search key
-
-
-  if (!system || system->is_running || !srctype || !dsttype || !cb)
-    return;
+  add_mime_filter(system, srctype, dsttype, cb, data, false);
+}
 
-  if (!system->filters)
-    system->filters = cupsArrayNew((cups_array_cb_t)compare_filters, NULL, NULL, 0, (cups_acopy_cb_t)copy_filter, (cups_afree_cb_t)free);
 
-  key.src    = srctype;
-  key.dst    = dsttype;
-  key.cb     = cb;
-  key.cbdata = data;
+//
+// 'papplSystemAddStreamingMIMEFilter()' - Add a streaming file filter to the system.
+//
+// This function adds a file filter to the system like the
+// @link papplSystemAddMIMEFilter@ function, except that jobs using the filter
+// start processing as soon as the first document data is received from the
+// Client.  The filter callback must read the document data using the
+// @link papplJobReadFile@ function, which waits for more data as needed.
+//
+// > Note: This function may not be called while the system is running.
+//
 
-  if (!cupsArrayFind(system->filters, &key))
-  {
-    papplLog(system, PAPPL_LOGLEVEL_DEBUG, "Adding '%s' to '%s' filter.", srctype, dsttype);
-    cupsArrayAdd(system->filters, &key);
-  }
+void
+papplSystemAddStreamingMIMEFilter(
+    pappl_system_t         *system,	// I - System
+    const char             *srctype,	// I - Source MIME media type (constant) string
+    const char             *dsttype,	// I - Destination MIME media type (constant) string
+    pappl_mime_filter_cb_t cb,		// I - Filter callback function
+    void                   *data)	// I - Filter callback data
+{
+  add_mime_filter(system, srctype, dsttype, cb, data, true);
 }
 
 
@@ -222,7 +244,7 @@ _papplSystemExportVersions(
     pappl_system_t *system,		// I - System
     ipp_t          *ipp,		// I - IPP message
     ipp_tag_t      group_tag,		// I - Group (`IPP_TAG_PRINTER` or `IPP_TAG_SYSTEM`)
-    cups_array_t   *ra)			// I - Requested attributes or `NULL` for all
+    _pappl_ra_t    *ra)			// I - Requested attributes or `NULL` for all
 {
   cups_len_t	i;			// Looping var
   ipp_attribute_t *attr;		// Attribute
@@ -238,7 +260,7 @@ _papplSystemExportVersions(
 
   // "xxx-firmware-name"
   snprintf(name, sizeof(name), "%s-firmware-name", name_prefix);
-  if (!ra || cupsArrayFind(ra, name))
+  if (_PAPPL_REQUESTED(ra, group_tag == IPP_TAG_PRINTER ? _PAPPL_RA_PRINTER_FIRMWARE_NAME : _PAPPL_RA_SYSTEM_FIRMWARE_NAME))
   {
     for (i = 0; i < system->num_versions; i ++)
       values[i] = system->versions[i].name;
@@ -260,7 +282,7 @@ _papplSystemExportVersions(
 
   // "xxx-firmware-patches"
   snprintf(name, sizeof(name), "%s-firmware-patches", name_prefix);
-  if (!ra || cupsArrayFind(ra, name))
+  if (_PAPPL_REQUESTED(ra, group_tag == IPP_TAG_PRINTER ? _PAPPL_RA_PRINTER_FIRMWARE_PATCHES : _PAPPL_RA_SYSTEM_FIRMWARE_PATCHES))
   {
     for (i = 0; i < system->num_versions; i ++)
       values[i] = system->versions[i].patches;
@@ -282,7 +304,7 @@ _papplSystemExportVersions(
 
   // "xxx-firmware-string-version"
   snprintf(name, sizeof(name), "%s-firmware-string-version", name_prefix);
-  if (!ra || cupsArrayFind(ra, name))
+  if (_PAPPL_REQUESTED(ra, group_tag == IPP_TAG_PRINTER ? _PAPPL_RA_PRINTER_FIRMWARE_STRING_VERSION : _PAPPL_RA_SYSTEM_FIRMWARE_STRING_VERSION))
   {
     for (i = 0; i < system->num_versions; i ++)
       values[i] = system->versions[i].sversion;
@@ -306,7 +328,7 @@ _papplSystemExportVersions(
 
   // "xxx-firmware-version"
   snprintf(name, sizeof(name), "%s-firmware-version", name_prefix);
-  if (!ra || cupsArrayFind(ra, name))
+  if (_PAPPL_REQUESTED(ra, group_tag == IPP_TAG_PRINTER ? _PAPPL_RA_PRINTER_FIRMWARE_VERSION : _PAPPL_RA_SYSTEM_FIRMWARE_VERSION))
   {
     for (i = 0, attr = NULL; i < system->num_versions; i ++)
     {
@@ -426,6 +448,37 @@ papplSystemGetAuthService(
 }
 
 
+//
+// 'papplSystemGetClientMetrics()' - Get the client connection metrics.
+//
+// This function returns a copy of the client connection metrics, which include
+// the number of connections that have been accepted, the number of requests
+// that have been queued for, served by, or rejected because there was no
+// available worker thread, and the maximum number of requests that have been
+// waiting for a worker thread at the same time.  This information is normally
+// used to size the worker pool and request queue for the expected load.
+//
+
+pappl_cmetrics_t *			// O - Metrics data
+papplSystemGetClientMetrics(
+    pappl_system_t   *system,		// I - System
+    pappl_cmetrics_t *metrics)		// I - Buffer for metrics data
+{
+  if (system && metrics)
+  {
+    pthread_mutex_lock(&system->client_mutex);
+    memcpy(metrics, &system->client_metrics, sizeof(pappl_cmetrics_t));
+    pthread_mutex_unlock(&system->client_mutex);
+  }
+  else if (metrics)
+  {
+    memset(metrics, 0, sizeof(pappl_cmetrics_t));
+  }
+
+  return (metrics);
+}
+
+
 //
 // 'papplSystemGetContact()' - Get the "system-contact" value.
 //
@@ -668,6 +721,59 @@ papplSystemGetHostPort(
 }
 
 
+//
+// 'papplSystemGetJobMetrics()' - Get the job processing metrics.
+//
+// This function returns a copy of the job processing metrics, which include
+// the current and maximum number of job worker threads that are processing a
+// job, the current and maximum number of printers waiting for a worker
+// thread, and the total number of jobs that have been processed.  This
+// information is normally used to size the job worker pool for the number of
+// printers and expected load.
+//
+// The raster metrics report the time spent producing raster lines and writing
+// them to the driver.  Since these overlap, their sum exceeds the elapsed time
+// when device I/O is hidden behind raster processing.
+//
+
+pappl_jmetrics_t *			// O - Metrics data
+papplSystemGetJobMetrics(
+    pappl_system_t   *system,		// I - System
+    pappl_jmetrics_t *metrics)		// I - Buffer for metrics data
+{
+  if (system && metrics)
+  {
+    pthread_mutex_lock(&system->job_mutex);
+    memcpy(metrics, &system->job_metrics, sizeof(pappl_jmetrics_t));
+    metrics->workers = system->num_job_workers;
+    metrics->busy    = system->busy_job_workers;
+    metrics->waiting = (size_t)cupsArrayGetCount(system->ready_printers);
+    pthread_mutex_unlock(&system->job_mutex);
+  }
+  else if (metrics)
+  {
+    memset(metrics, 0, sizeof(pappl_jmetrics_t));
+  }
+
+  return (metrics);
+}
+
+
+//
+// 'papplSystemGetListenerThreads()' - Get the number of listener threads.
+//
+// This function gets the number of threads that accept new network
+// connections.
+//
+
+int					// O - Number of listener threads
+papplSystemGetListenerThreads(
+    pappl_system_t *system)		// I - System
+{
+  return (system ? system->listen_threads : 0);
+}
+
+
 //
 // 'papplSystemGetLocation()' - Get the system location string, if any.
 //
@@ -719,6 +825,26 @@ papplSystemGetLogLevel(
 }
 
 
+//
+// 'papplSystemGetMaxClientQueue()' - Get the maximum number of queued requests.
+//
+// This function gets the maximum number of requests that can be waiting for a
+// client worker thread.
+//
+
+int					// O - Maximum number of queued requests
+papplSystemGetMaxClientQueue(
+    pappl_system_t *system)		// I - System
+{
+  if (!system)
+    return (0);
+  else if (system->max_queue > 0)
+    return (system->max_queue);
+  else
+    return (_PAPPL_QUEUE_PER_WORKER * papplSystemGetMaxClientWorkers(system));
+}
+
+
 //
 // 'papplSystemGetMaxClients()' - Get the maximum number of clients.
 //
@@ -734,6 +860,66 @@ papplSystemGetMaxClients(
 }
 
 
+//
+// 'papplSystemGetMaxClientWorkers()' - Get the number of client worker threads.
+//
+// This function gets the number of worker threads that process client
+// requests.
+//
+
+int					// O - Number of client worker threads
+papplSystemGetMaxClientWorkers(
+    pappl_system_t *system)		// I - System
+{
+  int	max_workers;			// Number of worker threads
+
+
+  if (!system)
+    return (0);
+  else if (system->max_workers > 0)
+    return (system->max_workers);
+
+  // Size the worker pool based on the number of processor cores, leaving room
+  // for requests that block on long-running operations...
+  if ((max_workers = 4 * _papplGetNumCPUs()) < _PAPPL_MIN_WORKERS)
+    max_workers = _PAPPL_MIN_WORKERS;
+  else if (max_workers > _PAPPL_MAX_WORKERS)
+    max_workers = _PAPPL_MAX_WORKERS;
+
+  return (max_workers);
+}
+
+
+//
+// 'papplSystemGetMaxJobWorkers()' - Get the number of job worker threads.
+//
+// This function gets the maximum number of worker threads that process jobs.
+//
+
+int					// O - Number of job worker threads
+papplSystemGetMaxJobWorkers(
+    pappl_system_t *system)		// I - System
+{
+  int	max_workers;			// Number of worker threads
+
+
+  if (!system)
+    return (0);
+  else if (system->max_job_workers > 0)
+    return (system->max_job_workers);
+
+  // Each printer processes one job at a time and jobs spend much of their
+  // time waiting on the device, so allow a couple of jobs per processor
+  // core...
+  if ((max_workers = 2 * _papplGetNumCPUs()) < _PAPPL_MIN_JOB_WORKERS)
+    max_workers = _PAPPL_MIN_JOB_WORKERS;
+  else if (max_workers > _PAPPL_MAX_JOB_WORKERS)
+    max_workers = _PAPPL_MAX_JOB_WORKERS;
+
+  return (max_workers);
+}
+
+
 //
 // 'papplSystemGetMaxLogSize()' - Get the maximum log file size.
 //
@@ -753,6 +939,35 @@ papplSystemGetMaxLogSize(
 }
 
 
+//
+// 'papplSystemGetMaxRenderWorkers()' - Get the number of threads rendering a page.
+//
+// This function gets the maximum number of threads that render the lines of a
+// page, including the job's own thread.
+//
+
+int					// O - Number of render threads
+papplSystemGetMaxRenderWorkers(
+    pappl_system_t *system)		// I - System
+{
+  int	max_workers;			// Number of render threads
+
+
+  if (!system)
+    return (0);
+  else if (system->max_render_workers > 0)
+    return (system->max_render_workers);
+
+  // Rendering is CPU-bound, so use one thread per processor core...
+  if ((max_workers = _papplGetNumCPUs()) < 1)
+    max_workers = 1;
+  else if (max_workers > _PAPPL_MAX_RENDER_WORKERS)
+    max_workers = _PAPPL_MAX_RENDER_WORKERS;
+
+  return (max_workers);
+}
+
+
 //
 // 'papplSystemGetMaxSubscriptions()' - Get the maximum number of event subscriptions.
 //
@@ -1658,6 +1873,58 @@ papplSystemSetHostName(
 }
 
 
+//
+// 'papplSystemSetListenerThreads()' - Set the number of listener threads.
+//
+// This function sets the number of threads that accept new network
+// connections from 0 (auto) to 32.  When more than one listener thread is
+// used, @link papplSystemAddListeners@ opens one load-balanced socket per
+// thread for each network address so that new connections are accepted in
+// parallel, and each listener thread is pinned to a processor core where
+// supported.  A value of `0` uses one listener thread per processor core.
+//
+// Load-balanced listener sockets are only supported on Linux and FreeBSD, so
+// other platforms always use a single listener thread.  Since other processes
+// running as the same user can also bind to a load-balanced socket's address,
+// multiple listener threads are only used when a fixed port number was passed
+// to @link papplSystemCreate@.
+//
+// The default number of listener threads is `1`.
+//
+// > Note: The number of listener threads must be set prior to calling
+// > @link papplSystemAddListeners@.
+//
+
+void
+papplSystemSetListenerThreads(
+    pappl_system_t *system,		// I - System
+    int            num_threads)		// I - Number of listener threads or `0` for auto
+{
+  if (system && !system->is_running)
+  {
+#ifdef _PAPPL_SO_REUSEPORT
+    if (num_threads <= 0)
+      num_threads = _papplGetNumCPUs();
+
+    if (num_threads > _PAPPL_MAX_LTHREADS)
+      num_threads = _PAPPL_MAX_LTHREADS;
+
+#else
+    if (num_threads != 1)
+      papplLog(system, PAPPL_LOGLEVEL_DEBUG, "Multiple listener threads are not supported on this platform.");
+
+    num_threads = 1;
+#endif // _PAPPL_SO_REUSEPORT
+
+    pthread_rwlock_wrlock(&system->rwlock);
+
+    system->listen_threads = num_threads;
+
+    pthread_rwlock_unlock(&system->rwlock);
+  }
+}
+
+
 //
 // 'papplSystemSetLocation()' - Set the system location string, if any.
 //
@@ -1709,6 +1976,37 @@ papplSystemSetLogLevel(
 }
 
 
+//
+// 'papplSystemSetMaxClientQueue()' - Set the maximum number of queued requests.
+//
+// This function sets the maximum number of requests that can be waiting for a
+// client worker thread.  When the queue is full, new requests are immediately
+// rejected with a "server-error-busy" IPP status or a 503 (Service Unavailable)
+// HTTP status so that clients can retry later.
+//
+// The default maximum number of queued requests is four times the number of
+// client worker threads.
+//
+// > Note: The maximum number of queued requests can only be set prior to
+// > calling @link papplSystemRun@.
+//
+
+void
+papplSystemSetMaxClientQueue(
+    pappl_system_t *system,		// I - System
+    int            max_queue)		// I - Maximum number of queued requests or `0` for auto
+{
+  if (system && !system->is_running)
+  {
+    pthread_rwlock_wrlock(&system->rwlock);
+
+    system->max_queue = max_queue > 0 ? max_queue : 0;
+
+    pthread_rwlock_unlock(&system->rwlock);
+  }
+}
+
+
 //
 // 'papplSystemSetMaxClients()' - Set the maximum number of clients.
 //
@@ -1792,6 +2090,81 @@ papplSystemSetMaxClients(
 }
 
 
+//
+// 'papplSystemSetMaxClientWorkers()' - Set the number of client worker threads.
+//
+// This function sets the number of worker threads that process client
+// requests from 0 (auto) to 64.  Idle connections do not use a worker thread,
+// so the number of worker threads only limits the number of requests that are
+// processed at the same time.
+//
+// The default number of client worker threads is four times the number of
+// processor cores, from 4 to 64.
+//
+// > Note: The number of client worker threads can only be set prior to calling
+// > @link papplSystemRun@.
+//
+
+void
+papplSystemSetMaxClientWorkers(
+    pappl_system_t *system,		// I - System
+    int            max_workers)		// I - Number of worker threads or `0` for auto
+{
+  if (system && !system->is_running)
+  {
+    // Restrict max_workers to <= _PAPPL_MAX_WORKERS...
+    if (max_workers < 0)
+      max_workers = 0;
+    else if (max_workers > _PAPPL_MAX_WORKERS)
+      max_workers = _PAPPL_MAX_WORKERS;
+
+    pthread_rwlock_wrlock(&system->rwlock);
+
+    system->max_workers = max_workers;
+
+    pthread_rwlock_unlock(&system->rwlock);
+  }
+}
+
+
+//
+// 'papplSystemSetMaxJobWorkers()' - Set the number of job worker threads.
+//
+// This function sets the maximum number of worker threads that process jobs
+// from 0 (auto) to 64.  Each printer processes one job at a time, so the
+// number of worker threads limits the number of printers that are printing
+// at the same time.  Worker threads are started as needed and are reused for
+// later jobs.
+//
+// The default number of job worker threads is twice the number of processor
+// cores, from 4 to 64.
+//
+// > Note: The number of job worker threads can only be set prior to calling
+// > @link papplSystemRun@.
+//
+
+void
+papplSystemSetMaxJobWorkers(
+    pappl_system_t *system,		// I - System
+    int            max_workers)		// I - Number of worker threads or `0` for auto
+{
+  if (system && !system->is_running)
+  {
+    // Restrict max_workers to <= _PAPPL_MAX_JOB_WORKERS...
+    if (max_workers < 0)
+      max_workers = 0;
+    else if (max_workers > _PAPPL_MAX_JOB_WORKERS)
+      max_workers = _PAPPL_MAX_JOB_WORKERS;
+
+    pthread_rwlock_wrlock(&system->rwlock);
+
+    system->max_job_workers = max_workers;
+
+    pthread_rwlock_unlock(&system->rwlock);
+  }
+}
+
+
 //
 // 'papplSystemSetMaxLogSize()' - Set the maximum log file size in bytes.
 //
@@ -1821,6 +2194,41 @@ papplSystemSetMaxLogSize(
 }
 
 
+//
+// 'papplSystemSetMaxRenderWorkers()' - Set the number of threads rendering a page.
+//
+// This function sets the maximum number of threads that render the lines of a
+// page from 0 (auto) to 64.  Images are split into bands of lines that are
+// rendered by the job's own thread and a pool of render worker threads that
+// is shared by all jobs.  A value of `1` renders each page on the job's
+// thread.
+//
+// The default number of render threads is the number of processor cores.
+// The new value is used starting with the next page.
+//
+
+void
+papplSystemSetMaxRenderWorkers(
+    pappl_system_t *system,		// I - System
+    int            max_workers)		// I - Number of render threads or `0` for auto
+{
+  if (system)
+  {
+    // Restrict max_workers to <= _PAPPL_MAX_RENDER_WORKERS...
+    if (max_workers < 0)
+      max_workers = 0;
+    else if (max_workers > _PAPPL_MAX_RENDER_WORKERS)
+      max_workers = _PAPPL_MAX_RENDER_WORKERS;
+
+    pthread_rwlock_wrlock(&system->rwlock);
+
+    system->max_render_workers = max_workers;
+
+    pthread_rwlock_unlock(&system->rwlock);
+  }
+}
+
+
 //
 // 'papplSystemSetMaxSubscriptions()' - Set the maximum number of event subscriptions.
 //
@@ -2219,6 +2627,8 @@ add_listeners(
   http_addrlist_t	*addrlist,	// Listen addresses
 			*addr;		// Current address
   char			service[255];	// Service port
+  size_t		i,		// Looping var
+			num_threads;	// Number of listener threads
 
 
   if (name && (!strcmp(name, "*") || !*name))
@@ -2234,9 +2644,43 @@ add_listeners(
   }
   else
   {
+    // Only use load-balanced sockets with a fixed port number, otherwise we
+    // might share an automatically chosen port with another process...
+    num_threads = (family == AF_LOCAL || !system->port || system->auto_port) ? 1 : (size_t)system->listen_threads;
+
     for (addr = addrlist; addr && system->num_listeners < _PAPPL_MAX_LISTENERS; addr = addr->next)
     {
-      if ((sock = httpAddrListen(&(addrlist->addr), port)) < 0)
+#ifdef _PAPPL_SO_REUSEPORT
+      if (num_threads > 1)
+      {
+        // Add one load-balanced socket per listener thread...
+        for (i = 0; i < num_threads && system->num_listeners < _PAPPL_MAX_LISTENERS; i ++)
+        {
+          if ((sock = listen_shared(&addr->addr)) < 0)
+          {
+	    char	temp[256];	// String address
+
+	    if (system->port || i > 0)
+	      papplLog(system, PAPPL_LOGLEVEL_ERROR, "Unable to create listener socket for '%s:%d': %s", httpAddrString(&addr->addr, temp, (int)sizeof(temp)), port, strerror(errno));
+	    break;
+          }
+
+	  system->listener_index[system->num_listeners] = i;
+	  system->listeners[system->num_listeners].fd        = sock;
+	  system->listeners[system->num_listeners ++].events = POLLIN;
+        }
+
+        if (i > 0)
+        {
+          ret = true;
+
+	  papplLog(system, PAPPL_LOGLEVEL_INFO, "Listening for connections on '%s:%d' with %u threads.", name ? name : "*", port, (unsigned)i);
+        }
+        continue;
+      }
+#endif // _PAPPL_SO_REUSEPORT
+
+      if ((sock = httpAddrListen(&(addr->addr), port)) < 0)
       {
 	char	temp[256];		// String address
 
@@ -2252,6 +2696,7 @@ add_listeners(
       {
         ret = true;
 
+	system->listener_index[system->num_listeners] = 0;
 	system->listeners[system->num_listeners].fd        = sock;
 	system->listeners[system->num_listeners ++].events = POLLIN;
 
@@ -2269,6 +2714,42 @@ add_listeners(
 }
 
 
+//
+// 'add_mime_filter()' - Add a file filter to the system.
+//
+
+static void
+add_mime_filter(
+    pappl_system_t         *system,	// I - System
+    const char             *srctype,	// I - Source MIME media type (constant) string
+    const char             *dsttype,	// I - Destination MIME media type (constant) string
+    pappl_mime_filter_cb_t cb,		// I - Filter callback function
+    void                   *data,	// I - Filter callback data
+    bool                   streaming)	// I - Does the filter support streaming?
+{
+  _pappl_mime_filter_t	key;		// Search key
+
+
+  if (!system || system->is_running || !srctype || !dsttype || !cb)
+    return;
+
+  if (!system->filters)
+    system->filters = cupsArrayNew((cups_array_cb_t)compare_filters, NULL, NULL, 0, (cups_acopy_cb_t)copy_filter, (cups_afree_cb_t)free);
+
+  key.src       = srctype;
+  key.dst       = dsttype;
+  key.cb        = cb;
+  key.cbdata    = data;
+  key.streaming = streaming;
+
+  if (!cupsArrayFind(system->filters, &key))
+  {
+    papplLog(system, PAPPL_LOGLEVEL_DEBUG, "Adding '%s' to '%s'%s filter.", srctype, dsttype, streaming ? " streaming" : "");
+    cupsArrayAdd(system->filters, &key);
+  }
+}
+
+
 //
 // 'compare_filters()' - Compare two filters.
 //
@@ -2302,3 +2783,50 @@ copy_filter(_pappl_mime_filter_t *f)	// I - Filter definition
 
   return (newf);
 }
+
+
+#ifdef _PAPPL_SO_REUSEPORT
+//
+// 'listen_shared()' - Create a load-balanced listener socket.
+//
+// Unlike `httpAddrListen`, the socket allows other sockets to bind to the same
+// address so that each listener thread can have its own accept queue.
+//
+
+static int				// O - Listener socket or `-1` on error
+listen_shared(http_addr_t *addr)	// I - Address with port
+{
+  int	sock,				// Listener socket
+	val = 1;			// Option value
+
+
+  if ((sock = (int)socket(httpAddrFamily(addr), SOCK_STREAM, 0)) < 0)
+    return (-1);
+
+  fcntl(sock, F_SETFD, FD_CLOEXEC);
+
+  setsockopt(sock, SOL_SOCKET, SO_REUSEADDR, &val, sizeof(val));
+
+  if (setsockopt(sock, SOL_SOCKET, _PAPPL_SO_REUSEPORT, &val, sizeof(val)))
+    goto error;
+
+#  ifdef IPV6_V6ONLY
+  if (httpAddrFamily(addr) == AF_INET6)
+    setsockopt(sock, IPPROTO_IPV6, IPV6_V6ONLY, &val, sizeof(val));
+#  endif // IPV6_V6ONLY
+
+  if (bind(sock, (struct sockaddr *)addr, (socklen_t)httpAddrLength(addr)) || listen(sock, SOMAXCONN))
+    goto error;
+
+  return (sock);
+
+  // If we get here there was an error...
+  error:
+
+  val = errno;
+  close(sock);
+  errno = val;
+
+  return (-1);
+}
+#endif // _PAPPL_SO_REUSEPORT
@@ -0,0 +1,992 @@
+//
+// System client connection functions for the Printer Application Framework
+//
+// Copyright © 2022 by Michael R Sweet.
+//
+// Licensed under Apache License v2.0.  See the file "LICENSE" for more
+// information.
+//
+
+//
+// Include necessary headers...
+//
+
+#if defined(__linux) && !defined(_GNU_SOURCE)
+#  define _GNU_SOURCE			// For pthread_setaffinity_np
+#endif // __linux && !_GNU_SOURCE
+#include "pappl-private.h"
+#ifdef HAVE_SYS_EPOLL_H
+#  include <sys/epoll.h>
+#endif // HAVE_SYS_EPOLL_H
+
+
+//
+// Local constants...
+//
+
+#define _PAPPL_MAX_EVENTS	64	// Maximum number of events per wakeup
+
+
+//
+// Local functions...
+//
+
+static void	*busy_worker(pappl_system_t *system);
+static int	check_client(pappl_client_t *client);
+static void	*client_loop(pappl_system_t *system);
+static void	*client_worker(pappl_system_t *system);
+static int	compare_clients(pappl_client_t *a, pappl_client_t *b);
+static void	expire_clients(pappl_system_t *system, time_t curtime);
+static bool	idle_client(pappl_system_t *system, pappl_client_t *client);
+static void	*listener_loop(_pappl_listener_t *listener);
+static void	ready_client(pappl_system_t *system, pappl_client_t *client);
+static void	remove_client(pappl_system_t *system, pappl_client_t *client);
+
+
+//
+// '_papplSystemAcceptClients()' - Accept new client connections.
+//
+// This function waits up to one second for new connections on the listener
+// sockets served by a listener thread and adds them to the client event loop.
+// New connections are left in the listen backlog while the system is at its
+// client limit.
+//
+
+bool					// O - `true` on success, `false` on error
+_papplSystemAcceptClients(
+    _pappl_listener_t *listener)	// I - Listener thread
+{
+  pappl_system_t	*system = listener->system;
+					// System
+  size_t		i;		// Looping var
+  int			pcount;		// Poll count
+  bool			accepting;	// Accept new connections?
+  pappl_client_t	*client;	// New client
+
+
+  // Only listen for new connections while we are below the client limit,
+  // otherwise leave them in the listen backlog until a client goes away...
+  pthread_rwlock_rdlock(&system->rwlock);
+  accepting = system->num_clients < system->max_clients;
+  pthread_rwlock_unlock(&system->rwlock);
+
+  if (accepting == listener->paused)
+  {
+    // Crossed the client limit, update the listeners...
+    if ((listener->paused = !accepting) == true)
+    {
+      papplLog(system, PAPPL_LOGLEVEL_WARN, "Too many clients (%d), pausing new connections.", system->max_clients);
+
+      pthread_mutex_lock(&system->client_mutex);
+      system->client_metrics.paused ++;
+      pthread_mutex_unlock(&system->client_mutex);
+    }
+    else
+    {
+      papplLog(system, PAPPL_LOGLEVEL_DEBUG, "Resuming new connections.");
+    }
+
+    for (i = 0; i < listener->num_pfds; i ++)
+      listener->pfds[i].events = accepting ? POLLIN : 0;
+  }
+
+  // Use a short timeout while paused so we notice when clients go away...
+  if ((pcount = poll(listener->pfds, (nfds_t)listener->num_pfds, accepting ? 1000 : 100)) < 0 && errno != EINTR && errno != EAGAIN)
+  {
+    papplLog(system, PAPPL_LOGLEVEL_ERROR, "Unable to accept new connections: %s", strerror(errno));
+    return (false);
+  }
+
+  if (pcount > 0)
+  {
+    // Accept client connections as needed...
+    for (i = 0; i < listener->num_pfds; i ++)
+    {
+      if (listener->pfds[i].revents & POLLIN)
+      {
+        // Reserve a client slot first so that listener threads can't exceed
+        // the client limit together...
+	pthread_rwlock_wrlock(&system->rwlock);
+	if ((accepting = system->num_clients < system->max_clients) == true)
+	  system->num_clients ++;
+	pthread_rwlock_unlock(&system->rwlock);
+
+        if (!accepting)
+          break;
+
+	if ((client = _papplClientCreate(system, (int)listener->pfds[i].fd)) != NULL)
+	{
+	  // Wait for the first request on the client event thread...
+	  _papplSystemAddClient(system, client);
+	}
+	else
+	{
+	  // Release the slot...
+	  pthread_rwlock_wrlock(&system->rwlock);
+	  system->num_clients --;
+	  pthread_rwlock_unlock(&system->rwlock);
+	}
+      }
+    }
+  }
+
+  return (true);
+}
+
+
+//
+// '_papplSystemAddClient()' - Add a newly accepted client connection.
+//
+// The connection is added to the list of idle connections and is handed to a
+// worker thread as soon as its first request arrives.
+//
+
+void
+_papplSystemAddClient(
+    pappl_system_t *system,		// I - System
+    pappl_client_t *client)		// I - Client
+{
+  pthread_mutex_lock(&system->client_mutex);
+  system->client_metrics.accepted ++;
+  pthread_mutex_unlock(&system->client_mutex);
+
+  if (!idle_client(system, client))
+    ready_client(system, client);
+}
+
+
+//
+// '_papplSystemStartClients()' - Start the client event loop and worker threads.
+//
+// Idle connections are parked in a single event loop thread that waits for new
+// requests to arrive.  Once a request is available, the connection is handed
+// to one of a fixed number of worker threads that processes the request and
+// then returns the connection to the event loop.  This keeps the number of
+// threads constant regardless of the number of connected clients.
+//
+// Requests waiting for a worker are held in a bounded queue.  When the queue
+// is full, new requests are rejected with a "busy" response rather than
+// waiting for an unbounded amount of time.  The busy responses are sent by a
+// separate thread so that slow clients never block the event loop.
+//
+
+bool					// O - `true` on success, `false` on failure
+_papplSystemStartClients(
+    pappl_system_t *system)		// I - System
+{
+  size_t	i;			// Looping var
+  bool		busy_started = false;	// Was the busy response thread started?
+
+
+  system->idle_clients    = cupsArrayNew((cups_array_cb_t)compare_clients, NULL, NULL, 0, NULL, NULL);
+  system->ready_clients   = cupsArrayNew(NULL, NULL, NULL, 0, NULL, NULL);
+  system->busy_clients    = cupsArrayNew(NULL, NULL, NULL, 0, NULL, NULL);
+  system->client_fd       = -1;
+  system->client_pipe[0]  = -1;
+  system->client_pipe[1]  = -1;
+  system->clients_running = true;
+
+  memset(&system->client_metrics, 0, sizeof(system->client_metrics));
+
+  if (!system->idle_clients || !system->ready_clients || !system->busy_clients)
+  {
+    papplLog(system, PAPPL_LOGLEVEL_FATAL, "Unable to allocate memory for client queues.");
+    goto fatal;
+  }
+
+#ifdef HAVE_SYS_EPOLL_H
+  if ((system->client_fd = epoll_create1(EPOLL_CLOEXEC)) < 0)
+  {
+    papplLog(system, PAPPL_LOGLEVEL_FATAL, "Unable to create client event descriptor: %s", strerror(errno));
+    goto fatal;
+  }
+
+#elif !_WIN32
+  if (pipe(system->client_pipe))
+  {
+    papplLog(system, PAPPL_LOGLEVEL_FATAL, "Unable to create client event pipe: %s", strerror(errno));
+    goto fatal;
+  }
+
+  fcntl(system->client_pipe[0], F_SETFL, fcntl(system->client_pipe[0], F_GETFL) | O_NONBLOCK);
+  fcntl(system->client_pipe[1], F_SETFL, fcntl(system->client_pipe[1], F_GETFL) | O_NONBLOCK);
+#endif // HAVE_SYS_EPOLL_H
+
+  // Size the worker pool and request queue...
+  system->num_workers = (size_t)papplSystemGetMaxClientWorkers(system);
+  system->queue_depth = (size_t)papplSystemGetMaxClientQueue(system);
+
+  if (system->num_workers > (size_t)system->max_clients)
+    system->num_workers = (size_t)system->max_clients;
+
+  if (pthread_create(&system->busy_tid, NULL, (void *(*)(void *))busy_worker, system))
+  {
+    papplLog(system, PAPPL_LOGLEVEL_FATAL, "Unable to create client busy response thread: %s", strerror(errno));
+    goto fatal;
+  }
+
+  busy_started = true;
+
+  if (pthread_create(&system->client_tid, NULL, (void *(*)(void *))client_loop, system))
+  {
+    papplLog(system, PAPPL_LOGLEVEL_FATAL, "Unable to create client event thread: %s", strerror(errno));
+    goto fatal;
+  }
+
+  for (i = 0; i < system->num_workers; i ++)
+  {
+    if (pthread_create(system->workers + i, NULL, (void *(*)(void *))client_worker, system))
+    {
+      papplLog(system, PAPPL_LOGLEVEL_ERROR, "Unable to create client worker thread: %s", strerror(errno));
+      break;
+    }
+  }
+
+  if ((system->num_workers = i) == 0)
+  {
+    papplLog(system, PAPPL_LOGLEVEL_FATAL, "No client worker threads.");
+    _papplSystemStopClients(system);
+    return (false);
+  }
+
+  papplLog(system, PAPPL_LOGLEVEL_DEBUG, "Started %u client worker threads with up to %u queued requests.", (unsigned)system->num_workers, (unsigned)system->queue_depth);
+
+  return (true);
+
+  // If we get here something went wrong...
+  fatal:
+
+  pthread_mutex_lock(&system->client_mutex);
+  system->clients_running = false;
+  pthread_cond_broadcast(&system->busy_cond);
+  pthread_mutex_unlock(&system->client_mutex);
+
+  if (busy_started)
+    pthread_join(system->busy_tid, NULL);
+
+  system->num_workers = 0;
+
+#ifdef HAVE_SYS_EPOLL_H
+  if (system->client_fd >= 0)
+    close(system->client_fd);
+#elif !_WIN32
+  if (system->client_pipe[0] >= 0)
+  {
+    close(system->client_pipe[0]);
+    close(system->client_pipe[1]);
+  }
+#endif // HAVE_SYS_EPOLL_H
+
+  cupsArrayDelete(system->idle_clients);
+  cupsArrayDelete(system->ready_clients);
+  cupsArrayDelete(system->busy_clients);
+
+  system->idle_clients  = NULL;
+  system->ready_clients = NULL;
+  system->busy_clients  = NULL;
+
+  return (false);
+}
+
+
+//
+// '_papplSystemStartListeners()' - Start the listener threads.
+//
+// Each listener socket is served by one listener thread.  The first listener
+// thread is the main thread, which calls @link _papplSystemAcceptClients@ from
+// @link papplSystemRun@.  When @link papplSystemSetListenerThreads@ is used,
+// each network address has one load-balanced socket per listener thread and
+// the remaining listener threads are started here, each pinned to a processor
+// core where supported.
+//
+
+bool					// O - `true` on success, `false` on failure
+_papplSystemStartListeners(
+    pappl_system_t *system)		// I - System
+{
+  size_t		i;		// Looping var
+  _pappl_listener_t	*listener;	// Current listener thread
+
+
+  // Figure out how many listener threads we need...
+  for (i = 0, system->num_lthreads = 1; i < system->num_listeners; i ++)
+  {
+    if (system->listener_index[i] >= system->num_lthreads)
+      system->num_lthreads = system->listener_index[i] + 1;
+  }
+
+  if ((system->lthreads = (_pappl_listener_t *)calloc(system->num_lthreads, sizeof(_pappl_listener_t))) == NULL)
+  {
+    papplLog(system, PAPPL_LOGLEVEL_FATAL, "Unable to allocate memory for listener threads.");
+    system->num_lthreads = 0;
+    return (false);
+  }
+
+  // Assign the listener sockets to each thread...
+  for (i = 0, listener = system->lthreads; i < system->num_lthreads; i ++, listener ++)
+  {
+    listener->system = system;
+    listener->index  = i;
+  }
+
+  for (i = 0; i < system->num_listeners; i ++)
+  {
+    listener = system->lthreads + system->listener_index[i];
+
+    listener->pfds[listener->num_pfds].fd       = system->listeners[i].fd;
+    listener->pfds[listener->num_pfds ++].events = POLLIN;
+  }
+
+  // Start the other listener threads...
+  system->listeners_running = true;
+
+  for (i = 1, listener = system->lthreads + 1; i < system->num_lthreads; i ++, listener ++)
+  {
+    if (pthread_create(&listener->tid, NULL, (void *(*)(void *))listener_loop, listener))
+    {
+      papplLog(system, PAPPL_LOGLEVEL_ERROR, "Unable to create listener thread: %s", strerror(errno));
+      break;
+    }
+  }
+
+  if (i < system->num_lthreads)
+  {
+    // Have the main thread serve the sockets that don't have a thread...
+    size_t	j;			// Looping var
+
+    for (j = i; j < system->num_lthreads; j ++)
+    {
+      memcpy(system->lthreads[0].pfds + system->lthreads[0].num_pfds, system->lthreads[j].pfds, system->lthreads[j].num_pfds * sizeof(struct pollfd));
+      system->lthreads[0].num_pfds += system->lthreads[j].num_pfds;
+    }
+
+    system->num_lthreads = i;
+  }
+
+  if (system->num_lthreads > 1)
+    papplLog(system, PAPPL_LOGLEVEL_INFO, "Started %u listener threads.", (unsigned)system->num_lthreads);
+
+  return (true);
+}
+
+
+//
+// '_papplSystemStopClients()' - Stop the client event loop and worker threads.
+//
+// Any remaining idle or queued connections are closed.
+//
+
+void
+_papplSystemStopClients(
+    pappl_system_t *system)		// I - System
+{
+  size_t		i;		// Looping var
+  pappl_client_t	*client;	// Current client
+
+
+  // Tell the threads to stop and wake up any that are waiting...
+  pthread_mutex_lock(&system->client_mutex);
+  system->clients_running = false;
+  pthread_cond_broadcast(&system->client_cond);
+  pthread_cond_broadcast(&system->busy_cond);
+  pthread_mutex_unlock(&system->client_mutex);
+
+  pthread_mutex_lock(&system->subscription_mutex);
+  pthread_cond_broadcast(&system->subscription_cond);
+  pthread_mutex_unlock(&system->subscription_mutex);
+
+#if !defined(HAVE_SYS_EPOLL_H) && !_WIN32
+  if (write(system->client_pipe[1], "", 1) < 0)
+    papplLog(system, PAPPL_LOGLEVEL_DEBUG, "Unable to wake client event thread: %s", strerror(errno));
+#endif // !HAVE_SYS_EPOLL_H && !_WIN32
+
+  // Wait for the threads to finish...
+  pthread_join(system->client_tid, NULL);
+
+  for (i = 0; i < system->num_workers; i ++)
+    pthread_join(system->workers[i], NULL);
+
+  pthread_join(system->busy_tid, NULL);
+
+  system->num_workers = 0;
+
+  papplLog(system, PAPPL_LOGLEVEL_INFO, "Client metrics: %lu accepted, %lu paused, %lu queued (%lu max), %lu rejected, %lu served.", (unsigned long)system->client_metrics.accepted, (unsigned long)system->client_metrics.paused, (unsigned long)system->client_metrics.queued, (unsigned long)system->client_metrics.max_queued, (unsigned long)system->client_metrics.rejected, (unsigned long)system->client_metrics.served);
+
+  // Close any remaining connections...
+  while ((client = (pappl_client_t *)cupsArrayGetFirst(system->ready_clients)) != NULL)
+  {
+    cupsArrayRemove(system->ready_clients, client);
+    _papplClientDelete(client);
+  }
+
+  while ((client = (pappl_client_t *)cupsArrayGetFirst(system->idle_clients)) != NULL)
+  {
+    cupsArrayRemove(system->idle_clients, client);
+    _papplClientDelete(client);
+  }
+
+  while ((client = (pappl_client_t *)cupsArrayGetFirst(system->busy_clients)) != NULL)
+  {
+    cupsArrayRemove(system->busy_clients, client);
+    _papplClientDelete(client);
+  }
+
+  cupsArrayDelete(system->idle_clients);
+  cupsArrayDelete(system->ready_clients);
+  cupsArrayDelete(system->busy_clients);
+
+  system->idle_clients  = NULL;
+  system->ready_clients = NULL;
+  system->busy_clients  = NULL;
+
+#ifdef HAVE_SYS_EPOLL_H
+  close(system->client_fd);
+  system->client_fd = -1;
+#elif !_WIN32
+  close(system->client_pipe[0]);
+  close(system->client_pipe[1]);
+  system->client_pipe[0] = system->client_pipe[1] = -1;
+#endif // HAVE_SYS_EPOLL_H
+}
+
+
+//
+// '_papplSystemStopListeners()' - Stop the listener threads.
+//
+
+void
+_papplSystemStopListeners(
+    pappl_system_t *system)		// I - System
+{
+  size_t		i;		// Looping var
+  _pappl_listener_t	*listener;	// Current listener thread
+
+
+  system->listeners_running = false;
+
+  for (i = 1, listener = system->lthreads + 1; i < system->num_lthreads; i ++, listener ++)
+    pthread_join(listener->tid, NULL);
+
+  free(system->lthreads);
+
+  system->lthreads     = NULL;
+  system->num_lthreads = 0;
+}
+
+
+//
+// 'busy_worker()' - Send "busy" responses to rejected connections.
+//
+// Rejected connections may still need a TLS handshake or more of the request
+// before a response can be sent, so this is done here with a short timeout
+// instead of on the client event thread.
+//
+
+static void *				// O - Thread exit status
+busy_worker(pappl_system_t *system)	// I - System
+{
+  pappl_client_t	*client;	// Current client
+
+
+  pthread_mutex_lock(&system->client_mutex);
+
+  while (system->clients_running)
+  {
+    // Wait for a rejected connection...
+    if ((client = (pappl_client_t *)cupsArrayGetFirst(system->busy_clients)) == NULL)
+    {
+      pthread_cond_wait(&system->busy_cond, &system->client_mutex);
+      continue;
+    }
+
+    cupsArrayRemove(system->busy_clients, client);
+
+    pthread_mutex_unlock(&system->client_mutex);
+
+    _papplClientRespondBusy(client);
+    _papplClientDelete(client);
+
+    pthread_mutex_lock(&system->client_mutex);
+  }
+
+  pthread_mutex_unlock(&system->client_mutex);
+
+  return (NULL);
+}
+
+
+//
+// 'check_client()' - Check whether an idle connection has a request.
+//
+// For unencrypted connections the pending data is peeked at so that the
+// connection is only handed to a worker once the complete request header has
+// arrived.  Encrypted connections are handed over as soon as data arrives.
+//
+
+static int				// O - `2` if header complete, `1` if ready, `0` if not, `-1` if closed
+check_client(pappl_client_t *client)	// I - Client
+{
+  char		buffer[8192];		// Peek buffer
+  ssize_t	bytes;			// Bytes peeked
+
+
+  if (httpIsEncrypted(client->http) || httpGetReady(client->http) > 0)
+    return (1);
+
+#ifdef MSG_DONTWAIT
+  bytes = recv(httpGetFd(client->http), buffer, sizeof(buffer) - 1, MSG_PEEK | MSG_DONTWAIT);
+#else
+  bytes = recv(httpGetFd(client->http), buffer, sizeof(buffer) - 1, MSG_PEEK);
+#endif // MSG_DONTWAIT
+
+  if (bytes < 0)
+    return ((errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR) ? 0 : -1);
+  else if (bytes == 0)
+    return (-1);
+
+  // A TLS handshake (or anything that doesn't look like HTTP) goes straight
+  // to a worker...
+  if (!buffer[0] || !strchr("DGHOPT", buffer[0]))
+    return (1);
+
+  // Header is complete or bigger than our buffer...
+  buffer[bytes] = '\0';
+
+  if (strstr(buffer, "\r\n\r\n") || strstr(buffer, "\n\n"))
+    return (2);
+  else if ((size_t)bytes == (sizeof(buffer) - 1))
+    return (1);
+
+#ifdef HAVE_SYS_EPOLL_H
+  // Otherwise wait for more data (edge-triggered events tell us when it comes)
+  return (0);
+
+#else
+  // poll() reports readable connections continuously, so don't wait for the
+  // rest of the header...
+  return (1);
+#endif // HAVE_SYS_EPOLL_H
+}
+
+
+//
+// 'client_loop()' - Wait for requests on idle client connections.
+//
+
+static void *				// O - Thread exit status
+client_loop(pappl_system_t *system)	// I - System
+{
+  int			i,		// Looping var
+			nevents;	// Number of events
+  pappl_client_t	*client;	// Current client
+  int			status;		// Client status
+  time_t		curtime,	// Current time
+			expire_time = 0;// Next expiration check
+#ifdef HAVE_SYS_EPOLL_H
+  struct epoll_event	events[_PAPPL_MAX_EVENTS];
+					// Events
+#else
+  size_t		count,		// Number of idle clients
+			alloc_pfds = 0;	// Allocated poll entries
+  struct pollfd		*pfds = NULL,	// Poll entries
+			*pfd;		// Current poll entry
+  pappl_client_t	**clients = NULL;
+					// Clients for poll entries
+#endif // HAVE_SYS_EPOLL_H
+
+
+  papplLog(system, PAPPL_LOGLEVEL_DEBUG, "Starting client event thread.");
+
+  while (system->clients_running)
+  {
+#ifdef HAVE_SYS_EPOLL_H
+    if ((nevents = epoll_wait(system->client_fd, events, _PAPPL_MAX_EVENTS, 1000)) < 0 && errno != EINTR)
+    {
+      papplLog(system, PAPPL_LOGLEVEL_ERROR, "Unable to wait for client events: %s", strerror(errno));
+      break;
+    }
+
+    for (i = 0; i < nevents; i ++)
+    {
+      client = (pappl_client_t *)events[i].data.ptr;
+      status = check_client(client);
+
+      if (status == 0 && (events[i].events & (EPOLLRDHUP | EPOLLHUP | EPOLLERR)))
+        status = 1;			// No more data coming, let a worker finish it
+
+      switch (status)
+      {
+        case 1 :			// Request ready
+        case 2 :			// Request header complete
+            ready_client(system, client);
+            break;
+        case -1 :			// Connection closed
+            remove_client(system, client);
+            _papplClientDelete(client);
+            break;
+        default :			// Incomplete request
+            break;
+      }
+    }
+
+#else
+    // Build the list of idle connections to poll...
+    pthread_mutex_lock(&system->client_mutex);
+
+    count = cupsArrayGetCount(system->idle_clients) + 1;
+
+    if (count > alloc_pfds)
+    {
+      struct pollfd	*temp_pfds;	// New poll entries
+      pappl_client_t	**temp_clients;	// New clients
+
+      if ((temp_pfds = (struct pollfd *)realloc(pfds, count * sizeof(struct pollfd))) != NULL)
+        pfds = temp_pfds;
+      if ((temp_clients = (pappl_client_t **)realloc(clients, count * sizeof(pappl_client_t *))) != NULL)
+        clients = temp_clients;
+
+      if (!temp_pfds || !temp_clients)
+      {
+        pthread_mutex_unlock(&system->client_mutex);
+        papplLog(system, PAPPL_LOGLEVEL_ERROR, "Unable to allocate memory for client events.");
+        break;
+      }
+
+      alloc_pfds = count;
+    }
+
+    pfds[0].fd     = system->client_pipe[0];
+    pfds[0].events = POLLIN;
+
+    for (i = 1, pfd = pfds + 1, client = (pappl_client_t *)cupsArrayGetFirst(system->idle_clients); client; i ++, pfd ++, client = (pappl_client_t *)cupsArrayGetNext(system->idle_clients))
+    {
+      clients[i]  = client;
+      pfd->fd     = httpGetFd(client->http);
+      pfd->events = POLLIN;
+    }
+
+    pthread_mutex_unlock(&system->client_mutex);
+
+#  if _WIN32
+    // Windows cannot poll a pipe, so use a short timeout to pick up newly
+    // idle connections...
+    if ((nevents = poll(pfds + 1, (nfds_t)(count - 1), 100)) < 0 && errno != EINTR)
+#  else
+    if ((nevents = poll(pfds, (nfds_t)count, 1000)) < 0 && errno != EINTR)
+#  endif // _WIN32
+    {
+      papplLog(system, PAPPL_LOGLEVEL_ERROR, "Unable to wait for client events: %s", strerror(errno));
+      break;
+    }
+
+#  if !_WIN32
+    if (pfds[0].revents & POLLIN)
+    {
+      char	buffer[256];		// Wakeup data
+
+      while (read(system->client_pipe[0], buffer, sizeof(buffer)) > 0);
+    }
+#  endif // !_WIN32
+
+    for (i = 1, pfd = pfds + 1; nevents > 0 && i < (int)count; i ++, pfd ++)
+    {
+      if (!pfd->revents)
+        continue;
+
+      client = clients[i];
+
+      switch (status = check_client(client))
+      {
+        case 1 :			// Request ready
+        case 2 :			// Request header complete
+            ready_client(system, client);
+            break;
+        case -1 :			// Connection closed
+            remove_client(system, client);
+            _papplClientDelete(client);
+            break;
+        default :			// Incomplete request
+            break;
+      }
+    }
+#endif // HAVE_SYS_EPOLL_H
+
+    // Close connections that have been idle too long...
+    if ((curtime = time(NULL)) >= expire_time)
+    {
+      expire_clients(system, curtime);
+      expire_time = curtime + 1;
+    }
+  }
+
+#ifndef HAVE_SYS_EPOLL_H
+  free(pfds);
+  free(clients);
+#endif // !HAVE_SYS_EPOLL_H
+
+  papplLog(system, PAPPL_LOGLEVEL_DEBUG, "Stopping client event thread.");
+
+  return (NULL);
+}
+
+
+//
+// 'client_worker()' - Process requests on client connections.
+//
+
+static void *				// O - Thread exit status
+client_worker(pappl_system_t *system)	// I - System
+{
+  pappl_client_t	*client;	// Current client
+  bool			keep;		// Keep the connection open?
+
+
+  pthread_mutex_lock(&system->client_mutex);
+
+  while (system->clients_running)
+  {
+    // Wait for a connection with a pending request...
+    if ((client = (pappl_client_t *)cupsArrayGetFirst(system->ready_clients)) == NULL)
+    {
+      pthread_cond_wait(&system->client_cond, &system->client_mutex);
+      continue;
+    }
+
+    cupsArrayRemove(system->ready_clients, client);
+
+    pthread_mutex_unlock(&system->client_mutex);
+
+    // Process the request(s) and then return the connection to the event
+    // loop or close it.  If the next request is already here but the queue
+    // is full, keep processing it on this thread...
+    while ((keep = _papplClientRun(client)) && !idle_client(system, client))
+      ;
+
+    if (!keep)
+      _papplClientDelete(client);
+
+    pthread_mutex_lock(&system->client_mutex);
+    system->client_metrics.served ++;
+  }
+
+  pthread_mutex_unlock(&system->client_mutex);
+
+  return (NULL);
+}
+
+
+//
+// 'compare_clients()' - Compare two client connections.
+//
+
+static int				// O - Result of comparison
+compare_clients(pappl_client_t *a,	// I - First client
+                pappl_client_t *b)	// I - Second client
+{
+  return (a->number - b->number);
+}
+
+
+//
+// 'expire_clients()' - Close connections that have been idle too long.
+//
+
+static void
+expire_clients(pappl_system_t *system,	// I - System
+               time_t         curtime)	// I - Current time
+{
+  pappl_client_t	*client;	// Current client
+  time_t		idle_time = curtime - _PAPPL_CLIENT_TIMEOUT;
+					// Oldest allowed idle time
+
+
+  do
+  {
+    pthread_mutex_lock(&system->client_mutex);
+
+    for (client = (pappl_client_t *)cupsArrayGetFirst(system->idle_clients); client; client = (pappl_client_t *)cupsArrayGetNext(system->idle_clients))
+    {
+      if (client->idle_time < idle_time)
+        break;
+    }
+
+    pthread_mutex_unlock(&system->client_mutex);
+
+    if (client)
+    {
+      papplLogClient(client, PAPPL_LOGLEVEL_DEBUG, "Connection idle for more than %d seconds.", _PAPPL_CLIENT_TIMEOUT);
+      remove_client(system, client);
+      _papplClientDelete(client);
+    }
+  }
+  while (client);
+}
+
+
+//
+// 'idle_client()' - Add a connection to the list of idle connections.
+//
+// Connections that already have the next request buffered are queued for a
+// worker instead.  `false` is returned if the worker queue is full, in which
+// case the caller still owns the connection.
+//
+
+static bool				// O - `true` if added, `false` if the queue is full
+idle_client(pappl_system_t *system,	// I - System
+            pappl_client_t *client)	// I - Client
+{
+  bool		ready = httpGetReady(client->http) > 0;
+					// Is there already buffered data?
+  size_t	count;			// Number of queued requests
+
+
+  client->idle_time = time(NULL);
+
+  pthread_mutex_lock(&system->client_mutex);
+
+  if (ready && system->clients_running)
+  {
+    // Already have the next request, queue it immediately...
+    if ((count = (size_t)cupsArrayGetCount(system->ready_clients)) >= system->queue_depth)
+    {
+      pthread_mutex_unlock(&system->client_mutex);
+      return (false);
+    }
+
+    cupsArrayAdd(system->ready_clients, client);
+    pthread_cond_signal(&system->client_cond);
+
+    system->client_metrics.queued ++;
+    if (count >= system->client_metrics.max_queued)
+      system->client_metrics.max_queued = count + 1;
+  }
+  else
+  {
+    cupsArrayAdd(system->idle_clients, client);
+
+#ifdef HAVE_SYS_EPOLL_H
+    struct epoll_event event;		// Event to monitor
+
+    event.events   = EPOLLIN | EPOLLRDHUP | EPOLLET;
+    event.data.ptr = client;
+
+    if (epoll_ctl(system->client_fd, EPOLL_CTL_ADD, httpGetFd(client->http), &event))
+    {
+      papplLogClient(client, PAPPL_LOGLEVEL_ERROR, "Unable to monitor connection: %s", strerror(errno));
+      cupsArrayRemove(system->idle_clients, client);
+      pthread_mutex_unlock(&system->client_mutex);
+      _papplClientDelete(client);
+      return (true);
+    }
+
+#elif !_WIN32
+    if (write(system->client_pipe[1], "", 1) < 0 && errno != EAGAIN)
+      papplLogClient(client, PAPPL_LOGLEVEL_DEBUG, "Unable to wake client event thread: %s", strerror(errno));
+#endif // HAVE_SYS_EPOLL_H
+  }
+
+  pthread_mutex_unlock(&system->client_mutex);
+
+  return (true);
+}
+
+
+//
+// 'listener_loop()' - Accept new connections on a listener thread.
+//
+
+static void *				// O - Thread exit status
+listener_loop(
+    _pappl_listener_t *listener)	// I - Listener thread
+{
+  pappl_system_t	*system = listener->system;
+					// System
+
+
+#if defined(__linux) && defined(CPU_SET)
+  // Pin the thread to a processor core to spread the accept work...
+  cpu_set_t	cpus;			// CPU affinity
+
+  CPU_ZERO(&cpus);
+  CPU_SET(listener->index % (size_t)_papplGetNumCPUs(), &cpus);
+
+  if (pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus))
+    papplLog(system, PAPPL_LOGLEVEL_DEBUG, "Unable to set listener thread %u affinity.", (unsigned)listener->index);
+#endif // __linux && CPU_SET
+
+  papplLog(system, PAPPL_LOGLEVEL_DEBUG, "Starting listener thread %u.", (unsigned)listener->index);
+
+  while (system->listeners_running && _papplSystemAcceptClients(listener));
+
+  papplLog(system, PAPPL_LOGLEVEL_DEBUG, "Stopping listener thread %u.", (unsigned)listener->index);
+
+  return (NULL);
+}
+
+
+//
+// 'ready_client()' - Move an idle connection to the worker queue.
+//
+// If the worker queue is full, the request is rejected and the connection is
+// handed to the busy response thread.  If too many connections are already
+// waiting for a busy response, the connection is closed.
+//
+
+static void
+ready_client(pappl_system_t *system,	// I - System
+             pappl_client_t *client)	// I - Client
+{
+  size_t	count;			// Number of queued requests
+  bool		busy = false;		// Send a busy response?
+
+
+  remove_client(system, client);
+
+  pthread_mutex_lock(&system->client_mutex);
+
+  if ((count = (size_t)cupsArrayGetCount(system->ready_clients)) < system->queue_depth)
+  {
+    cupsArrayAdd(system->ready_clients, client);
+    pthread_cond_signal(&system->client_cond);
+
+    system->client_metrics.queued ++;
+    if (count >= system->client_metrics.max_queued)
+      system->client_metrics.max_queued = count + 1;
+  }
+  else
+  {
+    papplLogClient(client, PAPPL_LOGLEVEL_WARN, "Too many pending requests (%u), rejecting request.", (unsigned)count);
+
+    system->client_metrics.rejected ++;
+
+    if ((busy = cupsArrayGetCount(system->busy_clients) < _PAPPL_MAX_BUSY) == true)
+    {
+      cupsArrayAdd(system->busy_clients, client);
+      pthread_cond_signal(&system->busy_cond);
+    }
+  }
+
+  pthread_mutex_unlock(&system->client_mutex);
+
+  if (count >= system->queue_depth && !busy)
+    _papplClientDelete(client);
+}
+
+
+//
+// 'remove_client()' - Remove a connection from the list of idle connections.
+//
+
+static void
+remove_client(pappl_system_t *system,	// I - System
+              pappl_client_t *client)	// I - Client
+{
+#ifdef HAVE_SYS_EPOLL_H
+  // Stop monitoring the connection before anyone else can touch it...
+  epoll_ctl(system->client_fd, EPOLL_CTL_DEL, httpGetFd(client->http), NULL);
+#endif // HAVE_SYS_EPOLL_H
+
+  pthread_mutex_lock(&system->client_mutex);
+  cupsArrayRemove(system->idle_clients, client);
+  pthread_mutex_unlock(&system->client_mutex);
+}
@@ -148,7 +148,8 @@ ipp_create_printer(
 		*driver_name;		// Name of driver
   ipp_attribute_t *attr;		// Current attribute
   pappl_printer_t *printer;		// Printer
-  cups_array_t	*ra;			// Requested attributes
+  cups_array_t	*names;			// Requested attribute names
+  _pappl_ra_t	*ra;			// Requested attributes
   http_status_t	auth_status;		// Authorization status
 
 
@@ -274,16 +275,17 @@ ipp_create_printer(
   // Return the printer
   papplClientRespondIPP(client, IPP_STATUS_OK, NULL);
 
-  ra = cupsArrayNew((cups_array_cb_t)strcmp, NULL, NULL, 0, NULL, NULL);
-  cupsArrayAdd(ra, "printer-id");
-  cupsArrayAdd(ra, "printer-is-accepting-jobs");
-  cupsArrayAdd(ra, "printer-state");
-  cupsArrayAdd(ra, "printer-state-reasons");
-  cupsArrayAdd(ra, "printer-uuid");
-  cupsArrayAdd(ra, "printer-xri-supported");
+  names = cupsArrayNew((cups_array_cb_t)strcmp, NULL, NULL, 0, NULL, NULL);
+  cupsArrayAdd(names, "printer-id");
+  cupsArrayAdd(names, "printer-is-accepting-jobs");
+  cupsArrayAdd(names, "printer-state");
+  cupsArrayAdd(names, "printer-state-reasons");
+  cupsArrayAdd(names, "printer-uuid");
+  cupsArrayAdd(names, "printer-xri-supported");
 
+  ra = _papplCreateRequestedAttrs(names);
   _papplPrinterCopyAttributes(printer, client, ra, NULL);
-  cupsArrayDelete(ra);
+  _papplDeleteRequestedAttrs(ra);
 }
 
 
@@ -392,7 +394,7 @@ ipp_get_printers(
 {
   pappl_system_t	*system = client->system;
 					// System
-  cups_array_t		*ra;		// Requested attributes array
+  _pappl_ra_t		*ra;		// Requested attributes
   size_t		i,		// Looping var
 			count,		// Number of printers
 			limit;		// Maximum number to return
@@ -402,7 +404,7 @@ ipp_get_printers(
 
   // Get request attributes...
   limit  = (size_t)ippGetInteger(ippFindAttribute(client->request, "limit", IPP_TAG_INTEGER), 0);
-  ra     = ippCreateRequestedArray(client->request);
+  ra     = _papplCreateRequestedAttrs(ippCreateRequestedArray(client->request));
   format = ippGetString(ippFindAttribute(client->request, "document-format", IPP_TAG_MIMETYPE), 0, NULL);
 
   papplClientRespondIPP(client, IPP_STATUS_OK, NULL);
@@ -432,7 +434,7 @@ ipp_get_printers(
 
   pthread_rwlock_unlock(&system->rwlock);
 
-  cupsArrayDelete(ra);
+  _papplDeleteRequestedAttrs(ra);
 }
 
 
@@ -446,7 +448,7 @@ ipp_get_system_attributes(
 {
   pappl_system_t	*system = client->system;
 					// System
-  cups_array_t		*ra;		// Requested attributes array
+  _pappl_ra_t		*ra;		// Requested attributes
   size_t		i,		// Looping var
 			count;		// Count of values
   pappl_printer_t	*printer;	// Current printer
@@ -457,7 +459,7 @@ ipp_get_system_attributes(
   time_t		state_time = 0;	// system-state-change-[date-]time value
 
 
-  ra = ippCreateRequestedArray(client->request);
+  ra = _papplCreateRequestedAttrs(ippCreateRequestedArray(client->request));
 
   papplClientRespondIPP(client, IPP_STATUS_OK, NULL);
 
@@ -465,7 +467,7 @@ ipp_get_system_attributes(
 
   _papplCopyAttributes(client->response, system->attrs, ra, IPP_TAG_ZERO, IPP_TAG_CUPS_CONST);
 
-  if (!ra || cupsArrayFind(ra, "system-config-change-date-time") || cupsArrayFind(ra, "system-config-change-time"))
+  if (_PAPPL_REQUESTED(ra, _PAPPL_RA_SYSTEM_CONFIG_CHANGE_DATE_TIME) || _PAPPL_REQUESTED(ra, _PAPPL_RA_SYSTEM_CONFIG_CHANGE_TIME))
   {
     for (i = 0, count = cupsArrayGetCount(system->printers); i < count; i ++)
     {
@@ -475,14 +477,14 @@ ipp_get_system_attributes(
         config_time = printer->config_time;
     }
 
-    if (!ra || cupsArrayFind(ra, "system-config-change-date-time"))
+    if (_PAPPL_REQUESTED(ra, _PAPPL_RA_SYSTEM_CONFIG_CHANGE_DATE_TIME))
       ippAddDate(client->response, IPP_TAG_SYSTEM, "system-config-change-date-time", ippTimeToDate(config_time));
 
-    if (!ra || cupsArrayFind(ra, "system-config-change-time"))
+    if (_PAPPL_REQUESTED(ra, _PAPPL_RA_SYSTEM_CONFIG_CHANGE_TIME))
       ippAddInteger(client->response, IPP_TAG_SYSTEM, IPP_TAG_INTEGER, "system-config-change-time", (int)(config_time - system->start_time));
   }
 
-  if (!ra || cupsArrayFind(ra, "system-configured-printers"))
+  if (_PAPPL_REQUESTED(ra, _PAPPL_RA_SYSTEM_CONFIGURED_PRINTERS))
   {
     attr = ippAddCollections(client->response, IPP_TAG_SYSTEM, "system-configured-printers", IPP_NUM_CAST cupsArrayGetCount(system->printers), NULL);
 
@@ -508,22 +510,22 @@ ipp_get_system_attributes(
     }
   }
 
-  if (!ra || cupsArrayFind(ra, "system-contact-col"))
+  if (_PAPPL_REQUESTED(ra, _PAPPL_RA_SYSTEM_CONTACT_COL))
   {
     col = _papplContactExport(&system->contact);
     ippAddCollection(client->response, IPP_TAG_SYSTEM, "system-contact-col", col);
     ippDelete(col);
   }
 
-  if (!ra || cupsArrayFind(ra, "system-current-time"))
+  if (_PAPPL_REQUESTED(ra, _PAPPL_RA_SYSTEM_CURRENT_TIME))
     ippAddDate(client->response, IPP_TAG_SYSTEM, "system-current-time", ippTimeToDate(time(NULL)));
 
-  if (!ra || cupsArrayFind(ra, "system-default-printer-id"))
+  if (_PAPPL_REQUESTED(ra, _PAPPL_RA_SYSTEM_DEFAULT_PRINTER_ID))
     ippAddInteger(client->response, IPP_TAG_SYSTEM, IPP_TAG_INTEGER, "system-default-printer-id", system->default_printer_id);
 
   _papplSystemExportVersions(system, client->response, IPP_TAG_SYSTEM, ra);
 
-  if (!ra || cupsArrayFind(ra, "system-geo-location"))
+  if (_PAPPL_REQUESTED(ra, _PAPPL_RA_SYSTEM_GEO_LOCATION))
   {
     if (system->geo_location)
       ippAddString(client->response, IPP_TAG_SYSTEM, IPP_TAG_URI, "system-geo-location", NULL, system->geo_location);
@@ -531,19 +533,19 @@ ipp_get_system_attributes(
       ippAddOutOfBand(client->response, IPP_TAG_SYSTEM, IPP_TAG_UNKNOWN, "system-geo-location");
   }
 
-  if (!ra || cupsArrayFind(ra, "system-location"))
+  if (_PAPPL_REQUESTED(ra, _PAPPL_RA_SYSTEM_LOCATION))
     ippAddString(client->response, IPP_TAG_SYSTEM, IPP_TAG_TEXT, "system-location", NULL, system->location ? system->location : "");
 
-  if (!ra || cupsArrayFind(ra, "system-name"))
+  if (_PAPPL_REQUESTED(ra, _PAPPL_RA_SYSTEM_NAME))
     ippAddString(client->response, IPP_TAG_SYSTEM, IPP_TAG_NAME, "system-name", NULL, system->name);
 
-  if (!ra || cupsArrayFind(ra, "system-organization"))
+  if (_PAPPL_REQUESTED(ra, _PAPPL_RA_SYSTEM_ORGANIZATION))
     ippAddString(client->response, IPP_TAG_SYSTEM, IPP_TAG_TEXT, "system-organization", NULL, system->organization ? system->organization : "");
 
-  if (!ra || cupsArrayFind(ra, "system-organizational-unit"))
+  if (_PAPPL_REQUESTED(ra, _PAPPL_RA_SYSTEM_ORGANIZATIONAL_UNIT))
     ippAddString(client->response, IPP_TAG_SYSTEM, IPP_TAG_TEXT, "system-organizational-unit", NULL, system->org_unit ? system->org_unit : "");
 
-  if (!ra || cupsArrayFind(ra, "system-state"))
+  if (_PAPPL_REQUESTED(ra, _PAPPL_RA_SYSTEM_STATE))
   {
     int	state = IPP_PSTATE_IDLE;	// System state
 
@@ -561,7 +563,7 @@ ipp_get_system_attributes(
     ippAddInteger(client->response, IPP_TAG_SYSTEM, IPP_TAG_ENUM, "system-state", state);
   }
 
-  if (!ra || cupsArrayFind(ra, "system-state-change-date-time") || cupsArrayFind(ra, "system-state-change-time"))
+  if (_PAPPL_REQUESTED(ra, _PAPPL_RA_SYSTEM_STATE_CHANGE_DATE_TIME) || _PAPPL_REQUESTED(ra, _PAPPL_RA_SYSTEM_STATE_CHANGE_TIME))
   {
     for (i = 0, count = cupsArrayGetCount(system->printers); i < count; i ++)
     {
@@ -571,14 +573,14 @@ ipp_get_system_attributes(
         state_time = printer->state_time;
     }
 
-    if (!ra || cupsArrayFind(ra, "system-state-change-date-time"))
+    if (_PAPPL_REQUESTED(ra, _PAPPL_RA_SYSTEM_STATE_CHANGE_DATE_TIME))
       ippAddDate(client->response, IPP_TAG_SYSTEM, "system-state-change-date-time", ippTimeToDate(state_time));
 
-    if (!ra || cupsArrayFind(ra, "system-state-change-time"))
+    if (_PAPPL_REQUESTED(ra, _PAPPL_RA_SYSTEM_STATE_CHANGE_TIME))
       ippAddInteger(client->response, IPP_TAG_SYSTEM, IPP_TAG_INTEGER, "system-state-change-time", (int)(state_time - system->start_time));
   }
 
-  if (!ra || cupsArrayFind(ra, "system-state-reasons"))
+  if (_PAPPL_REQUESTED(ra, _PAPPL_RA_SYSTEM_STATE_REASONS))
   {
     pappl_preason_t	state_reasons = PAPPL_PREASON_NONE;
 
@@ -610,13 +612,13 @@ ipp_get_system_attributes(
     }
   }
 
-  if (!ra || cupsArrayFind(ra, "system-up-time"))
+  if (_PAPPL_REQUESTED(ra, _PAPPL_RA_SYSTEM_UP_TIME))
     ippAddInteger(client->response, IPP_TAG_SYSTEM, IPP_TAG_INTEGER, "system-up-time", (int)(time(NULL) - system->start_time));
 
-  if (system->uuid && (!ra || cupsArrayFind(ra, "system-uuid")))
+  if (system->uuid && (_PAPPL_REQUESTED(ra, _PAPPL_RA_SYSTEM_UUID)))
     ippAddString(client->response, IPP_TAG_SYSTEM, IPP_TAG_URI, "system-uuid", NULL, system->uuid);
 
-  if (!ra || cupsArrayFind(ra, "system-xri-supported"))
+  if (_PAPPL_REQUESTED(ra, _PAPPL_RA_SYSTEM_XRI_SUPPORTED))
   {
     char	uri[1024];		// URI value
 
@@ -632,7 +634,7 @@ ipp_get_system_attributes(
 
   pthread_rwlock_unlock(&system->rwlock);
 
-  cupsArrayDelete(ra);
+  _papplDeleteRequestedAttrs(ra);
 }
 
 
@@ -0,0 +1,430 @@
+//
+// System job processing functions for the Printer Application Framework
+//
+// Copyright © 2022 by Michael R Sweet.
+//
+// Licensed under Apache License v2.0.  See the file "LICENSE" for more
+// information.
+//
+
+//
+// Include necessary headers...
+//
+
+#include "pappl-private.h"
+
+
+//
+// Local types...
+//
+
+typedef struct _pappl_rtask_s		// Render task
+{
+  _pappl_rtask_cb_t	cb;			// Task callback
+  void			*data;			// Task callback data
+} _pappl_rtask_t;
+
+
+//
+// Local functions...
+//
+
+static void	*job_worker(pappl_system_t *system);
+static void	*render_worker(pappl_system_t *system);
+
+
+//
+// '_papplSystemAddRenderTask()' - Queue a task for the render workers.
+//
+// Render tasks let a job render parts of a page on other processor cores.
+// The job thread renders as well, so render worker threads are started as
+// needed up to one less than the maximum number of threads rendering a page
+// and are shared by all jobs.
+//
+// A task that has not been started can be removed with
+// @link _papplSystemRemoveRenderTasks@, otherwise the task callback must tell
+// the job that it is done.  `false` is returned if the render workers are not
+// running.
+//
+
+bool					// O - `true` on success, `false` on failure
+_papplSystemAddRenderTask(
+    pappl_system_t    *system,		// I - System
+    _pappl_rtask_cb_t cb,		// I - Task callback
+    void              *data)		// I - Task callback data
+{
+  _pappl_rtask_t	*task;		// Render task
+
+
+  pthread_mutex_lock(&system->render_mutex);
+
+  if (!system->render_running || (task = (_pappl_rtask_t *)calloc(1, sizeof(_pappl_rtask_t))) == NULL)
+  {
+    pthread_mutex_unlock(&system->render_mutex);
+    return (false);
+  }
+
+  task->cb   = cb;
+  task->data = data;
+
+  cupsArrayAdd(system->render_tasks, task);
+
+  if ((size_t)cupsArrayGetCount(system->render_tasks) > (system->num_render_workers - system->busy_render_workers) && (system->num_render_workers + 1) < (size_t)papplSystemGetMaxRenderWorkers(system))
+  {
+    // Not enough idle workers, start another one...
+    pthread_t	tid;			// Worker thread
+
+    if (pthread_create(&tid, NULL, (void *(*)(void *))render_worker, system))
+    {
+      papplLog(system, PAPPL_LOGLEVEL_ERROR, "Unable to create render worker thread: %s", strerror(errno));
+    }
+    else
+    {
+      pthread_detach(tid);
+      system->num_render_workers ++;
+    }
+  }
+
+  pthread_cond_signal(&system->render_cond);
+  pthread_mutex_unlock(&system->render_mutex);
+
+  return (true);
+}
+
+
+//
+// '_papplSystemQueuePrinter()' - Queue a printer for a job worker.
+//
+// Each printer is a queue of jobs - a printer is queued at most once and only
+// dispatches its next job when it has fewer than its maximum number of
+// processing jobs.  Worker threads are started as needed, up to the maximum
+// number of job workers, and are reused for later jobs.
+//
+
+void
+_papplSystemQueuePrinter(
+    pappl_system_t  *system,		// I - System
+    pappl_printer_t *printer)		// I - Printer
+{
+  size_t	waiting;		// Number of waiting printers
+
+
+  pthread_mutex_lock(&system->job_mutex);
+
+  if (!system->jobs_running || printer->is_queued)
+  {
+    // Not running or already queued...
+    pthread_mutex_unlock(&system->job_mutex);
+    return;
+  }
+
+  printer->is_queued = true;
+
+  cupsArrayAdd(system->ready_printers, printer);
+
+  system->job_metrics.queued ++;
+  if ((waiting = (size_t)cupsArrayGetCount(system->ready_printers)) > system->job_metrics.max_waiting)
+    system->job_metrics.max_waiting = waiting;
+
+  if (system->busy_job_workers >= system->num_job_workers && system->num_job_workers < (size_t)papplSystemGetMaxJobWorkers(system))
+  {
+    // All of the workers are busy, start another one...
+    pthread_t	tid;			// Worker thread
+
+    if (pthread_create(&tid, NULL, (void *(*)(void *))job_worker, system))
+    {
+      papplLog(system, PAPPL_LOGLEVEL_ERROR, "Unable to create job worker thread: %s", strerror(errno));
+    }
+    else
+    {
+      pthread_detach(tid);
+      system->num_job_workers ++;
+    }
+  }
+
+  pthread_cond_signal(&system->job_cond);
+  pthread_mutex_unlock(&system->job_mutex);
+}
+
+
+//
+// '_papplSystemRemoveRenderTasks()' - Remove render tasks that have not been started.
+//
+
+size_t					// O - Number of tasks removed
+_papplSystemRemoveRenderTasks(
+    pappl_system_t *system,		// I - System
+    void           *data)		// I - Task callback data
+{
+  cups_len_t		i;		// Looping var
+  size_t		count = 0;	// Number of tasks removed
+  _pappl_rtask_t	*task;		// Current task
+
+
+  pthread_mutex_lock(&system->render_mutex);
+
+  for (i = 0; i < cupsArrayGetCount(system->render_tasks);)
+  {
+    task = (_pappl_rtask_t *)cupsArrayGetElement(system->render_tasks, i);
+
+    if (task->data == data)
+    {
+      cupsArrayRemove(system->render_tasks, task);
+      count ++;
+    }
+    else
+    {
+      i ++;
+    }
+  }
+
+  pthread_mutex_unlock(&system->render_mutex);
+
+  return (count);
+}
+
+
+//
+// '_papplSystemStartJobs()' - Start processing jobs.
+//
+// Any jobs that were queued before the system was started are dispatched to
+// the job workers.
+//
+
+bool					// O - `true` on success, `false` on failure
+_papplSystemStartJobs(
+    pappl_system_t *system)		// I - System
+{
+  cups_len_t		i,		// Looping var
+			count;		// Number of printers
+  pappl_printer_t	*printer;	// Current printer
+
+
+  pthread_mutex_lock(&system->job_mutex);
+
+  if ((system->ready_printers = cupsArrayNew(NULL, NULL, NULL, 0, NULL, NULL)) == NULL)
+  {
+    pthread_mutex_unlock(&system->job_mutex);
+    papplLog(system, PAPPL_LOGLEVEL_FATAL, "Unable to allocate memory for job queue.");
+    return (false);
+  }
+
+  system->jobs_running     = true;
+  system->num_job_workers  = 0;
+  system->busy_job_workers = 0;
+
+  memset(&system->job_metrics, 0, sizeof(system->job_metrics));
+
+  pthread_mutex_unlock(&system->job_mutex);
+
+  // Render tasks can still be removed by jobs after the render workers are
+  // stopped, so the queue is kept until the system is deleted...
+  pthread_mutex_lock(&system->render_mutex);
+
+  if (!system->render_tasks && (system->render_tasks = cupsArrayNew(NULL, NULL, NULL, 0, NULL, (cups_afree_cb_t)free)) == NULL)
+  {
+    pthread_mutex_unlock(&system->render_mutex);
+    papplLog(system, PAPPL_LOGLEVEL_FATAL, "Unable to allocate memory for render queue.");
+    return (false);
+  }
+
+  system->render_running      = true;
+  system->num_render_workers  = 0;
+  system->busy_render_workers = 0;
+
+  pthread_mutex_unlock(&system->render_mutex);
+
+  papplLog(system, PAPPL_LOGLEVEL_DEBUG, "Processing jobs with up to %d worker threads.", papplSystemGetMaxJobWorkers(system));
+  papplLog(system, PAPPL_LOGLEVEL_DEBUG, "Rendering pages with up to %d threads.", papplSystemGetMaxRenderWorkers(system));
+
+  // Check for pending jobs...
+  pthread_rwlock_rdlock(&system->rwlock);
+  for (i = 0, count = cupsArrayGetCount(system->printers); i < count; i ++)
+  {
+    printer = (pappl_printer_t *)cupsArrayGetElement(system->printers, i);
+
+    _papplPrinterCheckJobs(printer);
+  }
+  pthread_rwlock_unlock(&system->rwlock);
+
+  return (true);
+}
+
+
+//
+// '_papplSystemStopJobs()' - Stop processing jobs.
+//
+// Idle job workers are stopped immediately.  Workers that are still
+// processing a job stop once the job is finished.
+//
+
+void
+_papplSystemStopJobs(
+    pappl_system_t *system)		// I - System
+{
+  pappl_printer_t	*printer;	// Current printer
+
+
+  pthread_mutex_lock(&system->job_mutex);
+
+  if (!system->jobs_running)
+  {
+    pthread_mutex_unlock(&system->job_mutex);
+    return;
+  }
+
+  // Tell the workers to stop and wait for the idle ones to exit...
+  system->jobs_running = false;
+  pthread_cond_broadcast(&system->job_cond);
+
+  while (system->num_job_workers > system->busy_job_workers)
+    pthread_cond_wait(&system->job_cond, &system->job_mutex);
+
+  if (system->busy_job_workers > 0)
+    papplLog(system, PAPPL_LOGLEVEL_WARN, "%u job worker threads are still processing jobs.", (unsigned)system->busy_job_workers);
+
+  papplLog(system, PAPPL_LOGLEVEL_INFO, "Job metrics: %lu processed, %lu queued (%lu max), %lu max busy workers.", (unsigned long)system->job_metrics.processed, (unsigned long)system->job_metrics.queued, (unsigned long)system->job_metrics.max_waiting, (unsigned long)system->job_metrics.max_busy);
+
+  // Any printers that are still waiting keep their pending jobs...
+  while ((printer = (pappl_printer_t *)cupsArrayGetFirst(system->ready_printers)) != NULL)
+  {
+    cupsArrayRemove(system->ready_printers, printer);
+    printer->is_queued = false;
+  }
+
+  cupsArrayDelete(system->ready_printers);
+  system->ready_printers = NULL;
+
+  pthread_mutex_unlock(&system->job_mutex);
+
+  // Stop the idle render workers - jobs that are still processing render any
+  // remaining parts of their pages themselves...
+  pthread_mutex_lock(&system->render_mutex);
+
+  system->render_running = false;
+  pthread_cond_broadcast(&system->render_cond);
+
+  while (system->num_render_workers > system->busy_render_workers)
+    pthread_cond_wait(&system->render_cond, &system->render_mutex);
+
+  pthread_mutex_unlock(&system->render_mutex);
+}
+
+
+//
+// 'job_worker()' - Process jobs for queued printers.
+//
+
+static void *				// O - Thread exit status
+job_worker(pappl_system_t *system)	// I - System
+{
+  pappl_printer_t	*printer;	// Current printer
+  pappl_job_t		*job;		// Current job
+  _pappl_bufpool_t	*pool;		// Raster buffer pool for this worker
+
+
+  // Raster buffers are reused by all of the jobs this worker processes...
+  pool = _papplBufPoolCreate();
+
+  pthread_mutex_lock(&system->job_mutex);
+
+  while (system->jobs_running)
+  {
+    // Get the next printer with a job to process...
+    if ((printer = (pappl_printer_t *)cupsArrayGetFirst(system->ready_printers)) == NULL)
+    {
+      pthread_cond_wait(&system->job_cond, &system->job_mutex);
+      continue;
+    }
+
+    cupsArrayRemove(system->ready_printers, printer);
+    printer->is_queued = false;
+
+    if (++ system->busy_job_workers > system->job_metrics.max_busy)
+      system->job_metrics.max_busy = system->busy_job_workers;
+
+    pthread_mutex_unlock(&system->job_mutex);
+
+    // Process the printer's next job, if any...
+    if ((job = _papplPrinterNextJob(printer)) != NULL)
+    {
+      // Let another worker start the following job if the printer can
+      // process more than one job at a time...
+      if (printer->max_processing_jobs > 1)
+        _papplPrinterCheckJobs(printer);
+
+      job->bufpool = pool;
+      _papplJobProcess(job);
+    }
+
+    pthread_mutex_lock(&system->job_mutex);
+
+    system->busy_job_workers --;
+    if (job)
+      system->job_metrics.processed ++;
+  }
+
+  // Let _papplSystemStopJobs know we are done...
+  system->num_job_workers --;
+  pthread_cond_broadcast(&system->job_cond);
+
+  pthread_mutex_unlock(&system->job_mutex);
+
+  _papplBufPoolDelete(pool);
+
+  return (NULL);
+}
+
+
+//
+// 'render_worker()' - Run queued render tasks.
+//
+
+static void *				// O - Thread exit status
+render_worker(pappl_system_t *system)	// I - System
+{
+  _pappl_rtask_t	*task;		// Current task
+  _pappl_rtask_cb_t	cb;		// Task callback
+  void			*data;		// Task callback data
+
+
+  pthread_mutex_lock(&system->render_mutex);
+
+  while (system->render_running)
+  {
+    // Get the next task to run...
+    if ((task = (_pappl_rtask_t *)cupsArrayGetFirst(system->render_tasks)) == NULL)
+    {
+      // Stop idle workers that are no longer needed after the maximum number
+      // of render threads is lowered...
+      if (system->num_render_workers >= (size_t)papplSystemGetMaxRenderWorkers(system))
+        break;
+
+      pthread_cond_wait(&system->render_cond, &system->render_mutex);
+      continue;
+    }
+
+    cb   = task->cb;
+    data = task->data;
+
+    cupsArrayRemove(system->render_tasks, task);
+
+    system->busy_render_workers ++;
+
+    pthread_mutex_unlock(&system->render_mutex);
+
+    (cb)(data);
+
+    pthread_mutex_lock(&system->render_mutex);
+
+    system->busy_render_workers --;
+  }
+
+  // Let _papplSystemStopJobs know we are done...
+  system->num_render_workers --;
+  pthread_cond_broadcast(&system->render_cond);
+
+  pthread_mutex_unlock(&system->render_mutex);
+
+  return (NULL);
+}
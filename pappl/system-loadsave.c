@@ -175,6 +175,8 @@ papplSystemLoadState(
 	  papplPrinterSetMaxActiveJobs(printer, (int)strtol(value, NULL, 10));
 	else if (!strcasecmp(line, "MaxCompletedJobs") && value)
 	  papplPrinterSetMaxCompletedJobs(printer, (int)strtol(value, NULL, 10));
+	else if (!strcasecmp(line, "MaxProcessingJobs") && value)
+	  papplPrinterSetMaxProcessingJobs(printer, (int)strtol(value, NULL, 10));
 	else if (!strcasecmp(line, "NextJobId") && value)
 	  papplPrinterSetNextJobID(printer, (int)strtol(value, NULL, 10));
 	else if (!strcasecmp(line, "ImpressionsCompleted") && value)
@@ -341,6 +343,16 @@ papplSystemLoadState(
 	    {
 	      // Add the job to printer active jobs array...
 	      cupsArrayAdd(printer->active_jobs, job);
+
+	      if (job->state == IPP_JSTATE_PENDING && !_papplPrinterAddPendingJobNoLock(printer, job))
+	      {
+	        // Unable to queue the job, set job state to aborted...
+	        cupsArrayRemove(printer->active_jobs, job);
+	        cupsArrayAdd(printer->completed_jobs, job);
+
+	        job->state     = IPP_JSTATE_ABORTED;
+	        job->completed = time(NULL);
+	      }
 	    }
 	  }
 	  else
@@ -468,6 +480,7 @@ papplSystemSaveState(
       cupsFilePutConf(fp, "PrintGroup", printer->print_group);
     cupsFilePrintf(fp, "MaxActiveJobs %d\n", printer->max_active_jobs);
     cupsFilePrintf(fp, "MaxCompletedJobs %d\n", printer->max_completed_jobs);
+    cupsFilePrintf(fp, "MaxProcessingJobs %d\n", printer->max_processing_jobs);
     cupsFilePrintf(fp, "NextJobId %d\n", printer->next_job_id);
     cupsFilePrintf(fp, "ImpressionsCompleted %d\n", printer->impcompleted);
 
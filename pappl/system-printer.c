@@ -19,7 +19,10 @@
 // Local functions...
 //
 
+static int	compare_devices(pappl_printer_t *a, pappl_printer_t *b);
+static int	compare_ids(pappl_printer_t *a, pappl_printer_t *b);
 static int	compare_printers(pappl_printer_t *a, pappl_printer_t *b);
+static int	compare_resources(pappl_printer_t *a, pappl_printer_t *b);
 
 
 //
@@ -45,6 +48,18 @@ _papplSystemAddPrinter(
 
   cupsArrayAdd(system->printers, printer);
 
+  // Add the printer to the lookup indices...
+  if (!system->printers_by_id)
+    system->printers_by_id = cupsArrayNew((cups_array_cb_t)compare_ids, NULL, NULL, 0, NULL, NULL);
+  if (!system->printers_by_resource)
+    system->printers_by_resource = cupsArrayNew((cups_array_cb_t)compare_resources, NULL, NULL, 0, NULL, NULL);
+  if (!system->printers_by_uri)
+    system->printers_by_uri = cupsArrayNew((cups_array_cb_t)compare_devices, NULL, NULL, 0, NULL, NULL);
+
+  cupsArrayAdd(system->printers_by_id, printer);
+  cupsArrayAdd(system->printers_by_resource, printer);
+  cupsArrayAdd(system->printers_by_uri, printer);
+
   if (!system->default_printer_id)
     system->default_printer_id = printer->printer_id;
 
@@ -70,9 +85,10 @@ papplSystemFindPrinter(
     int            printer_id,		// I - Printer ID or `0`
     const char     *device_uri)		// I - Device URI or `NULL`
 {
-  size_t		i,		// Current printer index
-			count;		// Printer count
-  pappl_printer_t	*printer = NULL;// Matching printer
+  pappl_printer_t	key,		// Search key
+			*printer = NULL;// Matching printer
+  char			temp[1024],	// Temporary resource path
+			*ptr;		// Pointer into resource path
 
 
   // Range check input...
@@ -83,7 +99,7 @@ papplSystemFindPrinter(
 
   pthread_rwlock_rdlock(&system->rwlock);
 
-  if (resource && (!strcmp(resource, "/") || !strcmp(resource, "/ipp/print") || (!strncmp(resource, "/ipp/print/", 11) && isdigit(resource[11] & 255))))
+  if ((resource && (!strcmp(resource, "/") || !strcmp(resource, "/ipp/print") || (!strncmp(resource, "/ipp/print/", 11) && isdigit(resource[11] & 255)))) || (!resource && !printer_id && !device_uri))
   {
     printer_id = system->default_printer_id;
     resource   = NULL;
@@ -91,36 +107,63 @@ papplSystemFindPrinter(
     papplLog(system, PAPPL_LOGLEVEL_DEBUG, "papplSystemFindPrinter: Looking for default printer_id=%d", printer_id);
   }
 
-  // Loop through the printers to find the one we want...
+  // Look up the printer using the corresponding index...
   //
-  // Note: Cannot use cupsArrayGetFirst/Last since other threads might be
-  // enumerating the printers array.
-
-  for (i = 0, count = cupsArrayGetCount(system->printers); i < count; i ++)
+  // Note: cupsArrayFind is safe to use with the read lock since the indices
+  // are only changed with the write lock held.
+  if (resource)
   {
-    printer = (pappl_printer_t *)cupsArrayGetElement(system->printers, i);
+    // The resource path may refer to a job or other object, so try each
+    // parent path until we get a match...
+    papplCopyString(temp, resource, sizeof(temp));
+    key.resource = temp;
 
-    papplLog(system, PAPPL_LOGLEVEL_DEBUG, "papplSystemFindPrinter: printer '%s' - resource=\"%s\", printer_id=%d, device_uri=\"%s\"", printer->name, printer->resource, printer->printer_id, printer->device_uri);
-
-    if (resource && !strncasecmp(printer->resource, resource, printer->resourcelen) && (!resource[printer->resourcelen] || resource[printer->resourcelen] == '/'))
-      break;
-    else if (printer->printer_id == printer_id)
-      break;
-    else if (device_uri && !strcmp(printer->device_uri, device_uri))
-      break;
+    while ((printer = (pappl_printer_t *)cupsArrayFind(system->printers_by_resource, &key)) == NULL && (ptr = strrchr(temp, '/')) != NULL && ptr > temp)
+      *ptr = '\0';
+  }
+  else if (printer_id > 0)
+  {
+    key.printer_id = printer_id;
+    printer        = (pappl_printer_t *)cupsArrayFind(system->printers_by_id, &key);
+  }
+  else if (device_uri)
+  {
+    key.device_uri = (char *)device_uri;
+    printer        = (pappl_printer_t *)cupsArrayFind(system->printers_by_uri, &key);
   }
-
-  if (i >= count)
-    printer = NULL;
 
   pthread_rwlock_unlock(&system->rwlock);
 
-  papplLog(system, PAPPL_LOGLEVEL_DEBUG, "papplSystemFindPrinter: Returning %p(%s)", printer, printer ? printer->name : "none");
+  papplLog(system, PAPPL_LOGLEVEL_DEBUG, "papplSystemFindPrinter: Returning %p(%s)", (void *)printer, printer ? printer->name : "none");
 
   return (printer);
 }
 
 
+//
+// 'compare_devices()' - Compare the device URIs of two printers.
+//
+
+static int				// O - Result of comparison
+compare_devices(pappl_printer_t *a,	// I - First printer
+                pappl_printer_t *b)	// I - Second printer
+{
+  return (strcmp(a->device_uri, b->device_uri));
+}
+
+
+//
+// 'compare_ids()' - Compare the IDs of two printers.
+//
+
+static int				// O - Result of comparison
+compare_ids(pappl_printer_t *a,		// I - First printer
+            pappl_printer_t *b)		// I - Second printer
+{
+  return (a->printer_id - b->printer_id);
+}
+
+
 //
 // 'compare_printers()' - Compare two printers.
 //
@@ -131,3 +174,15 @@ compare_printers(pappl_printer_t *a,	// I - First printer
 {
   return (strcmp(a->name, b->name));
 }
+
+
+//
+// 'compare_resources()' - Compare the resource paths of two printers.
+//
+
+static int				// O - Result of comparison
+compare_resources(pappl_printer_t *a,	// I - First printer
+                  pappl_printer_t *b)	// I - Second printer
+{
+  return (strcasecmp(a->resource, b->resource));
+}
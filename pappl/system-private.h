@@ -19,19 +19,52 @@
 // Constants...
 //
 
-#  define _PAPPL_MAX_LISTENERS	32	// Maximum number of listener sockets
+#  define _PAPPL_MAX_LISTENERS	256	// Maximum number of listener sockets
+#  define _PAPPL_MAX_LTHREADS	32	// Maximum number of listener threads
+#  define _PAPPL_MAX_WORKERS	64	// Maximum number of client worker threads
+#  define _PAPPL_MIN_WORKERS	4	// Minimum number of client worker threads
+#  define _PAPPL_MAX_JOB_WORKERS 64	// Maximum number of job worker threads
+#  define _PAPPL_MIN_JOB_WORKERS 4	// Minimum number of job worker threads
+#  define _PAPPL_MAX_RENDER_WORKERS 64	// Maximum number of threads rendering a page
+#  define _PAPPL_CLIENT_TIMEOUT	30	// Idle client connection timeout in seconds
+#  define _PAPPL_QUEUE_PER_WORKER 4	// Default number of queued requests per worker
+#  define _PAPPL_MAX_BUSY	16	// Maximum number of connections waiting for a "busy" response
+#  define _PAPPL_BUSY_TIMEOUT	5	// Timeout for "busy" responses in seconds
+
+#  ifdef SO_REUSEPORT_LB
+#    define _PAPPL_SO_REUSEPORT SO_REUSEPORT_LB
+						// Load-balanced listener sockets (FreeBSD)
+#  elif defined(SO_REUSEPORT) && defined(__linux)
+#    define _PAPPL_SO_REUSEPORT SO_REUSEPORT
+						// Load-balanced listener sockets (Linux)
+#  endif // SO_REUSEPORT_LB
 
 
 //
 // Types and structures...
 //
 
+typedef void (*_pappl_rtask_cb_t)(void *data);
+					// Render task callback
+
+typedef struct _pappl_listener_s	// Listener thread
+{
+  pappl_system_t	*system;		// System
+  size_t		index;			// Listener thread index
+  pthread_t		tid;			// Thread ID, if not the main thread
+  bool			paused;			// Are new connections paused?
+  size_t		num_pfds;		// Number of listener sockets
+  struct pollfd		pfds[_PAPPL_MAX_LISTENERS];
+						// Listener sockets
+} _pappl_listener_t;
+
 typedef struct _pappl_mime_filter_s	// MIME filter
 {
   const char		*src,			// Source MIME media type
 			*dst;			// Destination MIME media type
   pappl_mime_filter_cb_t cb;			// Filter callback function
   void			*cbdata;		// Filter callback data
+  bool			streaming;		// Can the filter process data as it is received?
 } _pappl_mime_filter_t;
 
 typedef struct _pappl_resource_s	// Resource
@@ -43,6 +76,8 @@ typedef struct _pappl_resource_s	// Resource
   time_t		last_modified;		// Last-Modified date/time
   const void		*data;			// Static data
   size_t		length;			// Length of file/data
+  char			*br_filename;		// Brotli-compressed variant of file, if any
+  size_t		br_length;		// Length of Brotli-compressed variant
   pappl_resource_cb_t	cb;			// Dynamic callback
   void			*cbdata;		// Callback data
 } _pappl_resource_t;
@@ -69,6 +104,7 @@ struct _pappl_system_s			// System data
   pappl_contact_t	contact;		// "system-contact-col" value
   char			*hostname;		// Published hostname
   int			port;			// Port number, if any
+  bool			auto_port;		// Was the port number picked automatically?
   char			*domain_path;		// Domain socket path, if any
   size_t		num_versions;		// Number of "xxx-firmware-yyy" values
   pappl_version_t	versions[10];		// "xxx-firmware-yyy" values
@@ -91,14 +127,61 @@ struct _pappl_system_s			// System data
   size_t		num_listeners;		// Number of listener sockets
   struct pollfd		listeners[_PAPPL_MAX_LISTENERS];
 						// Listener sockets
+  size_t		listener_index[_PAPPL_MAX_LISTENERS];
+						// Listener thread for each socket
+  int			listen_threads;		// Number of listener threads per address
+  bool			listeners_running;	// Are the listener threads running?
+  size_t		num_lthreads;		// Number of listener threads
+  _pappl_listener_t	*lthreads;		// Listener threads
   int			num_clients,		// Current number of clients
 			max_clients;		// Maximum number of clients
+  pthread_mutex_t	client_mutex;		// Mutex for client queues
+  pthread_cond_t	client_cond;		// Condition for ready clients
+  bool			clients_running;	// Are the client threads running?
+  cups_array_t		*idle_clients,		// Connections waiting for a request
+			*ready_clients,		// Connections waiting for a worker
+			*busy_clients;		// Connections waiting for a "busy" response
+  pthread_cond_t	busy_cond;		// Condition for busy clients
+  pthread_t		busy_tid;		// Busy response thread
+  int			client_fd,		// Client event descriptor (epoll), if any
+			client_pipe[2];		// Client event wakeup pipe, if any
+  pthread_t		client_tid;		// Client event loop thread
+  int			max_workers,		// Maximum number of client worker threads (0 = auto)
+			max_queue;		// Maximum number of queued requests (0 = auto)
+  size_t		num_workers,		// Number of client worker threads
+			queue_depth;		// Maximum number of queued requests
+  pthread_t		workers[_PAPPL_MAX_WORKERS];
+						// Client worker threads
+  pappl_cmetrics_t	client_metrics;		// Client connection metrics
+  pthread_mutex_t	resolver_mutex;		// Mutex for host name cache
+  pthread_cond_t	resolver_cond;		// Condition for pending lookups
+  bool			resolver_running;	// Is the resolver thread running?
+  cups_array_t		*resolver_cache;	// Host name cache
+  pthread_t		resolver_tid;		// Host name resolver thread
+  pthread_mutex_t	job_mutex;		// Mutex for job queue
+  pthread_cond_t	job_cond;		// Condition for ready printers
+  bool			jobs_running;		// Are the job worker threads running?
+  cups_array_t		*ready_printers;	// Printers waiting for a job worker
+  int			max_job_workers;	// Maximum number of job worker threads (0 = auto)
+  size_t		num_job_workers,	// Number of job worker threads
+			busy_job_workers;	// Number of job worker threads processing a job
+  pappl_jmetrics_t	job_metrics;		// Job processing metrics
+  pthread_mutex_t	render_mutex;		// Mutex for render task queue
+  pthread_cond_t	render_cond;		// Condition for queued render tasks
+  bool			render_running;		// Are the render worker threads running?
+  cups_array_t		*render_tasks;		// Render tasks waiting for a worker
+  int			max_render_workers;	// Maximum number of threads rendering a page (0 = auto)
+  size_t		num_render_workers,	// Number of render worker threads
+			busy_render_workers;	// Number of render worker threads running a task
   cups_array_t		*links;			// Web navigation links
   cups_array_t		*resources;		// Array of resources
   cups_array_t		*localizations;		// Array of localizations
   cups_array_t		*filters;		// Array of filters
   int			next_client;		// Next client number
   cups_array_t		*printers;		// Array of printers
+  cups_array_t		*printers_by_id,	// Printers sorted by printer-id
+			*printers_by_resource,	// Printers sorted by resource path
+			*printers_by_uri;	// Printers sorted by device URI
   int			default_printer_id,	// Default printer-id
 			next_printer_id;	// Next printer-id
   char			password_hash[100];	// Access password hash
@@ -151,23 +234,37 @@ struct _pappl_system_s			// System data
 // Functions...
 //
 
+extern bool		_papplSystemAcceptClients(_pappl_listener_t *listener) _PAPPL_PRIVATE;
+extern void		_papplSystemAddClient(pappl_system_t *system, pappl_client_t *client) _PAPPL_PRIVATE;
 extern void		_papplSystemAddEventNoLock(pappl_system_t *system, pappl_printer_t *printer, pappl_job_t *job, pappl_event_t event, const char *message, ...) _PAPPL_FORMAT(5, 6) _PAPPL_PRIVATE;
 extern void		_papplSystemAddEventNoLockv(pappl_system_t *system, pappl_printer_t *printer, pappl_job_t *job, pappl_event_t event, const char *message, va_list ap) _PAPPL_PRIVATE;
 extern void		_papplSystemAddLoc(pappl_system_t *system, pappl_loc_t *loc) _PAPPL_PRIVATE;
 extern void		_papplSystemAddPrinter(pappl_system_t *system, pappl_printer_t *printer, int printer_id) _PAPPL_PRIVATE;
 extern void		_papplSystemAddPrinterIcons(pappl_system_t *system, pappl_printer_t *printer) _PAPPL_PRIVATE;
+extern bool		_papplSystemAddRenderTask(pappl_system_t *system, _pappl_rtask_cb_t cb, void *data) _PAPPL_PRIVATE;
 extern bool		_papplSystemAddSubscription(pappl_system_t *system, pappl_subscription_t *sub, int sub_id) _PAPPL_PRIVATE;
 extern void		_papplSystemCleanJobs(pappl_system_t *system) _PAPPL_PRIVATE;
 extern void		_papplSystemCleanSubscriptions(pappl_system_t *system, bool clean_all) _PAPPL_PRIVATE;
 extern void		_papplSystemConfigChanged(pappl_system_t *system) _PAPPL_PRIVATE;
-extern void		_papplSystemExportVersions(pappl_system_t *system, ipp_t *ipp, ipp_tag_t group_tag, cups_array_t *ra);
+extern void		_papplSystemExportVersions(pappl_system_t *system, ipp_t *ipp, ipp_tag_t group_tag, _pappl_ra_t *ra);
 extern _pappl_mime_filter_t *_papplSystemFindMIMEFilter(pappl_system_t *system, const char *srctype, const char *dsttype) _PAPPL_PRIVATE;
 extern _pappl_resource_t *_papplSystemFindResourceForLanguage(pappl_system_t *system, const char *language) _PAPPL_PRIVATE;
 extern _pappl_resource_t *_papplSystemFindResourceForPath(pappl_system_t *system, const char *path) _PAPPL_PRIVATE;
 extern char		*_papplSystemMakeUUID(pappl_system_t *system, const char *printer_name, int job_id, char *buffer, size_t bufsize) _PAPPL_PRIVATE;
 extern void		_papplSystemProcessIPP(pappl_client_t *client) _PAPPL_PRIVATE;
+extern void		_papplSystemQueuePrinter(pappl_system_t *system, pappl_printer_t *printer) _PAPPL_PRIVATE;
 extern bool		_papplSystemRegisterDNSSDNoLock(pappl_system_t *system) _PAPPL_PRIVATE;
+extern size_t		_papplSystemRemoveRenderTasks(pappl_system_t *system, void *data) _PAPPL_PRIVATE;
+extern char		*_papplSystemResolveHost(pappl_system_t *system, http_addr_t *addr, char *buffer, size_t bufsize) _PAPPL_PRIVATE;
+extern bool		_papplSystemStartClients(pappl_system_t *system) _PAPPL_PRIVATE;
+extern bool		_papplSystemStartJobs(pappl_system_t *system) _PAPPL_PRIVATE;
+extern bool		_papplSystemStartListeners(pappl_system_t *system) _PAPPL_PRIVATE;
+extern bool		_papplSystemStartResolver(pappl_system_t *system) _PAPPL_PRIVATE;
 extern void		_papplSystemStatusUI(pappl_system_t *system) _PAPPL_PRIVATE;
+extern void		_papplSystemStopClients(pappl_system_t *system) _PAPPL_PRIVATE;
+extern void		_papplSystemStopJobs(pappl_system_t *system) _PAPPL_PRIVATE;
+extern void		_papplSystemStopListeners(pappl_system_t *system) _PAPPL_PRIVATE;
+extern void		_papplSystemStopResolver(pappl_system_t *system) _PAPPL_PRIVATE;
 extern void		_papplSystemUnregisterDNSSDNoLock(pappl_system_t *system) _PAPPL_PRIVATE;
 
 extern void		_papplSystemWebAddPrinter(pappl_client_t *client, pappl_system_t *system) _PAPPL_PRIVATE;
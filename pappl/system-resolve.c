@@ -0,0 +1,274 @@
+//
+// System host name resolver functions for the Printer Application Framework
+//
+// Copyright © 2022 by Michael R Sweet.
+//
+// Licensed under Apache License v2.0.  See the file "LICENSE" for more
+// information.
+//
+
+//
+// Include necessary headers...
+//
+
+#include "pappl-private.h"
+
+
+//
+// Local constants...
+//
+
+#define _PAPPL_MAX_HOSTS	1024	// Maximum number of cached host names
+#define _PAPPL_HOST_TTL		300	// Time-to-live for host names in seconds
+#define _PAPPL_NOHOST_TTL	60	// Time-to-live for failed lookups in seconds
+
+
+//
+// Local types...
+//
+
+typedef struct _pappl_host_s		// Cached host name
+{
+  char		address[256],		// Numeric address (key)
+		name[256];		// Host name or "" if not resolved
+  http_addr_t	addr;			// Peer address
+  bool		pending;		// Is a lookup pending?
+  time_t	expires;		// Expiration time
+} _pappl_host_t;
+
+
+//
+// Local functions...
+//
+
+static int	compare_hosts(_pappl_host_t *a, _pappl_host_t *b);
+static void	*resolve_hosts(pappl_system_t *system);
+
+
+//
+// '_papplSystemResolveHost()' - Get the host name for a peer address.
+//
+// This function never blocks on DNS.  If the host name is cached it is
+// copied to the buffer, otherwise the numeric address is copied and a lookup
+// is queued for the resolver thread so that later connections from the same
+// address get the host name.
+//
+
+char *					// O - Host name or numeric address
+_papplSystemResolveHost(
+    pappl_system_t *system,		// I - System
+    http_addr_t    *addr,		// I - Peer address
+    char           *buffer,		// I - Buffer
+    size_t         bufsize)		// I - Size of buffer
+{
+  _pappl_host_t	key,			// Search key
+		*host;			// Cached host name
+  time_t	curtime;		// Current time
+
+
+  // Local (domain socket) connections are always "localhost"...
+  if (httpAddrFamily(addr) == AF_LOCAL)
+  {
+    papplCopyString(buffer, "localhost", bufsize);
+    return (buffer);
+  }
+
+  httpAddrGetString(addr, key.address, (cups_len_t)sizeof(key.address));
+  papplCopyString(buffer, key.address, bufsize);
+
+  pthread_mutex_lock(&system->resolver_mutex);
+
+  if (!system->resolver_running)
+  {
+    pthread_mutex_unlock(&system->resolver_mutex);
+    return (buffer);
+  }
+
+  curtime = time(NULL);
+
+  if ((host = (_pappl_host_t *)cupsArrayFind(system->resolver_cache, &key)) != NULL)
+  {
+    // Use the cached name, even if it is stale, and refresh as needed...
+    if (host->name[0])
+      papplCopyString(buffer, host->name, bufsize);
+
+    if (!host->pending && host->expires <= curtime)
+    {
+      host->pending = true;
+      pthread_cond_signal(&system->resolver_cond);
+    }
+  }
+  else
+  {
+    // Make room in the cache as needed...
+    if (cupsArrayGetCount(system->resolver_cache) >= _PAPPL_MAX_HOSTS)
+    {
+      for (host = (_pappl_host_t *)cupsArrayGetFirst(system->resolver_cache); host; host = (_pappl_host_t *)cupsArrayGetNext(system->resolver_cache))
+      {
+        if (!host->pending && host->expires <= curtime)
+        {
+          cupsArrayRemove(system->resolver_cache, host);
+          break;
+        }
+      }
+    }
+
+    // Queue a lookup for the resolver thread...
+    if (cupsArrayGetCount(system->resolver_cache) < _PAPPL_MAX_HOSTS && (host = (_pappl_host_t *)calloc(1, sizeof(_pappl_host_t))) != NULL)
+    {
+      papplCopyString(host->address, key.address, sizeof(host->address));
+      memcpy(&host->addr, addr, sizeof(host->addr));
+      host->pending = true;
+
+      cupsArrayAdd(system->resolver_cache, host);
+      pthread_cond_signal(&system->resolver_cond);
+    }
+  }
+
+  pthread_mutex_unlock(&system->resolver_mutex);
+
+  return (buffer);
+}
+
+
+//
+// '_papplSystemStartResolver()' - Start the host name resolver thread.
+//
+
+bool					// O - `true` on success, `false` on failure
+_papplSystemStartResolver(
+    pappl_system_t *system)		// I - System
+{
+  pthread_mutex_lock(&system->resolver_mutex);
+
+  if ((system->resolver_cache = cupsArrayNew((cups_array_cb_t)compare_hosts, NULL, NULL, 0, NULL, (cups_afree_cb_t)free)) == NULL)
+  {
+    pthread_mutex_unlock(&system->resolver_mutex);
+    papplLog(system, PAPPL_LOGLEVEL_ERROR, "Unable to allocate memory for host name cache.");
+    return (false);
+  }
+
+  system->resolver_running = true;
+
+  if (pthread_create(&system->resolver_tid, NULL, (void *(*)(void *))resolve_hosts, system))
+  {
+    papplLog(system, PAPPL_LOGLEVEL_ERROR, "Unable to create host name resolver thread: %s", strerror(errno));
+
+    system->resolver_running = false;
+
+    cupsArrayDelete(system->resolver_cache);
+    system->resolver_cache = NULL;
+
+    pthread_mutex_unlock(&system->resolver_mutex);
+    return (false);
+  }
+
+  pthread_mutex_unlock(&system->resolver_mutex);
+
+  return (true);
+}
+
+
+//
+// '_papplSystemStopResolver()' - Stop the host name resolver thread.
+//
+// Any lookup that is in progress is allowed to finish.
+//
+
+void
+_papplSystemStopResolver(
+    pappl_system_t *system)		// I - System
+{
+  pthread_mutex_lock(&system->resolver_mutex);
+
+  if (!system->resolver_running)
+  {
+    pthread_mutex_unlock(&system->resolver_mutex);
+    return;
+  }
+
+  system->resolver_running = false;
+  pthread_cond_broadcast(&system->resolver_cond);
+  pthread_mutex_unlock(&system->resolver_mutex);
+
+  pthread_join(system->resolver_tid, NULL);
+
+  cupsArrayDelete(system->resolver_cache);
+  system->resolver_cache = NULL;
+}
+
+
+//
+// 'compare_hosts()' - Compare two cached host names.
+//
+
+static int				// O - Result of comparison
+compare_hosts(_pappl_host_t *a,		// I - First host
+              _pappl_host_t *b)		// I - Second host
+{
+  return (strcmp(a->address, b->address));
+}
+
+
+//
+// 'resolve_hosts()' - Look up host names for pending addresses.
+//
+
+static void *				// O - Thread exit status
+resolve_hosts(pappl_system_t *system)	// I - System
+{
+  _pappl_host_t	*host;			// Current host
+  http_addr_t	addr;			// Address to look up
+  char		address[256],		// Numeric address
+		name[256];		// Host name
+
+
+  papplLog(system, PAPPL_LOGLEVEL_DEBUG, "Starting host name resolver thread.");
+
+  pthread_mutex_lock(&system->resolver_mutex);
+
+  while (system->resolver_running)
+  {
+    // Find the next pending lookup...
+    for (host = (_pappl_host_t *)cupsArrayGetFirst(system->resolver_cache); host; host = (_pappl_host_t *)cupsArrayGetNext(system->resolver_cache))
+    {
+      if (host->pending)
+        break;
+    }
+
+    if (!host)
+    {
+      pthread_cond_wait(&system->resolver_cond, &system->resolver_mutex);
+      continue;
+    }
+
+    // Do the lookup without holding the lock - pending entries are never
+    // removed from the cache so the pointer remains valid...
+    memcpy(&addr, &host->addr, sizeof(addr));
+    papplCopyString(address, host->address, sizeof(address));
+
+    pthread_mutex_unlock(&system->resolver_mutex);
+
+    if (!httpAddrLookup(&addr, name, (cups_len_t)sizeof(name)) || !strcmp(name, address))
+      name[0] = '\0';
+
+    if (name[0])
+      papplLog(system, PAPPL_LOGLEVEL_DEBUG, "Resolved '%s' to '%s'.", address, name);
+    else
+      papplLog(system, PAPPL_LOGLEVEL_DEBUG, "Unable to resolve '%s'.", address);
+
+    pthread_mutex_lock(&system->resolver_mutex);
+
+    if (name[0])
+      papplCopyString(host->name, name, sizeof(host->name));
+
+    host->pending = false;
+    host->expires = time(NULL) + (name[0] ? _PAPPL_HOST_TTL : _PAPPL_NOHOST_TTL);
+  }
+
+  pthread_mutex_unlock(&system->resolver_mutex);
+
+  papplLog(system, PAPPL_LOGLEVEL_DEBUG, "Stopping host name resolver thread.");
+
+  return (NULL);
+}
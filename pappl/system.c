@@ -177,6 +177,15 @@ papplSystemCreate(
   pthread_mutex_init(&system->config_mutex, NULL);
   pthread_mutex_init(&system->subscription_mutex, NULL);
   pthread_cond_init(&system->subscription_cond, NULL);
+  pthread_mutex_init(&system->client_mutex, NULL);
+  pthread_cond_init(&system->client_cond, NULL);
+  pthread_cond_init(&system->busy_cond, NULL);
+  pthread_mutex_init(&system->resolver_mutex, NULL);
+  pthread_cond_init(&system->resolver_cond, NULL);
+  pthread_mutex_init(&system->job_mutex, NULL);
+  pthread_cond_init(&system->job_cond, NULL);
+  pthread_mutex_init(&system->render_mutex, NULL);
+  pthread_cond_init(&system->render_cond, NULL);
 
   system->options           = options;
   system->start_time        = time(NULL);
@@ -190,6 +199,7 @@ papplSystemCreate(
   system->logmaxsize        = 1024 * 1024;
   system->next_client       = 1;
   system->next_printer_id   = 1;
+  system->listen_threads    = 1;
   system->subtypes          = subtypes ? strdup(subtypes) : NULL;
   system->tls_only          = tls_only;
   system->admin_gid         = (gid_t)-1;
@@ -247,7 +257,7 @@ papplSystemCreate(
 
   // Initialize base filters...
 #ifdef HAVE_LIBJPEG
-  papplSystemAddMIMEFilter(system, "image/jpeg", "image/pwg-raster", _papplJobFilterJPEG, NULL);
+  papplSystemAddStreamingMIMEFilter(system, "image/jpeg", "image/pwg-raster", _papplJobFilterJPEG, NULL);
 #endif // HAVE_LIBJPEG
 #ifdef HAVE_LIBPNG
   papplSystemAddMIMEFilter(system, "image/png", "image/pwg-raster", _papplJobFilterPNG, NULL);
@@ -286,6 +296,9 @@ papplSystemDelete(
   _papplSystemUnregisterDNSSDNoLock(system);
 
   cupsArrayDelete(system->printers);
+  cupsArrayDelete(system->printers_by_id);
+  cupsArrayDelete(system->printers_by_resource);
+  cupsArrayDelete(system->printers_by_uri);
 
   free(system->uuid);
   free(system->name);
@@ -320,6 +333,16 @@ papplSystemDelete(
   cupsArrayDelete(system->subscriptions);
   pthread_cond_destroy(&system->subscription_cond);
   pthread_mutex_destroy(&system->subscription_mutex);
+  pthread_cond_destroy(&system->client_cond);
+  pthread_cond_destroy(&system->busy_cond);
+  pthread_mutex_destroy(&system->client_mutex);
+  pthread_cond_destroy(&system->resolver_cond);
+  pthread_mutex_destroy(&system->resolver_mutex);
+  pthread_cond_destroy(&system->job_cond);
+  pthread_mutex_destroy(&system->job_mutex);
+  cupsArrayDelete(system->render_tasks);
+  pthread_cond_destroy(&system->render_cond);
+  pthread_mutex_destroy(&system->render_mutex);
 
   pthread_rwlock_destroy(&system->rwlock);
   pthread_rwlock_destroy(&system->session_rwlock);
@@ -383,8 +406,6 @@ papplSystemRun(pappl_system_t *system)	// I - System
 {
   size_t		i,		// Looping var
 			count;		// Number of listeners that fired
-  int			pcount;		// Poll count
-  pappl_client_t	*client;	// New client
   char			header[HTTP_MAX_VALUE];
 					// Server: header value
   int			dns_sd_host_changes;
@@ -505,6 +526,37 @@ papplSystemRun(pappl_system_t *system)	// I - System
   // Make the static attributes...
   make_attributes(system);
 
+  // Start the host name resolver - clients are logged using their numeric
+  // address if the resolver is not available...
+  _papplSystemStartResolver(system);
+
+  // Start processing jobs...
+  if (!_papplSystemStartJobs(system))
+  {
+    _papplSystemStopResolver(system);
+    system->is_running = false;
+    return;
+  }
+
+  // Start the client event loop and worker threads...
+  if (!_papplSystemStartClients(system))
+  {
+    _papplSystemStopJobs(system);
+    _papplSystemStopResolver(system);
+    system->is_running = false;
+    return;
+  }
+
+  // Start the listener threads...
+  if (!_papplSystemStartListeners(system))
+  {
+    _papplSystemStopClients(system);
+    _papplSystemStopJobs(system);
+    _papplSystemStopResolver(system);
+    system->is_running = false;
+    return;
+  }
+
   // Start all child threads in a detached state...
   pthread_attr_init(&tattr);
   pthread_attr_setdetachstate(&tattr, PTHREAD_CREATE_DETACHED);
@@ -556,49 +608,9 @@ papplSystemRun(pappl_system_t *system)	// I - System
       _papplLogOpen(system);
     }
 
-    if ((pcount = poll(system->listeners, (nfds_t)system->num_listeners, 1000)) < 0 && errno != EINTR && errno != EAGAIN)
-    {
-      papplLog(system, PAPPL_LOGLEVEL_ERROR, "Unable to accept new connections: %s", strerror(errno));
+    // Accept new connections on the main listener thread...
+    if (!_papplSystemAcceptClients(system->lthreads))
       break;
-    }
-
-    if (pcount > 0)
-    {
-      // Accept client connections as needed...
-      for (i = 0; i < (size_t)system->num_listeners; i ++)
-      {
-	if (system->listeners[i].revents & POLLIN)
-	{
-	  if ((client = _papplClientCreate(system, (int)system->listeners[i].fd)) != NULL)
-	  {
-	    pthread_rwlock_wrlock(&system->rwlock);
-	    system->num_clients ++;
-	    pthread_rwlock_unlock(&system->rwlock);
-
-	    if (pthread_create(&client->thread_id, &tattr, (void *(*)(void *))_papplClientRun, client))
-	    {
-	      // Unable to create client thread...
-	      papplLog(system, PAPPL_LOGLEVEL_ERROR, "Unable to create client thread: %s", strerror(errno));
-	      _papplClientDelete(client);
-	    }
-	  }
-	}
-      }
-
-      if (system->num_clients >= system->max_clients)
-      {
-	for (i = 0; i < (size_t)system->num_listeners; i ++)
-	  system->listeners[i].events = 0;
-      }
-    }
-    else if (system->num_clients < system->max_clients)
-    {
-      if (system->num_clients >= system->max_clients)
-      {
-	for (i = 0; i < (size_t)system->num_listeners; i ++)
-	  system->listeners[i].events = POLLIN;
-      }
-    }
 
     dns_sd_host_changes = _papplDNSSDGetHostChanges();
 
@@ -679,6 +691,20 @@ papplSystemRun(pappl_system_t *system)	// I - System
     if (system->clean_time && curtime >= system->clean_time)
       papplSystemCleanJobs(system);
 
+    // Close devices that have been idle for too long and retry devices that
+    // were unavailable...
+    pthread_rwlock_rdlock(&system->rwlock);
+    for (i = 0, count = cupsArrayGetCount(system->printers); i < count; i ++)
+    {
+      printer = (pappl_printer_t *)cupsArrayGetElement(system->printers, i);
+
+      _papplPrinterCloseIdleDevice(printer, false);
+
+      if (printer->device_retry && curtime >= printer->device_retry)
+        _papplPrinterCheckJobs(printer);
+    }
+    pthread_rwlock_unlock(&system->rwlock);
+
     if (curtime >= subtime)
     {
       _papplSystemCleanSubscriptions(system, false);
@@ -688,6 +714,11 @@ papplSystemRun(pappl_system_t *system)	// I - System
 
   papplLog(system, PAPPL_LOGLEVEL_INFO, "Shutting down system.");
 
+  _papplSystemStopListeners(system);
+  _papplSystemStopClients(system);
+  _papplSystemStopJobs(system);
+  _papplSystemStopResolver(system);
+
   ippDelete(system->attrs);
   system->attrs = NULL;
 
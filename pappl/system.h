@@ -20,6 +20,31 @@ extern "C" {
 // Types...
 //
 
+typedef struct pappl_cmetrics_s		// Client connection metrics
+{
+  size_t	accepted;			// Total number of connections accepted
+  size_t	paused;				// Total number of times new connections were paused at the client limit
+  size_t	queued;				// Total number of requests queued for a worker
+  size_t	max_queued;			// Maximum number of requests waiting for a worker
+  size_t	rejected;			// Total number of requests rejected because the queue was full
+  size_t	served;				// Total number of requests served by a worker
+} pappl_cmetrics_t;
+
+typedef struct pappl_jmetrics_s		// Job processing metrics
+{
+  size_t	workers;			// Current number of job worker threads
+  size_t	busy;				// Current number of job worker threads processing a job
+  size_t	max_busy;			// Maximum number of job worker threads processing a job
+  size_t	waiting;			// Current number of printers waiting for a worker
+  size_t	max_waiting;			// Maximum number of printers waiting for a worker
+  size_t	queued;				// Total number of times a printer was queued for a worker
+  size_t	processed;			// Total number of jobs processed by a worker
+  size_t	raster_lines;			// Total number of raster lines written
+  size_t	raster_msecs;			// Total elapsed time for raster pages in milliseconds
+  size_t	render_msecs;			// Total time spent producing raster lines in milliseconds
+  size_t	write_msecs;			// Total time spent writing raster lines in milliseconds
+} pappl_jmetrics_t;
+
 typedef struct pappl_pr_driver_s	// Printer driver information
 {
   const char	*name;				// Driver name
@@ -41,7 +66,8 @@ enum pappl_soptions_e			// System option bits
   PAPPL_SOPTIONS_WEB_REMOTE = 0x0080,		// Allow remote queue management (vs. localhost only)
   PAPPL_SOPTIONS_WEB_SECURITY = 0x0100,		// Enable the user/password settings page
   PAPPL_SOPTIONS_WEB_TLS = 0x0200,		// Enable the TLS settings page
-  PAPPL_SOPTIONS_NO_TLS = 0x0400		// Disable TLS support @since PAPPL 1.1@
+  PAPPL_SOPTIONS_NO_TLS = 0x0400,		// Disable TLS support @since PAPPL 1.1@
+  PAPPL_SOPTIONS_WEB_BUFFER = 0x0800		// Buffer web pages between the standard header and footer @since PAPPL 1.3@
 };
 typedef unsigned pappl_soptions_t;	// Bitfield for system options
 
@@ -116,6 +142,7 @@ extern void		papplSystemAddResourceData(pappl_system_t *system, const char *path
 extern void		papplSystemAddResourceDirectory(pappl_system_t *system, const char *basepath, const char *directory) _PAPPL_PUBLIC;
 extern void		papplSystemAddResourceFile(pappl_system_t *system, const char *path, const char *format, const char *filename) _PAPPL_PUBLIC;
 extern void		papplSystemAddResourceString(pappl_system_t *system, const char *path, const char *format, const char *data) _PAPPL_PUBLIC;
+extern void		papplSystemAddStreamingMIMEFilter(pappl_system_t *system, const char *srctype, const char *dsttype, pappl_mime_filter_cb_t cb, void *data) _PAPPL_PUBLIC;
 extern void		papplSystemAddStringsData(pappl_system_t *system, const char *path, const char *language, const char *data) _PAPPL_PUBLIC;
 extern void		papplSystemAddStringsFile(pappl_system_t *system, const char *path, const char *language, const char *filename) _PAPPL_PUBLIC;
 extern void		papplSystemCleanJobs(pappl_system_t *system) _PAPPL_PUBLIC;
@@ -126,6 +153,7 @@ extern pappl_printer_t	*papplSystemFindPrinter(pappl_system_t *system, const cha
 extern pappl_subscription_t *papplSystemFindSubscription(pappl_system_t *system, int sub_id) _PAPPL_PUBLIC;
 extern char		*papplSystemGetAdminGroup(pappl_system_t *system, char *buffer, size_t bufsize) _PAPPL_PUBLIC;
 extern const char	*papplSystemGetAuthService(pappl_system_t *system) _PAPPL_PUBLIC;
+extern pappl_cmetrics_t	*papplSystemGetClientMetrics(pappl_system_t *system, pappl_cmetrics_t *metrics) _PAPPL_PUBLIC;
 extern pappl_contact_t	*papplSystemGetContact(pappl_system_t *system, pappl_contact_t *contact) _PAPPL_PUBLIC;
 extern int		papplSystemGetDefaultPrinterID(pappl_system_t *system) _PAPPL_PUBLIC;
 extern char		*papplSystemGetDefaultPrintGroup(pappl_system_t *system, char *buffer, size_t bufsize) _PAPPL_PUBLIC;
@@ -135,10 +163,16 @@ extern char		*papplSystemGetGeoLocation(pappl_system_t *system, char *buffer, si
 extern char		*papplSystemGetHostname(pappl_system_t *system, char *buffer, size_t bufsize) _PAPPL_DEPRECATED("Use papplSystemGetHostName instead.");
 extern char		*papplSystemGetHostName(pappl_system_t *system, char *buffer, size_t bufsize) _PAPPL_PUBLIC;
 extern int		papplSystemGetHostPort(pappl_system_t *system) _PAPPL_PUBLIC;
+extern pappl_jmetrics_t	*papplSystemGetJobMetrics(pappl_system_t *system, pappl_jmetrics_t *metrics) _PAPPL_PUBLIC;
+extern int		papplSystemGetListenerThreads(pappl_system_t *system) _PAPPL_PUBLIC;
 extern char		*papplSystemGetLocation(pappl_system_t *system, char *buffer, size_t bufsize) _PAPPL_PUBLIC;
 extern pappl_loglevel_t	papplSystemGetLogLevel(pappl_system_t *system) _PAPPL_PUBLIC;
+extern int		papplSystemGetMaxClientQueue(pappl_system_t *system) _PAPPL_PUBLIC;
 extern int		papplSystemGetMaxClients(pappl_system_t *system) _PAPPL_PUBLIC;
+extern int		papplSystemGetMaxClientWorkers(pappl_system_t *system) _PAPPL_PUBLIC;
+extern int		papplSystemGetMaxJobWorkers(pappl_system_t *system) _PAPPL_PUBLIC;
 extern size_t		papplSystemGetMaxLogSize(pappl_system_t *system) _PAPPL_PUBLIC;
+extern int		papplSystemGetMaxRenderWorkers(pappl_system_t *system) _PAPPL_PUBLIC;
 extern size_t		papplSystemGetMaxSubscriptions(pappl_system_t *system) _PAPPL_PUBLIC;
 extern char		*papplSystemGetName(pappl_system_t *system, char *buffer, size_t bufsize) _PAPPL_PUBLIC;
 extern int		papplSystemGetNextPrinterID(pappl_system_t *system) _PAPPL_PUBLIC;
@@ -174,10 +208,15 @@ extern void		papplSystemSetFooterHTML(pappl_system_t *system, const char *html)
 extern void		papplSystemSetGeoLocation(pappl_system_t *system, const char *value) _PAPPL_PUBLIC;
 extern void		papplSystemSetHostname(pappl_system_t *system, const char *value) _PAPPL_DEPRECATED("Use papplSystemSetHostName instead.");
 extern void		papplSystemSetHostName(pappl_system_t *system, const char *value) _PAPPL_PUBLIC;
+extern void		papplSystemSetListenerThreads(pappl_system_t *system, int num_threads) _PAPPL_PUBLIC;
 extern void		papplSystemSetLocation(pappl_system_t *system, const char *value) _PAPPL_PUBLIC;
 extern void		papplSystemSetLogLevel(pappl_system_t *system, pappl_loglevel_t loglevel) _PAPPL_PUBLIC;
+extern void		papplSystemSetMaxClientQueue(pappl_system_t *system, int max_queue) _PAPPL_PUBLIC;
 extern void		papplSystemSetMaxClients(pappl_system_t *system, int max_clients) _PAPPL_PUBLIC;
+extern void		papplSystemSetMaxClientWorkers(pappl_system_t *system, int max_workers) _PAPPL_PUBLIC;
+extern void		papplSystemSetMaxJobWorkers(pappl_system_t *system, int max_workers) _PAPPL_PUBLIC;
 extern void		papplSystemSetMaxLogSize(pappl_system_t *system, size_t max_size) _PAPPL_PUBLIC;
+extern void		papplSystemSetMaxRenderWorkers(pappl_system_t *system, int max_workers) _PAPPL_PUBLIC;
 extern void		papplSystemSetMaxSubscriptions(pappl_system_t *system, size_t max_subscriptions) _PAPPL_PUBLIC;
 extern void		papplSystemSetMIMECallback(pappl_system_t *system, pappl_mime_cb_t cb, void *data) _PAPPL_PUBLIC;
 extern void		papplSystemSetNextPrinterID(pappl_system_t *system, int next_printer_id) _PAPPL_PUBLIC;
@@ -32,7 +32,7 @@ void
 _papplCopyAttributes(
     ipp_t        *to,			// I - Destination request
     ipp_t        *from,			// I - Source request
-    cups_array_t *ra,			// I - Requested attributes
+    _pappl_ra_t  *ra,			// I - Requested attributes
     ipp_tag_t    group_tag,		// I - Group to copy
     int          quickcopy)		// I - Do a quick copy?
 {
@@ -80,6 +80,157 @@ papplCopyString(char       *dst,	// I - Destination buffer
 }
 
 
+//
+// '_papplCreateRequestedAttrs()' - Compile the requested attributes.
+//
+// This function takes ownership of the "names" array from
+// `ippCreateRequestedArray` and looks up each name once, so that the copy
+// functions can use the `_PAPPL_REQUESTED` macro to test the attributes they
+// generate.  `NULL` is returned when all attributes are requested.
+//
+
+_pappl_ra_t *				// O - Requested attributes or `NULL` for all
+_papplCreateRequestedAttrs(
+    cups_array_t *names)		// I - Requested attribute names or `NULL` for all
+{
+  _pappl_ra_t	*ra;			// Requested attributes
+  const char	*name;			// Current name
+  int		left,			// Left side of search
+		right,			// Right side of search
+		current,		// Current element
+		result;			// Result of comparison
+  static const char * const ra_names[_PAPPL_RA_MAX] =
+  {					// Attribute names for _pappl_rattr_t
+    "copies-supported",
+    "date-time-at-completed",
+    "date-time-at-creation",
+    "date-time-at-processing",
+    "identify-actions-default",
+    "job-impressions",
+    "job-impressions-completed",
+    "job-printer-up-time",
+    "job-state",
+    "job-state-message",
+    "job-state-reasons",
+    "label-mode-configured",
+    "label-tear-offset-configured",
+    "marker-colors",
+    "marker-high-levels",
+    "marker-levels",
+    "marker-low-levels",
+    "marker-names",
+    "marker-types",
+    "media-col-default",
+    "media-col-ready",
+    "media-default",
+    "media-ready",
+    "multiple-document-handling-default",
+    "orientation-requested-default",
+    "output-bin-default",
+    "print-color-mode-default",
+    "print-content-optimize-default",
+    "print-quality-default",
+    "print-scaling-default",
+    "printer-config-change-date-time",
+    "printer-config-change-time",
+    "printer-contact-col",
+    "printer-current-time",
+    "printer-darkness-configured",
+    "printer-dns-sd-name",
+    "printer-firmware-name",
+    "printer-firmware-patches",
+    "printer-firmware-string-version",
+    "printer-firmware-version",
+    "printer-geo-location",
+    "printer-icons",
+    "printer-impressions-completed",
+    "printer-input-tray",
+    "printer-is-accepting-jobs",
+    "printer-location",
+    "printer-more-info",
+    "printer-organization",
+    "printer-organizational-unit",
+    "printer-resolution-default",
+    "printer-speed-default",
+    "printer-state",
+    "printer-state-change-date-time",
+    "printer-state-change-time",
+    "printer-state-message",
+    "printer-state-reasons",
+    "printer-strings-languages-supported",
+    "printer-strings-uri",
+    "printer-supply",
+    "printer-supply-description",
+    "printer-supply-info-uri",
+    "printer-up-time",
+    "printer-uri-supported",
+    "printer-wifi-ssid",
+    "printer-wifi-state",
+    "printer-xri-supported",
+    "queued-job-count",
+    "sides-default",
+    "system-config-change-date-time",
+    "system-config-change-time",
+    "system-configured-printers",
+    "system-contact-col",
+    "system-current-time",
+    "system-default-printer-id",
+    "system-firmware-name",
+    "system-firmware-patches",
+    "system-firmware-string-version",
+    "system-firmware-version",
+    "system-geo-location",
+    "system-location",
+    "system-name",
+    "system-organization",
+    "system-organizational-unit",
+    "system-state",
+    "system-state-change-date-time",
+    "system-state-change-time",
+    "system-state-reasons",
+    "system-up-time",
+    "system-uuid",
+    "system-xri-supported",
+    "time-at-completed",
+    "time-at-creation",
+    "time-at-processing",
+    "uri-authentication-supported",
+  };
+
+
+  if (!names)
+    return (NULL);
+
+  if ((ra = (_pappl_ra_t *)calloc(1, sizeof(_pappl_ra_t))) == NULL)
+  {
+    cupsArrayDelete(names);
+    return (NULL);
+  }
+
+  ra->names = names;
+
+  for (name = (const char *)cupsArrayGetFirst(names); name; name = (const char *)cupsArrayGetNext(names))
+  {
+    for (left = 0, right = _PAPPL_RA_MAX - 1; left <= right;)
+    {
+      current = (left + right) / 2;
+
+      if ((result = strcmp(name, ra_names[current])) == 0)
+      {
+        ra->bits[current / 8] |= (unsigned char)(1 << (current & 7));
+        break;
+      }
+      else if (result < 0)
+        right = current - 1;
+      else
+        left = current + 1;
+    }
+  }
+
+  return (ra);
+}
+
+
 //
 // 'papplCreateTempFile()' - Create a temporary file.
 //
@@ -148,6 +299,52 @@ papplCreateTempFile(
 }
 
 
+//
+// '_papplDeleteRequestedAttrs()' - Free compiled requested attributes.
+//
+
+void
+_papplDeleteRequestedAttrs(
+    _pappl_ra_t *ra)			// I - Requested attributes
+{
+  if (ra)
+  {
+    cupsArrayDelete(ra->names);
+    free(ra);
+  }
+}
+
+
+//
+// '_papplGetNumCPUs()' - Return the number of online processor cores.
+//
+
+int					// O - Number of processor cores
+_papplGetNumCPUs(void)
+{
+  static int	num_cpus = 0;		// Cached number of cores
+
+
+  if (num_cpus <= 0)
+  {
+#if _WIN32
+    SYSTEM_INFO	info;			// System information
+
+    GetSystemInfo(&info);
+    num_cpus = (int)info.dwNumberOfProcessors;
+
+#else
+    num_cpus = (int)sysconf(_SC_NPROCESSORS_ONLN);
+#endif // _WIN32
+
+    if (num_cpus < 1)
+      num_cpus = 1;
+  }
+
+  return (num_cpus);
+}
+
+
 //
 // 'papplGetRand()' - Return a 32-bit pseudo-random number.
 //
@@ -365,8 +562,8 @@ filter_cb(_pappl_ipp_filter_t *filter,	// I - Filter parameters
   ipp_tag_t group = ippGetGroupTag(attr);
   const char *name = ippGetName(attr);
 
-  if ((filter->group_tag != IPP_TAG_ZERO && group != filter->group_tag && group != IPP_TAG_ZERO) || !name || (!strcmp(name, "media-col-database") && !cupsArrayFind(filter->ra, (void *)name)))
+  if ((filter->group_tag != IPP_TAG_ZERO && group != filter->group_tag && group != IPP_TAG_ZERO) || !name || (!strcmp(name, "media-col-database") && (!filter->ra || !cupsArrayFind(filter->ra->names, (void *)name))))
     return (0);
 
-  return (!filter->ra || cupsArrayFind(filter->ra, (void *)name) != NULL);
+  return (!filter->ra || cupsArrayFind(filter->ra->names, (void *)name) != NULL);
 }
@@ -37,9 +37,15 @@
 //   all                  All of the following tests
 //   api                  API tests
 //   client               Simulated client tests
+//   dither               Dither kernel tests
 //   jpeg                 JPEG image tests
+//   max-jobs             Concurrent job processing tests
 //   png                  PNG image tests
 //   pwg-raster           PWG Raster tests
+//   render               Parallel image rendering benchmarks
+//   scale                Image scaler tests
+//   scheduler            Job scheduling tests
+//   streaming            Streaming filter tests
 //
 
 //
@@ -47,11 +53,22 @@
 //
 
 #include <pappl/system-private.h>
+#include <pappl/job-private.h>	// _papplJobDitherLine and the image scaler
 #include <cups/dir.h>
 #include "testpappl.h"
 #include "test.h"
 #include <stdlib.h>
 #include <limits.h>
+#include <math.h>
+#ifdef HAVE_LIBJPEG
+#  include <jpeglib.h>
+#endif // HAVE_LIBJPEG
+#ifdef HAVE_LIBPNG
+#  include <png.h>
+#endif // HAVE_LIBPNG
+#if !_WIN32
+#  include <sys/resource.h>
+#endif // !_WIN32
 
 #if _WIN32
 #  define PATH_MAX	    MAX_PATH
@@ -125,6 +142,21 @@ static inline unsigned testrand(void)
 static bool		all_tests_done = false;
 static size_t		event_count = 0;
 static pappl_event_t	event_mask = PAPPL_EVENT_NONE;
+static pthread_mutex_t	hold_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t	hold_cond = PTHREAD_COND_INITIALIZER;
+static int		hold_running = 0,
+			hold_max = 0;
+static bool		hold_release = false;
+static pthread_mutex_t	sched_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pappl_printer_t	*sched_printer = NULL;
+static int		sched_jobs[6];
+static size_t		sched_count = 0;
+static pthread_mutex_t	stream_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t	stream_cond = PTHREAD_COND_INITIALIZER;
+static int		stream_job_id = 0;
+static size_t		stream_bytes = 0;
+static bool		stream_done = false,
+			stream_error = false;
 
 
 //
@@ -139,6 +171,13 @@ typedef struct _pappl_testdata_s	// Test data
   bool			waitsystem;	// Wait for system to start?
 } _pappl_testdata_t;
 
+typedef struct _pappl_testimage_s	// Image scaler test data
+{
+  const unsigned char	*pixels;	// Image pixels
+  int			width,		// Width in columns
+			depth;		// Bytes per pixel
+} _pappl_testimage_t;
+
 typedef struct _pappl_testprinter_s	// Printer test data
 {
   bool			pass;		// Pass/fail
@@ -151,20 +190,50 @@ typedef struct _pappl_testprinter_s	// Printer test data
 //
 
 static http_t	*connect_to_printer(pappl_system_t *system, bool remote, char *uri, size_t urisize);
+#if defined(HAVE_LIBJPEG) || defined(HAVE_LIBPNG)
+static const char *copy_print_file(const char *file, char *tempname, size_t tempsize);
+#endif // HAVE_LIBJPEG || HAVE_LIBPNG
 static void	device_error_cb(const char *message, void *err_data);
 static bool	device_list_cb(const char *device_info, const char *device_uri, const char *device_id, void *data);
 static int	do_ps_query(const char *device_uri);
 static void	event_cb(pappl_system_t *system, pappl_printer_t *printer, pappl_job_t *job, pappl_event_t event, void *data);
+static int	get_thread_count(void);
+static long	get_write_count(void);
 static const char *make_raster_file(ipp_t *response, bool grayscale, char *tempname, size_t tempsize);
 static void	*run_tests(_pappl_testdata_t *testdata);
 static bool	test_api(pappl_system_t *system);
 static bool	test_api_printer(pappl_printer_t *printer);
 static bool	test_api_printer_cb(pappl_printer_t *printer, _pappl_testprinter_t *tp);
 static bool	test_client(pappl_system_t *system);
+static bool	test_connections(pappl_system_t *system);
+static bool	test_dither(void);
+static void	test_dither_line(pappl_pr_options_t *options, unsigned y, const unsigned char *pixels, bool black, unsigned char *line, unsigned xstart, unsigned xend);
+static bool	test_find_printer(pappl_system_t *system);
+static bool	test_get_jobs(pappl_system_t *system);
 #if defined(HAVE_LIBJPEG) || defined(HAVE_LIBPNG)
+static bool	test_image_copies(pappl_system_t *system, const char *prompt, const char *format, const char *file, int num_copies);
 static bool	test_image_files(pappl_system_t *system, const char *prompt, const char *format, int num_files, const char * const *files);
+static bool	test_image_memory(pappl_system_t *system, const char *prompt, const char *format);
 #endif // HAVE_LIBJPEG || HAVE_LIBPNG
+static bool	test_max_jobs(pappl_system_t *system);
+static bool	test_max_jobs_cb(pappl_job_t *job, pappl_device_t *device, void *data);
+static bool	test_offline(pappl_system_t *system);
 static bool	test_pwg_raster(pappl_system_t *system);
+static bool	test_pwg_raster_pages(pappl_system_t *system, unsigned num_pages);
+static bool	test_raster_metrics(pappl_system_t *system, const char *prompt, pappl_jmetrics_t *start);
+#ifdef HAVE_LIBJPEG
+static bool	test_render(pappl_system_t *system);
+#endif // HAVE_LIBJPEG
+static bool	test_scale(void);
+static const unsigned char *test_scale_cb(_pappl_testimage_t *image, int row);
+static unsigned char *test_scale_image(const unsigned char *pixels, int width, int height, int depth, int out_width, int out_height, _pappl_resample_t filter);
+static void	test_scale_nearest(const unsigned char *pixels, int width, int height, int depth, unsigned char *line, int out_width, int out_height);
+static int	test_scale_taps(_pappl_resample_t filter, int in_size, int out_size, int i, double *weights, int *first);
+static bool	test_scheduler(pappl_system_t *system);
+static bool	test_streaming(pappl_system_t *system);
+static bool	test_streaming_cb(pappl_job_t *job, pappl_device_t *device, void *data);
+static bool	test_streaming_wait(size_t bytes, bool done);
+static bool	test_webif(pappl_system_t *system);
 static bool	test_wifi_join_cb(pappl_system_t *system, void *data, const char *ssid, const char *psk);
 static int	test_wifi_list_cb(pappl_system_t *system, void *data, cups_dest_t **ssids);
 static pappl_wifi_t *test_wifi_status_cb(pappl_system_t *system, void *data, pappl_wifi_t *wifi_data);
@@ -467,6 +536,9 @@ main(int  argc,				// I - Number of command-line arguments
 	      }
 	      auth = argv[i];
               break;
+          case 'B' : // -B (buffer web interface output)
+              soptions |= PAPPL_SOPTIONS_WEB_BUFFER;
+              break;
           case 'c' : // -c (clean run)
               clean = true;
               break;
@@ -562,9 +634,20 @@ main(int  argc,				// I - Number of command-line arguments
 	        // Add all tests
 		cupsArrayAdd(testdata.names, "api");
 		cupsArrayAdd(testdata.names, "client");
+		cupsArrayAdd(testdata.names, "connections");
+		cupsArrayAdd(testdata.names, "dither");
+		cupsArrayAdd(testdata.names, "find-printer");
+		cupsArrayAdd(testdata.names, "get-jobs");
 		cupsArrayAdd(testdata.names, "jpeg");
+		cupsArrayAdd(testdata.names, "max-jobs");
+		cupsArrayAdd(testdata.names, "offline");
 		cupsArrayAdd(testdata.names, "png");
 		cupsArrayAdd(testdata.names, "pwg-raster");
+		cupsArrayAdd(testdata.names, "render");
+		cupsArrayAdd(testdata.names, "scale");
+		cupsArrayAdd(testdata.names, "scheduler");
+		cupsArrayAdd(testdata.names, "streaming");
+		cupsArrayAdd(testdata.names, "webif");
 	      }
 	      else if (strchr(argv[i], ','))
 	      {
@@ -617,9 +700,13 @@ main(int  argc,				// I - Number of command-line arguments
 
   // Initialize the system and any printers...
   system = papplSystemCreate(soptions, name ? name : "Test System", port, "_print,_universal", spool, log, level, auth, tls_only);
+  if (port)
+    papplSystemSetListenerThreads(system, 2);	// Load-balanced listeners need a fixed port
   papplSystemAddListeners(system, NULL);
   papplSystemSetEventCallback(system, event_cb, (void *)"testpappl");
   papplSystemSetPrinterDrivers(system, (int)(sizeof(pwg_drivers) / sizeof(pwg_drivers[0])), pwg_drivers, pwg_autoadd, /* create_cb */NULL, pwg_callback, "testpappl");
+  papplSystemAddMIMEFilter(system, "application/vnd.pappl-hold", "image/pwg-raster", test_max_jobs_cb, NULL);
+  papplSystemAddStreamingMIMEFilter(system, "application/vnd.pappl-stream", "image/pwg-raster", test_streaming_cb, NULL);
   papplSystemSetWiFiCallbacks(system, test_wifi_join_cb, test_wifi_list_cb, test_wifi_status_cb, (void *)"testpappl");
   papplSystemAddLink(system, "Configuration", "/config", true);
   papplSystemSetFooterHTML(system,
@@ -771,6 +858,65 @@ connect_to_printer(
 }
 
 
+#if defined(HAVE_LIBJPEG) || defined(HAVE_LIBPNG)
+//
+// 'copy_print_file()' - Copy a file to a temporary print file.
+//
+// The file is looked up in the current directory and then in the "testsuite"
+// directory.  Errors are reported with `testEndMessage`.
+//
+
+static const char *			// O - Print filename or `NULL` on error
+copy_print_file(const char *file,	// I - File to copy
+                char       *tempname,	// I - Temporary filename buffer
+                size_t     tempsize)	// I - Size of temp file buffer
+{
+  int		srcfd,			// Source file
+		fd;			// Print file
+  ssize_t	bytes;			// Bytes read
+  char		buffer[8192];		// Copy buffer
+
+
+  if ((srcfd = open(file, O_RDONLY | O_BINARY)) < 0)
+  {
+    snprintf(buffer, sizeof(buffer), "testsuite/%s", file);
+    srcfd = open(buffer, O_RDONLY | O_BINARY);
+  }
+
+  if (srcfd < 0)
+  {
+    testEndMessage(false, "unable to open '%s': %s", file, strerror(errno));
+    return (NULL);
+  }
+
+  if ((fd = cupsTempFd(tempname, (cups_len_t)tempsize)) < 0)
+  {
+    testEndMessage(false, "unable to create temporary print file: %s", strerror(errno));
+    close(srcfd);
+    return (NULL);
+  }
+
+  while ((bytes = read(srcfd, buffer, sizeof(buffer))) > 0)
+  {
+    if (write(fd, buffer, (size_t)bytes) != bytes)
+      break;			// Short write or write error
+  }
+
+  close(srcfd);
+
+  if (close(fd) || bytes != 0)
+  {
+    testEndMessage(false, "unable to copy '%s' to '%s': %s", file, tempname, strerror(errno));
+    unlink(tempname);
+    *tempname = '\0';
+    return (NULL);
+  }
+
+  return (tempname);
+}
+#endif // HAVE_LIBJPEG || HAVE_LIBPNG
+
+
 //
 // 'device_error_cb()' - Show a device error message.
 //
@@ -875,6 +1021,87 @@ event_cb(pappl_system_t  *system,	// I - System
 
   event_count ++;
   event_mask |= event;
+
+  if (event == PAPPL_EVENT_JOB_STATE_CHANGED)
+  {
+    // Record the order in which jobs are started for the scheduler test...
+    size_t	i;			// Looping var
+    int		job_id = papplJobGetID(job);
+					// Job ID
+
+    pthread_mutex_lock(&sched_mutex);
+
+    if (sched_printer && printer == sched_printer)
+    {
+      for (i = 0; i < sched_count; i ++)
+      {
+        if (sched_jobs[i] == job_id)
+          break;
+      }
+
+      if (i >= sched_count && sched_count < (sizeof(sched_jobs) / sizeof(sched_jobs[0])))
+        sched_jobs[sched_count ++] = job_id;
+    }
+
+    pthread_mutex_unlock(&sched_mutex);
+  }
+}
+
+
+//
+// 'get_thread_count()' - Get the number of threads in this process.
+//
+
+static int				// O - Number of threads or `-1` if unknown
+get_thread_count(void)
+{
+  int		count = 0;		// Number of threads
+  cups_dir_t	*dir;			// Task directory
+  cups_dentry_t	*dent;			// Task entry
+
+
+  // Linux provides a directory entry for every thread...
+  if ((dir = cupsDirOpen("/proc/self/task")) == NULL)
+    return (-1);
+
+  while ((dent = cupsDirRead(dir)) != NULL)
+    count ++;
+
+  cupsDirClose(dir);
+
+  return (count);
+}
+
+
+//
+// 'get_write_count()' - Get the number of write system calls made by this
+//                       process.
+//
+
+static long				// O - Number of write calls or `-1` if unknown
+get_write_count(void)
+{
+  cups_file_t	*fp;			// I/O statistics file
+  char		line[256];		// Line from file
+  long		count = -1;		// Number of write calls
+
+
+  // Linux provides I/O statistics for every process...
+  if ((fp = cupsFileOpen("/proc/self/io", "r")) == NULL)
+    return (-1);
+
+  while (cupsFileGets(fp, line, sizeof(line)))
+  {
+    if (!strncmp(line, "syscw:", 6))
+    {
+      count = strtol(line + 6, NULL, 10);
+      break;
+    }
+  }
+
+  cupsFileClose(fp);
+
+  return (count);
 }
 
 
@@ -1178,18 +1405,52 @@ run_tests(_pappl_testdata_t *testdata)	// I - Testing data
       if (!test_client(testdata->system))
         ret = (void *)1;
     }
+    else if (!strcmp(name, "connections"))
+    {
+      if (!test_connections(testdata->system))
+        ret = (void *)1;
+    }
+    else if (!strcmp(name, "dither"))
+    {
+      if (!test_dither())
+        ret = (void *)1;
+    }
+    else if (!strcmp(name, "find-printer"))
+    {
+      if (!test_find_printer(testdata->system))
+        ret = (void *)1;
+    }
+    else if (!strcmp(name, "get-jobs"))
+    {
+      if (!test_get_jobs(testdata->system))
+        ret = (void *)1;
+    }
 #ifdef HAVE_LIBJPEG
     else if (!strcmp(name, "jpeg"))
     {
       if (!test_image_files(testdata->system, "jpeg", "image/jpeg", (int)(sizeof(jpeg_files) / sizeof(jpeg_files[0])), jpeg_files))
         ret = (void *)1;
+      else if (!test_image_memory(testdata->system, "jpeg", "image/jpeg"))
+        ret = (void *)1;
     }
 #endif // HAVE_LIBJPEG
+    else if (!strcmp(name, "max-jobs"))
+    {
+      if (!test_max_jobs(testdata->system))
+        ret = (void *)1;
+    }
+    else if (!strcmp(name, "offline"))
+    {
+      if (!test_offline(testdata->system))
+        ret = (void *)1;
+    }
 #ifdef HAVE_LIBPNG
     else if (!strcmp(name, "png"))
     {
       if (!test_image_files(testdata->system, "png", "image/png", (int)(sizeof(png_files) / sizeof(png_files[0])), png_files))
         ret = (void *)1;
+      else if (!test_image_memory(testdata->system, "png", "image/png"))
+        ret = (void *)1;
     }
 #endif // HAVE_LIBPNG
     else if (!strcmp(name, "pwg-raster"))
@@ -1197,6 +1458,33 @@ run_tests(_pappl_testdata_t *testdata)	// I - Testing data
       if (!test_pwg_raster(testdata->system))
         ret = (void *)1;
     }
+#ifdef HAVE_LIBJPEG
+    else if (!strcmp(name, "render"))
+    {
+      if (!test_render(testdata->system))
+        ret = (void *)1;
+    }
+#endif // HAVE_LIBJPEG
+    else if (!strcmp(name, "scale"))
+    {
+      if (!test_scale())
+        ret = (void *)1;
+    }
+    else if (!strcmp(name, "scheduler"))
+    {
+      if (!test_scheduler(testdata->system))
+        ret = (void *)1;
+    }
+    else if (!strcmp(name, "streaming"))
+    {
+      if (!test_streaming(testdata->system))
+        ret = (void *)1;
+    }
+    else if (!strcmp(name, "webif"))
+    {
+      if (!test_webif(testdata->system))
+        ret = (void *)1;
+    }
     else
     {
       testBegin("%s", name);
@@ -1326,6 +1614,9 @@ test_api(pappl_system_t *system)	// I - System
   pappl_printer_t	*printer;	// Current printer
   pappl_loc_t		*loc;		// Current localization
   _pappl_testprinter_t	pdata;		// Printer test data
+  pappl_job_t		job;		// Job for buffer tests
+  void			*buffer,	// Buffer
+			*buffer2;	// Second buffer
   const char		*key = "A printer with that name already exists.",
 					// Key string
 			*text;		// Localized text
@@ -2193,6 +2484,81 @@ test_api(pappl_system_t *system)	// I - System
   else
     testEnd(true);
 
+  // papplJobGetBuffer/ReleaseBuffer
+  memset(&job, 0, sizeof(job));
+  job.bufpool = _papplBufPoolCreate();
+
+  testBegin("api: papplJobGetBuffer(1000)");
+  if ((buffer = papplJobGetBuffer(&job, 1000)) == NULL)
+  {
+    testEndMessage(false, "got NULL");
+    pass = false;
+  }
+  else if ((size_t)buffer & 63)
+  {
+    testEndMessage(false, "buffer %p is not aligned to 64 bytes", buffer);
+    pass = false;
+  }
+  else
+  {
+    memset(buffer, 0xff, 1000);
+    testEnd(true);
+  }
+
+  testBegin("api: papplJobGetBuffer(1000) while in use");
+  if ((buffer2 = papplJobGetBuffer(&job, 1000)) == NULL)
+  {
+    testEndMessage(false, "got NULL");
+    pass = false;
+  }
+  else if (buffer2 == buffer)
+  {
+    testEndMessage(false, "got the same buffer");
+    pass = false;
+  }
+  else
+    testEnd(true);
+
+  testBegin("api: papplJobReleaseBuffer");
+  papplJobReleaseBuffer(&job, buffer2);
+  papplJobReleaseBuffer(&job, buffer);
+  testEnd(true);
+
+  testBegin("api: papplJobGetBuffer(1000) reuse");
+  if ((buffer2 = papplJobGetBuffer(&job, 1000)) == NULL)
+  {
+    testEndMessage(false, "got NULL");
+    pass = false;
+  }
+  else if (buffer2 != buffer)
+  {
+    testEndMessage(false, "got %p, expected %p", buffer2, buffer);
+    pass = false;
+  }
+  else
+    testEnd(true);
+
+  papplJobReleaseBuffer(&job, buffer2);
+
+  _papplBufPoolDelete(job.bufpool);
+  job.bufpool = NULL;
+
+  testBegin("api: papplJobGetBuffer(1000) without pool");
+  if ((buffer = papplJobGetBuffer(&job, 1000)) == NULL)
+  {
+    testEndMessage(false, "got NULL");
+    pass = false;
+  }
+  else if ((size_t)buffer & 63)
+  {
+    testEndMessage(false, "buffer %p is not aligned to 64 bytes", buffer);
+    pass = false;
+  }
+  else
+    testEnd(true);
+
+  papplJobReleaseBuffer(&job, buffer);
+
   return (pass);
 }
 
@@ -2327,6 +2693,37 @@ test_api_printer(
   else
     testEnd(true);
 
+  // papplPrinterGet/SetDeviceLinger
+  testBegin("api: papplPrinterGetDeviceLinger");
+  if ((get_int = papplPrinterGetDeviceLinger(printer)) != 0)
+  {
+    testEndMessage(false, "got %d, expected 0", get_int);
+    pass = false;
+  }
+  else
+    testEnd(true);
+
+  set_int = (TESTRAND % 60) + 1;
+  testBegin("api: papplPrinterSetDeviceLinger(%d)", set_int);
+  papplPrinterSetDeviceLinger(printer, set_int);
+  if ((get_int = papplPrinterGetDeviceLinger(printer)) != set_int)
+  {
+    testEndMessage(false, "got %d, expected %d", get_int, set_int);
+    pass = false;
+  }
+  else
+    testEnd(true);
+
+  testBegin("api: papplPrinterSetDeviceLinger(0)");
+  papplPrinterSetDeviceLinger(printer, 0);
+  if ((get_int = papplPrinterGetDeviceLinger(printer)) != 0)
+  {
+    testEndMessage(false, "got %d, expected 0", get_int);
+    pass = false;
+  }
+  else
+    testEnd(true);
+
   // papplPrinterGet/SetDNSSDName
   testBegin("api: papplPrinterGetDNSSDName");
   if (!papplPrinterGetDNSSDName(printer, get_str, sizeof(get_str)))
@@ -2467,6 +2864,39 @@ test_api_printer(
   else
     testEnd(true);
 
+  // papplPrinterGet/SetMaxProcessingJobs
+  testBegin("api: papplPrinterGetMaxProcessingJobs");
+  if ((get_int = papplPrinterGetMaxProcessingJobs(printer)) != 1)
+  {
+    testEndMessage(false, "got %d, expected 1", get_int);
+    pass = false;
+  }
+  else
+    testEnd(true);
+
+  set_int = (TESTRAND % 8) + 2;
+  testBegin("api: papplPrinterSetMaxProcessingJobs(%d)", set_int);
+  papplPrinterSetMaxProcessingJobs(printer, set_int);
+  if ((get_int = papplPrinterGetMaxProcessingJobs(printer)) != set_int)
+  {
+    testEndMessage(false, "got %d, expected %d", get_int, set_int);
+    pass = false;
+  }
+  else
+    testEnd(true);
+
+  testBegin("api: papplPrinterSetMaxProcessingJobs(0)");
+  papplPrinterSetMaxProcessingJobs(printer, 0);
+  if ((get_int = papplPrinterGetMaxProcessingJobs(printer)) != set_int)
+  {
+    testEndMessage(false, "got %d, expected %d", get_int, set_int);
+    pass = false;
+  }
+  else
+    testEnd(true);
+
+  papplPrinterSetMaxProcessingJobs(printer, 1);
+
   // papplPrinterGet/SetNextJobID
   testBegin("api: papplPrinterGetNextJobID");
   if ((get_int = papplPrinterGetNextJobID(printer)) != 1)
@@ -2613,7 +3043,9 @@ test_client(pappl_system_t *system)	// I - System
   bool		ret = false;		// Return value
   http_t	*http;			// HTTP connection
   char		uri[1024],		// "printer-uri" value
-		filename[1024] = "";	// Print file
+		filename[1024] = "",	// Print file
+		location[256];		// Saved printer location
+  pappl_printer_t *printer;		// Printer
   ipp_t		*request,		// Request
 		*response,		// Response
 		*supported = NULL;	// Supported values
@@ -2794,6 +3226,48 @@ test_client(pappl_system_t *system)	// I - System
     testEnd(true);
   }
 
+  // Test that cached printer attributes are updated...
+  testBegin("client: Get-Printer-Attributes=/ipp/print (updated)");
+
+  if ((printer = papplSystemFindPrinter(system, "/ipp/print", 0, NULL)) == NULL)
+  {
+    testEndMessage(false, "Unable to find printer");
+    goto done;
+  }
+
+  papplPrinterGetLocation(printer, location, sizeof(location));
+  papplPrinterSetLocation(printer, "Updated Location");
+
+  for (i = 0; i < 2; i ++)
+  {
+    request = ippNewRequest(IPP_OP_GET_PRINTER_ATTRIBUTES);
+    ippAddString(request, IPP_TAG_OPERATION, IPP_CONST_TAG(IPP_TAG_URI), "printer-uri", NULL, "ipp://localhost/ipp/print");
+    ippAddString(request, IPP_TAG_OPERATION, IPP_TAG_NAME, "requesting-user-name", NULL, cupsGetUser());
+    ippAddStrings(request, IPP_TAG_OPERATION, IPP_CONST_TAG(IPP_TAG_KEYWORD), "requested-attributes", (int)(sizeof(pattrs) / sizeof(pattrs[0])), NULL, pattrs);
+
+    response = cupsDoRequest(http, request, "/ipp/print");
+
+    if (cupsLastError() != IPP_STATUS_OK)
+    {
+      testEndMessage(false, "%s", cupsLastErrorString());
+      ippDelete(response);
+      papplPrinterSetLocation(printer, location);
+      goto done;
+    }
+    else if ((attr = ippFindAttribute(response, "printer-location", IPP_TAG_TEXT)) == NULL || strcmp(ippGetString(attr, 0, NULL), "Updated Location"))
+    {
+      testEndMessage(false, "Got printer-location='%s', expected 'Updated Location'", attr ? ippGetString(attr, 0, NULL) : "(null)");
+      ippDelete(response);
+      papplPrinterSetLocation(printer, location);
+      goto done;
+    }
+
+    ippDelete(response);
+  }
+
+  papplPrinterSetLocation(printer, location);
+  testEnd(true);
+
   // Create a system subscription for a variety of events...
   testBegin("client: Create-System-Subscriptions");
 
@@ -2987,177 +3461,2488 @@ test_client(pappl_system_t *system)	// I - System
 
 #if defined(HAVE_LIBJPEG) || defined(HAVE_LIBPNG)
 //
-// 'test_image_files()' - Run image file tests.
+// 'test_connections()' - Test scaling of idle client connections.
+//
+// Opens increasing numbers of keep-alive connections, sends a request on each,
+// and verifies that the number of threads in the process does not grow with
+// the number of connections.
 //
 
 static bool				// O - `true` on success, `false` on failure
-test_image_files(
-    pappl_system_t       *system,	// I - System
-    const char           *prompt,	// I - Prompt for files
-    const char           *format,	// I - MIME media type of files
-    int                  num_files,	// I - Number of files to print
-    const char * const * files)		// I - Files to print
+test_connections(
+    pappl_system_t *system)		// I - System
 {
-  int		i, j, k, m;		// Looping vars
-  http_t	*http;			// HTTP connection
-  char		uri[1024],		// "printer-uri" value
-		filename[1024],		// Print file
-		job_name[1024];		// "job_name" value
-  ipp_t		*request,		// Request
-		*response;		// Response
-  int		job_id;			// "job-id" value
+  bool		ret = false;		// Return value
+  http_t	*http[64];		// HTTP connections
+  int		i,			// Looping var
+		num_http = 0,		// Number of connections
+		max_http,		// Maximum connections for this pass
+		threads,		// Current number of threads
+		min_threads = -1,	// Minimum number of threads
+		max_threads = -1;	// Maximum number of threads
+  char		uri[1024];		// "printer-uri" value
+  ipp_t		*request,		// IPP request
+		*response;		// IPP response
+  pappl_cmetrics_t metrics;		// Client metrics
+
+
+  for (max_http = 16; max_http <= (int)(sizeof(http) / sizeof(http[0])); max_http *= 2)
+  {
+    // Open more connections...
+    testBegin("connections: Open %d connections", max_http);
+
+    for (; num_http < max_http; num_http ++)
+    {
+      if ((http[num_http] = connect_to_printer(system, false, uri, sizeof(uri))) == NULL)
+      {
+	testEndMessage(false, "%s", cupsLastErrorString());
+	goto done;
+      }
+    }
+
+    testEnd(true);
+
+    // Send a request on each connection and leave it open/idle...
+    testBegin("connections: Get-Printer-Attributes on %d connections", max_http);
+
+    for (i = 0; i < num_http; i ++)
+    {
+      request = ippNewRequest(IPP_OP_GET_PRINTER_ATTRIBUTES);
+      ippAddString(request, IPP_TAG_OPERATION, IPP_TAG_URI, "printer-uri", NULL, uri);
+      ippAddString(request, IPP_TAG_OPERATION, IPP_TAG_NAME, "requesting-user-name", NULL, cupsGetUser());
+      ippAddString(request, IPP_TAG_OPERATION, IPP_CONST_TAG(IPP_TAG_KEYWORD), "requested-attributes", NULL, "printer-state");
+
+      response = cupsDoRequest(http[i], request, "/ipp/print");
+      ippDelete(response);
+
+      if (cupsLastError() != IPP_STATUS_OK)
+      {
+	testEndMessage(false, "%s", cupsLastErrorString());
+	goto done;
+      }
+    }
+
+    testEnd(true);
+
+    // Count the threads in the process...
+    if ((threads = get_thread_count()) < 0)
+      continue;
+
+    if (min_threads < 0 || threads < min_threads)
+      min_threads = threads;
+    if (threads > max_threads)
+      max_threads = threads;
+
+    testMessage("connections: %d threads with %d connections.", threads, num_http);
+  }
+
+  testBegin("connections: Thread count");
+  if (min_threads < 0)
+  {
+    testEndMessage(true, "not supported");
+  }
+  else if ((max_threads - min_threads) > 2)
+  {
+    testEndMessage(false, "%d to %d threads", min_threads, max_threads);
+    goto done;
+  }
+  else
+  {
+    testEndMessage(true, "%d to %d threads", min_threads, max_threads);
+  }
+
+  // Check the client metrics...
+  testBegin("connections: papplSystemGetClientMetrics");
+  papplSystemGetClientMetrics(system, &metrics);
+  if (metrics.accepted < (size_t)num_http || metrics.served < (size_t)num_http)
+  {
+    testEndMessage(false, "got %lu accepted, %lu served, expected at least %d", (unsigned long)metrics.accepted, (unsigned long)metrics.served, num_http);
+    goto done;
+  }
+  else if (metrics.rejected > 0)
+  {
+    testEndMessage(false, "got %lu rejected, expected 0", (unsigned long)metrics.rejected);
+    goto done;
+  }
+  else
+  {
+    testEndMessage(true, "%lu accepted, %lu queued (%lu max), %lu served", (unsigned long)metrics.accepted, (unsigned long)metrics.queued, (unsigned long)metrics.max_queued, (unsigned long)metrics.served);
+  }
+
+  ret = true;
+
+  done:
+
+  for (i = 0; i < num_http; i ++)
+    httpClose(http[i]);
+
+  return (ret);
+}
+
+
+//
+// 'test_dither()' - Test the dither kernel against the scalar dither code.
+//
+
+static bool				// O - `true` on success, `false` on failure
+test_dither(void)
+{
+  bool			ret = false;	// Return value
+  pappl_pr_options_t	*options;	// Print options with dither array
+  unsigned char		*pixels = NULL,	// 8-bit pixels
+			*line = NULL,	// Output line from kernel
+			*expected = NULL;// Output line from scalar code
+  unsigned		i,		// Looping var
+			black,		// Black or luminance pixels?
+			xstart,		// First column
+			xend,		// Last column + 1
+			y,		// Current line
+			pass;		// Benchmark pass
+  size_t		bytes;		// Bytes per line
+  double		secs[2];	// Time for scalar code and kernel
+  struct timeval	start,		// Start time
+			end;		// End time
+  static const unsigned	widths[] = { 1, 7, 15, 16, 17, 31, 32, 33, 100, 5100 };
+					// Widths to test
+  static const unsigned	width = 5100,	// Width of 8.5in at 600dpi
+			height = 6600;	// Length of 11in at 600dpi
+
+
+  testBegin("dither: Allocate buffers");
+
+  bytes = (width + 64 + 7) / 8;
+
+  if ((options = calloc(1, sizeof(pappl_pr_options_t))) == NULL || (pixels = malloc(width + 64)) == NULL || (line = malloc(bytes)) == NULL || (expected = malloc(bytes)) == NULL)
+  {
+    testEndMessage(false, "%s", strerror(errno));
+    goto done;
+  }
+
+  // Use random thresholds and pixels, including 0 and 255...
+  for (y = 0; y < 16; y ++)
+  {
+    for (i = 0; i < 16; i ++)
+      options->dither[y][i] = (unsigned char)TESTRAND;
+  }
+
+  options->dither[0][0] = 0;
+  options->dither[0][1] = 255;
+
+  for (i = 0; i < (width + 64); i ++)
+    pixels[i] = (unsigned char)TESTRAND;
+
+  pixels[0] = 0;
+  pixels[1] = 255;
+
+  testEnd(true);
+
+  // Compare the output for all alignments and widths...
+  testBegin("dither: _papplJobDitherLine");
+
+  for (black = 0; black < 2; black ++)
+  {
+    for (xstart = 0; xstart < 40; xstart ++)
+    {
+      for (i = 0; i < (unsigned)(sizeof(widths) / sizeof(widths[0])); i ++)
+      {
+        xend = xstart + widths[i];
+
+        for (y = 0; y < 16; y ++)
+        {
+          memset(line, 0xaa, bytes);
+          memset(expected, 0xaa, bytes);
+
+          _papplJobDitherLine(options, y, pixels, black != 0, line, xstart, xend);
+          test_dither_line(options, y, pixels, black != 0, expected, xstart, xend);
+
+          if (memcmp(line, expected, bytes))
+          {
+            testEndMessage(false, "different output for black=%u, xstart=%u, xend=%u, y=%u", black, xstart, xend, y);
+            goto done;
+          }
+        }
+      }
+    }
+  }
+
+  testEnd(true);
+
+  // Benchmark a letter page at 600dpi...
+  testBegin("dither: %ux%u page", width, height);
+
+  for (pass = 0; pass < 2; pass ++)
+  {
+    gettimeofday(&start, NULL);
+
+    for (y = 0; y < height; y ++)
+    {
+      if (pass)
+        _papplJobDitherLine(options, y, pixels, false, line, 0, width);
+      else
+        test_dither_line(options, y, pixels, false, line, 0, width);
+    }
+
+    gettimeofday(&end, NULL);
+
+    secs[pass] = (end.tv_sec - start.tv_sec) + 0.000001 * (end.tv_usec - start.tv_usec);
+  }
+
+  testEndMessage(true, "%.1fms scalar, %.1fms kernel, %.1fx", 1000.0 * secs[0], 1000.0 * secs[1], secs[1] > 0.0 ? secs[0] / secs[1] : 0.0);
+
+  ret = true;
+
+  done:
+
+  free(options);
+  free(pixels);
+  free(line);
+  free(expected);
+
+  return (ret);
+}
+
+
+//
+// 'test_dither_line()' - Dither a line one pixel at a time.
+//
+// This is the scalar dither code used by PAPPL 1.2 and earlier.
+//
+
+static void
+test_dither_line(
+    pappl_pr_options_t  *options,	// I - Print options
+    unsigned            y,		// I - Line number
+    const unsigned char *pixels,	// I - 8-bit pixels, starting at column "xstart"
+    bool                black,		// I - `true` for black (K) pixels, `false` for luminance
+    unsigned char       *line,		// I - 1-bit line
+    unsigned            xstart,		// I - First column
+    unsigned            xend)		// I - Last column + 1
+{
+  const unsigned char	*dither = options->dither[y & 15];
+					// Dither line
+  unsigned		x;		// Current column
+  unsigned char		*lineptr,	// Pointer in line
+			byte,		// Byte in line
+			bit;		// Current bit
+
+
+  for (x = xstart, lineptr = line + x / 8, bit = 128 >> (x & 7), byte = 0; x < xend; x ++, pixels ++)
+  {
+    if (black ? *pixels > dither[x & 15] : *pixels <= dither[x & 15])
+      byte |= bit;
+
+    if (bit == 1)
+    {
+      *lineptr++ = byte;
+      byte       = 0;
+      bit        = 128;
+    }
+    else
+      bit /= 2;
+  }
+
+  if (bit < 128)
+    *lineptr = byte;
+}
+
+
+//
+// 'test_find_printer()' - Benchmark printer lookups against the number of printers.
+//
+
+static bool				// O - `true` on success, `false` on failure
+test_find_printer(pappl_system_t *system)// I - System
+{
+  bool			ret = false;	// Return value
+  pappl_printer_t	*printers[200],	// Benchmark printers
+			*printer;	// Found printer
+  int			i,		// Looping var
+			num_printers = 0,// Number of printers
+			count;		// Lookup count
+  char			name[256],	// Printer name
+			device_uri[256],// Device URI
+			path[256],	// Printer web path
+			resource[1024];	// Printer IPP resource
+  struct timeval	start,		// Start time
+			end;		// End time
+  static const int	steps[] = { 10, 50, 200 };
+					// Number of printers for each benchmark
+
+
+  for (i = 0; i < (int)(sizeof(steps) / sizeof(steps[0])); i ++)
+  {
+    // Add printers as needed...
+    testBegin("find-printer: papplPrinterCreate x %d", steps[i] - num_printers);
+
+    while (num_printers < steps[i])
+    {
+      snprintf(name, sizeof(name), "Lookup Printer %d", num_printers + 1);
+      snprintf(device_uri, sizeof(device_uri), "file:///dev/null?printer=%d", num_printers + 1);
+
+      if ((printers[num_printers] = papplPrinterCreate(system, 0, name, "pwg_common-300dpi-black_1", "MFG:PWG;MDL:Test Printer;", device_uri)) == NULL)
+      {
+        testEndMessage(false, "%s", strerror(errno));
+        goto done;
+      }
+
+      num_printers ++;
+    }
+
+    testEnd(true);
+
+    // Time lookups of each kind...
+    testBegin("find-printer: %d printers", num_printers);
+
+    gettimeofday(&start, NULL);
+
+    for (count = 0; count < 10000; count ++)
+    {
+      pappl_printer_t *p = printers[count % num_printers];
+					// Printer to look up
+
+      papplPrinterGetPath(p, NULL, path, sizeof(path));
+      snprintf(resource, sizeof(resource), "/ipp/print%s/%d", path, count);
+
+      if ((printer = papplSystemFindPrinter(system, resource, 0, NULL)) != p)
+      {
+        testEndMessage(false, "resource lookup of '%s' returned %p, expected %p", resource, (void *)printer, (void *)p);
+        goto done;
+      }
+
+      if ((printer = papplSystemFindPrinter(system, NULL, papplPrinterGetID(p), NULL)) != p)
+      {
+        testEndMessage(false, "printer-id lookup of %d returned %p, expected %p", papplPrinterGetID(p), (void *)printer, (void *)p);
+        goto done;
+      }
+
+      if ((printer = papplSystemFindPrinter(system, NULL, 0, papplPrinterGetDeviceURI(p))) != p)
+      {
+        testEndMessage(false, "device URI lookup of '%s' returned %p, expected %p", papplPrinterGetDeviceURI(p), (void *)printer, (void *)p);
+        goto done;
+      }
+    }
+
+    gettimeofday(&end, NULL);
+
+    testEndMessage(true, "%.3fus per lookup", (1000000.0 * (end.tv_sec - start.tv_sec) + (end.tv_usec - start.tv_usec)) / (3 * count));
+  }
+
+  ret = true;
+
+  done:
+
+  // Delete the printers we added...
+  testBegin("find-printer: papplPrinterDelete x %d", num_printers);
+
+  for (i = 0; i < num_printers; i ++)
+    papplPrinterDelete(printers[i]);
+
+  testEnd(true);
+
+  return (ret);
+}
+
+
+//
+// 'test_get_jobs()' - Benchmark Get-Jobs with a large number of jobs.
+//
+
+static bool				// O - `true` on success, `false` on failure
+test_get_jobs(pappl_system_t *system)	// I - System
+{
+  bool			ret = false;	// Return value
+  http_t		*http;		// HTTP connection
+  pappl_printer_t	*printer;	// Benchmark printer
+  char			uri[1024],	// "printer-uri" value
+			path[256],	// Printer web path
+			resource[1024];	// Printer IPP resource
+  ipp_t			*request,	// IPP request
+			*response;	// IPP response
+  ipp_attribute_t	*attr;		// Current attribute
+  int			i,		// Looping var
+			count,		// Request count
+			num_jobs;	// Number of jobs in response
+  struct timeval	start,		// Start time
+			end;		// End time
+  static const char * const ra_all[] =	// requested-attributes=all
+  {
+    "all"
+  };
+  static const char * const ra_list[] =	// requested-attributes for a job list
+  {
+    "job-id",
+    "job-impressions-completed",
+    "job-name",
+    "job-originating-user-name",
+    "job-state",
+    "job-state-reasons",
+    "time-at-creation"
+  };
+  static const struct
+  {
+    const char		*name;		// Benchmark name
+    int			num_ra;		// Number of requested-attributes values
+    const char * const	*ra;		// requested-attributes values
+  } tests[] =
+  {
+    { "all", (int)(sizeof(ra_all) / sizeof(ra_all[0])), ra_all },
+    { "list", (int)(sizeof(ra_list) / sizeof(ra_list[0])), ra_list }
+  };
+
+
+  // Create a stopped printer to hold the jobs...
+  testBegin("get-jobs: papplPrinterCreate");
+  if ((printer = papplPrinterCreate(system, 0, "Get-Jobs Printer", "pwg_common-300dpi-black_1", "MFG:PWG;MDL:Test Printer;", "file:///dev/null")) == NULL)
+  {
+    testEndMessage(false, "%s", strerror(errno));
+    return (false);
+  }
+
+  papplPrinterSetMaxActiveJobs(printer, 0);
+  papplPrinterPause(printer);
+  papplPrinterGetPath(printer, NULL, path, sizeof(path));
+  snprintf(resource, sizeof(resource), "/ipp/print%s", path);
+  testEnd(true);
+
+  testBegin("get-jobs: Connect to server");
+  if ((http = connect_to_printer(system, false, uri, sizeof(uri))) == NULL)
+  {
+    testEndMessage(false, "%s", cupsLastErrorString());
+    papplPrinterDelete(printer);
+    return (false);
+  }
+
+  httpAssembleURI(HTTP_URI_CODING_ALL, uri, sizeof(uri), "ipp", NULL, "localhost", papplSystemGetHostPort(system), resource);
+  testEnd(true);
+
+  // Queue the jobs...
+  testBegin("get-jobs: Create-Job x 500");
+
+  for (i = 0; i < 500; i ++)
+  {
+    request = ippNewRequest(IPP_OP_CREATE_JOB);
+    ippAddString(request, IPP_TAG_OPERATION, IPP_TAG_URI, "printer-uri", NULL, uri);
+    ippAddString(request, IPP_TAG_OPERATION, IPP_TAG_NAME, "requesting-user-name", NULL, cupsGetUser());
+    ippAddString(request, IPP_TAG_OPERATION, IPP_TAG_NAME, "job-name", NULL, "Get-Jobs Benchmark");
+
+    ippDelete(cupsDoRequest(http, request, resource));
+
+    if (cupsLastError() != IPP_STATUS_OK)
+    {
+      testEndMessage(false, "%s", cupsLastErrorString());
+      goto done;
+    }
+  }
+
+  testEnd(true);
+
+  // Run the benchmarks...
+  for (i = 0; i < (int)(sizeof(tests) / sizeof(tests[0])); i ++)
+  {
+    testBegin("get-jobs: Get-Jobs requested-attributes=%s", tests[i].name);
+
+    gettimeofday(&start, NULL);
+
+    for (count = 0; count < 20; count ++)
+    {
+      request = ippNewRequest(IPP_OP_GET_JOBS);
+      ippAddString(request, IPP_TAG_OPERATION, IPP_TAG_URI, "printer-uri", NULL, uri);
+      ippAddString(request, IPP_TAG_OPERATION, IPP_TAG_NAME, "requesting-user-name", NULL, cupsGetUser());
+      ippAddStrings(request, IPP_TAG_OPERATION, IPP_CONST_TAG(IPP_TAG_KEYWORD), "requested-attributes", tests[i].num_ra, NULL, tests[i].ra);
+
+      response = cupsDoRequest(http, request, resource);
+
+      if (cupsLastError() != IPP_STATUS_OK)
+      {
+        testEndMessage(false, "%s", cupsLastErrorString());
+        ippDelete(response);
+        goto done;
+      }
+
+      for (num_jobs = 0, attr = ippFindAttribute(response, "job-id", IPP_TAG_INTEGER); attr; attr = ippFindNextAttribute(response, "job-id", IPP_TAG_INTEGER))
+        num_jobs ++;
+
+      ippDelete(response);
+
+      if (num_jobs != 500)
+      {
+        testEndMessage(false, "got %d jobs, expected 500", num_jobs);
+        goto done;
+      }
+    }
+
+    gettimeofday(&end, NULL);
+
+    testEndMessage(true, "%.3fms per request", (1000.0 * (end.tv_sec - start.tv_sec) + 0.001 * (end.tv_usec - start.tv_usec)) / count);
+  }
+
+  ret = true;
+
+  done:
+
+  httpClose(http);
+
+  papplPrinterDelete(printer);
+
+  return (ret);
+}
+
+
+//
+// 'test_image_copies()' - Measure the CPU time per copy of an image.
+//
+// The first copy of an image is scaled and dithered, and the remaining copies
+// are replayed from the page raster cache.
+//
+
+static bool				// O - `true` on success, `false` on failure
+test_image_copies(
+    pappl_system_t *system,		// I - System
+    const char     *prompt,		// I - Prompt for file
+    const char     *format,		// I - MIME media type of file
+    const char     *file,		// I - File to print
+    int            num_copies)		// I - Number of copies
+{
+  bool			ret = false;	// Return value
+  pappl_printer_t	*printer;	// Printer
+  pappl_job_t		*job;		// Print job
+  int			i,		// Looping var
+			copies[2];	// Number of copies for each job
+  char			value[32],	// "copies" value
+			filename[1024] = "";
+					// Print filename
+  cups_len_t		num_options;	// Number of options
+  cups_option_t		*options;	// Options
+  clock_t		start;		// CPU time before job
+  double		cpu[2];		// CPU time for each job
+
+
+  testBegin("%s: Print %d copies", prompt, num_copies);
+
+  if ((printer = papplPrinterCreate(system, 0, "Image Copies Printer", "pwg_common-300dpi-black_1", "MFG:PWG;MDL:Test Printer;", "file:///dev/null")) == NULL)
+  {
+    testEndMessage(false, "%s", strerror(errno));
+    return (false);
+  }
+
+  copies[0] = 1;
+  copies[1] = num_copies;
+
+  for (i = 0; i < 2; i ++)
+  {
+    // Copy the image to a temporary file that is removed with the job...
+    if (!copy_print_file(file, filename, sizeof(filename)))
+      goto done;
+
+    // Print it and wait for the job to finish...
+    snprintf(value, sizeof(value), "%d", copies[i]);
+    num_options = cupsAddOption("copies", value, 0, &options);
+
+    start = clock();
+    job   = papplJobCreateWithFile(printer, cupsGetUser(), format, "Image Copies", (int)num_options, options, filename);
+
+    cupsFreeOptions(num_options, options);
+
+    if (!job)
+    {
+      testEndMessage(false, "%s", strerror(errno));
+      goto done;
+    }
+
+    filename[0] = '\0';			// File is removed with the job
+
+    while (papplJobGetState(job) < IPP_JSTATE_CANCELED)
+      usleep(10000);
+
+    cpu[i] = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+    if (papplJobGetState(job) != IPP_JSTATE_COMPLETED)
+    {
+      testEndMessage(false, "job-state=%d, expected %d", papplJobGetState(job), IPP_JSTATE_COMPLETED);
+      goto done;
+    }
+    else if (papplJobGetImpressionsCompleted(job) != copies[i])
+    {
+      testEndMessage(false, "got %d copies, expected %d", papplJobGetImpressionsCompleted(job), copies[i]);
+      goto done;
+    }
+  }
+
+  testEndMessage(true, "%.1fms CPU for 1 copy, %.1fms CPU per additional copy", 1000.0 * cpu[0], 1000.0 * (cpu[1] - cpu[0]) / (num_copies - 1));
+
+  ret = true;
+
+  done:
+
+  if (filename[0])
+    unlink(filename);
+
+  papplPrinterDelete(printer);
+
+  return (ret);
+}
+
+
+//
+// 'test_image_files()' - Run image file tests.
+//
+
+static bool				// O - `true` on success, `false` on failure
+test_image_files(
+    pappl_system_t       *system,	// I - System
+    const char           *prompt,	// I - Prompt for files
+    const char           *format,	// I - MIME media type of files
+    int                  num_files,	// I - Number of files to print
+    const char * const * files)		// I - Files to print
+{
+  int		i, j, k, m;		// Looping vars
+  http_t	*http;			// HTTP connection
+  char		uri[1024],		// "printer-uri" value
+		filename[1024],		// Print file
+		job_name[1024];		// "job_name" value
+  ipp_t		*request,		// Request
+		*response;		// Response
+  int		job_id;			// "job-id" value
+  ipp_jstate_t	job_state;		// "job-state" value
+  pappl_jmetrics_t start;		// Job metrics before printing
+  static const int orients[] =		// "orientation-requested" values
+  {
+    IPP_ORIENT_NONE,
+    IPP_ORIENT_PORTRAIT,
+    IPP_ORIENT_LANDSCAPE,
+    IPP_ORIENT_REVERSE_PORTRAIT,
+    IPP_ORIENT_REVERSE_LANDSCAPE
+  };
+  static const char * const modes[] =	// "print-color-mode" values
+  {
+    "auto",
+    "color",
+    "monochrome"
+  };
+  static const char * const scalings[] =// "print-scaling" values
+  {
+    "auto",
+    "auto-fit",
+    "fill",
+    "fit",
+    "none"
+  };
+
+
+  papplSystemGetJobMetrics(system, &start);
+
+  // Connect to system...
+  testBegin("%s: Connect to server", prompt);
+  if ((http = connect_to_printer(system, true, uri, sizeof(uri))) == NULL)
+  {
+    testEndMessage(false, "Unable to connect: %s", cupsLastErrorString());
+    return (false);
+  }
+
+  testEnd(true);
+
+  // Print files...
+  for (i = 0; i < num_files; i ++)
+  {
+    if (access(files[i], R_OK))
+      snprintf(filename, sizeof(filename), "testsuite/%s", files[i]);
+    else
+      papplCopyString(filename, files[i], sizeof(filename));
+
+    for (j = 0; j < (int)(sizeof(orients) / sizeof(orients[0])); j ++)
+    {
+      for (k = 0; k < (int)(sizeof(modes) / sizeof(modes[0])); k ++)
+      {
+	for (m = 0; m < (int)(sizeof(scalings) / sizeof(scalings[0])); m ++)
+	{
+	  // Stop the test if the system is shutdown (e.g. CTRL+C)
+	  if (papplSystemIsShutdown(system))
+	    return (false);
+
+	  // Print the job...
+	  snprintf(job_name, sizeof(job_name), "%s+%s+%s+%s", files[i], ippEnumString("orientation-requested", orients[j]), modes[k], scalings[m]);
+	  testBegin("%s: Print-Job(%s)", prompt, job_name);
+
+	  request = ippNewRequest(IPP_OP_PRINT_JOB);
+	  ippAddString(request, IPP_TAG_OPERATION, IPP_TAG_URI, "printer-uri", NULL, uri);
+	  ippAddString(request, IPP_TAG_OPERATION, IPP_TAG_NAME, "requesting-user-name", NULL, cupsGetUser());
+	  ippAddString(request, IPP_TAG_OPERATION, IPP_TAG_MIMETYPE, "document-format", NULL, format);
+	  ippAddString(request, IPP_TAG_OPERATION, IPP_TAG_NAME, "job-name", NULL, job_name);
+
+          ippAddInteger(request, IPP_TAG_JOB, IPP_TAG_ENUM, "orientation-requested", orients[j]);
+	  ippAddString(request, IPP_TAG_JOB, IPP_TAG_KEYWORD, "print-color-mode", NULL, modes[k]);
+	  ippAddString(request, IPP_TAG_JOB, IPP_TAG_KEYWORD, "print-scaling", NULL, scalings[m]);
+
+	  response = cupsDoFileRequest(http, request, "/ipp/print", filename);
+
+	  if (cupsLastError() >= IPP_STATUS_ERROR_BAD_REQUEST)
+	  {
+	    testEndMessage(false, "%s", cupsLastErrorString());
+	    ippDelete(response);
+	    httpClose(http);
+	    return (false);
+	  }
+
+	  job_id = ippGetInteger(ippFindAttribute(response, "job-id", IPP_TAG_INTEGER), 0);
+
+          testEndMessage(true, "job-id=%d", job_id);
+	  ippDelete(response);
+
+	  // Poll job status until completed...
+	  do
+	  {
+	    sleep(1);
+
+	    testBegin("%s: Get-Job-Attributes(job-id=%d)", prompt, job_id);
+
+	    request = ippNewRequest(IPP_OP_GET_JOB_ATTRIBUTES);
+	    ippAddString(request, IPP_TAG_OPERATION, IPP_TAG_URI, "printer-uri", NULL, uri);
+	    ippAddInteger(request, IPP_TAG_OPERATION, IPP_TAG_INTEGER, "job-id", job_id);
+	    ippAddString(request, IPP_TAG_OPERATION, IPP_TAG_NAME, "requesting-user-name", NULL, cupsGetUser());
+
+	    response = cupsDoRequest(http, request, "/ipp/print");
+
+	    if (cupsLastError() >= IPP_STATUS_ERROR_BAD_REQUEST)
+	    {
+	      testEndMessage(false, "%s", cupsLastErrorString());
+	      httpClose(http);
+	      ippDelete(response);
+	      return (false);
+	    }
+
+	    job_state = (ipp_jstate_t)ippGetInteger(ippFindAttribute(response, "job-state", IPP_TAG_ENUM), 0);
+
+            testEndMessage(true, "job-state=%d", job_state);
+	    ippDelete(response);
+	  }
+	  while (job_state < IPP_JSTATE_CANCELED);
+	}
+      }
+    }
+  }
+
+  httpClose(http);
+
+  if (!test_raster_metrics(system, prompt, &start))
+    return (false);
+
+  return (test_image_copies(system, prompt, format, files[0], 20));
+}
+
+
+//
+// 'test_image_memory()' - Measure the peak memory used to print a large image.
+//
+// JPEG and PNG images are streamed to the printer a few lines at a time, so
+// printing a large photo on a label printer should not need memory for the
+// whole image.
+//
+
+static bool				// O - `true` on success, `false` on failure
+test_image_memory(
+    pappl_system_t *system,		// I - System
+    const char     *prompt,		// I - Prompt for image
+    const char     *format)		// I - MIME media type of image
+{
+  bool			ret = false;	// Return value
+  pappl_printer_t	*printer;	// Printer
+  pappl_job_t		*job;		// Print job
+  int			fd;		// Print file
+  FILE			*fp;		// Print file stream
+  char			filename[1024] = "";
+					// Print filename
+  unsigned char		*line;		// Image line
+  unsigned		x,		// X position
+			y;		// Y position
+  size_t		isize;		// Uncompressed image size
+#if !_WIN32
+  struct rusage		usage;		// Resource usage
+  long			maxrss;		// Peak memory before job
+  size_t		growth;		// Peak memory growth in bytes
+#endif // !_WIN32
+  static const unsigned	width = 6000,	// Image width
+			height = 8000;	// Image height
+
+
+  testBegin("%s: Print %ux%u image", prompt, width, height);
+
+  // Write a large grayscale image...
+  if ((fd = cupsTempFd(filename, (cups_len_t)sizeof(filename))) < 0 || (fp = fdopen(fd, "wb")) == NULL)
+  {
+    testEndMessage(false, "unable to create temporary print file: %s", strerror(errno));
+    if (fd >= 0)
+    {
+      close(fd);
+      unlink(filename);
+    }
+    return (false);
+  }
+
+  if ((line = malloc(width)) == NULL)
+  {
+    testEndMessage(false, "%s", strerror(errno));
+    fclose(fp);
+    unlink(filename);
+    return (false);
+  }
+
+#ifdef HAVE_LIBJPEG
+  if (!strcmp(format, "image/jpeg"))
+  {
+    struct jpeg_compress_struct	cinfo;	// Compressor info
+    struct jpeg_error_mgr	cerr;	// Compressor error handler
+    JSAMPROW			row = line;
+					// Sample row pointer
+
+    cinfo.err = jpeg_std_error(&cerr);
+    jpeg_create_compress(&cinfo);
+    jpeg_stdio_dest(&cinfo, fp);
+
+    cinfo.image_width      = width;
+    cinfo.image_height     = height;
+    cinfo.input_components = 1;
+    cinfo.in_color_space   = JCS_GRAYSCALE;
+
+    jpeg_set_defaults(&cinfo);
+    jpeg_start_compress(&cinfo, TRUE);
+
+    for (y = 0; y < height; y ++)
+    {
+      for (x = 0; x < width; x ++)
+	line[x] = (unsigned char)(((x / 64) ^ (y / 64)) & 1 ? 255 * x / width : 255 * y / height);
+
+      jpeg_write_scanlines(&cinfo, &row, 1);
+    }
+
+    jpeg_finish_compress(&cinfo);
+    jpeg_destroy_compress(&cinfo);
+  }
+#endif // HAVE_LIBJPEG
+
+#ifdef HAVE_LIBPNG
+  if (!strcmp(format, "image/png"))
+  {
+    png_structp	pp;			// PNG compressor
+    png_infop	info;			// PNG image information
+
+    pp   = png_create_write_struct(PNG_LIBPNG_VER_STRING, NULL, NULL, NULL);
+    info = png_create_info_struct(pp);
+
+    png_init_io(pp, fp);
+    png_set_IHDR(pp, info, width, height, 8, PNG_COLOR_TYPE_GRAY, PNG_INTERLACE_NONE, PNG_COMPRESSION_TYPE_DEFAULT, PNG_FILTER_TYPE_DEFAULT);
+    png_write_info(pp, info);
+
+    for (y = 0; y < height; y ++)
+    {
+      for (x = 0; x < width; x ++)
+	line[x] = (unsigned char)(((x / 64) ^ (y / 64)) & 1 ? 255 * x / width : 255 * y / height);
+
+      png_write_row(pp, line);
+    }
+
+    png_write_end(pp, info);
+    png_destroy_write_struct(&pp, &info);
+  }
+#endif // HAVE_LIBPNG
+
+  fclose(fp);
+  free(line);
+
+  isize = (size_t)width * (size_t)height;
+
+  // Print it on a 4" label printer and wait for the job to finish...
+  if ((printer = papplPrinterCreate(system, 0, "Image Memory Printer", "pwg_4inch-203dpi-black_1", "MFG:PWG;MDL:Test Printer;", "file:///dev/null")) == NULL)
+  {
+    testEndMessage(false, "%s", strerror(errno));
+    unlink(filename);
+    return (false);
+  }
+
+#if !_WIN32
+  getrusage(RUSAGE_SELF, &usage);
+  maxrss = usage.ru_maxrss;
+#endif // !_WIN32
+
+  if ((job = papplJobCreateWithFile(printer, cupsGetUser(), format, "Large Image", 0, NULL, filename)) == NULL)
+  {
+    testEndMessage(false, "%s", strerror(errno));
+    goto done;
+  }
+
+  filename[0] = '\0';			// File is removed with the job
+
+  while (papplJobGetState(job) < IPP_JSTATE_CANCELED)
+    usleep(10000);
+
+  if (papplJobGetState(job) != IPP_JSTATE_COMPLETED)
+  {
+    testEndMessage(false, "job-state=%d, expected %d", papplJobGetState(job), IPP_JSTATE_COMPLETED);
+    goto done;
+  }
+
+#if !_WIN32
+  // Check the peak memory use - ru_maxrss is in bytes on macOS and kilobytes
+  // everywhere else...
+  getrusage(RUSAGE_SELF, &usage);
+
+#  ifdef __APPLE__
+  growth = (size_t)(usage.ru_maxrss - maxrss);
+#  else
+  growth = 1024 * (size_t)(usage.ru_maxrss - maxrss);
+#  endif // __APPLE__
+
+  if (growth >= isize / 4)
+  {
+    testEndMessage(false, "peak memory grew by %luk, expected less than %luk", (unsigned long)(growth / 1024), (unsigned long)(isize / 4096));
+    goto done;
+  }
+
+  testEndMessage(true, "peak memory grew by %luk for a %luk image", (unsigned long)(growth / 1024), (unsigned long)(isize / 1024));
+
+#else
+  testEndMessage(true, "%luk image", (unsigned long)(isize / 1024));
+#endif // !_WIN32
+
+  ret = true;
+
+  done:
+
+  if (filename[0])
+    unlink(filename);
+
+  papplPrinterDelete(printer);
+
+  return (ret);
+}
+#endif // HAVE_LIBJPEG || HAVE_LIBPNG
+
+
+//
+// 'test_max_jobs()' - Test processing several jobs at once.
+//
+// More jobs than the printer's maximum number of processing jobs are queued
+// using a filter that holds each job until it is released, so the number of
+// jobs in the processing state can be checked.
+//
+
+static bool				// O - `true` on success, `false` on failure
+test_max_jobs(pappl_system_t *system)	// I - System
+{
+  bool		ret = false;		// Return value
+  http_t	*http = NULL;		// HTTP connection
+  char		uri[1024],		// "printer-uri" value
+		filename[1024] = "";	// Print file
+  int		fd;			// Print file descriptor
+  ipp_t		*request,		// IPP request
+		*response;		// IPP response
+  int		i,			// Looping var
+		num_jobs,		// Number of jobs submitted
+		job_ids[5],		// Submitted job IDs
+		processing,		// Number of processing jobs
+		max_processing = 1;	// Original maximum processing jobs
+  pappl_printer_t *printer = NULL;	// Printer
+  pappl_job_t	*job;			// Job
+
+
+  // Connect to system...
+  testBegin("max-jobs: Connect to server");
+  if ((http = connect_to_printer(system, false, uri, sizeof(uri))) == NULL)
+  {
+    testEndMessage(false, "Unable to connect: %s", cupsLastErrorString());
+    return (false);
+  }
+  testEnd(true);
+
+  if ((printer = papplSystemFindPrinter(system, "/ipp/print", 0, NULL)) == NULL)
+  {
+    testBegin("max-jobs: papplSystemFindPrinter");
+    testEndMessage(false, "Unable to find printer");
+    goto done;
+  }
+
+  // Create a small document file...
+  if ((fd = cupsTempFd(filename, (cups_len_t)sizeof(filename))) < 0)
+  {
+    testBegin("max-jobs: cupsTempFd");
+    testEndMessage(false, "%s", strerror(errno));
+    goto done;
+  }
+
+  if (write(fd, "HOLD", 4) < 0)
+  {
+    testBegin("max-jobs: write");
+    testEndMessage(false, "%s", strerror(errno));
+    close(fd);
+    goto done;
+  }
+
+  close(fd);
+
+  max_processing = papplPrinterGetMaxProcessingJobs(printer);
+
+  testBegin("max-jobs: papplPrinterSetMaxProcessingJobs(2)");
+  papplPrinterSetMaxProcessingJobs(printer, 2);
+  if ((i = papplPrinterGetMaxProcessingJobs(printer)) != 2)
+  {
+    testEndMessage(false, "got %d, expected 2", i);
+    goto done;
+  }
+  testEnd(true);
+
+  pthread_mutex_lock(&hold_mutex);
+  hold_running = 0;
+  hold_max     = 0;
+  hold_release = false;
+  pthread_mutex_unlock(&hold_mutex);
+
+  // Queue the jobs on the stopped printer...
+  papplPrinterPause(printer);
+
+  for (num_jobs = 0; num_jobs < (int)(sizeof(job_ids) / sizeof(job_ids[0])); num_jobs ++)
+  {
+    testBegin("max-jobs: Print-Job(%d)", num_jobs + 1);
+
+    request = ippNewRequest(IPP_OP_PRINT_JOB);
+    ippAddString(request, IPP_TAG_OPERATION, IPP_TAG_URI, "printer-uri", NULL, uri);
+    ippAddString(request, IPP_TAG_OPERATION, IPP_TAG_NAME, "requesting-user-name", NULL, cupsGetUser());
+    ippAddString(request, IPP_TAG_OPERATION, IPP_CONST_TAG(IPP_TAG_MIMETYPE), "document-format", NULL, "application/vnd.pappl-hold");
+    ippAddString(request, IPP_TAG_OPERATION, IPP_TAG_NAME, "job-name", NULL, "max-jobs");
+
+    response = cupsDoFileRequest(http, request, "/ipp/print", filename);
+
+    if (cupsLastError() >= IPP_STATUS_ERROR_BAD_REQUEST)
+    {
+      testEndMessage(false, "%s", cupsLastErrorString());
+      ippDelete(response);
+      papplPrinterResume(printer);
+      goto release;
+    }
+
+    job_ids[num_jobs] = ippGetInteger(ippFindAttribute(response, "job-id", IPP_TAG_INTEGER), 0);
+
+    ippDelete(response);
+
+    testEndMessage(true, "job-id=%d", job_ids[num_jobs]);
+  }
+
+  papplPrinterResume(printer);
+
+  // Wait for two jobs to be processing...
+  testBegin("max-jobs: Two jobs processing");
+
+  for (i = 0; i < 30; i ++)
+  {
+    pthread_mutex_lock(&hold_mutex);
+    processing = hold_running;
+    pthread_mutex_unlock(&hold_mutex);
+
+    if (processing >= 2)
+      break;
+
+    sleep(1);
+  }
+
+  // Give the job workers a chance to (incorrectly) start more jobs...
+  sleep(1);
+
+  for (i = 0, processing = 0; i < num_jobs; i ++)
+  {
+    if ((job = papplPrinterFindJob(printer, job_ids[i])) != NULL && papplJobGetState(job) == IPP_JSTATE_PROCESSING)
+      processing ++;
+  }
+
+  if (processing != 2)
+  {
+    testEndMessage(false, "got %d processing jobs, expected 2", processing);
+    goto release;
+  }
+  else if (hold_max != 2)
+  {
+    testEndMessage(false, "got %d running filters, expected 2", hold_max);
+    goto release;
+  }
+
+  testEnd(true);
+
+  // Release the jobs and wait for them to complete...
+  pthread_mutex_lock(&hold_mutex);
+  hold_release = true;
+  pthread_cond_broadcast(&hold_cond);
+  pthread_mutex_unlock(&hold_mutex);
+
+  testBegin("max-jobs: Wait for jobs");
+
+  for (i = 0; i < 60; i ++)
+  {
+    int	j;				// Looping var
+
+    for (j = 0; j < num_jobs; j ++)
+    {
+      if ((job = papplPrinterFindJob(printer, job_ids[j])) != NULL && papplJobGetState(job) < IPP_JSTATE_CANCELED)
+        break;
+    }
+
+    if (j >= num_jobs)
+      break;
+
+    sleep(1);
+  }
+
+  if (i >= 60)
+  {
+    testEndMessage(false, "timeout");
+    goto done;
+  }
+  else if (hold_max != 2)
+  {
+    testEndMessage(false, "got up to %d running filters, expected 2", hold_max);
+    goto done;
+  }
+
+  testEnd(true);
+
+  ret = true;
+
+  release:
+
+  pthread_mutex_lock(&hold_mutex);
+  hold_release = true;
+  pthread_cond_broadcast(&hold_cond);
+  pthread_mutex_unlock(&hold_mutex);
+
+  done:
+
+  if (printer)
+    papplPrinterSetMaxProcessingJobs(printer, max_processing);
+
+  if (filename[0])
+    unlink(filename);
+
+  httpClose(http);
+
+  return (ret);
+}
+
+
+//
+// 'test_max_jobs_cb()' - Filter callback that holds a job until released.
+//
+
+static bool				// O - `true` on success, `false` on failure
+test_max_jobs_cb(
+    pappl_job_t    *job,		// I - Job
+    pappl_device_t *device,		// I - Device (unused)
+    void           *data)		// I - Callback data (unused)
+{
+  int			i;		// Looping var
+  struct timeval	curtime;	// Current time
+  struct timespec	timeout;	// Timeout
+
+
+  (void)device;
+  (void)data;
+
+  pthread_mutex_lock(&hold_mutex);
+
+  hold_running ++;
+  if (hold_running > hold_max)
+    hold_max = hold_running;
+
+  // Wait up to 60 seconds to be released...
+  for (i = 0; i < 60 && !hold_release && !papplJobIsCanceled(job); i ++)
+  {
+    gettimeofday(&curtime, NULL);
+    timeout.tv_sec  = curtime.tv_sec + 1;
+    timeout.tv_nsec = curtime.tv_usec * 1000;
+
+    pthread_cond_timedwait(&hold_cond, &hold_mutex, &timeout);
+  }
+
+  hold_running --;
+
+  pthread_mutex_unlock(&hold_mutex);
+
+  return (true);
+}
+
+
+//
+// 'test_offline()' - Test printing to an unavailable device.
+//
+// Jobs for a printer whose device cannot be opened stay pending while the
+// device is retried in the background, and the printer reports "offline".
+//
+
+static bool				// O - `true` on success, `false` on failure
+test_offline(pappl_system_t *system)	// I - System
+{
+  bool			ret = false;	// Return value
+  pappl_printer_t	*printer;	// Offline printer
+  pappl_job_t		*job;		// Print job
+  int			i,		// Looping var
+			fd;		// Print file
+  ipp_jstate_t		job_state;	// Job state
+  char			filename[1024] = "";
+					// Print filename
+
+
+  testBegin("offline: papplPrinterCreate");
+  if ((printer = papplPrinterCreate(system, 0, "Offline Printer", "pwg_common-300dpi-black_1", "MFG:PWG;MDL:Test Printer;", "socket://127.0.0.1:9")) == NULL)
+  {
+    testEndMessage(false, "%s", strerror(errno));
+    return (false);
+  }
+  testEnd(true);
+
+  testBegin("offline: papplJobCreateWithFile");
+  if ((fd = cupsTempFd(filename, (cups_len_t)sizeof(filename))) < 0)
+  {
+    testEndMessage(false, "%s", strerror(errno));
+    goto done;
+  }
+
+  if (write(fd, "RaS2", 4) < 0)
+  {
+    testEndMessage(false, "%s", strerror(errno));
+    close(fd);
+    goto done;
+  }
+
+  close(fd);
+
+  if ((job = papplJobCreateWithFile(printer, cupsGetUser(), "image/pwg-raster", "Offline Test", 0, NULL, filename)) == NULL)
+  {
+    testEndMessage(false, "%s", strerror(errno));
+    goto done;
+  }
+  testEndMessage(true, "job-id=%d", papplJobGetID(job));
+
+  testBegin("offline: printer-state-reasons");
+  for (i = 0; i < 100 && !(papplPrinterGetReasons(printer) & PAPPL_PREASON_OFFLINE); i ++)
+    usleep(100000);
+
+  if (!(papplPrinterGetReasons(printer) & PAPPL_PREASON_OFFLINE))
+  {
+    testEndMessage(false, "expected 'offline'");
+    goto done;
+  }
+  testEnd(true);
+
+  testBegin("offline: job-state");
+  if ((job_state = papplJobGetState(job)) != IPP_JSTATE_PENDING)
+  {
+    testEndMessage(false, "got %d, expected %d", job_state, IPP_JSTATE_PENDING);
+    goto done;
+  }
+  testEnd(true);
+
+  ret = true;
+
+  done:
+
+  if (filename[0])
+    unlink(filename);
+
+  papplPrinterDelete(printer);
+
+  return (ret);
+}
+
+
+//
+// 'test_pwg_raster()' - Run PWG Raster tests.
+//
+
+static bool				// O - `true` on success, `false` on failure
+test_pwg_raster(pappl_system_t *system)	// I - System
+{
+  bool		ret = false;		// Return value
+  http_t	*http = NULL;		// HTTP connection
+  char		uri[1024],		// "printer-uri" value
+		filename[1024] = "",	// Print file
+		job_name[1024];		// "job_name" value
+  ipp_t		*request,		// IPP request
+		*response,		// IPP response
+		*supported = NULL;	// Supported attributes
+  ipp_attribute_t *mode_supported;	// "print-color-mode-supported" attribute
+  int		i;			// Looping var
+  int		job_id;			// "job-id" value
   ipp_jstate_t	job_state;		// "job-state" value
-  static const int orients[] =		// "orientation-requested" values
+  pappl_jmetrics_t metrics,		// Job processing metrics
+		start;			// Job metrics before printing
+  pappl_printer_t *printer;		// Printer
+  pappl_job_t	*job = NULL;		// Job
+  static const char * const modes[] =	// "print-color-mode" values
+  {
+    "auto",
+    "auto-monochrome",
+    "color",
+    "monochrome"
+  };
+
+
+  papplSystemGetJobMetrics(system, &start);
+
+  // Connect to system...
+  testBegin("pwg-raster: Connect to server");
+  if ((http = connect_to_printer(system, false, uri, sizeof(uri))) == NULL)
+  {
+    testEndMessage(false, "Unable to connect: %s", cupsLastErrorString());
+    return (false);
+  }
+  testEnd(true);
+
+  // Get printer capabilities
+  testBegin("pwg-raster: Get-Printer-Attributes");
+
+  request = ippNewRequest(IPP_OP_GET_PRINTER_ATTRIBUTES);
+  ippAddString(request, IPP_TAG_OPERATION, IPP_TAG_URI, "printer-uri", NULL, "ipp://localhost/ipp/print");
+  ippAddString(request, IPP_TAG_OPERATION, IPP_TAG_NAME, "requesting-user-name", NULL, cupsGetUser());
+
+  supported = cupsDoRequest(http, request, "/ipp/print");
+
+  if (cupsLastError() != IPP_STATUS_OK)
+  {
+    testEndMessage(false, "%s", cupsLastErrorString());
+    goto done;
+  }
+
+  if ((mode_supported = ippFindAttribute(supported, "print-color-mode-supported", IPP_TAG_KEYWORD)) == NULL)
+  {
+    testEndMessage(false, "missing required 'print-color-mode-supported' attribute in response");
+    goto done;
+  }
+
+  testEnd(true);
+
+  // Loop through the supported print-color-mode values...
+  for (i = 0; i < (int)(sizeof(modes) / sizeof(modes[0])); i ++)
+  {
+    // Make raster data for this mode...
+    testBegin("pwg-raster: Print-Job(%s)", modes[i]);
+
+    if (!ippContainsString(mode_supported, modes[i]))
+      continue;				// Not supported, skip
+
+    if (!make_raster_file(supported, strstr(modes[i], "monochrome") != NULL, filename, sizeof(filename)))
+      break;				// Error
+
+    // Print the file...
+    snprintf(job_name, sizeof(job_name), "pwg-raster-%s", modes[i]);
+
+    request = ippNewRequest(IPP_OP_PRINT_JOB);
+    ippAddString(request, IPP_TAG_OPERATION, IPP_TAG_URI, "printer-uri", NULL, uri);
+    ippAddString(request, IPP_TAG_OPERATION, IPP_TAG_NAME, "requesting-user-name", NULL, cupsGetUser());
+    ippAddString(request, IPP_TAG_OPERATION, IPP_CONST_TAG(IPP_TAG_MIMETYPE), "document-format", NULL, "image/pwg-raster");
+    ippAddString(request, IPP_TAG_OPERATION, IPP_TAG_NAME, "job-name", NULL, job_name);
+
+    ippAddString(request, IPP_TAG_JOB, IPP_TAG_KEYWORD, "print-color-mode", NULL, modes[i]);
+
+    response = cupsDoFileRequest(http, request, "/ipp/print", filename);
+
+    if (cupsLastError() >= IPP_STATUS_ERROR_BAD_REQUEST)
+    {
+      testEndMessage(false, "Unable to print %s: %s", job_name, cupsLastErrorString());
+      goto done;
+    }
+
+    job_id = ippGetInteger(ippFindAttribute(response, "job-id", IPP_TAG_INTEGER), 0);
+
+    ippDelete(response);
+
+    testEndMessage(true, "job-id=%d", job_id);
+
+    // Poll job status until completed...
+    do
+    {
+      sleep(1);
+
+      testBegin("pwg-raster: Get-Job-Attributes(job-id=%d)", job_id);
+
+      request = ippNewRequest(IPP_OP_GET_JOB_ATTRIBUTES);
+      ippAddString(request, IPP_TAG_OPERATION, IPP_TAG_URI, "printer-uri", NULL, uri);
+      ippAddInteger(request, IPP_TAG_OPERATION, IPP_TAG_INTEGER, "job-id", job_id);
+      ippAddString(request, IPP_TAG_OPERATION, IPP_TAG_NAME, "requesting-user-name", NULL, cupsGetUser());
+
+      response = cupsDoRequest(http, request, "/ipp/print");
+
+      if (cupsLastError() >= IPP_STATUS_ERROR_BAD_REQUEST)
+      {
+	testEndMessage(false, "Unable to get job state for '%s': %s", job_name, cupsLastErrorString());
+        goto done;
+      }
+
+      job_state = (ipp_jstate_t)ippGetInteger(ippFindAttribute(response, "job-state", IPP_TAG_ENUM), 0);
+
+      testEndMessage(true, "job-state=%d", job_state);
+      ippDelete(response);
+    }
+    while (job_state < IPP_JSTATE_CANCELED);
+
+    // Cleanup...
+    unlink(filename);
+  }
+
+  // Print to a stopped printer - the raster data must be queued instead of
+  // getting a server-error-busy response...
+  testBegin("pwg-raster: Print-Job(stopped)");
+
+  if ((printer = papplSystemFindPrinter(system, "/ipp/print", 0, NULL)) == NULL)
   {
-    IPP_ORIENT_NONE,
-    IPP_ORIENT_PORTRAIT,
-    IPP_ORIENT_LANDSCAPE,
-    IPP_ORIENT_REVERSE_PORTRAIT,
-    IPP_ORIENT_REVERSE_LANDSCAPE
+    testEndMessage(false, "Unable to find printer");
+    goto done;
+  }
+
+  if (!make_raster_file(supported, true, filename, sizeof(filename)))
+    goto done;
+
+  papplPrinterPause(printer);
+
+  request = ippNewRequest(IPP_OP_PRINT_JOB);
+  ippAddString(request, IPP_TAG_OPERATION, IPP_TAG_URI, "printer-uri", NULL, uri);
+  ippAddString(request, IPP_TAG_OPERATION, IPP_TAG_NAME, "requesting-user-name", NULL, cupsGetUser());
+  ippAddString(request, IPP_TAG_OPERATION, IPP_CONST_TAG(IPP_TAG_MIMETYPE), "document-format", NULL, "image/pwg-raster");
+  ippAddString(request, IPP_TAG_OPERATION, IPP_TAG_NAME, "job-name", NULL, "pwg-raster-stopped");
+
+  response = cupsDoFileRequest(http, request, "/ipp/print", filename);
+
+  papplPrinterResume(printer);
+
+  if (cupsLastError() >= IPP_STATUS_ERROR_BAD_REQUEST)
+  {
+    testEndMessage(false, "Unable to print: %s", cupsLastErrorString());
+    goto done;
+  }
+
+  job_id    = ippGetInteger(ippFindAttribute(response, "job-id", IPP_TAG_INTEGER), 0);
+  job_state = (ipp_jstate_t)ippGetInteger(ippFindAttribute(response, "job-state", IPP_TAG_ENUM), 0);
+
+  ippDelete(response);
+
+  if (job_state != IPP_JSTATE_PENDING)
+  {
+    testEndMessage(false, "job-state=%d, expected %d", job_state, IPP_JSTATE_PENDING);
+    goto done;
+  }
+
+  testEndMessage(true, "job-id=%d", job_id);
+
+  testBegin("pwg-raster: Wait for job %d", job_id);
+
+  for (i = 0; i < 30; i ++)
+  {
+    if ((job = papplPrinterFindJob(printer, job_id)) == NULL || papplJobGetState(job) >= IPP_JSTATE_CANCELED)
+      break;
+
+    sleep(1);
+  }
+
+  if (!job || papplJobGetState(job) != IPP_JSTATE_COMPLETED)
+  {
+    testEndMessage(false, "job-state=%d, expected %d", job ? papplJobGetState(job) : 0, IPP_JSTATE_COMPLETED);
+    goto done;
+  }
+
+  testEnd(true);
+
+  unlink(filename);
+
+  // Print a many-page raster stream to measure the per-page overhead...
+  if (!test_pwg_raster_pages(system, 500))
+    goto done;
+
+  // Check the job metrics...
+  testBegin("pwg-raster: papplSystemGetJobMetrics");
+  papplSystemGetJobMetrics(system, &metrics);
+  if (metrics.processed == 0 || metrics.workers == 0)
+  {
+    testEndMessage(false, "got %lu processed, %lu workers, expected at least 1", (unsigned long)metrics.processed, (unsigned long)metrics.workers);
+    goto done;
+  }
+  else if (metrics.waiting > 0)
+  {
+    testEndMessage(false, "got %lu waiting, expected 0", (unsigned long)metrics.waiting);
+    goto done;
+  }
+  else
+  {
+    testEndMessage(true, "%lu processed, %lu workers (%lu max busy)", (unsigned long)metrics.processed, (unsigned long)metrics.workers, (unsigned long)metrics.max_busy);
+  }
+
+  // Check the raster pipeline metrics...
+  if (!test_raster_metrics(system, "pwg-raster", &start))
+    goto done;
+
+  // If we complete the loop without errors, it is a successful run...
+  ret = true;
+
+  done:
+
+  if (filename[0])
+    unlink(filename);
+
+  httpClose(http);
+  ippDelete(supported);
+
+  return (ret);
+}
+
+
+//
+// 'test_pwg_raster_pages()' - Measure the per-page overhead of PWG Raster jobs.
+//
+// The pages only contain a single line, so the processing time is dominated by
+// the cost of setting up each page.
+//
+
+static bool				// O - `true` on success, `false` on failure
+test_pwg_raster_pages(
+    pappl_system_t *system,		// I - System
+    unsigned       num_pages)		// I - Number of pages
+{
+  bool			ret = false;	// Return value
+  pappl_printer_t	*printer;	// Printer
+  pappl_job_t		*job;		// Print job
+  int			fd;		// Print file
+  cups_raster_t		*ras;		// Raster stream
+  cups_page_header_t	header;		// Page header
+  unsigned char		*line = NULL;	// Line of raster data
+  unsigned		page;		// Current page
+  char			filename[1024] = "";
+					// Print filename
+  struct timeval	start,		// Start time
+			end;		// End time
+
+
+  testBegin("pwg-raster: Print %u pages", num_pages);
+
+  if ((printer = papplPrinterCreate(system, 0, "Raster Pages Printer", "pwg_common-300dpi-sgray_8", "MFG:PWG;MDL:Test Printer;", "file:///dev/null")) == NULL)
+  {
+    testEndMessage(false, "%s", strerror(errno));
+    return (false);
+  }
+
+  // Write the raster stream...
+  if (!cupsRasterInitPWGHeader(&header, pwgMediaForPWG("na_letter_8.5x11in"), "sgray_8", 300, 300, "one-sided", NULL))
+  {
+    testEndMessage(false, "unable to initialize raster context: %s", cupsRasterErrorString());
+    goto done;
+  }
+
+  header.cupsHeight                                  = 1;
+  header.cupsInteger[CUPS_RASTER_PWG_TotalPageCount] = num_pages;
+
+  if ((line = malloc(header.cupsBytesPerLine)) == NULL)
+  {
+    testEndMessage(false, "unable to allocate %u bytes for raster output: %s", header.cupsBytesPerLine, strerror(errno));
+    goto done;
+  }
+
+  memset(line, 0xff, header.cupsBytesPerLine);
+
+  if ((fd = cupsTempFd(filename, (cups_len_t)sizeof(filename))) < 0)
+  {
+    testEndMessage(false, "unable to create temporary print file: %s", strerror(errno));
+    goto done;
+  }
+
+  if ((ras = cupsRasterOpen(fd, CUPS_RASTER_WRITE_PWG)) == NULL)
+  {
+    testEndMessage(false, "unable to open raster stream: %s", cupsRasterErrorString());
+    close(fd);
+    goto done;
+  }
+
+  for (page = 0; page < num_pages; page ++)
+  {
+    cupsRasterWriteHeader(ras, &header);
+    cupsRasterWritePixels(ras, line, header.cupsBytesPerLine);
+  }
+
+  cupsRasterClose(ras);
+  close(fd);
+
+  // Print it and wait for the job to finish...
+  gettimeofday(&start, NULL);
+
+  if ((job = papplJobCreateWithFile(printer, cupsGetUser(), "image/pwg-raster", "Raster Pages", 0, NULL, filename)) == NULL)
+  {
+    testEndMessage(false, "%s", strerror(errno));
+    goto done;
+  }
+
+  filename[0] = '\0';			// File is removed with the job
+
+  while (papplJobGetState(job) < IPP_JSTATE_CANCELED)
+    usleep(10000);
+
+  gettimeofday(&end, NULL);
+
+  if (papplJobGetState(job) != IPP_JSTATE_COMPLETED)
+  {
+    testEndMessage(false, "job-state=%d, expected %d", papplJobGetState(job), IPP_JSTATE_COMPLETED);
+    goto done;
+  }
+  else if ((unsigned)papplJobGetImpressionsCompleted(job) != num_pages)
+  {
+    testEndMessage(false, "got %d pages, expected %u", papplJobGetImpressionsCompleted(job), num_pages);
+    goto done;
+  }
+
+  testEndMessage(true, "%.3fms per page", (1000.0 * (end.tv_sec - start.tv_sec) + 0.001 * (end.tv_usec - start.tv_usec)) / num_pages);
+
+  ret = true;
+
+  done:
+
+  if (filename[0])
+    unlink(filename);
+
+  free(line);
+
+  papplPrinterDelete(printer);
+
+  return (ret);
+}
+
+
+//
+// 'test_raster_metrics()' - Report the raster processing throughput.
+//
+// The time spent producing raster lines and the time spent writing them to
+// the driver overlap, so their sum exceeds the elapsed time when the device
+// I/O is hidden behind the raster processing.
+//
+
+static bool				// O - `true` on success, `false` on failure
+test_raster_metrics(
+    pappl_system_t   *system,		// I - System
+    const char       *prompt,		// I - Test prompt
+    pappl_jmetrics_t *start)		// I - Job metrics before printing
+{
+  pappl_jmetrics_t	metrics;	// Job metrics after printing
+  size_t		lines,		// Raster lines written
+			elapsed,	// Elapsed time
+			render,		// Time producing raster lines
+			writing,	// Time writing raster lines
+			overlap;	// Overlapping time
+
+
+  testBegin("%s: Raster throughput", prompt);
+
+  papplSystemGetJobMetrics(system, &metrics);
+
+  lines   = metrics.raster_lines - start->raster_lines;
+  elapsed = metrics.raster_msecs - start->raster_msecs;
+  render  = metrics.render_msecs - start->render_msecs;
+  writing = metrics.write_msecs - start->write_msecs;
+  overlap = (render + writing) > elapsed ? render + writing - elapsed : 0;
+
+  if (lines == 0)
+  {
+    testEndMessage(false, "no raster lines written");
+    return (false);
+  }
+
+  testEndMessage(true, "%lu lines in %lu msecs (%.0f lines/sec), %lu msecs rendering, %lu msecs writing, %lu msecs overlapped", (unsigned long)lines, (unsigned long)elapsed, elapsed > 0 ? 1000.0 * lines / elapsed : 0.0, (unsigned long)render, (unsigned long)writing, (unsigned long)overlap);
+
+  return (true);
+}
+
+#ifdef HAVE_LIBJPEG
+//
+// 'test_render()' - Measure the time to render an image with 1 to 8 render threads.
+//
+// Rotated images are loaded into memory and rendered in bands by the job
+// thread and the system's render workers, so the rendering time should drop
+// with the number of render threads up to the number of processor cores.
+//
+
+static bool				// O - `true` on success, `false` on failure
+test_render(pappl_system_t *system)	// I - System
+{
+  bool			ret = false;	// Return value
+  pappl_printer_t	*printer;	// Printer
+  pappl_job_t		*job;		// Print job
+  int			i,		// Looping var
+			srcfd = -1;	// Image file
+  FILE			*fp;		// Image file stream
+  char			srcname[1024] = "",
+					// Image filename
+			filename[1024] = "";
+					// Print filename
+  unsigned char		*line = NULL;	// Image line
+  unsigned		x,		// X position
+			y;		// Y position
+  pappl_jmetrics_t	start,		// Job metrics before printing
+			end;		// Job metrics after printing
+  size_t		msecs,		// Rendering time
+			msecs1 = 0;	// Rendering time with one thread
+  struct jpeg_compress_struct cinfo;	// Compressor info
+  struct jpeg_error_mgr	cerr;		// Compressor error handler
+  JSAMPROW		row;		// Sample row pointer
+  static const unsigned	width = 4032,	// Image width
+			height = 3024;	// Image height
+  static const int	workers[] = { 1, 2, 4, 8 };
+					// Number of render threads for each benchmark
+
+
+  testBegin("render: Write %ux%u image", width, height);
+
+  // Write a large landscape color photo, which is rotated to fit the page...
+  if ((srcfd = cupsTempFd(srcname, (cups_len_t)sizeof(srcname))) < 0 || (fp = fdopen(srcfd, "wb")) == NULL)
+  {
+    testEndMessage(false, "unable to create temporary image file: %s", strerror(errno));
+    if (srcfd >= 0)
+    {
+      close(srcfd);
+      unlink(srcname);
+    }
+    return (false);
+  }
+
+  if ((line = malloc(3 * width)) == NULL)
+  {
+    testEndMessage(false, "%s", strerror(errno));
+    fclose(fp);
+    unlink(srcname);
+    return (false);
+  }
+
+  cinfo.err = jpeg_std_error(&cerr);
+  jpeg_create_compress(&cinfo);
+  jpeg_stdio_dest(&cinfo, fp);
+
+  cinfo.image_width      = width;
+  cinfo.image_height     = height;
+  cinfo.input_components = 3;
+  cinfo.in_color_space   = JCS_RGB;
+
+  jpeg_set_defaults(&cinfo);
+  jpeg_start_compress(&cinfo, TRUE);
+
+  for (y = 0, row = line; y < height; y ++)
+  {
+    for (x = 0; x < width; x ++)
+    {
+      line[3 * x + 0] = (unsigned char)(255 * x / width);
+      line[3 * x + 1] = (unsigned char)(255 * y / height);
+      line[3 * x + 2] = (unsigned char)(((x / 64) ^ (y / 64)) & 1 ? 255 : 0);
+    }
+
+    jpeg_write_scanlines(&cinfo, &row, 1);
+  }
+
+  jpeg_finish_compress(&cinfo);
+  jpeg_destroy_compress(&cinfo);
+
+  fclose(fp);
+  free(line);
+
+  testEnd(true);
+
+  testBegin("render: papplPrinterCreate");
+  if ((printer = papplPrinterCreate(system, 0, "Render Printer", "pwg_common-300dpi-srgb_8", "MFG:PWG;MDL:Test Printer;", "file:///dev/null")) == NULL)
+  {
+    testEndMessage(false, "%s", strerror(errno));
+    unlink(srcname);
+    return (false);
+  }
+  testEnd(true);
+
+  for (i = 0; i < (int)(sizeof(workers) / sizeof(workers[0])); i ++)
+  {
+    testBegin("render: Print with %d render thread%s", workers[i], workers[i] == 1 ? "" : "s");
+
+    // Copy the image to a temporary file that is removed with the job...
+    if (!copy_print_file(srcname, filename, sizeof(filename)))
+      goto done;
+
+    // Print it and wait for the job to finish...
+    papplSystemSetMaxRenderWorkers(system, workers[i]);
+    papplSystemGetJobMetrics(system, &start);
+
+    if ((job = papplJobCreateWithFile(printer, cupsGetUser(), "image/jpeg", "Render Image", 0, NULL, filename)) == NULL)
+    {
+      testEndMessage(false, "%s", strerror(errno));
+      goto done;
+    }
+
+    filename[0] = '\0';			// File is removed with the job
+
+    while (papplJobGetState(job) < IPP_JSTATE_CANCELED)
+      usleep(10000);
+
+    if (papplJobGetState(job) != IPP_JSTATE_COMPLETED)
+    {
+      testEndMessage(false, "job-state=%d, expected %d", papplJobGetState(job), IPP_JSTATE_COMPLETED);
+      goto done;
+    }
+
+    papplSystemGetJobMetrics(system, &end);
+
+    if ((msecs = end.render_msecs - start.render_msecs) == 0)
+      msecs = 1;
+
+    if (i == 0)
+      msecs1 = msecs;
+
+    testEndMessage(true, "%lu msecs rendering, %.2fx", (unsigned long)msecs, (double)msecs1 / (double)msecs);
+  }
+
+  ret = true;
+
+  done:
+
+  papplSystemSetMaxRenderWorkers(system, 0);
+
+  if (filename[0])
+    unlink(filename);
+
+  unlink(srcname);
+
+  papplPrinterDelete(printer);
+
+  return (ret);
+}
+#endif // HAVE_LIBJPEG
+
+
+//
+// 'test_scale()' - Test the image scaler against floating point scaling code.
+//
+
+static bool				// O - `true` on success, `false` on failure
+test_scale(void)
+{
+  bool			ret = false;	// Return value
+  size_t		i,		// Looping var
+			bytes;		// Bytes per image
+  int			c,		// Current test case
+			depth,		// Bytes per pixel
+			left,		// First output column
+			right,		// Last output column + 1
+			x,		// Current column
+			y,		// Current line
+			diff;		// Difference from expected value
+  _pappl_resample_t	filter;		// Resampling filter
+  _pappl_testimage_t	image;		// Image
+  _pappl_scaler_t	*scaler = NULL;	// Image scaler
+  unsigned char		*pixels = NULL,	// Image pixels
+			*solid = NULL,	// Solid color image pixels
+			*line = NULL,	// Output line
+			*expected = NULL;// Expected output
+  double		secs[3];	// Time for nearest-neighbor, bilinear, and Lanczos-2
+  struct timeval	start,		// Start time
+			end;		// End time
+  static const int	cases[][4] =	// Input and output sizes to test
+  {
+    { 1, 1, 17, 9 },
+    { 3, 2, 1, 1 },
+    { 5, 5, 3, 3 },
+    { 37, 41, 300, 290 },
+    { 300, 290, 37, 41 },
+    { 640, 480, 333, 222 },
+    { 100, 100, 100, 100 },
+    { 1000, 20, 999, 21 }
   };
-  static const char * const modes[] =	// "print-color-mode" values
+  static const int	width = 4032,	// Width of 12 megapixel photo
+			height = 3024,	// Height of 12 megapixel photo
+			out_width = 2400,
+					// Width of 8in at 300dpi
+			out_height = 1800;
+					// Height of 6in at 300dpi
+
+
+  testBegin("scale: Allocate buffers");
+
+  bytes = (size_t)(3 * width * height);
+
+  if ((pixels = malloc(bytes)) == NULL || (solid = malloc(bytes)) == NULL || (line = malloc((size_t)(3 * out_width))) == NULL)
   {
-    "auto",
-    "color",
-    "monochrome"
-  };
-  static const char * const scalings[] =// "print-scaling" values
+    testEndMessage(false, "%s", strerror(errno));
+    goto done;
+  }
+
+  for (i = 0; i < bytes; i ++)
+    pixels[i] = (unsigned char)TESTRAND;
+
+  memset(solid, 77, bytes);
+
+  testEnd(true);
+
+  // Compare the output for all filters, depths, and sizes, scaling all of the
+  // columns and some of the columns...
+  testBegin("scale: _papplScalerGetLine");
+
+  for (filter = _PAPPL_RESAMPLE_BILINEAR; filter <= _PAPPL_RESAMPLE_LANCZOS2; filter ++)
   {
-    "auto",
-    "auto-fit",
-    "fill",
-    "fit",
-    "none"
+    for (depth = 1; depth <= 3; depth += 2)
+    {
+      for (c = 0; c < (int)(sizeof(cases) / sizeof(cases[0])); c ++)
+      {
+        if ((expected = test_scale_image(pixels, cases[c][0], cases[c][1], depth, cases[c][2], cases[c][3], filter)) == NULL)
+        {
+          testEndMessage(false, "%s", strerror(errno));
+          goto done;
+        }
+
+        for (left = 0, right = cases[c][2]; left < right; left += cases[c][2] / 7 + 1, right -= cases[c][2] / 5 + 1)
+        {
+          image.pixels = pixels;
+          image.width  = cases[c][0];
+          image.depth  = depth;
+
+          if ((scaler = _papplScalerCreate(cases[c][0], cases[c][1], depth, cases[c][2], cases[c][3], left, right, filter, (_pappl_scaler_cb_t)test_scale_cb, &image)) == NULL)
+          {
+            testEndMessage(false, "unable to create scaler for %dx%dx%d to %dx%d", cases[c][0], cases[c][1], depth, cases[c][2], cases[c][3]);
+            goto done;
+          }
+
+          for (y = 0; y < cases[c][3]; y ++)
+          {
+            if (!_papplScalerGetLine(scaler, y, line))
+            {
+              testEndMessage(false, "unable to get line %d for %dx%dx%d to %dx%d", y, cases[c][0], cases[c][1], depth, cases[c][2], cases[c][3]);
+              goto done;
+            }
+
+            // Allow for fixed point rounding...
+            for (x = left * depth; x < right * depth; x ++)
+            {
+              diff = line[x - left * depth] - expected[(y * cases[c][2]) * depth + x];
+
+              if (diff < -2 || diff > 2)
+              {
+                testEndMessage(false, "got %d, expected %d at %d,%d for filter=%d, %dx%dx%d to %dx%d, columns %d to %d", line[x - left * depth], expected[(y * cases[c][2]) * depth + x], x / depth, y, filter, cases[c][0], cases[c][1], depth, cases[c][2], cases[c][3], left, right - 1);
+                goto done;
+              }
+            }
+          }
+
+          _papplScalerDelete(scaler);
+          scaler = NULL;
+
+          // Solid colors must not change...
+          image.pixels = solid;
+
+          if ((scaler = _papplScalerCreate(cases[c][0], cases[c][1], depth, cases[c][2], cases[c][3], left, right, filter, (_pappl_scaler_cb_t)test_scale_cb, &image)) == NULL)
+          {
+            testEndMessage(false, "unable to create scaler for %dx%dx%d to %dx%d", cases[c][0], cases[c][1], depth, cases[c][2], cases[c][3]);
+            goto done;
+          }
+
+          for (y = 0; y < cases[c][3]; y ++)
+          {
+            if (!_papplScalerGetLine(scaler, y, line))
+            {
+              testEndMessage(false, "unable to get line %d for %dx%dx%d to %dx%d", y, cases[c][0], cases[c][1], depth, cases[c][2], cases[c][3]);
+              goto done;
+            }
+
+            for (x = 0; x < (right - left) * depth; x ++)
+            {
+              if (line[x] != 77)
+              {
+                testEndMessage(false, "got %d, expected 77 at %d,%d for filter=%d, %dx%dx%d to %dx%d, columns %d to %d", line[x], x / depth + left, y, filter, cases[c][0], cases[c][1], depth, cases[c][2], cases[c][3], left, right - 1);
+                goto done;
+              }
+            }
+          }
+
+          _papplScalerDelete(scaler);
+          scaler = NULL;
+        }
+
+        free(expected);
+        expected = NULL;
+      }
+    }
+  }
+
+  testEnd(true);
+
+  // Benchmark a 12 megapixel photo printed at 8x6in and 300dpi...
+  for (depth = 1; depth <= 3; depth += 2)
+  {
+    testBegin("scale: %dx%d %s to %dx%d", width, height, depth == 1 ? "sgray" : "srgb", out_width, out_height);
+
+    gettimeofday(&start, NULL);
+    test_scale_nearest(pixels, width, height, depth, line, out_width, out_height);
+    gettimeofday(&end, NULL);
+
+    secs[0] = (end.tv_sec - start.tv_sec) + 0.000001 * (end.tv_usec - start.tv_usec);
+
+    for (filter = _PAPPL_RESAMPLE_BILINEAR; filter <= _PAPPL_RESAMPLE_LANCZOS2; filter ++)
+    {
+      gettimeofday(&start, NULL);
+
+      image.pixels = pixels;
+      image.width  = width;
+      image.depth  = depth;
+
+      if ((scaler = _papplScalerCreate(width, height, depth, out_width, out_height, 0, out_width, filter, (_pappl_scaler_cb_t)test_scale_cb, &image)) == NULL)
+      {
+        testEndMessage(false, "unable to create scaler");
+        goto done;
+      }
+
+      for (y = 0; y < out_height; y ++)
+      {
+        if (!_papplScalerGetLine(scaler, y, line))
+        {
+          testEndMessage(false, "unable to get line %d", y);
+          goto done;
+        }
+      }
+
+      _papplScalerDelete(scaler);
+      scaler = NULL;
+
+      gettimeofday(&end, NULL);
+
+      secs[filter + 1] = (end.tv_sec - start.tv_sec) + 0.000001 * (end.tv_usec - start.tv_usec);
+    }
+
+    testEndMessage(true, "%.1fms nearest, %.1fms bilinear, %.1fms Lanczos-2", 1000.0 * secs[0], 1000.0 * secs[1], 1000.0 * secs[2]);
+  }
+
+  ret = true;
+
+  done:
+
+  _papplScalerDelete(scaler);
+  free(pixels);
+  free(solid);
+  free(line);
+  free(expected);
+
+  return (ret);
+}
+
+
+//
+// 'test_scale_cb()' - Get a line of a test image.
+//
+
+static const unsigned char *		// O - Line
+test_scale_cb(
+    _pappl_testimage_t *image,		// I - Image
+    int                row)		// I - Line number
+{
+  return (image->pixels + (size_t)row * (size_t)(image->width * image->depth));
+}
+
+
+//
+// 'test_scale_image()' - Scale an image using floating point math.
+//
+// The image is scaled horizontally and then vertically, rounding to 8 bits
+// after each pass like the image scaler.
+//
+
+static unsigned char *			// O - Scaled image or `NULL` on error
+test_scale_image(
+    const unsigned char *pixels,	// I - Image pixels
+    int                 width,		// I - Width in columns
+    int                 height,		// I - Height in lines
+    int                 depth,		// I - Bytes per pixel
+    int                 out_width,	// I - Output width in columns
+    int                 out_height,	// I - Output height in lines
+    _pappl_resample_t   filter)		// I - Resampling filter
+{
+  int		x,			// Current column
+		y,			// Current line
+		c,			// Current color
+		k,			// Current tap
+		count,			// Number of taps
+		first;			// First input column or line
+  double	weights[1024],		// Filter weights
+		v;			// Filtered value
+  unsigned char	*hpixels,		// Horizontally scaled image
+		*scaled;		// Scaled image
+
+
+  if ((hpixels = malloc((size_t)(out_width * height * depth))) == NULL)
+    return (NULL);
+
+  if ((scaled = malloc((size_t)(out_width * out_height * depth))) == NULL)
+  {
+    free(hpixels);
+    return (NULL);
+  }
+
+  for (x = 0; x < out_width; x ++)
+  {
+    count = test_scale_taps(filter, width, out_width, x, weights, &first);
+
+    for (y = 0; y < height; y ++)
+    {
+      for (c = 0; c < depth; c ++)
+      {
+        for (k = 0, v = 0.5; k < count; k ++)
+          v += weights[k] * pixels[(y * width + first + k) * depth + c];
+
+        hpixels[(y * out_width + x) * depth + c] = (unsigned char)(v < 0.0 ? 0 : v > 255.0 ? 255 : (int)v);
+      }
+    }
+  }
+
+  for (y = 0; y < out_height; y ++)
+  {
+    count = test_scale_taps(filter, height, out_height, y, weights, &first);
+
+    for (x = 0; x < out_width * depth; x ++)
+    {
+      for (k = 0, v = 0.5; k < count; k ++)
+        v += weights[k] * hpixels[(first + k) * out_width * depth + x];
+
+      scaled[y * out_width * depth + x] = (unsigned char)(v < 0.0 ? 0 : v > 255.0 ? 255 : (int)v);
+    }
+  }
+
+  free(hpixels);
+
+  return (scaled);
+}
+
+
+//
+// 'test_scale_nearest()' - Scale an image using nearest-neighbor sampling.
+//
+// This is the scaling code used by PAPPL 1.2 and earlier.
+//
+
+static void
+test_scale_nearest(
+    const unsigned char *pixels,	// I - Image pixels
+    int                 width,		// I - Width in columns
+    int                 height,		// I - Height in lines
+    int                 depth,		// I - Bytes per pixel
+    unsigned char       *line,		// I - Output line
+    int                 out_width,	// I - Output width in columns
+    int                 out_height)	// I - Output height in lines
+{
+  int			x,		// Current column
+			y,		// Current line
+			row = 0,	// Current image line
+			xerr,		// X error accumulator
+			xmod = width % out_width,
+					// X modulus
+			xstep = (width / out_width) * depth,
+					// X step
+			yerr = -(height % out_height) / 2,
+					// Y error accumulator
+			ymod = height % out_height,
+					// Y modulus
+			ystep = height / out_height;
+					// Y step
+  const unsigned char	*pixptr;	// Pointer into image
+  unsigned char		*lineptr;	// Pointer into line
+
+
+  for (y = 0; y < out_height; y ++)
+  {
+    pixptr = pixels + (size_t)row * (size_t)(width * depth);
+
+    for (x = 0, xerr = -xmod / 2, lineptr = line; x < out_width; x ++)
+    {
+      memcpy(lineptr, pixptr, (size_t)depth);
+      lineptr += depth;
+
+      pixptr += xstep;
+      xerr += xmod;
+      if (xerr >= out_width)
+      {
+        xerr -= out_width;
+        pixptr += depth;
+      }
+    }
+
+    row  += ystep;
+    yerr += ymod;
+    if (yerr >= out_height)
+    {
+      row ++;
+      yerr -= out_height;
+    }
+  }
+}
+
+
+//
+// 'test_scale_taps()' - Compute the filter taps for an output column or line.
+//
+
+static int				// O - Number of taps
+test_scale_taps(
+    _pappl_resample_t filter,		// I - Resampling filter
+    int               in_size,		// I - Input size
+    int               out_size,		// I - Output size
+    int               i,		// I - Output column or line
+    double            *weights,		// I - Weights array
+    int               *first)		// O - First input column or line
+{
+  int		j,			// Looping var
+		lo,			// First input pixel
+		hi;			// Last input pixel + 1
+  double	scale = (double)in_size / (double)out_size,
+					// Input pixels per output pixel
+		fscale = scale > 1.0 ? scale : 1.0,
+					// Filter scale
+		support = (filter == _PAPPL_RESAMPLE_LANCZOS2 ? 2.0 : 1.0) * fscale,
+					// Filter support
+		center = (i + 0.5) * scale,
+					// Center of output pixel
+		x,			// Distance from center
+		total = 0.0;		// Total of weights
+
+
+  if ((lo = (int)(center - support + 0.5)) < 0)
+    lo = 0;
+  if ((hi = (int)(center + support + 0.5)) > in_size)
+    hi = in_size;
+
+  for (j = lo; j < hi; j ++)
+  {
+    x = fabs((j + 0.5 - center) / fscale);
+
+    if (filter == _PAPPL_RESAMPLE_LANCZOS2)
+      weights[j - lo] = x < 0.000001 ? 1.0 : x >= 2.0 ? 0.0 : 2.0 * sin(3.14159265358979323846 * x) * sin(1.57079632679489661923 * x) / (9.86960440108935861883 * x * x);
+    else
+      weights[j - lo] = x < 1.0 ? 1.0 - x : 0.0;
+
+    total += weights[j - lo];
+  }
+
+  for (j = lo; j < hi; j ++)
+    weights[j - lo] /= total;
+
+  *first = lo;
+
+  return (hi - lo);
+}
+
+
+//
+// 'test_scheduler()' - Test the order in which jobs are processed.
+//
+// Jobs are queued on a stopped printer and must be started in order of
+// "job-priority" and then round-robin by user, so that a batch of jobs from
+// one user does not delay the jobs from other users.
+//
+
+static bool				// O - `true` on success, `false` on failure
+test_scheduler(pappl_system_t *system)	// I - System
+{
+  bool		ret = false;		// Return value
+  http_t	*http = NULL;		// HTTP connection
+  char		uri[1024],		// "printer-uri" value
+		filename[1024] = "";	// Print file
+  int		fd;			// Print file descriptor
+  ipp_t		*request,		// IPP request
+		*response;		// IPP response
+  size_t	i,			// Looping var
+		num_jobs = 0;		// Number of jobs submitted
+  int		job_ids[6],		// Submitted job IDs
+		expected[6];		// Expected processing order
+  pappl_printer_t *printer;		// Printer
+  pappl_job_t	*job;			// Job
+  static const char * const users[6] =	// "requesting-user-name" values
+  {
+    "alice",
+    "alice",
+    "alice",
+    "bob",
+    "carol",
+    "alice"
+  };
+  static const int priorities[6] =	// "job-priority" values
+  {
+    50,
+    50,
+    50,
+    50,
+    90,
+    10
+  };
+  static const size_t order[6] =	// Expected order of submitted jobs
+  {
+    4,					// carol has the highest priority
+    0,					// alice's first job
+    3,					// bob's job comes before alice's second
+    1,
+    2,
+    5					// alice's low priority job is last
   };
 
 
   // Connect to system...
-  testBegin("%s: Connect to server", prompt);
-  if ((http = connect_to_printer(system, true, uri, sizeof(uri))) == NULL)
+  testBegin("scheduler: Connect to server");
+  if ((http = connect_to_printer(system, false, uri, sizeof(uri))) == NULL)
   {
     testEndMessage(false, "Unable to connect: %s", cupsLastErrorString());
     return (false);
   }
-
   testEnd(true);
 
-  // Print files...
-  for (i = 0; i < num_files; i ++)
+  if ((printer = papplSystemFindPrinter(system, "/ipp/print", 0, NULL)) == NULL)
   {
-    if (access(files[i], R_OK))
-      snprintf(filename, sizeof(filename), "testsuite/%s", files[i]);
-    else
-      papplCopyString(filename, files[i], sizeof(filename));
+    testBegin("scheduler: papplSystemFindPrinter");
+    testEndMessage(false, "Unable to find printer");
+    goto done;
+  }
 
-    for (j = 0; j < (int)(sizeof(orients) / sizeof(orients[0])); j ++)
+  // Create a (bad) raster file that aborts quickly...
+  if ((fd = cupsTempFd(filename, (cups_len_t)sizeof(filename))) < 0)
+  {
+    testBegin("scheduler: cupsTempFd");
+    testEndMessage(false, "%s", strerror(errno));
+    goto done;
+  }
+
+  if (write(fd, "RaS2", 4) < 0)
+  {
+    testBegin("scheduler: write");
+    testEndMessage(false, "%s", strerror(errno));
+    close(fd);
+    goto done;
+  }
+
+  close(fd);
+
+  // Queue the jobs on the stopped printer...
+  papplPrinterPause(printer);
+
+  for (num_jobs = 0; num_jobs < (sizeof(job_ids) / sizeof(job_ids[0])); num_jobs ++)
+  {
+    testBegin("scheduler: Print-Job(%s, job-priority=%d)", users[num_jobs], priorities[num_jobs]);
+
+    request = ippNewRequest(IPP_OP_PRINT_JOB);
+    ippAddString(request, IPP_TAG_OPERATION, IPP_TAG_URI, "printer-uri", NULL, uri);
+    ippAddString(request, IPP_TAG_OPERATION, IPP_TAG_NAME, "requesting-user-name", NULL, users[num_jobs]);
+    ippAddString(request, IPP_TAG_OPERATION, IPP_CONST_TAG(IPP_TAG_MIMETYPE), "document-format", NULL, "image/pwg-raster");
+    ippAddString(request, IPP_TAG_OPERATION, IPP_TAG_NAME, "job-name", NULL, "scheduler");
+
+    ippAddInteger(request, IPP_TAG_JOB, IPP_TAG_INTEGER, "job-priority", priorities[num_jobs]);
+
+    response = cupsDoFileRequest(http, request, "/ipp/print", filename);
+
+    if (cupsLastError() >= IPP_STATUS_ERROR_BAD_REQUEST)
     {
-      for (k = 0; k < (int)(sizeof(modes) / sizeof(modes[0])); k ++)
-      {
-	for (m = 0; m < (int)(sizeof(scalings) / sizeof(scalings[0])); m ++)
-	{
-	  // Stop the test if the system is shutdown (e.g. CTRL+C)
-	  if (papplSystemIsShutdown(system))
-	    return (false);
+      testEndMessage(false, "%s", cupsLastErrorString());
+      ippDelete(response);
+      papplPrinterResume(printer);
+      goto done;
+    }
 
-	  // Print the job...
-	  snprintf(job_name, sizeof(job_name), "%s+%s+%s+%s", files[i], ippEnumString("orientation-requested", orients[j]), modes[k], scalings[m]);
-	  testBegin("%s: Print-Job(%s)", prompt, job_name);
+    job_ids[num_jobs] = ippGetInteger(ippFindAttribute(response, "job-id", IPP_TAG_INTEGER), 0);
 
-	  request = ippNewRequest(IPP_OP_PRINT_JOB);
-	  ippAddString(request, IPP_TAG_OPERATION, IPP_TAG_URI, "printer-uri", NULL, uri);
-	  ippAddString(request, IPP_TAG_OPERATION, IPP_TAG_NAME, "requesting-user-name", NULL, cupsGetUser());
-	  ippAddString(request, IPP_TAG_OPERATION, IPP_TAG_MIMETYPE, "document-format", NULL, format);
-	  ippAddString(request, IPP_TAG_OPERATION, IPP_TAG_NAME, "job-name", NULL, job_name);
+    ippDelete(response);
 
-          ippAddInteger(request, IPP_TAG_JOB, IPP_TAG_ENUM, "orientation-requested", orients[j]);
-	  ippAddString(request, IPP_TAG_JOB, IPP_TAG_KEYWORD, "print-color-mode", NULL, modes[k]);
-	  ippAddString(request, IPP_TAG_JOB, IPP_TAG_KEYWORD, "print-scaling", NULL, scalings[m]);
+    testEndMessage(true, "job-id=%d", job_ids[num_jobs]);
+  }
 
-	  response = cupsDoFileRequest(http, request, "/ipp/print", filename);
+  // Start the printer and record the order in which the jobs are started...
+  pthread_mutex_lock(&sched_mutex);
+  sched_printer = printer;
+  sched_count   = 0;
+  pthread_mutex_unlock(&sched_mutex);
 
-	  if (cupsLastError() >= IPP_STATUS_ERROR_BAD_REQUEST)
-	  {
-	    testEndMessage(false, "%s", cupsLastErrorString());
-	    ippDelete(response);
-	    httpClose(http);
-	    return (false);
-	  }
+  papplPrinterResume(printer);
 
-	  job_id = ippGetInteger(ippFindAttribute(response, "job-id", IPP_TAG_INTEGER), 0);
+  testBegin("scheduler: Wait for jobs");
 
-          testEndMessage(true, "job-id=%d", job_id);
-	  ippDelete(response);
+  for (i = 0; i < 60; i ++)
+  {
+    size_t	j;			// Looping var
 
-	  // Poll job status until completed...
-	  do
-	  {
-	    sleep(1);
+    for (j = 0; j < num_jobs; j ++)
+    {
+      if ((job = papplPrinterFindJob(printer, job_ids[j])) != NULL && papplJobGetState(job) < IPP_JSTATE_CANCELED)
+        break;
+    }
+
+    if (j >= num_jobs)
+      break;
+
+    sleep(1);
+  }
 
-	    testBegin("%s: Get-Job-Attributes(job-id=%d)", prompt, job_id);
+  pthread_mutex_lock(&sched_mutex);
+  sched_printer = NULL;
+  pthread_mutex_unlock(&sched_mutex);
 
-	    request = ippNewRequest(IPP_OP_GET_JOB_ATTRIBUTES);
-	    ippAddString(request, IPP_TAG_OPERATION, IPP_TAG_URI, "printer-uri", NULL, uri);
-	    ippAddInteger(request, IPP_TAG_OPERATION, IPP_TAG_INTEGER, "job-id", job_id);
-	    ippAddString(request, IPP_TAG_OPERATION, IPP_TAG_NAME, "requesting-user-name", NULL, cupsGetUser());
+  if (i >= 60)
+  {
+    testEndMessage(false, "timeout");
+    goto done;
+  }
 
-	    response = cupsDoRequest(http, request, "/ipp/print");
+  testEnd(true);
 
-	    if (cupsLastError() >= IPP_STATUS_ERROR_BAD_REQUEST)
-	    {
-	      testEndMessage(false, "%s", cupsLastErrorString());
-	      httpClose(http);
-	      ippDelete(response);
-	      return (false);
-	    }
+  testBegin("scheduler: Job order");
 
-	    job_state = (ipp_jstate_t)ippGetInteger(ippFindAttribute(response, "job-state", IPP_TAG_ENUM), 0);
+  for (i = 0; i < num_jobs; i ++)
+    expected[i] = job_ids[order[i]];
 
-            testEndMessage(true, "job-state=%d", job_state);
-	    ippDelete(response);
-	  }
-	  while (job_state < IPP_JSTATE_CANCELED);
-	}
-      }
+  if (sched_count != num_jobs)
+  {
+    testEndMessage(false, "got %u started jobs, expected %u", (unsigned)sched_count, (unsigned)num_jobs);
+    goto done;
+  }
+
+  for (i = 0; i < num_jobs; i ++)
+  {
+    if (sched_jobs[i] != expected[i])
+    {
+      testEndMessage(false, "got job %d at position %u, expected job %d", sched_jobs[i], (unsigned)(i + 1), expected[i]);
+      goto done;
     }
   }
 
+  testEndMessage(true, "%d,%d,%d,%d,%d,%d", sched_jobs[0], sched_jobs[1], sched_jobs[2], sched_jobs[3], sched_jobs[4], sched_jobs[5]);
+
+  ret = true;
+
+  done:
+
+  if (filename[0])
+    unlink(filename);
+
   httpClose(http);
 
-  return (true);
+  return (ret);
 }
-#endif // HAVE_LIBJPEG || HAVE_LIBPNG
 
 
 //
-// 'test_pwg_raster()' - Run PWG Raster tests.
+// 'test_streaming()' - Test streaming document data to a filter.
+//
+// The document is sent in chunks and each chunk must be read by the filter
+// before the next one is sent.  The second job is canceled while the document
+// is still being sent.
 //
 
 static bool				// O - `true` on success, `false` on failure
-test_pwg_raster(pappl_system_t *system)	// I - System
+test_streaming(pappl_system_t *system)	// I - System
 {
   bool		ret = false;		// Return value
   http_t	*http = NULL;		// HTTP connection
   char		uri[1024],		// "printer-uri" value
-		filename[1024] = "",	// Print file
-		job_name[1024];		// "job_name" value
+		buffer[16384];		// Document data
   ipp_t		*request,		// IPP request
-		*response,		// IPP response
-		*supported = NULL;	// Supported attributes
-  ipp_attribute_t *mode_supported;	// "print-color-mode-supported" attribute
-  int		i;			// Looping var
-  int		job_id;			// "job-id" value
-  ipp_jstate_t	job_state;		// "job-state" value
-  static const char * const modes[] =	// "print-color-mode" values
-  {
-    "auto",
-    "auto-monochrome",
-    "color",
-    "monochrome"
-  };
+		*response;		// IPP response
+  int		i,			// Looping var
+		cancel,			// Cancel the job?
+		job_id;			// Job ID
+  size_t	total;			// Bytes sent
+  pappl_printer_t *printer;		// Printer
+  pappl_job_t	*job;			// Job
 
 
   // Connect to system...
-  testBegin("pwg-raster: Connect to server");
+  testBegin("streaming: Connect to server");
   if ((http = connect_to_printer(system, false, uri, sizeof(uri))) == NULL)
   {
     testEndMessage(false, "Unable to connect: %s", cupsLastErrorString());
@@ -3165,57 +5950,88 @@ test_pwg_raster(pappl_system_t *system)	// I - System
   }
   testEnd(true);
 
-  // Get printer capabilities
-  testBegin("pwg-raster: Get-Printer-Attributes");
-
-  request = ippNewRequest(IPP_OP_GET_PRINTER_ATTRIBUTES);
-  ippAddString(request, IPP_TAG_OPERATION, IPP_TAG_URI, "printer-uri", NULL, "ipp://localhost/ipp/print");
-  ippAddString(request, IPP_TAG_OPERATION, IPP_TAG_NAME, "requesting-user-name", NULL, cupsGetUser());
-
-  supported = cupsDoRequest(http, request, "/ipp/print");
-
-  if (cupsLastError() != IPP_STATUS_OK)
-  {
-    testEndMessage(false, "%s", cupsLastErrorString());
-    goto done;
-  }
-
-  if ((mode_supported = ippFindAttribute(supported, "print-color-mode-supported", IPP_TAG_KEYWORD)) == NULL)
+  if ((printer = papplSystemFindPrinter(system, "/ipp/print", 0, NULL)) == NULL)
   {
-    testEndMessage(false, "missing required 'print-color-mode-supported' attribute in response");
+    testBegin("streaming: papplSystemFindPrinter");
+    testEndMessage(false, "Unable to find printer");
     goto done;
   }
 
-  testEnd(true);
+  memset(buffer, 'S', sizeof(buffer));
 
-  // Loop through the supported print-color-mode values...
-  for (i = 0; i < (int)(sizeof(modes) / sizeof(modes[0])); i ++)
+  for (cancel = 0; cancel < 2; cancel ++)
   {
-    // Make raster data for this mode...
-    testBegin("pwg-raster: Print-Job(%s)", modes[i]);
-
-    if (!ippContainsString(mode_supported, modes[i]))
-      continue;				// Not supported, skip
-
-    if (!make_raster_file(supported, strstr(modes[i], "monochrome") != NULL, filename, sizeof(filename)))
-      break;				// Error
+    pthread_mutex_lock(&stream_mutex);
+    stream_job_id = 0;
+    stream_bytes  = 0;
+    stream_done   = false;
+    stream_error  = false;
+    pthread_mutex_unlock(&stream_mutex);
 
-    // Print the file...
-    snprintf(job_name, sizeof(job_name), "pwg-raster-%s", modes[i]);
+    testBegin("streaming: Print-Job(%s)", cancel ? "cancel" : "complete");
 
     request = ippNewRequest(IPP_OP_PRINT_JOB);
     ippAddString(request, IPP_TAG_OPERATION, IPP_TAG_URI, "printer-uri", NULL, uri);
     ippAddString(request, IPP_TAG_OPERATION, IPP_TAG_NAME, "requesting-user-name", NULL, cupsGetUser());
-    ippAddString(request, IPP_TAG_OPERATION, IPP_CONST_TAG(IPP_TAG_MIMETYPE), "document-format", NULL, "image/pwg-raster");
-    ippAddString(request, IPP_TAG_OPERATION, IPP_TAG_NAME, "job-name", NULL, job_name);
+    ippAddString(request, IPP_TAG_OPERATION, IPP_CONST_TAG(IPP_TAG_MIMETYPE), "document-format", NULL, "application/vnd.pappl-stream");
+    ippAddString(request, IPP_TAG_OPERATION, IPP_TAG_NAME, "job-name", NULL, "streaming");
 
-    ippAddString(request, IPP_TAG_JOB, IPP_TAG_KEYWORD, "print-color-mode", NULL, modes[i]);
+    if (cupsSendRequest(http, request, "/ipp/print", CUPS_LENGTH_VARIABLE) != HTTP_STATUS_CONTINUE)
+    {
+      testEndMessage(false, "%s", cupsLastErrorString());
+      ippDelete(request);
+      goto done;
+    }
 
-    response = cupsDoFileRequest(http, request, "/ipp/print", filename);
+    ippDelete(request);
+
+    for (i = 0, total = 0; i < 4; i ++)
+    {
+      if (cupsWriteRequestData(http, buffer, sizeof(buffer)) != HTTP_STATUS_CONTINUE)
+      {
+        testEndMessage(false, "Unable to send document data: %s", cupsLastErrorString());
+        goto done;
+      }
+
+      httpFlushWrite(http);
+
+      total += sizeof(buffer);
+
+      if (cancel && i > 1)
+        continue;
+
+      // The filter must see the data before the document is complete...
+      if (!test_streaming_wait(total, false))
+      {
+        testEndMessage(false, "filter read %u of %u bytes while streaming", (unsigned)stream_bytes, (unsigned)total);
+        goto done;
+      }
+
+      if (cancel && i == 1)
+      {
+        // Cancel the job in the middle of the document...
+        if ((job = papplPrinterFindJob(printer, stream_job_id)) == NULL)
+        {
+          testEndMessage(false, "unable to find job %d", stream_job_id);
+          goto done;
+        }
+
+        papplJobCancel(job);
+
+        if (!test_streaming_wait(0, true))
+        {
+          testEndMessage(false, "filter did not stop after cancel");
+          goto done;
+        }
+      }
+    }
+
+    response = cupsGetResponse(http, "/ipp/print");
 
     if (cupsLastError() >= IPP_STATUS_ERROR_BAD_REQUEST)
     {
-      testEndMessage(false, "Unable to print %s: %s", job_name, cupsLastErrorString());
+      testEndMessage(false, "%s", cupsLastErrorString());
+      ippDelete(response);
       goto done;
     }
 
@@ -3223,49 +6039,240 @@ test_pwg_raster(pappl_system_t *system)	// I - System
 
     ippDelete(response);
 
-    testEndMessage(true, "job-id=%d", job_id);
+    if (!test_streaming_wait(0, true))
+    {
+      testEndMessage(false, "filter did not finish");
+      goto done;
+    }
 
-    // Poll job status until completed...
-    do
+    if (job_id != stream_job_id)
+    {
+      testEndMessage(false, "filter got job %d, expected %d", stream_job_id, job_id);
+      goto done;
+    }
+    else if (stream_error)
+    {
+      testEndMessage(false, "papplJobReadFile returned an error");
+      goto done;
+    }
+    else if (!cancel && stream_bytes != total)
+    {
+      testEndMessage(false, "filter read %u bytes, expected %u", (unsigned)stream_bytes, (unsigned)total);
+      goto done;
+    }
+    else if (cancel && stream_bytes >= total)
+    {
+      testEndMessage(false, "filter read the whole document after cancel");
+      goto done;
+    }
+
+    // Wait for the job to complete...
+    for (i = 0; i < 30; i ++)
     {
+      if ((job = papplPrinterFindJob(printer, job_id)) != NULL && papplJobGetState(job) >= IPP_JSTATE_CANCELED)
+        break;
+
       sleep(1);
+    }
 
-      testBegin("pwg-raster: Get-Job-Attributes(job-id=%d)", job_id);
+    if (!job || papplJobGetState(job) != (cancel ? IPP_JSTATE_CANCELED : IPP_JSTATE_COMPLETED))
+    {
+      testEndMessage(false, "job-state=%s", job ? ippEnumString("job-state", (int)papplJobGetState(job)) : "unknown");
+      goto done;
+    }
 
-      request = ippNewRequest(IPP_OP_GET_JOB_ATTRIBUTES);
-      ippAddString(request, IPP_TAG_OPERATION, IPP_TAG_URI, "printer-uri", NULL, uri);
-      ippAddInteger(request, IPP_TAG_OPERATION, IPP_TAG_INTEGER, "job-id", job_id);
-      ippAddString(request, IPP_TAG_OPERATION, IPP_TAG_NAME, "requesting-user-name", NULL, cupsGetUser());
+    testEndMessage(true, "job-id=%d, %u bytes", job_id, (unsigned)stream_bytes);
+  }
 
-      response = cupsDoRequest(http, request, "/ipp/print");
+  ret = true;
 
-      if (cupsLastError() >= IPP_STATUS_ERROR_BAD_REQUEST)
+  done:
+
+  httpClose(http);
+
+  return (ret);
+}
+
+
+//
+// 'test_streaming_cb()' - Streaming filter callback.
+//
+// The filter just reads the document data using papplJobReadFile.
+//
+
+static bool				// O - `true` on success, `false` on failure
+test_streaming_cb(
+    pappl_job_t    *job,		// I - Job
+    pappl_device_t *device,		// I - Device (unused)
+    void           *data)		// I - Callback data (unused)
+{
+  int		fd;			// Document file
+  char		buffer[8192];		// Read buffer
+  ssize_t	bytes;			// Bytes read
+
+
+  (void)device;
+  (void)data;
+
+  pthread_mutex_lock(&stream_mutex);
+  stream_job_id = papplJobGetID(job);
+  pthread_mutex_unlock(&stream_mutex);
+
+  if ((fd = open(papplJobGetFilename(job), O_RDONLY | O_BINARY)) < 0)
+  {
+    bytes = -1;
+  }
+  else
+  {
+    while ((bytes = papplJobReadFile(job, fd, buffer, sizeof(buffer))) > 0)
+    {
+      pthread_mutex_lock(&stream_mutex);
+      stream_bytes += (size_t)bytes;
+      pthread_cond_broadcast(&stream_cond);
+      pthread_mutex_unlock(&stream_mutex);
+    }
+
+    close(fd);
+  }
+
+  pthread_mutex_lock(&stream_mutex);
+  stream_done  = true;
+  stream_error = bytes < 0;
+  pthread_cond_broadcast(&stream_cond);
+  pthread_mutex_unlock(&stream_mutex);
+
+  return (bytes == 0);
+}
+
+
+//
+// 'test_streaming_wait()' - Wait for the streaming filter.
+//
+// This function waits up to 10 seconds for the filter to read at least "bytes"
+// bytes or, if "done" is `true`, to finish.
+//
+
+static bool				// O - `true` on success, `false` on timeout
+test_streaming_wait(size_t bytes,	// I - Minimum number of bytes read
+                    bool   done)	// I - Wait for the filter to finish?
+{
+  bool			ret;		// Return value
+  struct timeval	curtime;	// Current time
+  struct timespec	timeout;	// Timeout
+
+
+  gettimeofday(&curtime, NULL);
+  timeout.tv_sec  = curtime.tv_sec + 10;
+  timeout.tv_nsec = curtime.tv_usec * 1000;
+
+  pthread_mutex_lock(&stream_mutex);
+
+  while (!(ret = stream_bytes >= bytes && (stream_done || !done)))
+  {
+    if (pthread_cond_timedwait(&stream_cond, &stream_mutex, &timeout))
+    {
+      ret = stream_bytes >= bytes && (stream_done || !done);
+      break;
+    }
+  }
+
+  pthread_mutex_unlock(&stream_mutex);
+
+  return (ret);
+}
+
+
+//
+// 'test_webif()' - Benchmark web interface page generation.
+//
+// Each page is fetched repeatedly over a single connection.  The number of
+// write system calls per page is reported on Linux.  Run with and without the
+// "-B" option to compare buffered and unbuffered output.
+//
+
+static bool				// O - `true` on success, `false` on failure
+test_webif(pappl_system_t *system)	// I - System
+{
+  bool			ret = false;	// Return value
+  http_t		*http;		// HTTP connection
+  pappl_printer_t	*printer;	// Default printer
+  http_status_t		status;		// HTTP status
+  char			uri[1024],	// "printer-uri" value (unused)
+			jobs[1024],	// Jobs page path
+			buffer[8192];	// Page buffer
+  const char		*paths[2];	// Pages to fetch
+  int			i,		// Looping var
+			count;		// Fetch count
+  ssize_t		bytes;		// Bytes read
+  size_t		total;		// Total bytes read
+  long			writes;		// Number of write calls
+  struct timeval	start,		// Start time
+			end;		// End time
+  double		msecs;		// Elapsed milliseconds
+
+
+  if ((printer = papplSystemFindPrinter(system, NULL, 0, NULL)) == NULL)
+  {
+    testBegin("webif: papplSystemFindPrinter");
+    testEndMessage(false, "no default printer");
+    return (false);
+  }
+
+  paths[0] = "/";
+  paths[1] = papplPrinterGetPath(printer, "jobs", jobs, sizeof(jobs));
+
+  if ((http = connect_to_printer(system, false, uri, sizeof(uri))) == NULL)
+  {
+    testBegin("webif: Connect to server");
+    testEndMessage(false, "%s", cupsLastErrorString());
+    return (false);
+  }
+
+  for (i = 0; i < (int)(sizeof(paths) / sizeof(paths[0])); i ++)
+  {
+    testBegin("webif: GET %s", paths[i]);
+
+    writes = get_write_count();
+    total  = 0;
+
+    gettimeofday(&start, NULL);
+
+    for (count = 0; count < 100; count ++)
+    {
+      if (httpGet(http, paths[i]))
       {
-	testEndMessage(false, "Unable to get job state for '%s': %s", job_name, cupsLastErrorString());
+        testEndMessage(false, "%s", cupsLastErrorString());
         goto done;
       }
 
-      job_state = (ipp_jstate_t)ippGetInteger(ippFindAttribute(response, "job-state", IPP_TAG_ENUM), 0);
+      while ((status = httpUpdate(http)) == HTTP_STATUS_CONTINUE)
+        ;
 
-      testEndMessage(true, "job-state=%d", job_state);
-      ippDelete(response);
+      if (status != HTTP_STATUS_OK)
+      {
+        testEndMessage(false, "%s", httpStatusString(status));
+        goto done;
+      }
+
+      while ((bytes = httpRead(http, buffer, sizeof(buffer))) > 0)
+        total += (size_t)bytes;
     }
-    while (job_state < IPP_JSTATE_CANCELED);
 
-    // Cleanup...
-    unlink(filename);
+    gettimeofday(&end, NULL);
+
+    msecs = (1000.0 * (end.tv_sec - start.tv_sec) + 0.001 * (end.tv_usec - start.tv_usec)) / count;
+
+    if (writes >= 0 && (writes = get_write_count() - writes) >= 0)
+      testEndMessage(true, "%.3fms, %.1f writes, %lu bytes per page", msecs, (double)writes / count, (unsigned long)(total / (size_t)count));
+    else
+      testEndMessage(true, "%.3fms, %lu bytes per page", msecs, (unsigned long)(total / (size_t)count));
   }
 
-  // If we complete the loop without errors, it is a successful run...
   ret = true;
 
   done:
 
-  if (filename[0])
-    unlink(filename);
-
   httpClose(http);
-  ippDelete(supported);
 
   return (ret);
 }
@@ -3592,6 +6599,7 @@ usage(int status)			// I - Exit status
   puts("  --version                  Show version");
   puts("  -1                         Single queue");
   puts("  -A PAM-SERVICE             Enable authentication using PAM service");
+  puts("  -B                         Buffer web interface output");
   puts("  -c                         Do a clean run (no loading of state)");
   puts("  -d SPOOL-DIRECTORY         Set the spool directory");
   puts("  -l LOG-FILE                Set the log file");
@@ -3606,9 +6614,20 @@ usage(int status)			// I - Exit status
   puts("Tests:");
   puts("  all                  All of the following tests");
   puts("  client               Simulated client tests");
+  puts("  connections          Client connection scaling tests");
+  puts("  dither               Dither kernel tests");
+  puts("  find-printer         Printer lookup benchmarks");
+  puts("  get-jobs             Get-Jobs benchmarks");
   puts("  jpeg                 JPEG image tests");
+  puts("  max-jobs             Concurrent job processing tests");
+  puts("  offline              Unavailable device tests");
   puts("  png                  PNG image tests");
   puts("  pwg-raster           PWG Raster tests");
+  puts("  render               Parallel image rendering benchmarks");
+  puts("  scale                Image scaler tests");
+  puts("  scheduler            Job scheduling tests");
+  puts("  streaming            Streaming filter tests");
+  puts("  webif                Web interface benchmarks");
 
   return (status);
 }
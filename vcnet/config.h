@@ -162,3 +162,7 @@ typedef unsigned long useconds_t;
 /* #undef HAVE_ARC4RANDOM */
 /* #undef HAVE_GETRANDOM */
 /* #undef HAVE_GNUTLS_RND */
+
+
+// Event polling support
+/* #undef HAVE_SYS_EPOLL_H */